@@ -50,8 +50,9 @@ override CFLAGS += -g -Wall -Werror -MMD -I$(INCLUDE)
 
 # Linker options
 #   -lm        Link με τη math library
+#   -pthread   Link με τη βιβλιοθήκη των POSIX threads
 #
-LDFLAGS += -lm
+LDFLAGS += -lm -pthread
 
 # Αν στα targets με τα οποία έχει κληθεί το make (μεταβλητή MAKECMDGOALS) υπάρχει κάποιο
 # coverage*, τότε προσθέτουμε το --coverage στα compile & link flags
@@ -49,6 +49,11 @@ void list_remove_next(List list, ListNode node);
 
 Pointer list_find(List list, Pointer value, CompareFunc compare);
 
+// Μεταφέρει όλους τους κόμβους της λίστας other στο τέλος της list, σε Ο(1).
+// Η other καταστρέφεται (χωρίς να κληθεί η destroy_value για τα στοιχεία της).
+
+void list_append(List list, List other);
+
 // Αλλάζει τη συνάρτηση που καλείται σε κάθε αφαίρεση/αντικατάσταση στοιχείου σε
 // destroy_value. Επιστρέφει την προηγούμενη τιμή της συνάρτησης.
 
@@ -59,6 +64,11 @@ DestroyFunc list_set_destroy_value(List list, DestroyFunc destroy_value);
 
 void list_destroy(List list);
 
+// Επιστρέφει τα bytes που δεσμεύει η λίστα για τη δική της δομή (struct και κόμβοι),
+// χωρίς τη μνήμη των ίδιων των στοιχείων. Πολυπλοκότητα O(1).
+
+size_t list_memory(List list);
+
 
 // Διάσχιση της λίστας /////////////////////////////////////////////
 //
@@ -57,6 +57,11 @@ DestroyFunc map_set_destroy_value(Map map, DestroyFunc destroy_value);
 
 void map_destroy(Map map);
 
+// Επιστρέφει τα bytes που δεσμεύει το map για τη δική του δομή (struct, πίνακας, buckets και κόμβοι),
+// χωρίς τη μνήμη των ίδιων των στοιχείων. Πολυπλοκότητα O(capacity).
+
+size_t map_memory(Map map);
+
 
 
 // Διάσχιση του map μέσω κόμβων ////////////////////////////////////////////////////////////
@@ -55,6 +55,11 @@ DestroyFunc set_set_destroy_value(Set set, DestroyFunc destroy_value);
 
 void set_destroy(Set set);
 
+// Επιστρέφει τα bytes που δεσμεύει το set για τη δική του δομή (struct και κόμβοι του δέντρου),
+// χωρίς τη μνήμη των ίδιων των στοιχείων. Πολυπλοκότητα O(1).
+
+size_t set_memory(Set set);
+
 
 // Διάσχιση του set ////////////////////////////////////////////////////////////
 //
@@ -72,7 +77,7 @@ SetNode set_first(Set set);
 SetNode set_last(Set set);
 
 // Επιστρέφουν τον επόμενο και τον προηγούμενο κομβο του node, ή SET_EOF / SET_BOF
-// αντίστοιχα αν ο node δεν έχει επόμενο / προηγούμενο.
+// αντίστοιχα αν ο node δεν έχει επόμενο / προηγούμενο. Μια πλήρης διάσχιση κοστίζει O(n).
 
 SetNode set_next(Set set, SetNode node);
 SetNode set_previous(Set set, SetNode node);
@@ -85,3 +90,23 @@ Pointer set_node_value(Set set, SetNode node);
 // Επιστρέφει τον κόμβο του στοιχείου, ή SET_EOF αν δεν βρεθεί.
 
 SetNode set_find_node(Set set, Pointer value);
+
+// Όπως η set_insert, αλλά επιστρέφει τον κόμβο του set που περιέχει πλέον τη value.
+// Ο κόμβος παραμένει έγκυρος (και με την ίδια τιμή) μέχρι να αφαιρεθεί η τιμή του.
+
+SetNode set_insert_node(Set set, Pointer value);
+
+// Αφαιρεί τον κόμβο node από το set, χωρίς αναζήτηση (και χωρίς κλήσεις της compare).
+// Οι υπόλοιποι κόμβοι του set παραμένουν έγκυροι.
+
+void set_remove_node(Set set, SetNode node);
+
+// Επιστρέφει τον κόμβο που βρίσκεται στη θέση pos (0-based) της σειράς διάταξης,
+// ή SET_EOF αν pos < 0 ή pos >= size. Πολυπλοκότητα O(log n).
+
+SetNode set_node_at(Set set, int pos);
+
+// Επιστρέφει το πλήθος των στοιχείων του set που είναι μικρότερα από value (δηλαδή τη θέση στην
+// οποία βρίσκεται, ή θα έμπαινε, η value). Πολυπλοκότητα O(log n).
+
+int set_rank(Set set, Pointer value);
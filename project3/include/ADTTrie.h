@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////
+//
+// ADT Trie
+//
+// Abstract αντιστοίχιση από String keys σε τιμές, με γρήγορη αναζήτηση
+// όλων των keys που αρχίζουν από ένα δοσμένο prefix. Κάθε key μπορεί να
+// αντιστοιχεί σε περισσότερες από μία τιμές.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "common_types.h"
+#include "ADTList.h"
+
+
+// Ενα trie αναπαριστάται από τον τύπο Trie
+
+typedef struct trie* Trie;
+
+
+// Δημιουργεί και επιστρέφει ένα κενό trie.
+// Αν destroy_value != NULL, τότε καλείται destroy_value(value) κάθε φορά που αφαιρείται μια τιμή.
+
+Trie trie_create(DestroyFunc destroy_value);
+
+// Επιστρέφει τον αριθμό των ζευγών (key, value) που περιέχει το trie
+
+int trie_size(Trie trie);
+
+// Προσθέτει το ζεύγος (key, value). Το trie κρατάει δικό του αντίγραφο του key, οπότε
+// αυτό μπορεί να αλλάξει αμέσως μετά την κλήση. Αν το key έχει ήδη τιμές, η value
+// προστίθεται σε αυτές (ακόμα και αν υπάρχει ήδη). Πολυπλοκότητα O(|key|).
+
+void trie_insert(Trie trie, String key, Pointer value);
+
+// Αφαιρεί το ζεύγος (key, value), όπου η value συγκρίνεται ως pointer. Επιστρέφει true αν
+// βρέθηκε το ζεύγος, false διαφορετικά. Πολυπλοκότητα O(|key| + τιμές του key).
+
+bool trie_remove(Trie trie, String key, Pointer value);
+
+// Επιστρέφει λίστα με τις τιμές όλων των keys που αρχίζουν από prefix (το "" ταιριάζει με
+// όλα), ταξινομημένες με βάση το key (οι τιμές του ίδιου key σε οποιαδήποτε σειρά). Αν
+// limit >= 0, επιστρέφονται το πολύ limit τιμές. Πολυπλοκότητα O(|prefix| + limit) για
+// σταθερό πλήθος χαρακτήρων. Η λίστα πρέπει να καταστραφεί από τον χρήστη.
+
+List trie_find_prefix(Trie trie, String prefix, int limit);
+
+// Αλλάζει τη συνάρτηση που καλείται σε κάθε αφαίρεση τιμής σε destroy_value.
+// Επιστρέφει την προηγούμενη τιμή της συνάρτησης.
+
+DestroyFunc trie_set_destroy_value(Trie trie, DestroyFunc destroy_value);
+
+// Ελευθερώνει όλη τη μνήμη που δεσμεύει το trie.
+// Οποιαδήποτε λειτουργία πάνω στο trie μετά το destroy είναι μη ορισμένη.
+
+void trie_destroy(Trie trie);
+
+// Επιστρέφει τα bytes που δεσμεύει το trie για τη δική του δομή (κόμβοι, αντίγραφα των
+// keys, πίνακες παιδιών και τιμών), χωρίς τη μνήμη των ίδιων των τιμών. Πολυπλοκότητα O(1).
+
+size_t trie_memory(Trie trie);
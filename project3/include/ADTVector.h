@@ -68,6 +68,11 @@ DestroyFunc vector_set_destroy_value(Vector vec, DestroyFunc destroy_value);
 
 void vector_destroy(Vector vec);
 
+// Επιστρέφει τα bytes που δεσμεύει το vector για τη δική του δομή (struct και πίνακας, μαζί με τις κενές θέσεις),
+// χωρίς τη μνήμη των ίδιων των στοιχείων. Πολυπλοκότητα O(1).
+
+size_t vector_memory(Vector vec);
+
 
 // Διάσχιση του vector ////////////////////////////////////////////////////////////
 //
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////
+//
+// ADT VersionedSet
+//
+// Abstract διατεταγμένο σύνολο (όπως το ADT Set) με snapshots: ένα
+// snapshot είναι μια σταθερή εικόνα του συνόλου τη στιγμή που
+// δημιουργήθηκε, η οποία μπορεί να διασχιστεί από άλλο thread ενώ το
+// σύνολο συνεχίζει να αλλάζει. Οι εκδόσεις που δεν χρειάζονται πλέον
+// (κανένα snapshot δεν τις βλέπει) αποδεσμεύονται αυτόματα.
+//
+////////////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "common_types.h"
+
+
+// Ένα σύνολο αναπαριστάται από τον τύπο VSet, και ένα snapshot του από τον τύπο VSetSnapshot
+
+typedef struct vset* VSet;
+typedef struct vset_snapshot* VSetSnapshot;
+
+
+// Δημιουργεί και επιστρέφει ένα σύνολο, στο οποίο τα στοιχεία συγκρίνονται με βάση
+// τη συνάρτηση compare.
+// Αν destroy_value != NULL, τότε καλείται destroy_value(value) για κάθε στοιχείο που αφαιρείται
+// ή αντικαθίσταται, όταν πλέον δεν το βλέπει κανένα snapshot (βλ. vset_release).
+
+VSet vset_create(CompareFunc compare, DestroyFunc destroy_value);
+
+// Επιστρέφει τον αριθμό στοιχείων που περιέχει το σύνολο vset
+
+int vset_size(VSet vset);
+
+// Προσθέτει την τιμή value στο σύνολο, αντικαθιστώντας τυχόν προηγούμενη τιμή ισοδύναμη της value.
+// Πολυπλοκότητα O(log n). Τα snapshots δεν επηρεάζονται.
+
+void vset_insert(VSet vset, Pointer value);
+
+// Αφαιρεί τη μοναδική τιμή ισοδύναμη της value από το σύνολο, αν υπάρχει.
+// Επιστρέφει true αν βρέθηκε η τιμή αυτή, false διαφορετικά. Τα snapshots δεν επηρεάζονται.
+
+bool vset_remove(VSet vset, Pointer value);
+
+// Ελευθερώνει όλη τη μνήμη που δεσμεύει το σύνολο, μαζί με όλα τα snapshots που δεν έχουν
+// γίνει release. Οποιαδήποτε λειτουργία πάνω στο vset ή στα snapshots του μετά το destroy
+// είναι μη ορισμένη.
+
+void vset_destroy(VSet vset);
+
+// Επιστρέφει τα bytes που δεσμεύει το vset για τη δική του δομή: τους κόμβους της τρέχουσας
+// έκδοσης, και όσους κρατιούνται ακόμα για κάποιο snapshot. Πολυπλοκότητα O(1).
+
+size_t vset_memory(VSet vset);
+
+
+// Snapshots ////////////////////////////////////////////////////////////////////
+//
+// Τα snapshots υλοποιούνται με path copying: όσο υπάρχει κάποιο snapshot, η vset_insert /
+// vset_remove αντιγράφει τους κόμβους που αλλάζει αντί να τους τροποποιεί, οπότε κάθε αλλαγή
+// δεσμεύει O(log n) νέους κόμβους. Χωρίς snapshots οι αλλαγές γίνονται επί τόπου.
+//
+// Οι vset_snapshot, vset_release, vset_snapshot_size και vset_visit μπορούν να κληθούν από
+// οποιοδήποτε thread, ταυτόχρονα με τις αλλαγές του συνόλου. Οι αλλαγές (vset_insert,
+// vset_remove) πρέπει να γίνονται από ένα thread τη φορά.
+
+// Δημιουργεί και επιστρέφει ένα snapshot με τα τρέχοντα στοιχεία του συνόλου. Πολυπλοκότητα O(1).
+
+VSetSnapshot vset_snapshot(VSet vset);
+
+// Αποδεσμεύει το snapshot. Οι κόμβοι και τα στοιχεία που κρατιούνταν μόνο για αυτό ελευθερώνονται
+// στην επόμενη αλλαγή του συνόλου (από το thread που κάνει τις αλλαγές, ώστε η destroy_value να μην
+// καλείται ποτέ ταυτόχρονα με αυτές).
+
+void vset_release(VSet vset, VSetSnapshot snapshot);
+
+// Επιστρέφει τον αριθμό στοιχείων του snapshot
+
+int vset_snapshot_size(VSetSnapshot snapshot);
+
+// Καθορίζει ένα διάστημα της διάταξης: επιστρέφει < 0 αν το value είναι πριν το διάστημα,
+// > 0 αν είναι μετά, και 0 αν ανήκει σε αυτό.
+
+typedef int (*VSetRangeFunc)(Pointer value, Pointer context);
+
+// Καλείται για κάθε στοιχείο της διάσχισης. Αν επιστρέψει false η διάσχιση σταματάει.
+
+typedef bool (*VSetVisitFunc)(Pointer value, Pointer context);
+
+// Καλεί τη visit, με τη σειρά διάταξης, για κάθε στοιχείο του snapshot για το οποίο η range
+// επιστρέφει 0 (για όλα, αν range == NULL). Το context περνάει και στις δύο συναρτήσεις.
+// Πολυπλοκότητα O(log n + m) για m στοιχεία μέσα στο διάστημα.
+
+void vset_visit(VSetSnapshot snapshot, VSetRangeFunc range, VSetVisitFunc visit, Pointer context);
@@ -8,7 +8,10 @@
 
 #pragma once // #include το πολύ μία φορά
 
+#include <stdio.h>
+
 #include "ADTList.h"
+#include "Stats.h"
 
 // Οι ημερομηνίες δίνονται σαν Strings, σε format YYYY-MM-DD, πχ "2019-10-31"
 typedef String Date;
@@ -37,6 +40,57 @@ void dm_init();
 
 void dm_destroy();
 
+// Ορίζει τον αριθμό των threads (default 1) που χρησιμοποιούν οι dm_get_records και
+// dm_count_records όταν χρειάζεται πλήρης διάσχιση των εγγραφών (disease == NULL και
+// country == NULL). Οι εγγραφές χωρίζονται σε τμήματα που φιλτράρονται παράλληλα και τα
+// αποτελέσματα συνενώνονται. Η ρύθμιση διατηρείται και μετά από dm_destroy / dm_init.
+
+void dm_set_threads(int threads);
+
+
+// Ενεργοποιεί (owned == true) ή απενεργοποιεί το owned mode, στο οποίο ο monitor
+// αποθηκεύει δικά του αντίγραφα των records (σε slabs, με τα disease και country
+// κοινά για όλες τις εγγραφές). Η ρύθμιση αλλάζει μόνο όταν ο monitor δεν περιέχει
+// εγγραφές (αλλιώς επιστρέφεται false) και διατηρείται μετά από dm_destroy / dm_init.
+
+bool dm_set_owned(bool owned);
+
+// Ενεργοποιεί (mvcc == true) ή απενεργοποιεί το multi-version mode, στο οποίο ο monitor κρατάει
+// επιπλέον όλες τις εγγραφές σε ένα ADTVersionedSet, ώστε να μπορούν να ανοιχτούν snapshots (βλ.
+// dm_snapshot_open). Κάθε αλλαγή κοστίζει ένα επιπλέον O(log n). Η ρύθμιση αλλάζει μόνο όταν ο
+// monitor δεν περιέχει εγγραφές (αλλιώς επιστρέφεται false) και διατηρείται μετά από dm_destroy / dm_init.
+
+bool dm_set_mvcc(bool mvcc);
+
+// Ενεργοποιεί (directory != NULL) ή απενεργοποιεί το history mode, στο οποίο ο monitor κρατάει στη
+// μνήμη μόνο τις εγγραφές των hot_months πιο πρόσφατων μηνών (μετρώντας από τον μήνα της πιο πρόσφατης
+// εγγραφής). Οι παλαιότερες μεταφέρονται, όταν προστίθενται ή όταν ένας νέος μήνας τις κάνει παλιές, σε
+// ένα RecordPartitions με ένα αρχείο ανά μήνα στο directory (που πρέπει να υπάρχει), και διαβάζονται από
+// εκεί μέσω mmap όταν το διάστημα ημερομηνιών μιας dm_get_records / dm_count_records(_batch) τις
+// περιλαμβάνει. Μια εγγραφή που δεν μπορεί να μεταφερθεί (π.χ. με ημερομηνία σε μήνα που είναι ήδη
+// στο δίσκο, ή όχι σε μορφή YYYY-MM-DD) μένει στη μνήμη.
+//
+// Οι εγγραφές του ιστορικού:
+// - Αφαιρούνται, αλλάζουν και αντικαθίστανται (dm_remove_record, dm_update_record, dm_insert_record
+//   με το ίδιο id) όπως και όσες είναι στη μνήμη. Ο monitor κρατάει στη μνήμη το id και την ημερομηνία
+//   κάθε εγγραφής του ιστορικού, και τα αντίγραφα που δεν ισχύουν πλέον μένουν στα αρχεία αλλά
+//   παραλείπονται. Η μεταφορά στο ιστορικό δεν ειδοποιεί τα subscriptions, η αφαίρεση όμως ναι (και
+//   τότε φορτώνεται ο μήνας της εγγραφής).
+// - Από τα queries, μόνο οι dm_get_records και dm_count_records(_batch) τις περιλαμβάνουν (και τα
+//   checkpoints). Όλα τα υπόλοιπα (dm_get_records_page, dm_sample_records, dm_count_by_country,
+//   dm_count_by_disease, dm_top_diseases, dm_top_countries, dm_find_by_name_prefix,
+//   dm_date_percentile, dm_snapshot_open) αποτυγχάνουν όσο είναι ενεργό το history mode,
+//   επιστρέφοντας NULL (και *n == 0), αντί για ένα αποτέλεσμα χωρίς τις εγγραφές του ιστορικού.
+// - Η dm_get_records επιστρέφει αντίγραφα όλων των εγγραφών (και όσων είναι στη μνήμη), που ανήκουν στη
+//   λίστα: τα αποδεσμεύει η list_destroy, και ισχύουν μέχρι τότε ανεξάρτητα από τον monitor.
+// - Για μια περιοχή εξετάζονται όλες οι εγγραφές του ιστορικού στο διάστημα ημερομηνιών.
+//
+// Τα queries που εξετάζουν το ιστορικό φορτώνουν αρχεία, οπότε δεν μπορούν να κληθούν ταυτόχρονα από
+// πολλά threads. Τα αρχεία διαγράφονται με τη dm_destroy. Επιστρέφει false αν directory != NULL και
+// hot_months < 1. Η ρύθμιση αλλάζει μόνο όταν ο monitor δεν περιέχει εγγραφές (αλλιώς επιστρέφεται
+// false) και διατηρείται μετά από dm_destroy / dm_init.
+
+bool dm_set_history(String directory, int hot_months);
 
 // Προσθέτει την εγγραφή record στο monitor. Δεν δεσμεύει νέα μνήμη (ούτε
 // φτιάχνει αντίγραφα του record), απλά αποθηκεύει τον pointer (η δέσμευση
@@ -45,20 +99,143 @@ void dm_destroy();
 //
 // Οι αλλαγές στα δεδομένα της εγγραφής απαγορεύονται μέχρι να γίνει remove από
 // τον monitor.
+//
+// Στο owned mode αποθηκεύεται αντίγραφο του record, οπότε ο χρήστης μπορεί να το
+// αλλάξει ή να το κάνει free αμέσως μετά την κλήση. Τα Records που επιστρέφουν τα
+// queries είναι τα αντίγραφα, και ισχύουν μέχρι να αφαιρεθούν από τον monitor.
 
 bool dm_insert_record(Record record);
 
+// Bulk load: προσθέτει τις εγγραφές records[0 .. n-1] με τη σειρά, με το ίδιο αποτέλεσμα
+// με n κλήσεις της dm_insert_record, αλλά χωρίς αναζήτηση της χώρας και της ασθένειας όταν
+// είναι ίδιες με της προηγούμενης εγγραφής. Αν replaced != NULL, στο replaced[i] αποθηκεύεται
+// το αποτέλεσμα της dm_insert_record για την εγγραφή i. Επιστρέφει πόσες εγγραφές αντικατέστησαν
+// κάποια υπάρχουσα.
+
+int dm_insert_records(Record records[], int n, bool replaced[]);
+
 // Αφαιρεί την εγγραφή με το συγκεκριμένο id από το σύστημα (χωρίς free, είναι
 // ευθύνη του χρήστη). Επιστρέφει true αν υπήρχε τέτοια εγγραφή, αλλιώς false.
+// Στο owned mode το αντίγραφο της εγγραφής αποδεσμεύεται.
 
 bool dm_remove_record(int id);
 
+// Αντικαθιστά την εγγραφή με το συγκεκριμένο id με την record, με το ίδιο αποτέλεσμα
+// με dm_remove_record(id) και dm_insert_record(record). Η εγγραφή μετακινείται όμως
+// μόνο στα indexes που εξαρτώνται από πεδία που άλλαξαν (πχ μια αλλαγή ημερομηνίας
+// δεν αγγίζει τους μετρητές των ασθενειών). Επιστρέφει true αν υπήρχε εγγραφή με
+// αυτό το id, αλλιώς false (και δεν γίνεται καμία αλλαγή).
+
+bool dm_update_record(int id, Record record);
+
+
+// Περιοχές
+//
+// Οι χώρες μπορούν να οργανωθούν σε μια ιεραρχία χώρα → περιοχή → ήπειρος. Ο monitor κρατάει
+// για κάθε περιοχή το πλήθος των εγγραφών και τους μετρητές των ασθενειών όλων των χωρών της,
+// και τα ενημερώνει σε κάθε insert / remove / update. Το όνομα μιας περιοχής (ή ηπείρου) μπορεί
+// να δοθεί ως country στα queries, οπότε αυτά αφορούν όλες τις χώρες της. Η ιεραρχία ανήκει στα
+// δεδομένα του monitor και καταστρέφεται από την dm_destroy.
+
+// Ορίζει ότι η χώρα country ανήκει στην περιοχή region, και (αν continent != NULL) ότι η region
+// ανήκει στην ήπειρο continent. Μια χώρα ή περιοχή που ανήκε ήδη αλλού μετακινείται, μαζί με τους
+// μετρητές της. Επιστρέφει false (χωρίς καμία αλλαγή) αν κάποιο όνομα χρησιμοποιείται ήδη σε άλλο
+// επίπεδο της ιεραρχίας (πχ μια χώρα με το όνομα μιας περιοχής), ή αν η continent περιέχεται
+// στην region. Πολυπλοκότητα ανάλογη των ασθενειών της χώρας / περιοχής που μετακινείται.
+
+bool dm_set_region(String country, String region, String continent);
+
+// Διαβάζει την ιεραρχία από το αρχείο path, με μία γραμμή "country, region[, continent]" για
+// κάθε κλήση της dm_set_region (οι κενές γραμμές και όσες αρχίζουν με # αγνοούνται). Επιστρέφει
+// false αν το αρχείο δεν ανοίγει ή κάποια γραμμή είναι λάθος (οι υπόλοιπες φορτώνονται κανονικά).
+
+bool dm_load_regions(String path);
+
+
+// Ανίχνευση εξάρσεων
+//
+// Ο monitor μπορεί να εξετάζει κάθε εγγραφή που προστίθεται (dm_insert_record, dm_insert_records)
+// για εξάρσεις ανά (ασθένεια, χώρα), χωρίς να χρειάζεται περιοδικό polling με dm_count_records. Για
+// κάθε ζεύγος μετράει τις εγγραφές ανά ημέρα και κρατάει μια baseline (EWMA) για το ημερήσιο πλήθος
+// (βλ. Outbreak.h). Όταν οι εγγραφές μιας ημέρας ξεπεράσουν τη μέση τιμή κατά threshold τυπικές
+// αποκλίσεις καλείται το callback, μία φορά ανά ημέρα, με κόστος O(1) ανά εγγραφή. Οι εγγραφές
+// θεωρούνται ότι φτάνουν περίπου με χρονολογική σειρά: όσες είναι παλιότερες από την τελευταία
+// ημέρα του ζεύγους δεν επηρεάζουν την ανίχνευση, όπως και οι dm_update_record / dm_remove_record.
+
+// Μια έξαρση, όπως περνάει στο callback
+
+struct dm_outbreak {
+	String disease;
+	String country;
+	Date date;					// Η ημέρα της έξαρσης
+	int count;					// Οι εγγραφές της ημέρας μέχρι στιγμής
+	double mean;				// Η μέση τιμή της baseline
+	double deviation;			// Η τυπική απόκλιση της baseline
+};
+typedef struct dm_outbreak* DMOutbreak;
+
+// Καλείται για κάθε έξαρση, κατά την εισαγωγή της εγγραφής που την προκάλεσε. Μπορεί να καλέσει
+// queries του monitor, όχι όμως αλλαγές (insert, remove, update). Τα strings του outbreak ισχύουν
+// μόνο κατά την κλήση.
+
+typedef void (*DMOutbreakFunc)(DMOutbreak outbreak, Pointer context);
+
+struct dm_outbreak_config {
+	double alpha;				// Βάρος κάθε νέας ημέρας στη baseline, στο (0, 1], πχ 0.1
+	double threshold;			// Τυπικές αποκλίσεις πάνω από τη μέση τιμή, πχ 3
+	int min_count;				// Ελάχιστο πλήθος εγγραφών της ημέρας για έξαρση
+	int warmup;					// Ημέρες που πρέπει να έχει η baseline πριν ξεκινήσει η ανίχνευση
+	DMOutbreakFunc callback;
+	Pointer context;			// Περνάει στο callback
+};
+typedef struct dm_outbreak_config* DMOutbreakConfig;
+
+// Ενεργοποιεί την ανίχνευση με τις παραμέτρους του config (αντιγράφεται), ή την απενεργοποιεί αν
+// config == NULL. Κάθε κλήση ξεκινάει τις baselines από την αρχή. Η ρύθμιση διατηρείται μετά από
+// dm_destroy / dm_init, οι baselines όμως ανήκουν στα δεδομένα και καταστρέφονται. Η baseline
+// ενός ζεύγους χάνεται επίσης όταν αφαιρεθεί η τελευταία του εγγραφή.
+
+void dm_set_outbreak_detection(DMOutbreakConfig config);
+
+
+// Συνεχή queries
+//
+// Αντί για περιοδικό polling με dm_get_records, ένας consumer μπορεί να εγγραφεί (dm_subscribe)
+// για τις αλλαγές των εγγραφών που ικανοποιούν τα κριτήρια disease, country (όπως στα queries,
+// το country μπορεί να είναι και περιοχή). Κάθε αλλαγή κοστίζει O(h) αναζητήσεις για ιεραρχία
+// περιοχών βάθους h, συν μία κλήση για κάθε subscription που ταιριάζει, ανεξάρτητα από το πλήθος
+// των εγγραφών και των υπόλοιπων subscriptions. Τα subscriptions ανήκουν στα δεδομένα του monitor
+// και καταστρέφονται από την dm_destroy.
+
+typedef enum {
+	DM_RECORD_INSERTED,			// dm_insert_record, dm_insert_records
+	DM_RECORD_REMOVED,			// dm_remove_record, και η εγγραφή που αντικαθίσταται από ένα insert
+} DMEvent;
+
+// Καλείται για κάθε εγγραφή που ταιριάζει, μετά την ενημέρωση των indexes. Ένα dm_update_record
+// δίνει DM_RECORD_REMOVED για την παλιά εγγραφή (αν ταιριάζει) και DM_RECORD_INSERTED για τη νέα (αν
+// ταιριάζει). Μπορεί να καλέσει queries του monitor, όχι όμως αλλαγές ή dm_subscribe / dm_unsubscribe.
+// Το record ισχύει μόνο κατά την κλήση για το DM_RECORD_REMOVED.
+
+typedef void (*DMSubscriptionFunc)(Record record, DMEvent event, Pointer context);
+
+// Εγγράφει το callback για τις εγγραφές με ασθένεια disease και χώρα country (όλες, αν NULL).
+// Επιστρέφει ένα id (> 0) για τη dm_unsubscribe, ή 0 αν callback == NULL. Πολυπλοκότητα O(1).
+
+int dm_subscribe(String disease, String country, DMSubscriptionFunc callback, Pointer context);
+
+// Διαγράφει το subscription id. Επιστρέφει false αν δεν υπάρχει. Πολυπλοκότητα ανάλογη των
+// subscriptions με τα ίδια κριτήρια.
+
+bool dm_unsubscribe(int id);
+
 
 // Monitor queries
 //
 // Στις παρακάτω συναρτήσεις χρησιμοποιούνται τα παρακάτω κριτήρια αναζήτησης εγγραφών:
 //   disease:   Μόνο εγγραφές με τη συγκεκριμένη ασθένεια (όλες, αν NULL)
-//   country:   Μόνο εγγραφές με τη συγκεκριμένη χώρα (όλες, αν NULL)
+//   country:   Μόνο εγγραφές με τη συγκεκριμένη χώρα (όλες, αν NULL). Αν είναι το όνομα μιας
+//              περιοχής (βλ. dm_set_region), εγγραφές από οποιαδήποτε χώρα της περιοχής.
 //   date_from: Μόνο εγγραφές με ημερομηνία date_from ή μεταγενέστερη (όλες, αν NULL)
 //   date_to:   Μόνο εγγραφές με ημερομηνία date_to ή προγενέστερη (όλες, αν NULL)
 //
@@ -68,24 +245,292 @@ bool dm_remove_record(int id);
 // Στις συναρτήσεις που επιστρέφουν λίστα, η λίστα δημιουργείται την ώρα της
 // κλήσης και είναι ευθύνη του χρήστη να καλέσει τη list_destroy (η οποία θα
 // ελευθερώσει μόνο τη λίστα, όχι τα δεδομένα).
+//
+// Τα queries δεν τροποποιούν καμία δομή του monitor, οπότε μπορούν να κληθούν ταυτόχρονα
+// από πολλά threads, αρκεί να μην εκτελείται την ίδια στιγμή κάποια αλλαγή (insert, remove,
+// update), να μην είναι ενεργό το trace, και με dm_set_threads(1) (το thread pool του
+// monitor δεν μπορεί να χρησιμοποιηθεί από πολλά threads μαζί).
 
 
 // Επιστρέφει λίστα με τα Records που ικανοποιούν τα συγκεκριμένα κριτήρια, σε
-// οποιαδήποτε σειρά.
+// οποιαδήποτε σειρά. Για μια περιοχή με c χώρες (που έχουν εγγραφές), πολυπλοκότητα
+// O(c log n + m) για m εγγραφές στο αποτέλεσμα: το διάστημα ημερομηνιών βρίσκεται με rank
+// στις εγγραφές κάθε χώρας, χωρίς να εξεταστούν οι υπόλοιπες χώρες ή εγγραφές.
 
 List dm_get_records(String disease, String country, Date date_from, Date date_to);
 
-// Επιστρέφει τον αριθμό εγγραφών που ικανοποιούν τα συγκεκριμένα κριτήρια.
+// Επιστρέφει τον αριθμό εγγραφών που ικανοποιούν τα συγκεκριμένα κριτήρια. Για μια περιοχή
+// χωρίς date_from / date_to η απάντηση προκύπτει από τους μετρητές της σε O(1), και με
+// ημερομηνίες σε O(c log n) για c χώρες, όπως στη dm_get_records.
 
 int dm_count_records(String disease, String country, Date date_from, Date date_to);
 
+// Επιστρέφει μια σελίδα των εγγραφών που ικανοποιούν τα κριτήρια της dm_get_records, ταξινομημένων
+// κατά ημερομηνία (και id για την ίδια ημερομηνία), από τις παλαιότερες ή, αν newest_first == true,
+// από τις νεότερες: τις limit εγγραφές (όλες τις υπόλοιπες αν limit < 0) μετά τις πρώτες offset.
+// Η λίστα είναι κενή αν offset < 0 ή offset >= πλήθος εγγραφών.
+// Πολυπλοκότητα O(log n + limit), μέσω rank / select στα AVL sets κατά ημερομηνία. Για μια περιοχή
+// με c χώρες, O(c^2 log^2 n + c limit).
+
+List dm_get_records_page(String disease, String country, Date date_from, Date date_to, bool newest_first, int offset, int limit);
+
+// Επιστρέφει ένα τυχαίο δείγμα k διαφορετικών εγγραφών από αυτές που ικανοποιούν τα κριτήρια της
+// dm_get_records (όλες αν είναι λιγότερες από k), ταξινομημένες κατά ημερομηνία. Κάθε υποσύνολο k
+// εγγραφών έχει την ίδια πιθανότητα, και με το ίδιο seed (και τις ίδιες εγγραφές) επιστρέφεται το
+// ίδιο δείγμα. Πολυπλοκότητα O(k log n), χωρίς διάσχιση των εγγραφών. Για μια περιοχή με c χώρες,
+// O(k c^2 log^2 n).
+
+List dm_sample_records(int k, String disease, String country, Date date_from, Date date_to, uint64_t seed);
+
+// Τα κριτήρια ενός query της dm_count_records_batch
+
+struct dm_query {
+	String disease;
+	String country;
+	Date date_from;
+	Date date_to;
+};
+typedef struct dm_query* DMQuery;
+
+// Αποθηκεύει στο results[i] το αποτέλεσμα της dm_count_records για τα κριτήρια του queries[i],
+// i = 0 .. n-1. Με περισσότερα από ένα threads (βλ. dm_set_threads) τα queries εκτελούνται
+// παράλληλα, ένα σε κάθε thread.
+
+void dm_count_records_batch(struct dm_query queries[], int n, int results[]);
+
+// Μια ομάδα του αποτελέσματος των dm_count_by_country, dm_count_by_disease
+
+struct dm_group_count {
+	String key;			// η χώρα ή η ασθένεια, ανήκει στο monitor
+	int count;
+};
+typedef struct dm_group_count* DMGroupCount;
+
+// Επιστρέφει για κάθε χώρα το πλήθος των εγγραφών της ασθένειας disease (ή όλων αν disease == NULL)
+// μέσα στο [date_from, date_to], δηλαδή ό,τι θα επέστρεφε η dm_count_records για κάθε χώρα. Το
+// αποτέλεσμα είναι ένας πίνακας (που πρέπει να γίνει free) με *n στοιχεία ταξινομημένα κατά key,
+// μόνο για τις χώρες με τουλάχιστον 1 εγγραφή. Τα keys ισχύουν όσο η χώρα έχει εγγραφές.
+// Πολυπλοκότητα O(c log n) για c χώρες, χωρίς διάσχιση των εγγραφών.
+
+DMGroupCount dm_count_by_country(String disease, Date date_from, Date date_to, int* n);
+
+// Όπως η dm_count_by_country, για κάθε ασθένεια με εγγραφές στη χώρα country (ή σε όλες αν
+// country == NULL). Το country μπορεί να είναι και περιοχή.
+
+DMGroupCount dm_count_by_disease(String country, Date date_from, Date date_to, int* n);
+
 // Επιστρέφει τις k ασθένειες με τις περισσότερες εγγραφές που ικανοποιούν τo
 // κριτήριο country (μπορεί να είναι NULL) _ταξινομημένες_ με βάση τον αριθμό
 // εγγραφών (πρώτα η ασθένεια με τις περισσότερες).
 //
 // Πχ η dm_top_diseases(3, "Germany") επιστρέφει τις 3 ασθένειες με τις
 // περισσότερες εγγραφές στη Γερμανία. Επιστρέφονται _μόνο_ ασθένειες με
-// __τουλάχιστον 1 εγγραφή__ (που ικανοποιεί τα κριτήρια).
+// __τουλάχιστον 1 εγγραφή__ (που ικανοποιεί τα κριτήρια). Το country μπορεί να είναι
+// και περιοχή, πχ η dm_top_diseases(3, "Europe").
 
 List dm_top_diseases(int k, String country);
 
+// Επιστρέφει τις k χώρες με τις περισσότερες εγγραφές της ασθένειας disease (ή όλων
+// των ασθενειών αν disease == NULL), _ταξινομημένες_ όπως στη dm_top_diseases. Επιστρέφονται
+// μόνο χώρες (όχι περιοχές) με τουλάχιστον 1 εγγραφή. Τα strings ανήκουν στο monitor και
+// ισχύουν όσο η χώρα έχει εγγραφές.
+// Πολυπλοκότητα O(k + log n), μέσω ενός ranking των χωρών ανά ασθένεια.
+
+List dm_top_countries(int k, String disease);
+
+// Επιστρέφει λίστα με τα Records των οποίων το name αρχίζει από prefix (το "" ταιριάζει με
+// όλα), ταξινομημένα κατά name. Αν limit >= 0, επιστρέφονται το πολύ limit εγγραφές.
+// Πολυπλοκότητα O(|prefix| + limit), μέσω ενός radix tree (ADTTrie) με τα names.
+
+List dm_find_by_name_prefix(String prefix, int limit);
+
+// Επιστρέφει την ημερομηνία του p-οστού εκατοστημορίου (0 <= p <= 100) των εγγραφών που ικανοποιούν
+// τα κριτήρια της dm_get_records, ταξινομημένων κατά ημερομηνία (nearest rank: η εγγραφή στη θέση
+// ceil(p/100 * m) από τις m, η πρώτη για p == 0). Πχ με p == 50 επιστρέφεται η διάμεσος. Επιστρέφει
+// NULL αν καμία εγγραφή δεν ικανοποιεί τα κριτήρια ή το p είναι εκτός ορίων. Η ημερομηνία ανήκει
+// στο αντίστοιχο Record, οπότε ισχύει μέχρι αυτό να αφαιρεθεί ή να αλλάξει.
+// Πολυπλοκότητα O(log n), μέσω rank / select στα AVL sets κατά ημερομηνία. Για μια περιοχή με
+// c χώρες, O(c^2 log^2 n).
+
+Date dm_date_percentile(String disease, String country, Date date_from, Date date_to, double p);
+
+
+// Snapshots
+//
+// Στο multi-version mode (βλ. dm_set_mvcc) ένα snapshot είναι μια σταθερή εικόνα όλων των εγγραφών
+// τη στιγμή που ανοίχτηκε. Τα queries σε ένα snapshot μπορούν να εκτελούνται από άλλα threads
+// ταυτόχρονα με αλλαγές του monitor (insert, remove, update, από ένα thread τη φορά), χωρίς
+// εξωτερικό locking, και βλέπουν πάντα την ίδια εικόνα. Οι εγγραφές που αφαιρούνται ενώ υπάρχουν
+// snapshots που τις βλέπουν κρατιούνται μέχρι το dm_snapshot_release (στο owned mode τα αντίγραφα
+// αποδεσμεύονται τότε, αλλιώς ο χρήστης δεν πρέπει να τις κάνει free νωρίτερα).
+
+typedef struct dm_snapshot* DMSnapshot;
+
+// Ανοίγει και επιστρέφει ένα snapshot, ή NULL αν δεν είναι ενεργό το multi-version mode (ή αν είναι
+// ενεργό το history mode).
+// Πολυπλοκότητα O(1). Μπορεί να κληθεί από οποιοδήποτε thread.
+
+DMSnapshot dm_snapshot_open();
+
+// Όπως οι dm_get_records / dm_count_records, για τις εγγραφές του snapshot, αλλά το country
+// είναι πάντα όνομα χώρας (όχι περιοχή). Η dm_snapshot_get_records επιστρέφει τις εγγραφές
+// ταξινομημένες κατά disease, country, name, id. Με disease != NULL η πολυπλοκότητα είναι
+// O(log n + m), για m εγγραφές της ασθένειας (ή του ζεύγους, αν και country != NULL).
+
+List dm_snapshot_get_records(DMSnapshot snapshot, String disease, String country, Date date_from, Date date_to);
+
+int dm_snapshot_count_records(DMSnapshot snapshot, String disease, String country, Date date_from, Date date_to);
+
+// Κλείνει το snapshot. Οι εγγραφές που κρατιούνταν μόνο για αυτό αποδεσμεύονται στην επόμενη
+// αλλαγή του monitor. Όλα τα snapshots πρέπει να κλείσουν πριν την dm_destroy.
+
+void dm_snapshot_release(DMSnapshot snapshot);
+
+
+// Trace
+//
+// Καταγραφή των κλήσεων που αλλάζουν τις εγγραφές (dm_insert_record(s), dm_remove_record,
+// dm_update_record) και όλων των queries πάνω τους (dm_get_records, dm_get_records_page,
+// dm_sample_records, dm_count_records(_batch), dm_count_by_country, dm_count_by_disease,
+// dm_top_diseases, dm_top_countries, dm_find_by_name_prefix, dm_date_percentile), καθώς και της
+// ιεραρχίας των περιοχών (dm_set_region, και μία dm_set_region για κάθε γραμμή της dm_load_regions),
+// με τα ορίσματα και τη χρονική στιγμή τους, σε αρχείο (βλ. Trace.h). Το πρόγραμμα dm_replay εκτελεί
+// ξανά ένα τέτοιο trace. Δεν καταγράφονται οι υπόλοιπες ρυθμίσεις του monitor (dm_set_owned,
+// dm_subscribe κλπ), τα snapshots, τα checkpoints και τα replicas.
+
+// Ξεκινάει την καταγραφή στο αρχείο path (αν υπήρχε ήδη καταγραφή, σταματάει πρώτα). Επιστρέφει
+// false αν το αρχείο δεν μπορεί να δημιουργηθεί. Η καταγραφή συνεχίζεται και μετά από dm_destroy
+// / dm_init, μέχρι την dm_trace_stop.
+
+bool dm_trace_start(String path);
+
+// Σταματάει την καταγραφή και κλείνει το αρχείο. Επιστρέφει false αν κάποια εγγραφή στο αρχείο
+// απέτυχε (ή αν δεν υπήρχε καταγραφή).
+
+bool dm_trace_stop();
+
+
+// Checkpoints
+//
+// Ένα checkpoint είναι ένα trace (βλ. Trace.h) με την ιεραρχία των περιοχών (ως TRACE_SET_REGION,
+// χωρίς τις περιοχές που δεν έχουν καμία χώρα) και ένα TRACE_INSERT για κάθε εγγραφή του monitor,
+// κατά ημερομηνία (στο history mode πρώτα οι εγγραφές του ιστορικού), οπότε το dm_replay το επαναφέρει σε έναν κενό monitor. Γράφεται από ένα child
+// process (fork), που βλέπει τη μνήμη του monitor όπως ήταν τη στιγμή της dm_checkpoint_async: οι
+// σελίδες αντιγράφονται από το λειτουργικό μόνο όταν αλλάξουν (copy-on-write), ενώ ο monitor
+// συνεχίζει κανονικά. Το αρχείο γράφεται ως path.tmp και μετονομάζεται σε path μόνο αφού γραφτεί
+// ολόκληρο και φτάσει στο δίσκο (fsync), οπότε το path περιέχει πάντα ένα πλήρες checkpoint. Αν κάποια
+// εγγραφή αποτύχει (π.χ. γέμισε ο δίσκος) το checkpoint αποτυγχάνει και το path μένει ως είχε.
+
+typedef enum {
+	DM_CHECKPOINT_IDLE,			// Δεν έχει ξεκινήσει κανένα checkpoint
+	DM_CHECKPOINT_RUNNING,
+	DM_CHECKPOINT_DONE,
+	DM_CHECKPOINT_FAILED,
+} DMCheckpointState;
+
+struct dm_checkpoint {
+	DMCheckpointState state;
+	int records;				// Εγγραφές στο checkpoint
+	uint64_t bytes;				// Μέγεθος του αρχείου
+	uint64_t pause;				// Nanoseconds που σταμάτησε ο monitor για το fork
+	uint64_t duration;			// Nanoseconds από την dm_checkpoint_async μέχρι να γραφτεί όλο το αρχείο
+};
+typedef struct dm_checkpoint* DMCheckpoint;
+
+// Ξεκινάει ένα checkpoint στο αρχείο path, στο παρασκήνιο. Ο monitor σταματάει μόνο για το fork, σε
+// χρόνο ανάλογο του page table και όχι των εγγραφών. Επιστρέφει false αν εκτελείται ήδη ένα checkpoint
+// (μέχρι η dm_checkpoint_status να αναφέρει την ολοκλήρωσή του) ή αν το fork αποτύχει. Δεν πρέπει να
+// καλείται ενώ κάποιο άλλο thread αλλάζει τον monitor.
+
+bool dm_checkpoint_async(String path);
+
+// Αποθηκεύει στο checkpoint (αν δεν είναι NULL) την κατάσταση του τελευταίου checkpoint, και αφού
+// ολοκληρωθεί τα records, bytes και duration του (το pause ισχύει από την αρχή). Αν wait == true και
+// το checkpoint εκτελείται ακόμα, περιμένει να ολοκληρωθεί. Επιστρέφει το checkpoint->state. Η
+// dm_destroy περιμένει το checkpoint που εκτελείται.
+
+DMCheckpointState dm_checkpoint_status(DMCheckpoint checkpoint, bool wait);
+
+
+// Read replicas
+//
+// Ο monitor μπορεί να δημοσιεύει τις εγγραφές του σε ένα shared memory region (βλ. SharedReplica.h),
+// ώστε άλλες διεργασίες να κάνουν replica_attach και να απαντούν queries (replica_get_records /
+// replica_count_records) χωρίς να κρατάνε τον δικό τους monitor. Το region συνεχίζει να υπάρχει και
+// μετά από dm_destroy / dm_init, μέχρι την dm_replica_close.
+
+// Δημιουργεί το region name με χώρο για εικόνες έως capacity bytes (αν υπήρχε ήδη replica, κλείνει
+// πρώτα) και δημοσιεύει τις τρέχουσες εγγραφές. Επιστρέφει false (χωρίς να μείνει region) αν το region
+// δεν μπορεί να δημιουργηθεί ή αν οι εγγραφές δεν χωράνε.
+
+bool dm_replica_create(String name, size_t capacity);
+
+// Δημοσιεύει τις τρέχουσες εγγραφές στο region, ως μια νέα εικόνα. Οι αλλαγές του monitor δεν φαίνονται
+// στους readers μέχρι την επόμενη δημοσίευση, οπότε ο writer αποφασίζει πόσο συχνά γίνεται (π.χ. μετά
+// από κάθε batch). Επιστρέφει false αν δεν υπάρχει replica ή αν οι εγγραφές δεν χωράνε στο capacity.
+// Στο history mode δημοσιεύονται και οι εγγραφές του ιστορικού, οπότε διαβάζονται όλοι οι μήνες
+// του και κρατιούνται προσωρινά αντίγραφά τους. Πολυπλοκότητα O(n).
+
+bool dm_replica_publish();
+
+// Διαγράφει το region (όσοι έχουν κάνει attach το βλέπουν μέχρι το replica_detach)
+
+void dm_replica_close();
+
+
+// Στατιστικά
+//
+// Ο monitor κρατάει latency histograms (σε nanoseconds) για κάθε public λειτουργία, και τα
+// ADTs μετρητές για συγκρίσεις, rebalancing και δεσμεύσεις μνήμης (βλ. Stats.h). Αυτά
+// συμπληρώνονται μόνο αν το πρόγραμμα γίνει compile με -DDM_STATS, αλλιώς είναι 0 και
+// δεν επιβαρύνουν καθόλου τις λειτουργίες. Τα μεγέθη των indexes είναι πάντα διαθέσιμα.
+
+struct dm_stats {
+	bool enabled;								// true αν έγινε compile με -DDM_STATS
+	int records;								// Εγγραφές
+	int countries;								// Διαφορετικές χώρες
+	int diseases;								// Διαφορετικές ασθένειες
+	int pairs;									// Διαφορετικά ζεύγη (χώρα, ασθένεια)
+	uint64_t counters[STAT_COUNTERS_NO];		// Βλ. StatCounter
+	struct histogram operations[STAT_OPS_NO];	// Βλ. StatOp
+};
+typedef struct dm_stats* DMStats;
+
+// Αποθηκεύει στο stats τις τρέχουσες τιμές όλων των στατιστικών
+
+void dm_stats(DMStats stats);
+
+// Μηδενίζει τους μετρητές και τα histograms
+
+void dm_stats_reset();
+
+// Τυπώνει τα στατιστικά στο file, σε μορφή κειμένου ή (αν json == true) σε μία γραμμή JSON
+
+void dm_stats_print(FILE* file, bool json);
+
+// Μνήμη (σε bytes) που δεσμεύει κάθε index του monitor, για τις δομές του μόνο
+// (κόμβοι, buckets, πίνακες, μετρητές), χωρίς το overhead του malloc. Τα records
+// δεν περιλαμβάνονται, εκτός από το owned mode (arena).
+
+struct dm_memory {
+	size_t entries;			// Ένα entry ανά εγγραφή, με τους κόμβους της στα indexes
+	size_t ids;				// Map id => entry
+	size_t names;			// Trie name => entries
+	size_t monitor;			// Set με όλες τις εγγραφές
+	size_t dates;			// Set με όλες τις εγγραφές κατά ημερομηνία
+	size_t countries;		// Map με τις χώρες, και οι εγγραφές κάθε χώρας κατά ημερομηνία
+	size_t tops;			// Μετρητές (χώρα, ασθένεια) με τις εγγραφές τους, τα rankings ανά χώρα και οι detectors εξάρσεων
+	size_t diseases;		// Map με τις ασθένειες, οι εγγραφές κάθε ασθένειας κατά ημερομηνία και το ranking των χωρών της
+	size_t regions;			// Η ιεραρχία των περιοχών, με τους μετρητές και τα rankings τους
+	size_t versions;		// Οι εγγραφές στο multi-version mode, μαζί με όσες κρατιούνται για snapshots
+	size_t ranking;			// Τα συνολικά rankings των ασθενειών και των χωρών
+	size_t arena;			// Τα αντίγραφα των records στο owned mode, αλλιώς 0
+	size_t history;			// Στο history mode τα partitions στη μνήμη και τα ids των εγγραφών του ιστορικού, αλλιώς 0
+	size_t total;			// Το άθροισμα όλων των παραπάνω
+};
+typedef struct dm_memory* DMMemory;
+
+// Αποθηκεύει στο memory τη μνήμη που δεσμεύει κάθε index. Πολυπλοκότητα ανάλογη του
+// συνολικού μεγέθους των hash tables (για το ids, ανάλογη των εγγραφών).
+
+void dm_memory_usage(DMMemory memory);
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////
+//
+// Outbreak detector
+//
+// Ανίχνευση εξάρσεων σε μια ροή εγγραφών με ημερομηνίες. Ο detector
+// μετράει τις εγγραφές κάθε ημέρας και κρατάει μια baseline για το
+// ημερήσιο πλήθος (EWMA της μέσης τιμής και της διασποράς). Μια ημέρα
+// θεωρείται έξαρση όταν το πλήθος της ξεπεράσει τη μέση τιμή κατά
+// threshold τυπικές αποκλίσεις. Κάθε εγγραφή κοστίζει O(1).
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "common_types.h"
+
+
+// Οι παράμετροι της ανίχνευσης
+
+struct outbreak_params {
+	double alpha;			// Βάρος κάθε νέας ημέρας στη baseline, στο (0, 1]
+	double threshold;		// Τυπικές αποκλίσεις πάνω από τη μέση τιμή για έξαρση
+	int min_count;			// Ελάχιστο πλήθος εγγραφών της ημέρας για έξαρση
+	int warmup;				// Ημέρες στη baseline πριν ξεκινήσει η ανίχνευση
+};
+typedef struct outbreak_params* OutbreakParams;
+
+// Η κατάσταση ενός detector. Τα πεδία διαβάζονται ελεύθερα, αλλάζουν όμως μόνο μέσω της outbreak_add.
+
+struct outbreak_detector {
+	int day;				// Η τρέχουσα ημέρα (βλ. outbreak_day)
+	int count;				// Οι εγγραφές της τρέχουσας ημέρας
+	int days;				// Οι ημέρες που έχουν μπει στη baseline
+	double mean;			// EWMA του ημερήσιου πλήθους, χωρίς την τρέχουσα ημέρα
+	double variance;		// EWMA της διασποράς
+	bool alerted;			// true αν η τρέχουσα ημέρα έχει ήδη αναφερθεί ως έξαρση
+};
+typedef struct outbreak_detector* OutbreakDetector;
+
+
+// Επιστρέφει τον αριθμό ημερών από την 1970-01-01 μέχρι την ημερομηνία date (σε μορφή
+// YYYY-MM-DD), ώστε διαδοχικές ημερομηνίες να έχουν διαδοχικούς αριθμούς.
+
+int outbreak_day(String date);
+
+// Δημιουργεί και επιστρέφει έναν detector χωρίς καμία εγγραφή
+
+OutbreakDetector outbreak_create();
+
+// Προσθέτει μια εγγραφή της ημέρας day. Αν η day είναι μεταγενέστερη της τρέχουσας, η τρέχουσα
+// (και όσες ημέρες χωρίς εγγραφές μεσολαβούν) μπαίνει στη baseline. Εγγραφές παλιότερων ημερών
+// αγνοούνται. Επιστρέφει true μόνο για την εγγραφή με την οποία η τρέχουσα ημέρα γίνεται έξαρση.
+
+bool outbreak_add(OutbreakDetector detector, int day, OutbreakParams params);
+
+// Επιστρέφει την τυπική απόκλιση της baseline
+
+double outbreak_deviation(OutbreakDetector detector);
+
+// Ελευθερώνει τη μνήμη του detector
+
+void outbreak_destroy(OutbreakDetector detector);
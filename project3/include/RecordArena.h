@@ -0,0 +1,47 @@
+///////////////////////////////////////////////////////////////////
+//
+// Record Arena
+//
+// Αποθήκευση αντιγράφων από records σε slabs σταθερού μεγέθους.
+// Κάθε αντίγραφο κρατάει το name και το date μέσα στο ίδιο slot
+// με το struct record, ενώ τα disease και country γίνονται intern
+// (ένα μόνο αντίγραφο για κάθε διαφορετικό string).
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "DiseaseMonitor.h"
+
+
+// Ένα arena αναπαριστάται από τον τύπο RecordArena
+
+typedef struct record_arena* RecordArena;
+
+
+// Δημιουργεί και επιστρέφει ένα κενό arena
+
+RecordArena arena_create();
+
+// Επιστρέφει τον αριθμό των records που είναι αποθηκευμένα στο arena
+
+int arena_size(RecordArena arena);
+
+// Δημιουργεί και επιστρέφει ένα αντίγραφο του record μέσα στο arena. Χρησιμοποιεί
+// πρώτα slots από records που έχουν αποδεσμευτεί με την arena_release.
+
+Record arena_copy(RecordArena arena, Record record);
+
+// Αποδεσμεύει το record (που πρέπει να έχει επιστραφεί από την arena_copy) ώστε
+// το slot του να χρησιμοποιηθεί ξανά. Τα intern strings διατηρούνται.
+
+void arena_release(RecordArena arena, Record record);
+
+// Επιστρέφει τα bytes που δεσμεύει το arena: slabs (μαζί με τα ελεύθερα slots), τα
+// strings που δεν χώρεσαν στα slots, και τα intern strings.
+
+size_t arena_memory(RecordArena arena);
+
+// Ελευθερώνει όλη τη μνήμη που δεσμεύει το arena, μαζί με όλα τα records του.
+
+void arena_destroy(RecordArena arena);
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////
+//
+// Record Partitions
+//
+// Αποθήκευση records σε partitions ανά μήνα. Κάθε partition κρατάει
+// τα δικά του αντίγραφα (σε ένα RecordArena) και τα δικά του indexes
+// κατά ημερομηνία: όλες τις εγγραφές, ανά χώρα, ανά ασθένεια και ανά
+// ζεύγος (χώρα, ασθένεια). Ένα query με διάστημα ημερομηνιών εξετάζει
+// μόνο τα partitions που το τέμνουν, και ένα ολόκληρο partition μπορεί
+// να παγώσει (partitions_freeze) ή να αφαιρεθεί (partitions_drop)
+// χωρίς να επηρεάσει τα υπόλοιπα. Τα παλαιότερα partitions μπορούν
+// να μεταφερθούν σε αρχεία στο δίσκο (partitions_set_spill), από όπου
+// διαβάζονται μέσω mmap μόνο όταν κάποιο query τα χρειαστεί.
+//
+// Τα partitions είναι append-only: οι εγγραφές δεν αφαιρούνται ούτε
+// αλλάζουν μεμονωμένα, μόνο μαζί με όλο το partition τους.
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "DiseaseMonitor.h"
+
+
+// Τα partitions αναπαριστώνται από τον τύπο RecordPartitions
+
+typedef struct record_partitions* RecordPartitions;
+
+
+// Δημιουργεί και επιστρέφει ένα κενό σύνολο partitions
+
+RecordPartitions partitions_create();
+
+// Επιστρέφει τον αριθμό των records σε όλα τα partitions
+
+int partitions_size(RecordPartitions partitions);
+
+// Προσθέτει ένα αντίγραφο του record στο partition του μήνα του (δημιουργώντας το αν δεν υπάρχει).
+// Επιστρέφει false (χωρίς να το προσθέσει) αν το date δεν είναι σε μορφή YYYY-MM-DD, αν το partition
+// έχει παγώσει, ή αν υπάρχει ήδη record με ίδιο date και id. Πολυπλοκότητα O(log n), με O(1) για
+// την εύρεση του partition αν είναι ίδιο με το προηγούμενο.
+
+bool partitions_insert(RecordPartitions partitions, Record record);
+
+// Καλείται από την partitions_scan για κάθε record. Αν επιστρέψει false η διάσχιση σταματάει.
+
+typedef bool (*PartitionsVisitFunc)(Record record, Pointer context);
+
+// Καλεί τη visit για κάθε record με τα συγκεκριμένα disease και country (ή οποιοδήποτε, αν είναι NULL)
+// και ημερομηνία μέσα στο [date_from, date_to] (χωρίς όριο αν είναι NULL), ταξινομημένα κατά ημερομηνία
+// (και id). Επιστρέφει τον αριθμό των records που βρέθηκαν (αν visit == NULL απλά τα μετράει).
+// Τα partitions εκτός του διαστήματος δεν εξετάζονται καθόλου, και όσα περιέχονται ολόκληρα σε αυτό
+// μετράνε σε O(1). Πολυπλοκότητα O(log n) για κάθε partition που τέμνει τα όρια, συν O(1) για κάθε record.
+// Το record που δέχεται η visit ισχύει μόνο μέχρι να επιστρέψει (στα partitions στο δίσκο είναι προσωρινό).
+// Ένα partition στο δίσκο φορτώνεται όταν το διάστημα το τέμνει (αν το αρχείο του δεν μπορεί να
+// διαβαστεί, παραλείπεται), και μένει φορτωμένο μέχρι να αποφορτωθεί (βλ. partitions_set_max_loaded).
+
+int partitions_scan(RecordPartitions partitions, String disease, String country, Date date_from, Date date_to, PartitionsVisitFunc visit, Pointer context);
+
+// Επιστρέφει λίστα με τους μήνες (σε μορφή YYYY-MM) όλων των partitions, ταξινομημένους. Τα strings
+// ισχύουν μέχρι να αφαιρεθεί το αντίστοιχο partition.
+
+List partitions_months(RecordPartitions partitions);
+
+// Παγώνει το partition του μήνα month (YYYY-MM): κάθε index γίνεται ένας ταξινομημένος πίνακας
+// (αντί για AVL), που καταλαμβάνει πολύ λιγότερη μνήμη, και δεν δέχεται πλέον νέα records.
+// Επιστρέφει false αν δεν υπάρχει τέτοιο partition. Πολυπλοκότητα O(εγγραφές του partition).
+
+bool partitions_freeze(RecordPartitions partitions, String month);
+
+// Επιστρέφει true αν το partition του μήνα month υπάρχει και έχει παγώσει
+
+bool partitions_frozen(RecordPartitions partitions, String month);
+
+// Αφαιρεί το partition του μήνα month μαζί με όλα τα records του. Επιστρέφει false αν δεν υπάρχει.
+// Τα υπόλοιπα partitions δεν αλλάζουν, οπότε η αφαίρεση δεν κοστίζει τίποτα ανά εγγραφή σε κάποιο
+// άλλο index: για ένα παγωμένο partition πολυπλοκότητα O(k) για k χώρες / ασθένειες / ζεύγη, αλλιώς
+// O(εγγραφές του partition) για την αποδέσμευση των AVL.
+
+bool partitions_drop(RecordPartitions partitions, String month);
+
+// Κρατάει στη μνήμη μόνο τα partitions των hot_months πιο πρόσφατων μηνών (μετρώντας από τον μήνα του
+// πιο πρόσφατου partition). Τα παλαιότερα παγώνουν, γράφονται το καθένα σε ένα αρχείο YYYY-MM.part μέσα
+// στο directory (που πρέπει να υπάρχει) και αποδεσμεύονται, τώρα και κάθε φορά που δημιουργείται ένα νεότερο
+// partition. Όταν ένα query τα χρειαστεί φορτώνονται μέσω mmap, οπότε στη μνήμη της εφαρμογής μένουν μόνο
+// οι περιγραφές των indexes τους, και οι σελίδες του αρχείου διαβάζονται (και αποδεσμεύονται) από το
+// λειτουργικό. Τα αρχεία διαγράφονται μαζί με το partition τους (partitions_drop / partitions_destroy).
+// Αν κάποιο αρχείο δεν γραφτεί, το partition μένει (παγωμένο) στη μνήμη. Με directory == NULL σταματάει
+// το spill, χωρίς να επηρεάσει όσα partitions είναι ήδη στο δίσκο. Επιστρέφει false αν hot_months < 1.
+
+bool partitions_set_spill(RecordPartitions partitions, String directory, int hot_months);
+
+// Κάνει αμέσως spill το partition του μήνα month (όπως η partitions_set_spill για τα παλαιότερα), ανεξάρτητα
+// από τα hot_months. Επιστρέφει false αν δεν υπάρχει τέτοιο partition, αν δεν έχει οριστεί directory, ή αν
+// το αρχείο δεν γραφτεί (οπότε το partition μένει παγωμένο στη μνήμη). Πολυπλοκότητα O(εγγραφές του partition).
+
+bool partitions_spill(RecordPartitions partitions, String month);
+
+// Ορίζει πόσα partitions στο δίσκο μπορούν να είναι φορτωμένα ταυτόχρονα (default 4). Όταν ένα query
+// φορτώνει ένα ακόμα, αποφορτώνεται αυτό που χρησιμοποιήθηκε λιγότερο πρόσφατα (LRU), οπότε ελευθερώνονται
+// τα indexes του και το mmap, ώστε η μνήμη να μη μεγαλώνει με το πλήθος των μηνών που εξετάζουν τα
+// queries. Αν ήδη υπάρχουν περισσότερα φορτωμένα, αποφορτώνονται αμέσως. Επιστρέφει false αν max_loaded < 1.
+
+bool partitions_set_max_loaded(RecordPartitions partitions, int max_loaded);
+
+// Επιστρέφει πόσα partitions στο δίσκο είναι φορτωμένα
+
+int partitions_loaded(RecordPartitions partitions);
+
+// Επιστρέφει true αν το partition του μήνα month υπάρχει και βρίσκεται στο δίσκο
+
+bool partitions_spilled(RecordPartitions partitions, String month);
+
+// Επιστρέφει τα bytes που δεσμεύουν τα partitions: τα αντίγραφα των records και τα indexes. Τα αρχεία
+// των partitions στο δίσκο (ακόμα και όταν έχουν φορτωθεί μέσω mmap) δεν μετράνε.
+
+size_t partitions_memory(RecordPartitions partitions);
+
+// Ελευθερώνει όλη τη μνήμη που δεσμεύουν τα partitions
+
+void partitions_destroy(RecordPartitions partitions);
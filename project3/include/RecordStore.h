@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////
+//
+// Record Store
+//
+// Συμπιεσμένη αποθήκευση records σε blocks σταθερού μεγέθους. Τα
+// name, disease και country αποθηκεύονται ως κωδικοί ενός λεξικού
+// (κάθε διαφορετικό string μία φορά), με όσα bytes χρειάζεται ο
+// μεγαλύτερος κωδικός του block. Μέσα σε κάθε block τα records
+// είναι ταξινομημένα κατά ημερομηνία, και κάθε ημερομηνία
+// αποθηκεύεται ως διαφορά από την προηγούμενη (συνήθως 1 byte).
+//
+// Τα records αποσυμπιέζονται κατά τη διάσχιση (store_scan), χωρίς
+// να δημιουργείται ποτέ ένα struct record για καθένα.
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "DiseaseMonitor.h"
+
+
+// Ένα store αναπαριστάται από τον τύπο RecordStore
+
+typedef struct record_store* RecordStore;
+
+
+// Δημιουργεί και επιστρέφει ένα κενό store
+
+RecordStore store_create();
+
+// Επιστρέφει τον αριθμό των records που είναι αποθηκευμένα στο store
+
+int store_size(RecordStore store);
+
+// Προσθέτει ένα αντίγραφο του record στο store. Το date πρέπει να είναι σε μορφή YYYY-MM-DD,
+// διαφορετικά το record δεν προστίθεται και επιστρέφεται false.
+// Τα records συγκεντρώνονται σε ένα ανοιχτό block, το οποίο συμπιέζεται όταν γεμίσει.
+
+bool store_append(RecordStore store, Record record);
+
+// Καλείται από την store_scan για κάθε record. Το record (και τα strings του) είναι έγκυρο
+// μόνο μέχρι να επιστρέψει η συνάρτηση. Αν επιστρέψει false η διάσχιση σταματάει.
+
+typedef bool (*StoreVisitFunc)(Record record, Pointer context);
+
+// Καλεί τη visit για κάθε record με τα συγκεκριμένα disease και country (ή οποιοδήποτε,
+// αν είναι NULL) και ημερομηνία μέσα στο [date_from, date_to] (χωρίς όριο αν είναι NULL),
+// με τη σειρά ημερομηνίας μέσα σε κάθε block. Επιστρέφει τον αριθμό των records που βρέθηκαν
+// (αν visit == NULL απλά τα μετράει). Τα date_from, date_to είναι σε μορφή YYYY-MM-DD.
+// Blocks εκτός του διαστήματος ημερομηνιών δεν διασχίζονται.
+
+int store_scan(RecordStore store, String disease, String country, Date date_from, Date date_to, StoreVisitFunc visit, Pointer context);
+
+// Επιστρέφει τα bytes που δεσμεύει το store: blocks, το ανοιχτό block, και τα λεξικά.
+
+size_t store_memory(RecordStore store);
+
+// Ελευθερώνει όλη τη μνήμη που δεσμεύει το store
+
+void store_destroy(RecordStore store);
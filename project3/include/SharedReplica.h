@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////
+//
+// Shared Replica
+//
+// Μια εικόνα των εγγραφών του monitor σε shared memory (POSIX shm),
+// ώστε πολλές διεργασίες να απαντούν queries πάνω της χωρίς η καθεμία
+// να κρατάει το δικό της αντίγραφο. Μία διεργασία (ο writer) δημοσιεύει
+// τις εγγραφές, και όσες κάνουν attach μπορούν μόνο να τις διαβάσουν.
+//
+// Η εικόνα δεν περιέχει pointers αλλά μόνο offsets, ώστε να ισχύει σε
+// όποια διεύθυνση κι αν γίνει mmap: ένας πίνακας με τα records κατά
+// ημερομηνία, ένα index για όλες τις εγγραφές, για κάθε χώρα, ασθένεια
+// και ζεύγος (χώρα, ασθένεια) με τις θέσεις των records του κατά
+// ημερομηνία, και τα strings.
+//
+// Το region έχει δύο slots. Ο writer γράφει πάντα αυτό που δεν είναι το
+// τρέχον και μετά το κάνει τρέχον, οπότε οι readers δεν περιμένουν ποτέ
+// τον writer. Κάθε slot έχει έναν version counter (seqlock), που είναι
+// μονός όσο ο writer γράφει το slot. Ένας reader που βρίσκει διαφορετική
+// τιμή μετά το query (επειδή στο μεταξύ ο writer ξαναέγραψε το ίδιο slot)
+// απλά το επαναλαμβάνει.
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include <stdint.h>
+#include "DiseaseMonitor.h"
+
+
+// Writer //////////////////////////////////////////////////////////////////////
+
+typedef struct replica_writer* ReplicaWriter;
+
+// Δημιουργεί το shared memory region name (της μορφής "/όνομα"), με χώρο για εικόνες έως capacity bytes,
+// και επιστρέφει έναν writer, ή NULL αν το region δεν μπορεί να δημιουργηθεί. Ένα υπάρχον region με το
+// ίδιο όνομα αντικαθίσταται. Μέχρι το πρώτο replica_publish η εικόνα είναι κενή.
+
+ReplicaWriter replica_writer_create(String name, size_t capacity);
+
+// Δημοσιεύει τα records[0 .. n-1], που πρέπει να είναι ταξινομημένα κατά ημερομηνία (και id). Επιστρέφει
+// false, χωρίς να αλλάξει η τρέχουσα εικόνα, αν δεν χωράνε στο capacity. Πολυπλοκότητα O(n).
+
+bool replica_publish(ReplicaWriter writer, Record records[], int n);
+
+// Διαγράφει το region (όσοι έχουν κάνει attach το βλέπουν μέχρι το replica_detach) και ελευθερώνει
+// τη μνήμη του writer
+
+void replica_writer_destroy(ReplicaWriter writer);
+
+
+// Reader //////////////////////////////////////////////////////////////////////
+
+typedef struct replica* Replica;
+
+// Κάνει attach στο region name (μόνο για ανάγνωση) και επιστρέφει ένα Replica, ή NULL αν το region
+// δεν υπάρχει ή δεν έχει δημιουργηθεί από replica_writer_create.
+
+Replica replica_attach(String name);
+
+// Επιστρέφει τον αριθμό των replica_publish μέχρι την τρέχουσα εικόνα (0 πριν το πρώτο). Μια αλλαγή
+// της τιμής ανάμεσα σε δύο queries σημαίνει ότι απαντήθηκαν από διαφορετικές εικόνες.
+
+uint64_t replica_version(Replica replica);
+
+// Όπως οι dm_get_records / dm_count_records, για τις εγγραφές της τρέχουσας εικόνας, αλλά το country
+// είναι πάντα όνομα χώρας (όχι περιοχή). Η replica_get_records επιστρέφει τις εγγραφές κατά ημερομηνία,
+// σε αντίγραφα που ανήκουν στη λίστα (τα αποδεσμεύει η list_destroy). Το αποτέλεσμα προέρχεται πάντα
+// από μία μόνο εικόνα. Πολυπλοκότητα O(log n) (συν O(1) για κάθε εγγραφή στην replica_get_records).
+
+List replica_get_records(Replica replica, String disease, String country, Date date_from, Date date_to);
+
+int replica_count_records(Replica replica, String disease, String country, Date date_from, Date date_to);
+
+// Κάνει detach από το region και ελευθερώνει τη μνήμη του Replica
+
+void replica_detach(Replica replica);
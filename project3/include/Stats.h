@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////
+//
+// Stats
+//
+// Latency histograms (log-linear, όπως τα HDR histograms) και μετρητές
+// για την παρακολούθηση της απόδοσης του DiseaseMonitor και των ADTs.
+//
+// Οι μετρήσεις μέσα στα modules γίνονται μέσω των macros STATS_*, τα
+// οποία μεταφράζονται σε κώδικα μόνο αν γίνει compile με -DDM_STATS
+// (πχ make CFLAGS=-DDM_STATS), αλλιώς δεν κοστίζουν τίποτα. Τα
+// histograms μπορούν να χρησιμοποιηθούν και απευθείας, πχ από ένα
+// benchmark, ανεξάρτητα από το DM_STATS.
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include <stdint.h>
+
+#include "common_types.h"
+
+
+// Histogram ///////////////////////////////////////////////////////////////////
+//
+// Οι τιμές (πχ nanoseconds) μοιράζονται σε buckets: οι τιμές < HISTOGRAM_SUB_BUCKETS έχουν
+// δικό τους bucket, και κάθε μεγαλύτερη δύναμη του 2 χωρίζεται σε HISTOGRAM_SUB_BUCKETS
+// ίσα buckets. Οπότε το σχετικό σφάλμα κάθε percentile είναι το πολύ 1 / HISTOGRAM_SUB_BUCKETS,
+// για τιμές έως 2^HISTOGRAM_MAX_BITS (μεγαλύτερες τιμές μετράνε στο τελευταίο bucket).
+
+#define HISTOGRAM_SUB_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_MAX_BITS 40
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 2) * HISTOGRAM_SUB_BUCKETS)
+
+struct histogram {
+	uint64_t count;						// Πλήθος τιμών
+	uint64_t sum;						// Άθροισμα τιμών
+	uint64_t max;						// Μέγιστη τιμή
+	uint64_t buckets[HISTOGRAM_BUCKETS];
+};
+typedef struct histogram* Histogram;
+
+
+// Προσθέτει την τιμή value στο histogram. Μπορεί να κληθεί ταυτόχρονα από πολλά threads.
+
+void histogram_record(Histogram histogram, uint64_t value);
+
+// Επιστρέφει (κατά προσέγγιση) το p-οστό percentile των τιμών, 0 <= p <= 100 (0 αν το histogram είναι κενό)
+
+uint64_t histogram_percentile(Histogram histogram, double p);
+
+// Προσθέτει όλες τις τιμές του histogram other στο histogram
+
+void histogram_merge(Histogram histogram, Histogram other);
+
+// Αφαιρεί όλες τις τιμές του histogram
+
+void histogram_reset(Histogram histogram);
+
+
+// Επιστρέφει τον τρέχοντα χρόνο σε nanoseconds (monotonic clock)
+
+uint64_t stats_now();
+
+
+// Μετρητές ////////////////////////////////////////////////////////////////////
+
+typedef enum {
+	STAT_SET_COMPARES,			// Κλήσεις της compare σε αναζητήσεις / εισαγωγές / διαγραφές του Set
+	STAT_SET_ROTATIONS,			// Περιστροφές κατά το rebalancing του AVL
+	STAT_SET_NODE_ALLOCS,		// Κόμβοι Set που δεσμεύτηκαν
+	STAT_MAP_LOOKUPS,			// Αναζητήσεις / εισαγωγές / διαγραφές στο Map
+	STAT_MAP_COMPARES,			// Συγκρίσεις κλειδιών στις λίστες των buckets
+	STAT_MAP_REHASHES,			// Rehash του hash table
+	STAT_MAP_NODE_ALLOCS,		// Κόμβοι Map που δεσμεύτηκαν
+	STAT_LIST_NODE_ALLOCS,		// Κόμβοι List που δεσμεύτηκαν
+	STAT_VECTOR_RESIZES,		// Αλλαγές μεγέθους (realloc) του πίνακα ενός Vector
+	STAT_ARENA_SLAB_ALLOCS,		// Slabs που δεσμεύτηκαν από το RecordArena
+	STAT_TRIE_NODE_ALLOCS,		// Κόμβοι Trie που δεσμεύτηκαν
+	STAT_VSET_NODE_ALLOCS,		// Κόμβοι VersionedSet που δεσμεύτηκαν
+	STAT_VSET_NODE_COPIES,		// Κόμβοι VersionedSet που αντιγράφηκαν επειδή τους έβλεπε κάποιο snapshot
+	STAT_COUNTERS_NO
+} StatCounter;
+
+// Οι public λειτουργίες του DiseaseMonitor για τις οποίες κρατάμε latency histograms
+
+typedef enum {
+	STAT_OP_INSERT,
+	STAT_OP_REMOVE,
+	STAT_OP_UPDATE,
+	STAT_OP_GET_RECORDS,
+	STAT_OP_COUNT_RECORDS,
+	STAT_OP_TOP_DISEASES,
+	STAT_OP_INSERT_BATCH,
+	STAT_OP_COUNT_BATCH,
+	STAT_OP_FIND_BY_NAME,
+	STAT_OP_DATE_PERCENTILE,
+	STAT_OP_TOP_COUNTRIES,
+	STAT_OP_COUNT_BY_COUNTRY,
+	STAT_OP_COUNT_BY_DISEASE,
+	STAT_OP_GET_RECORDS_PAGE,
+	STAT_OP_SAMPLE_RECORDS,
+	STAT_OP_CHECKPOINT,			// Μόνο η παύση του monitor για το fork, βλ. dm_checkpoint_async
+	STAT_OPS_NO
+} StatOp;
+
+// Τα ονόματα των μετρητών και των λειτουργιών, για εκτύπωση
+
+extern const char* stat_counter_names[STAT_COUNTERS_NO];
+extern const char* stat_op_names[STAT_OPS_NO];
+
+// Οι τρέχουσες τιμές των μετρητών, και τα histograms (σε nanoseconds) των λειτουργιών.
+// Ενημερώνονται μόνο μέσω των macros παρακάτω.
+
+extern uint64_t stat_counters[STAT_COUNTERS_NO];
+extern struct histogram stat_histograms[STAT_OPS_NO];
+
+// Μηδενίζει όλους τους μετρητές και τα histograms
+
+void stats_reset();
+
+
+// Macros για τα modules:
+//   STATS_ADD(counter, n)     αυξάνει τον μετρητή κατά n
+//   STATS_TIMER_START(t)      ξεκινάει μια χρονομέτρηση στην (τοπική) μεταβλητή t
+//   STATS_TIMER_STOP(op, t)   προσθέτει το χρόνο από το STATS_TIMER_START(t) στο histogram της op
+
+#ifdef DM_STATS
+
+#define STATS_ENABLED true
+#define STATS_ADD(counter, n) __atomic_fetch_add(&stat_counters[counter], (n), __ATOMIC_RELAXED)
+#define STATS_TIMER_START(t) uint64_t t = stats_now()
+#define STATS_TIMER_STOP(op, t) histogram_record(&stat_histograms[op], stats_now() - (t))
+
+#else
+
+#define STATS_ENABLED false
+#define STATS_ADD(counter, n) ((void)0)
+#define STATS_TIMER_START(t) ((void)0)
+#define STATS_TIMER_STOP(op, t) ((void)0)
+
+#endif
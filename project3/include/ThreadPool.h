@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////
+//
+// Thread Pool
+//
+// Ένα σταθερό σύνολο από worker threads, στο οποίο εκτελούνται
+// παράλληλα ανεξάρτητες εργασίες (fork-join).
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include "common_types.h"
+
+
+// Ένα thread pool αναπαριστάται από τον τύπο ThreadPool
+
+typedef struct thread_pool* ThreadPool;
+
+// Μια εργασία προς εκτέλεση, καλείται με όρισμα το αντίστοιχο στοιχείο του πίνακα args
+
+typedef void (*TaskFunc)(Pointer arg);
+
+
+// Δημιουργεί και επιστρέφει ένα pool που εκτελεί εργασίες σε threads νήματα συνολικά
+// (threads - 1 workers, μαζί με το thread που καλεί την pool_run).
+
+ThreadPool pool_create(int threads);
+
+// Επιστρέφει τον αριθμό των νημάτων του pool
+
+int pool_threads(ThreadPool pool);
+
+// Εκτελεί την task(args[i]) για κάθε i = 0 .. n-1, μοιράζοντας τις κλήσεις στα νήματα
+// του pool. Επιστρέφει αφού ολοκληρωθούν _όλες_ οι κλήσεις. Δεν επιτρέπεται να κληθεί
+// ταυτόχρονα από περισσότερα του ενός threads.
+
+void pool_run(ThreadPool pool, TaskFunc task, Pointer args[], int n);
+
+// Τερματίζει τους workers και ελευθερώνει όλη τη μνήμη που δεσμεύει το pool.
+
+void pool_destroy(ThreadPool pool);
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////
+//
+// Trace
+//
+// Καταγραφή μιας ακολουθίας κλήσεων του DiseaseMonitor σε αρχείο,
+// σε συμπαγή δυαδική μορφή, και ανάγνωσή της για επανεκτέλεση.
+//
+// Κάθε λειτουργία αποθηκεύεται ως: τύπος (1 byte), χρόνος από την
+// προηγούμενη λειτουργία (varint, nanoseconds) και τα ορίσματά της
+// (ακέραιοι ως varints, strings ως μήκος + bytes). Τα disease και
+// country κωδικοποιούνται μέσω λεξικού: κάθε διαφορετικό string
+// γράφεται μόνο την πρώτη φορά, και μετά μόνο ο αριθμός του.
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include <stdint.h>
+
+#include "DiseaseMonitor.h"
+
+
+// Οι λειτουργίες που καταγράφονται
+
+typedef enum {
+	TRACE_INSERT,
+	TRACE_REMOVE,
+	TRACE_UPDATE,
+	TRACE_GET_RECORDS,
+	TRACE_COUNT_RECORDS,
+	TRACE_TOP_DISEASES,
+	TRACE_GET_RECORDS_PAGE,
+	TRACE_SAMPLE_RECORDS,
+	TRACE_COUNT_BY_COUNTRY,
+	TRACE_COUNT_BY_DISEASE,
+	TRACE_TOP_COUNTRIES,
+	TRACE_FIND_BY_NAME_PREFIX,
+	TRACE_DATE_PERCENTILE,
+	TRACE_SET_REGION,
+	TRACE_OPS_NO
+} TraceOpType;
+
+// Μια λειτουργία και τα ορίσματά της. Χρησιμοποιούνται μόνο τα πεδία που αντιστοιχούν στον τύπο:
+//   TRACE_INSERT:        record
+//   TRACE_REMOVE:        id
+//   TRACE_UPDATE:        id, record
+//   TRACE_GET_RECORDS:   disease, country, date_from, date_to (οποιοδήποτε μπορεί να είναι NULL)
+//   TRACE_COUNT_RECORDS: disease, country, date_from, date_to
+//   TRACE_TOP_DISEASES:  k, country
+//   TRACE_GET_RECORDS_PAGE:    disease, country, date_from, date_to, newest_first, offset, limit
+//   TRACE_SAMPLE_RECORDS:      k, disease, country, date_from, date_to, seed
+//   TRACE_COUNT_BY_COUNTRY:    disease, date_from, date_to
+//   TRACE_COUNT_BY_DISEASE:    country, date_from, date_to
+//   TRACE_TOP_COUNTRIES:       k, disease
+//   TRACE_FIND_BY_NAME_PREFIX: prefix, limit
+//   TRACE_DATE_PERCENTILE:     disease, country, date_from, date_to, p
+//   TRACE_SET_REGION:          country, region, continent (μπορεί να είναι NULL)
+
+struct trace_op {
+	TraceOpType type;
+	uint64_t time;				// Nanoseconds από την αρχή του trace (συμπληρώνεται από τον writer)
+	int id;
+	struct record record;
+	String disease;
+	String country;
+	Date date_from;
+	Date date_to;
+	int k;
+	bool newest_first;
+	int offset;
+	int limit;
+	uint64_t seed;
+	double p;
+	String prefix;
+	String region;
+	String continent;
+};
+typedef struct trace_op* TraceOp;
+
+
+// Writer //////////////////////////////////////////////////////////////////////
+
+typedef struct trace_writer* TraceWriter;
+
+// Δημιουργεί το αρχείο path και επιστρέφει έναν writer, ή NULL αν το αρχείο δεν μπορεί να δημιουργηθεί.
+// Ο χρόνος των λειτουργιών μετράει από αυτή τη στιγμή.
+
+TraceWriter trace_writer_create(String path);
+
+// Προσθέτει στο trace τη λειτουργία op, με χρόνο την τρέχουσα στιγμή
+
+void trace_write(TraceWriter writer, TraceOp op);
+
+// Γράφει ό,τι έχει μείνει στο buffer, κλείνει το αρχείο και ελευθερώνει τη μνήμη του writer. Επιστρέφει
+// false αν κάποια εγγραφή στο αρχείο απέτυχε (οπότε το trace μπορεί να είναι ελλιπές).
+
+bool trace_writer_destroy(TraceWriter writer);
+
+
+// Reader //////////////////////////////////////////////////////////////////////
+
+typedef struct trace_reader* TraceReader;
+
+// Ανοίγει το αρχείο path και επιστρέφει έναν reader, ή NULL αν το αρχείο δεν υπάρχει ή δεν είναι trace
+
+TraceReader trace_reader_create(String path);
+
+// Διαβάζει την επόμενη λειτουργία στο op. Επιστρέφει false στο τέλος του αρχείου (ή αν το αρχείο
+// είναι κατεστραμμένο). Τα strings του op ανήκουν στον reader: τα disease / country / region /
+// continent ισχύουν μέχρι την trace_reader_destroy, τα υπόλοιπα μόνο μέχρι την επόμενη trace_read. Τα πεδία που δεν
+// αντιστοιχούν στον τύπο της λειτουργίας δεν ορίζονται.
+
+bool trace_read(TraceReader reader, TraceOp op);
+
+// Κλείνει το αρχείο και ελευθερώνει τη μνήμη του reader
+
+void trace_reader_destroy(TraceReader reader);
@@ -5,6 +5,9 @@
 // Χρήση του τύπου "bool" για μεταβλητές που παίρνουν μόνο τιμές true / false
 #include <stdbool.h> 
 
+// Χρήση του τύπου "size_t" για μεγέθη μνήμης
+#include <stddef.h>
+
 // Pointer προς ένα αντικείμενο οποιουδήποτε τύπου. Απλά είναι πιο ευανάγνωστο από το "void*" που μοιάζει με το "void"
 typedef void* Pointer;
 
@@ -1,58 +1,190 @@
-
 #include "DiseaseMonitor.h"
 #include "ADTMap.h"
-#include "ADTPriorityQueue.h"
 #include "ADTSet.h"
 #include "ADTList.h"
+#include "ADTTrie.h"
+#include "ADTVersionedSet.h"
+#include "Outbreak.h"
+#include "ThreadPool.h"
+#include "RecordArena.h"
+#include "RecordPartitions.h"
+#include "SharedReplica.h"
+#include "Stats.h"
+#include "Trace.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Μετρητής εγγραφών μιας ασθένειας, για τη dm_top_diseases. Κάθε TopNode ανήκει σε ένα
+// ranking (Set ταξινομημένο κατά counter) και κρατάει τον κόμβο του σε αυτό, ώστε η
+// αλλαγή του counter να μη χρειάζεται αναζήτηση. Οι μετρητές (χώρα, ασθένεια) ανήκουν
+// επιπλέον στο disease->countries, για τη dm_top_countries.
+
+struct top_node{
+    String disease;
+    String country;     // η χώρα των μετρητών (χώρα, ασθένεια) και των συνολικών μετρητών των χωρών, αλλιώς NULL
+    int counter;
+    SetNode node;       // ο κόμβος στο ranking, NULL όσο counter == 0
+    SetNode country_node;       // ο κόμβος στο disease->countries (ή στο country_ranking), NULL όσο counter == 0
+    OutbreakDetector detector;  // μόνο στους μετρητές (χώρα, ασθένεια), βλ. dm_set_outbreak_detection
+    Set records;        // μόνο στους μετρητές (χώρα, ασθένεια): οι εγγραφές τους, compare_date
+};
+typedef struct top_node* TopNode;
+
+// Μια περιοχή της ιεραρχίας χώρα → περιοχή → ήπειρος (βλ. dm_set_region). Κρατάει τα αθροίσματα
+// των μετρητών όλων των χωρών που ανήκουν σε αυτή (άμεσα ή μέσω μιας υπο-περιοχής), ώστε τα
+// queries για μια περιοχή να απαντώνται χωρίς διάσχιση των χωρών της.
+
+struct region{
+    String name;
+    struct region* parent;  // η περιοχή που την περιέχει, NULL για τις ηπείρους
+    int total;              // εγγραφές σε όλες τις χώρες της περιοχής
+    Map tops;               // disease => TopNode, τα αθροίσματα των μετρητών (χώρα, ασθένεια)
+    Set ranking;            // TopNodes, compare_top
+    Set countries;          // οι χώρες που ανήκουν απευθείας στην περιοχή (τα keys του country_regions)
+    Set children;           // οι περιοχές που έχουν parent αυτή, compare_regions
+};
+typedef struct region* Region;
+
+// Index ανά χώρα: οι εγγραφές ταξινομημένες κατά ημερομηνία, και οι μετρητές των ασθενειών της
+
+struct country{
+    String name;        // δικό μας αντίγραφο, χρησιμοποιείται και ως key στο countries
+    Set records;        // Entries, compare_date
+    Map tops;           // disease => TopNode
+    Set ranking;        // TopNodes, compare_top
+    Region region;      // η περιοχή της χώρας, NULL αν δεν ανήκει σε κάποια
+    struct top_node total;  // μέλος του country_ranking
+};
+typedef struct country* Country;
+
+// Index ανά ασθένεια: οι εγγραφές ταξινομημένες κατά ημερομηνία, και ο συνολικός μετρητής της
+
+struct disease{
+    String name;
+    Set records;
+    Set countries;          // οι μετρητές (χώρα, ασθένεια) της ασθένειας, compare_top_country
+    struct top_node total;  // μέλος του global ranking
+};
+typedef struct disease* Disease;
+
+// Κάθε εγγραφή του monitor αντιστοιχεί σε ένα entry, το οποίο κρατάει όλους τους κόμβους
+// που δημιουργήθηκαν κατά την εισαγωγή. Έτσι η αφαίρεση γίνεται χωρίς καμία αναζήτηση, με
+// μία μόνο αναζήτηση στο ids. Τα indexes περιέχουν entries και όχι records.
+
+struct entry{
+    int id;                 // αντίγραφο του record->id, key στο ids
+    Record record;
+    Country country;
+    Disease disease;
+    TopNode top;            // ο μετρητής (country, disease)
+    SetNode monitor_node;   // οι κόμβοι στα disease_monitor, country->records, disease->records, top->records, dates
+    SetNode country_node;
+    SetNode disease_node;
+    SetNode top_node;
+    SetNode date_node;
+};
+typedef struct entry* Entry;
+
+// Μια εγγραφή του ιστορικού (βλ. dm_set_history). Τα partitions είναι append-only, οπότε μια εγγραφή που
+// αφαιρείται ή αντικαθίσταται μένει εκεί, και ισχύει μόνο το αντίγραφο με το id και την ημερομηνία
+// που είναι στο archived.
+
+struct archived{
+    int id;                 // key στο archived
+    char date[11];          // YYYY-MM-DD, όπως το δέχτηκε η partitions_insert
+};
+typedef struct archived* Archived;
+
+static Map countries = NULL;        // String => Country
+static Map diseases = NULL;         // String => Disease
+static Map ids = NULL;              // int => Entry
+static Trie names = NULL;           // name => Entries, για τη dm_find_by_name_prefix
+static Set disease_monitor = NULL;  // όλα τα Entries
+static Set dates = NULL;            // όλα τα Entries, compare_date
+static Set ranking = NULL;          // οι συνολικοί μετρητές (disease->total) όλων των ασθενειών
+static Set country_ranking = NULL;  // οι συνολικοί μετρητές (country->total) όλων των χωρών
+static Map regions = NULL;          // String => Region
+static Map country_regions = NULL;  // όνομα χώρας => Region, ισχύει και για χώρες χωρίς εγγραφές
+
+static int threads = 1;             // βλ. dm_set_threads
+static ThreadPool pool = NULL;      // δημιουργείται την πρώτη φορά που χρειάζεται
+
+static bool owned = false;          // βλ. dm_set_owned
+static RecordArena arena = NULL;    // τα αντίγραφα των records, μόνο αν owned == true
+
+static bool mvcc = false;           // βλ. dm_set_mvcc
+static VSet versions = NULL;        // όλα τα Records, για τα snapshots, μόνο αν mvcc == true
+
+static String history_directory = NULL;     // βλ. dm_set_history
+static int history_months = 0;
+static RecordPartitions history = NULL;     // οι παλιές εγγραφές, μόνο αν history_directory != NULL
+static Map archived = NULL;                 // id => Archived, οι εγγραφές του history που ισχύουν
+static char history_cutoff[16];             // ο πρώτος μήνας (YYYY-MM) που μένει στη μνήμη, "" αν δεν έχει υπολογιστεί
+
+static TraceWriter trace = NULL;    // βλ. dm_trace_start
+
+static pid_t checkpoint_pid = 0;    // το child που γράφει το checkpoint, 0 αν δεν εκτελείται κάποιο
+static int checkpoint_pipe = -1;    // από εδώ ο parent διαβάζει το αποτέλεσμα του child
+static struct dm_checkpoint checkpoint_info = { .state = DM_CHECKPOINT_IDLE };  // βλ. dm_checkpoint_status
+
+static ReplicaWriter replica = NULL;    // βλ. dm_replica_create
+
+static struct dm_outbreak_config outbreak_config;   // βλ. dm_set_outbreak_detection
+static bool outbreak_enabled = false;
+static int detectors = 0;           // πλήθος των OutbreakDetectors, για τη dm_memory_usage
 
-static Map countries = NULL;
-static Map diseases = NULL;
-static Map ids = NULL;
-static Set disease_monitor = NULL;
-static Map top = NULL;
-static PriorityQueue pqueue = NULL;
+static Map subscriptions = NULL;    // id => Subscription, βλ. dm_subscribe
+static Map channels = NULL;         // (disease, country) => Channel, ο πίνακας dispatch των subscriptions
+static int next_subscription = 1;
 
-static int compare_countries(String a, String b){
+static int compare_strings(String a, String b){
     return strcmp(a,b);
 }
 
-static int compare_diseases(String a, String b){
-    return strcmp(a,b);
+static int compare_regions(Region a, Region b){
+    return strcmp(a->name,b->name);
 }
 
-int compare_ids(Pointer a, Pointer b) {
-	return *(int*)a - *(int*)b;
+static int compare_ids(Pointer a, Pointer b) {
+    int x = *(int*)a, y = *(int*)b;
+	return (x > y) - (x < y);       // χωρίς αφαίρεση, που μπορεί να κάνει overflow
 }
 
-int compare_date(Record a, Record b){
-    if(strcmp(a->date,b->date)!=0)
-        return strcmp(a->date,b->date);
+static int compare_date(Entry a, Entry b){
+    int res = strcmp(a->record->date,b->record->date);
+    if(res != 0)
+        return res;
 
-    return a->id - b->id;
+    return compare_ids(&a->id,&b->id);
 }
 
-static int compare(Record a, Record b){
-    if(strcmp(a->disease,b->disease)!=0)
-        return strcmp(a->disease,b->disease);
+// Η διάταξη του disease_monitor (και του versions): disease, country, name, id
 
-    else if(strcmp(a->country,b->country)!=0)
-        return strcmp(a->country,b->country);
+static int compare_records(Record x, Record y){
+    if(strcmp(x->disease,y->disease)!=0)
+        return strcmp(x->disease,y->disease);
 
-    else if(strcmp(a->name,b->name)!=0)
-        return strcmp(a->name,b->name);
+    else if(strcmp(x->country,y->country)!=0)
+        return strcmp(x->country,y->country);
 
-    return a->id - b->id;
-}
+    else if(strcmp(x->name,y->name)!=0)
+        return strcmp(x->name,y->name);
 
-struct top_node{
-    String disease;
-    int counter;
-};
+    return compare_ids(&x->id,&y->id);
+}
 
-typedef struct top_node* TopNode;
+static int compare(Entry a, Entry b){
+    return compare_records(a->record,b->record);
+}
 
 static int compare_top(TopNode a, TopNode b){
     if(a->counter != b->counter)
@@ -61,293 +193,2342 @@ static int compare_top(TopNode a, TopNode b){
         return strcmp(a->disease,b->disease);        
 }
 
-void dm_init(){
-    countries = map_create((CompareFunc)compare_countries,NULL,NULL);
-    map_set_hash_function(countries,hash_string);
+// Η διάταξη των rankings των χωρών: counter, και για ίσους μετρητές το όνομα της χώρας
 
-    diseases = map_create((CompareFunc)compare_diseases,NULL,NULL);
-    map_set_hash_function(diseases,hash_string);
+static int compare_top_country(TopNode a, TopNode b){
+    if(a->counter != b->counter)
+        return a->counter - b->counter;
+    else
+        return strcmp(a->country,b->country);
+}
 
-    ids = map_create((CompareFunc)compare_ids,NULL,NULL);
-    map_set_hash_function(ids,hash_int);
+// Αλλάζει τον counter του node κατά diff, μετακινώντας τον στη σωστή θέση του ranking.
+// Οι μετρητές με counter == 0 δεν ανήκουν στο ranking.
 
-    disease_monitor = set_create((CompareFunc)compare,NULL); 
+static void top_update(Set ranking, TopNode node, int diff){
+    if(node->node != NULL)
+        set_remove_node(ranking,node->node);
 
-    top = map_create((CompareFunc)compare_countries,NULL,NULL);
-    map_set_hash_function(top,hash_string);
+    node->counter += diff;
+    node->node = node->counter > 0 ? set_insert_node(ranking,node) : NULL;
+}
+
+// Όπως η top_update, για τα rankings των χωρών (βλ. compare_top_country)
 
-    pqueue = pqueue_create((CompareFunc)compare_top,NULL,NULL);
+static void top_country_update(Set ranking, TopNode node, int diff){
+    if(node->country_node != NULL)
+        set_remove_node(ranking,node->country_node);
+
+    node->counter += diff;
+    node->country_node = node->counter > 0 ? set_insert_node(ranking,node) : NULL;
 }
 
-void dm_destroy(){
-    for(MapNode node = map_first(ids); node != MAP_EOF; node = map_next(ids,node))
-        set_destroy(map_node_value(ids,node));
+// Αλλάζει τον μετρητή (χώρα, ασθένεια) top κατά diff, στο ranking της χώρας και στο disease->countries,
+// καθώς και τον συνολικό μετρητή της χώρας
 
-    for(MapNode node = map_first(countries); node != MAP_EOF; node = map_next(countries,node))
-        set_destroy(map_node_value(countries,node));
+static void pair_update(Country country, Disease disease, TopNode top, int diff){
+    if(top->country_node != NULL){
+        set_remove_node(disease->countries,top->country_node);
+        top->country_node = NULL;
+    }
+    top_update(country->ranking,top,diff);
+    if(top->counter > 0)
+        top->country_node = set_insert_node(disease->countries,top);
 
-    for(MapNode node = map_first(diseases); node != MAP_EOF; node = map_next(diseases,node))
-        set_destroy(map_node_value(diseases,node));    
+    top_country_update(country_ranking,&country->total,diff);
+}
 
-    for(MapNode node = map_first(top); node != MAP_EOF; node = map_next(top,node))
-        set_destroy(map_node_value(top,node));             
+static void top_destroy(TopNode node){
+    if(node->records != NULL)
+        set_destroy(node->records);
+    if(node->detector != NULL){
+        outbreak_destroy(node->detector);
+        detectors--;
+    }
+    free(node);
+}
 
-    map_destroy(top);
-    map_destroy(countries);
-    map_destroy(diseases);
-    map_destroy(ids);
-    set_destroy(disease_monitor);
-    pqueue_set_destroy_value(pqueue,free);
-    pqueue_destroy(pqueue);
+static void country_destroy(Country country){
+    set_destroy(country->records);
+    map_destroy(country->tops);
+    set_destroy(country->ranking);
+    free(country->name);
+    free(country);
 }
 
-List dm_get_records(String disease, String country, Date date_from, Date date_to){
+static void disease_destroy(Disease disease){
+    set_destroy(disease->records);
+    set_destroy(disease->countries);
+    free(disease->name);
+    free(disease);
+}
 
-    List list = list_create(NULL); 
+static void region_destroy(Region region){
+    map_destroy(region->tops);
+    set_destroy(region->ranking);
+    set_destroy(region->countries);
+    set_destroy(region->children);
+    free(region->name);
+    free(region);
+}
 
-    if(disease != NULL){
-        MapNode DisNode = map_find_node(diseases,disease);
-        if(DisNode == NULL)
-            return list;
+// Επιστρέφουν το index της χώρας / ασθένειας name, δημιουργώντας το αν δεν υπάρχει
 
-        Set DisSet = map_node_value(diseases,DisNode);
-        for(SetNode node = set_first(DisSet); node != SET_EOF; node = set_next(DisSet,node)){
-            Record record = set_node_value(DisSet,node);
-            if((date_from != NULL && strcmp(record->date,date_from) < 0) || (date_to != NULL && strcmp(record->date,date_to) > 0) ){
-                continue;
-            }
-            else{
-                if(country == NULL || strcmp(record->country,country)==0){
-                    list_insert_next(list,LIST_EOF,record);
-                }
-            }
-        }
+static Country country_get(String name){
+    Country country = map_find(countries,name);
+    if(country == NULL){
+        country = malloc(sizeof(*country));
+        country->name = strdup(name);
+        country->records = set_create((CompareFunc)compare_date,NULL);
+        country->tops = map_create((CompareFunc)compare_strings,NULL,(DestroyFunc)top_destroy);
+        map_set_hash_function(country->tops,hash_string);
+        country->ranking = set_create((CompareFunc)compare_top,NULL);
+        country->region = map_find(country_regions,name);
+        country->total = (struct top_node){ .country = country->name, .counter = 0, .node = NULL, .country_node = NULL, .detector = NULL, .records = NULL };
+        map_insert(countries,country->name,country);
     }
-    else if(country != NULL){
-        MapNode CNode = map_find_node(countries,country);
-        if(CNode == NULL)
-            return list;
-        Set CSet = map_node_value(countries,CNode);
-        for(SetNode node = set_first(CSet); node != SET_EOF; node = set_next(CSet,node)){
-            Record record = set_node_value(CSet,node);
-            if((date_from != NULL && strcmp(record->date,date_from)<0) || (date_to != NULL && strcmp(record->date,date_to) > 0) ){
-                continue;
-            }
-            else{
-                list_insert_next(list,LIST_EOF,record);
-            }
-        }
+    return country;
+}
+
+static Disease disease_get(String name){
+    Disease disease = map_find(diseases,name);
+    if(disease == NULL){
+        disease = malloc(sizeof(*disease));
+        disease->name = strdup(name);
+        disease->records = set_create((CompareFunc)compare_date,NULL);
+        disease->countries = set_create((CompareFunc)compare_top_country,NULL);
+        disease->total = (struct top_node){ .disease = disease->name, .counter = 0, .node = NULL, .country_node = NULL, .detector = NULL, .records = NULL };
+        map_insert(diseases,disease->name,disease);
     }
-    else{
-        for(SetNode node = set_first(disease_monitor);node!=SET_EOF;node=set_next(disease_monitor,node)){
-            Record r = set_node_value(disease_monitor,node);
-            if((disease == NULL || strcmp(disease,r->disease)==0) && (country == NULL || strcmp(country,r->country)==0) && (date_from == NULL || strcmp(r->date,date_from)>=0) && (date_to == NULL || strcmp(r->date,date_to)<=0)){
-                list_insert_next(list,LIST_EOF,set_node_value(disease_monitor,node));
-            }   
+    return disease;
+}
+
+static Region region_get(String name){
+    Region region = map_find(regions,name);
+    if(region == NULL){
+        region = malloc(sizeof(*region));
+        region->name = strdup(name);
+        region->parent = NULL;
+        region->total = 0;
+        region->tops = map_create((CompareFunc)compare_strings,NULL,(DestroyFunc)top_destroy);
+        map_set_hash_function(region->tops,hash_string);
+        region->ranking = set_create((CompareFunc)compare_top,NULL);
+        region->countries = set_create((CompareFunc)compare_strings,NULL);
+        region->children = set_create((CompareFunc)compare_regions,NULL);
+        map_insert(regions,region->name,region);
+    }
+    return region;
+}
+
+// Επιστρέφει τον μετρητή της disease στο tops (μιας χώρας ή περιοχής), δημιουργώντας τον αν
+// δεν υπάρχει. Το disease πρέπει να είναι το όνομα που κρατάει το αντίστοιχο Disease.
+
+static TopNode top_get(Map tops, String disease){
+    TopNode node = map_find(tops,disease);
+    if(node == NULL){
+        node = malloc(sizeof(*node));
+        node->disease = disease;
+        node->country = NULL;
+        node->counter = 0;
+        node->node = NULL;
+        node->country_node = NULL;
+        node->detector = NULL;
+        node->records = NULL;       // δημιουργείται στην πρώτη εγγραφή, βλ. top_records
+        map_insert(tops,disease,node);
+    }
+    return node;
+}
+
+// Οι εγγραφές ενός μετρητή (χώρα, ασθένεια) κατά ημερομηνία. Οι μετρητές των περιοχών και οι
+// συνολικοί δεν κρατάνε εγγραφές, οπότε το set δημιουργείται μόνο όταν χρειαστεί.
+
+static Set top_records(TopNode top){
+    if(top->records == NULL)
+        top->records = set_create((CompareFunc)compare_date,NULL);
+    return top->records;
+}
+
+// Επιστρέφει τον μετρητή (country, disease), δημιουργώντας τον αν δεν υπάρχει
+
+static TopNode pair_get(Country country, Disease disease){
+    TopNode top = top_get(country->tops,disease->name);
+    top->country = country->name;
+    return top;
+}
+
+// Ιεραρχία περιοχών ////////////////////////////////////////////////////////////
+
+// Αλλάζει τον μετρητή της disease στην region κατά diff. Οι μετρητές που μηδενίζονται αφαιρούνται,
+// αφού το όνομα της ασθένειας παύει να υπάρχει όταν αφαιρεθεί η τελευταία της εγγραφή.
+
+static void region_top_update(Region region, String disease, int diff){
+    TopNode top = top_get(region->tops,disease);
+    top_update(region->ranking,top,diff);
+    if(top->counter == 0)
+        map_remove(region->tops,top->disease);
+}
+
+// Ενημερώνει την περιοχή της country και όλες όσες την περιέχουν για diff εγγραφές της disease
+
+static void regions_update(Country country, String disease, int diff){
+    for(Region r = country->region; r != NULL; r = r->parent){
+        r->total += diff;
+        region_top_update(r,disease,diff);
+    }
+}
+
+// Προσθέτει (sign == 1) ή αφαιρεί (sign == -1) από την region και όλες όσες την περιέχουν τις total
+// εγγραφές και τους μετρητές tops (disease => TopNode) μιας χώρας ή περιοχής που μετακινείται
+
+static void region_rollup(Region region, Map tops, int total, int sign){
+    for(Region r = region; r != NULL; r = r->parent){
+        r->total += sign * total;
+        for(MapNode node = map_first(tops); node != MAP_EOF; node = map_next(tops,node)){
+            TopNode top = map_node_value(tops,node);
+            region_top_update(r,top->disease,sign * top->counter);
         }
     }
+}
 
-        // printf("new\n");
-        // for(MapNode node = map_first(countries);node!=MAP_EOF;node = map_next(countries,node)){
-        // Set set = map_node_value(countries,node);
-        // for(SetNode nod = set_first(set); nod!=SET_EOF; nod = set_next(set,nod)){
-        //     Record r = set_node_value(set,nod);
-        //     printf("%s %s %s %d %s\n",r->country,r->name,r->disease,r->id,r->date);
-        // }
-        // printf("stop\n");
-        // }
+// Επιστρέφει true αν η περιοχή r (μπορεί να είναι NULL) είναι η region ή περιέχεται σε αυτή
 
-    return list;
+static bool region_contains(Region region, Region r){
+    for(; r != NULL; r = r->parent)
+        if(r == region)
+            return true;
+    return false;
 }
 
-int dm_count_records(String disease, String country, Date date_from, Date date_to){
-    List list = dm_get_records(disease,country,date_from,date_to);
-    int size = list_size(list);
-    list_destroy(list);
-    return size;
+// Αποθηκεύει στο found (μετά τις n πρώτες θέσεις) τις χώρες με εγγραφές της region και όλων των
+// περιοχών που περιέχει, και επιστρέφει το νέο πλήθος. Πολυπλοκότητα ανάλογη των χωρών και
+// περιοχών που περιέχει η region, όχι όλων των χωρών.
+
+static int region_countries(Region region, Country found[], int n){
+    for(SetNode node = set_first(region->countries); node != SET_EOF; node = set_next(region->countries,node)){
+        Country C = map_find(countries,set_node_value(region->countries,node));
+        if(C != NULL)
+            found[n++] = C;
+    }
+    for(SetNode node = set_first(region->children); node != SET_EOF; node = set_next(region->children,node))
+        n = region_countries(set_node_value(region->children,node),found,n);
+    return n;
 }
 
-List dm_top_diseases(int k, String country){
-    List list = list_create(NULL);
-    if(country != NULL){
-        MapNode node = map_find_node(top,country);
-        if(node == NULL)
-            return list;
-    
-        Set set = map_node_value(top,node);
-        SetNode Snode = set_first(set);
-        for(int i = 0; i < k; i++){
-            TopNode node = set_node_value(set,Snode);
-            list_insert_next(list,LIST_EOF,node);
-            Snode = set_next(set,Snode);
+static bool set_region(String country, String region, String continent){
+    // Τα ονόματα των χωρών και των περιοχών της ιεραρχίας πρέπει να είναι διαφορετικά
+    if(strcmp(country,region) == 0 || map_find(regions,country) != NULL || map_find(country_regions,region) != NULL)
+        return false;
+    if(continent != NULL && (strcmp(continent,region) == 0 || strcmp(continent,country) == 0 || map_find(country_regions,continent) != NULL))
+        return false;
+
+    // Η ήπειρος δεν μπορεί να περιέχεται ήδη στην περιοχή
+    Region old_region = map_find(regions,region);
+    Region old_continent = continent != NULL ? map_find(regions,continent) : NULL;
+    if(old_region != NULL && old_continent != NULL && region_contains(old_region,old_continent))
+        return false;
+
+    // Η περιοχή μετακινείται στη νέα ήπειρο μαζί με τους μετρητές της
+    Region R = region_get(region);
+    if(continent != NULL && R->parent != region_get(continent)){
+        if(R->parent != NULL){
+            region_rollup(R->parent,R->tops,R->total,-1);
+            set_remove(R->parent->children,R);
         }
+        R->parent = region_get(continent);
+        set_insert(R->parent->children,R);
+        region_rollup(R->parent,R->tops,R->total,1);
     }
-    else{
-        List temp = list_create(NULL);
 
-        for(int i = 1; i <= k; i++){
-        //printf("size: %d, k:%d\n",pqueue_size(pqueue),k);  
-            PriorityQueueNode PQnode = pqueue_max(pqueue);
-            TopNode node = pqueue_node_value(pqueue,PQnode);
-            list_insert_next(list,LIST_EOF,node);
-            list_insert_next(temp,LIST_EOF,PQnode);
-            pqueue_remove_max(pqueue);
-        }        
-        for(ListNode ln = list_first(temp); ln != LIST_EOF; ln = list_next(temp,ln)){
-            pqueue_insert(pqueue,list_node_value(temp,ln));
+    // Το ίδιο και η χώρα, αν έχει ήδη εγγραφές
+    Region old = map_find(country_regions,country);
+    if(old != R){
+        Country C = map_find(countries,country);
+        if(C != NULL){
+            if(old != NULL)
+                region_rollup(old,C->tops,set_size(C->records),-1);
+            region_rollup(R,C->tops,set_size(C->records),1);
+            C->region = R;
+        }
+        if(old != NULL){
+            set_remove(old->countries,country);
+            map_remove(country_regions,country);
         }
-        list_destroy(temp);
+        String key = strdup(country);
+        map_insert(country_regions,key,R);
+        set_insert(R->countries,key);
     }
-    return list;
+    return true;
 }
 
-bool dm_insert_record(Record record){
-    set_insert(disease_monitor,record);
-
-    bool flag1 = true;
-    bool flag2 = true;
-    bool flag3 = true;
-
-    MapNode Mtop = map_find_node(top,record->country);
-    if(Mtop == NULL){
-        Set TopSet = set_create((CompareFunc)compare_top,NULL);
-        map_insert(top,record->country,TopSet);
-        Mtop = map_find_node(top,record->country);
-    }
-        Set InSet = map_node_value(top,Mtop);
-        struct top_node search = {.disease = record->disease};
-        SetNode find = set_find_node(InSet,&search);
-        if(find != NULL){
-            TopNode node = set_node_value(InSet,find);
-            pqueue_remove_node(pqueue,(PriorityQueueNode)node);
-            node->counter ++;
-            set_insert(InSet,node);
-            pqueue_insert(pqueue,node);
+// Αφαιρεί τα κενά στην αρχή και στο τέλος του s (το οποίο τροποποιεί)
+
+static char* trim(char* s){
+    while(isspace((unsigned char)*s))
+        s++;
+    char* end = s + strlen(s);
+    while(end > s && isspace((unsigned char)end[-1]))
+        end--;
+    *end = '\0';
+    return s;
+}
+
+static bool load_regions(String path){
+    FILE* file = fopen(path,"r");
+    if(file == NULL)
+        return false;
+
+    bool ok = true;
+    char* line = NULL;
+    size_t capacity = 0;
+    while(getline(&line,&capacity,file) != -1){
+        char* start = trim(line);
+        if(*start == '\0' || *start == '#')
+            continue;
+
+        // Τα πεδία χωρίζονται με κόμματα: country, region [, continent]
+        char* fields[3] = { start, NULL, NULL };
+        int n = 1;
+        for(char* p = start; (p = strchr(p,',')) != NULL && n <= 3; n++){
+            *p++ = '\0';
+            if(n < 3)
+                fields[n] = p;
         }
-        else{
-            TopNode node = malloc(sizeof(node));
-            node->counter = 1;
-            node->disease = record->disease;
-            set_insert(InSet,node);
-            pqueue_insert(pqueue,node);
-        }
-
-    MapNode node1 = map_find_node(ids,&(record->id));
-    if(node1 == NULL){
-        flag1 = false;
-        Set set = set_create((CompareFunc)compare_ids,NULL);
-        map_insert(ids,&(record->id),set);
-        node1 = map_find_node(ids,&(record->id));    
-    }
-        Set set1 = map_node_value(ids,node1);
-        SetNode n1 = set_find_node(set1,record);
-        if(n1 == NULL)
-            flag1 = false;        
-        set_insert(set1,record);
-
-    MapNode node2 = map_find_node(countries,record->country);
-    if(node2 == NULL){
-        flag2 = false;
-        Set set2 = set_create((CompareFunc)compare_date,NULL);
-        map_insert(countries,record->country,set2);
-        node2 = map_find_node(countries,record->country);
-    }
-        Set set3 = map_node_value(countries,node2);
-        SetNode n2 = set_find_node(set3,record);
-        if(n2 == NULL)
-            flag2 = false;        
-        set_insert(set3,record);
-
-    MapNode node3 = map_find_node(diseases,record->disease);
-    if(node3 == NULL){
-        flag3 = false;
-        Set set4 = set_create((CompareFunc)compare_date,NULL);
-        map_insert(diseases,record->disease,set4);
-        node3 = map_find_node(diseases,record->disease);
-    }
-        Set set5 = map_node_value(diseases,node3);
-        SetNode n3 = set_find_node(set5,record);
-        if(n3 == NULL)
-            flag3 = false;
-
-        set_insert(set5,record); 
-
-    if(flag1 == false && flag2 == false && flag3 == false)
+        for(int i = 0; i < n && i < 3; i++)
+            fields[i] = trim(fields[i]);
+
+        if(n < 2 || n > 3 || fields[0][0] == '\0' || fields[1][0] == '\0' || (n == 3 && fields[2][0] == '\0')){
+            ok = false;
+            continue;
+        }
+
+        // Κάθε γραμμή καταγράφεται στο trace ως μια κλήση της dm_set_region, ώστε το replay να μη χρειάζεται το αρχείο
+        String continent = n == 3 ? fields[2] : NULL;
+        if(trace != NULL)
+            trace_write(trace,&(struct trace_op){ .type = TRACE_SET_REGION, .country = fields[0], .region = fields[1], .continent = continent });
+        if(!set_region(fields[0],fields[1],continent))
+            ok = false;
+    }
+
+    free(line);
+    fclose(file);
+    return ok;
+}
+
+// Συνεχή queries ///////////////////////////////////////////////////////////////
+//
+// Οι subscriptions ομαδοποιούνται σε channels ανά (disease, country), όπου NULL σημαίνει όλες. Μια
+// εγγραφή αφορά μόνο τα channels με την ασθένειά της ή NULL, και τη χώρα της, κάποια περιοχή που
+// την περιέχει ή NULL. Οπότε κάθε αλλαγή κοστίζει μερικές αναζητήσεις στο channels (μία για κάθε
+// επίπεδο της ιεραρχίας) και μία κλήση για κάθε subscription που ταιριάζει.
+
+struct channel{
+    String disease;         // δικά μας αντίγραφα, ή NULL
+    String country;
+    List subscriptions;     // Subscriptions, με τη σειρά της dm_subscribe
+};
+typedef struct channel* Channel;
+
+struct subscription{
+    int id;                 // key στο subscriptions
+    Channel channel;
+    DMSubscriptionFunc callback;
+    Pointer context;
+};
+typedef struct subscription* Subscription;
+
+// Σύγκριση strings που μπορεί να είναι NULL (πριν από όλα τα υπόλοιπα)
+
+static int compare_nullable(String a, String b){
+    if(a == NULL || b == NULL)
+        return (a != NULL) - (b != NULL);
+    return strcmp(a,b);
+}
+
+static int compare_channels(Channel a, Channel b){
+    int res = compare_nullable(a->disease,b->disease);
+    return res != 0 ? res : compare_nullable(a->country,b->country);
+}
+
+static uint hash_channel(Channel channel){
+    return (channel->disease != NULL ? hash_string(channel->disease) : 0) * 31
+        + (channel->country != NULL ? hash_string(channel->country) : 0);
+}
+
+static void channel_destroy(Channel channel){
+    list_destroy(channel->subscriptions);
+    free(channel->disease);
+    free(channel->country);
+    free(channel);
+}
+
+static int subscribe(String disease, String country, DMSubscriptionFunc callback, Pointer context){
+    if(callback == NULL)
+        return 0;
+
+    struct channel probe = { .disease = disease, .country = country };
+    Channel channel = map_find(channels,&probe);
+    if(channel == NULL){
+        channel = malloc(sizeof(*channel));
+        channel->disease = disease != NULL ? strdup(disease) : NULL;
+        channel->country = country != NULL ? strdup(country) : NULL;
+        channel->subscriptions = list_create(free);
+        map_insert(channels,channel,channel);
+    }
+
+    Subscription subscription = malloc(sizeof(*subscription));
+    *subscription = (struct subscription){ .id = next_subscription++, .channel = channel, .callback = callback, .context = context };
+    list_insert_next(channel->subscriptions,list_last(channel->subscriptions),subscription);
+    map_insert(subscriptions,&subscription->id,subscription);
+    return subscription->id;
+}
+
+static bool unsubscribe(int id){
+    Subscription subscription = map_find(subscriptions,&id);
+    if(subscription == NULL)
         return false;
-    else
-        return true;
+    map_remove(subscriptions,&id);
+
+    // Η λίστα είναι απλά συνδεδεμένη, οπότε χρειαζόμαστε τον προηγούμενο κόμβο
+    Channel channel = subscription->channel;
+    List list = channel->subscriptions;
+    ListNode previous = LIST_BOF;
+    for(ListNode node = list_first(list); list_node_value(list,node) != subscription; node = list_next(list,node))
+        previous = node;
+    list_remove_next(list,previous);    // κάνει free το subscription
+
+    if(list_size(list) == 0)
+        map_remove(channels,channel);   // κάνει destroy το channel
+    return true;
 }
 
-bool dm_remove_record(int id){
+static void channel_notify(String disease, String country, Record record, DMEvent event){
+    struct channel probe = { .disease = disease, .country = country };
+    Channel channel = map_find(channels,&probe);
+    if(channel == NULL)
+        return;
+
+    for(ListNode node = list_first(channel->subscriptions); node != LIST_EOF; node = list_next(channel->subscriptions,node)){
+        Subscription subscription = list_node_value(channel->subscriptions,node);
+        subscription->callback(record,event,subscription->context);
+    }
+}
+
+// Καλεί τα callbacks όλων των subscriptions που ταιριάζουν με το record. Η χώρα μπορεί να μην έχει
+// πλέον index (αν αφαιρέθηκε η τελευταία της εγγραφή), οπότε οι περιοχές βρίσκονται από το country_regions.
+
+static void notify(Record record, DMEvent event){
+    if(map_size(channels) == 0)
+        return;
+
+    String diseases[] = { record->disease, NULL };
+    for(int i = 0; i < 2; i++){
+        channel_notify(diseases[i],record->country,record,event);
+        for(Region r = map_find(country_regions,record->country); r != NULL; r = r->parent)
+            channel_notify(diseases[i],r->name,record,event);
+        channel_notify(diseases[i],NULL,record,event);
+    }
+}
+
+// Η destroy_value του versions: τα records αποδεσμεύονται όταν δεν τα βλέπει πλέον κανένα snapshot
+
+static void release_record(Record record){
+    if(arena != NULL)
+        arena_release(arena,record);
+}
+
+// Δημιουργεί τα partitions του ιστορικού, αν είναι ενεργό το history mode
+
+static void history_create(){
+    history_cutoff[0] = '\0';
+    if(history_directory != NULL){
+        history = partitions_create();
+        partitions_set_spill(history,history_directory,history_months);
+        archived = map_create((CompareFunc)compare_ids,NULL,free);
+        map_set_hash_function(archived,hash_int);
+    }
+}
+
+// Καταστρέφει τα partitions του ιστορικού (μαζί με τα αρχεία τους)
+
+static void history_destroy(){
+    if(history != NULL){
+        partitions_destroy(history);
+        map_destroy(archived);
+        history = NULL;
+        archived = NULL;
+    }
+}
 
-    // for(MapNode node = map_first(ids);node!=MAP_EOF;node = map_next(ids,node)){
-    //     printf("%d\n",*(int*)map_node_key(ids,node));
-    // }
-    // printf("new\n");
+void dm_init(){
+    countries = map_create((CompareFunc)compare_strings,NULL,(DestroyFunc)country_destroy);
+    map_set_hash_function(countries,hash_string);
+
+    diseases = map_create((CompareFunc)compare_strings,NULL,(DestroyFunc)disease_destroy);
+    map_set_hash_function(diseases,hash_string);
+
+    ids = map_create((CompareFunc)compare_ids,NULL,free);
+    map_set_hash_function(ids,hash_int);
+
+    names = trie_create(NULL);
+
+    regions = map_create((CompareFunc)compare_strings,NULL,(DestroyFunc)region_destroy);
+    map_set_hash_function(regions,hash_string);
+
+    country_regions = map_create((CompareFunc)compare_strings,free,NULL);
+    map_set_hash_function(country_regions,hash_string);
+
+    subscriptions = map_create((CompareFunc)compare_ids,NULL,NULL);
+    map_set_hash_function(subscriptions,hash_int);
+
+    channels = map_create((CompareFunc)compare_channels,NULL,(DestroyFunc)channel_destroy);
+    map_set_hash_function(channels,(HashFunc)hash_channel);
+
+    disease_monitor = set_create((CompareFunc)compare,NULL); 
+    dates = set_create((CompareFunc)compare_date,NULL);
+    ranking = set_create((CompareFunc)compare_top,NULL);
+    country_ranking = set_create((CompareFunc)compare_top_country,NULL);
+
+    if(owned)
+        arena = arena_create();
+    if(mvcc)
+        versions = vset_create((CompareFunc)compare_records,(DestroyFunc)release_record);
+    history_create();
+}
+
+void dm_destroy(){
+    // Το child έχει το δικό του αντίγραφο της μνήμης, αλλά πρέπει να μαζευτεί
+    if(checkpoint_pid != 0)
+        dm_checkpoint_status(NULL,true);
+
+    map_destroy(countries);
+    map_destroy(diseases);
+    map_destroy(ids);
+    trie_destroy(names);
+    map_destroy(regions);
+    map_destroy(country_regions);
+    map_destroy(subscriptions);
+    map_destroy(channels);
+    set_destroy(disease_monitor);
+    set_destroy(dates);
+    set_destroy(ranking);
+    set_destroy(country_ranking);
+    disease_monitor = NULL;
+
+    // Πριν το arena, αφού η vset_destroy αποδεσμεύει τα records
+    if(versions != NULL){
+        vset_destroy(versions);
+        versions = NULL;
+    }
 
-    MapNode node = map_find_node(ids,&id);      
-    if(node == NULL)
+    if(pool != NULL){
+        pool_destroy(pool);
+        pool = NULL;
+    }
+
+    if(arena != NULL){
+        arena_destroy(arena);
+        arena = NULL;
+    }
+    history_destroy();
+}
+
+bool dm_set_owned(bool value){
+    if(disease_monitor != NULL && set_size(disease_monitor) > 0)
         return false;
 
-    Set set = map_node_value(ids,node);
+    owned = value;
 
-    struct record search = { .id = id};
-    SetNode find = set_find_node(set,&search);
+    // Αν ο monitor είναι ήδη αρχικοποιημένος, το arena δημιουργείται / καταστρέφεται τώρα
+    if(disease_monitor != NULL && owned && arena == NULL)
+        arena = arena_create();
+    else if(!owned && arena != NULL){
+        arena_destroy(arena);
+        arena = NULL;
+    }
+    return true;
+}
 
-    if(find == NULL)
+bool dm_set_mvcc(bool value){
+    if(disease_monitor != NULL && set_size(disease_monitor) > 0)
         return false;
 
-    Record record = set_node_value(set,find);
-    set_remove(set,record);  
+    mvcc = value;
+
+    if(disease_monitor != NULL && mvcc && versions == NULL)
+        versions = vset_create((CompareFunc)compare_records,(DestroyFunc)release_record);
+    else if(!mvcc && versions != NULL){
+        vset_destroy(versions);
+        versions = NULL;
+    }
+    return true;
+}
+
+bool dm_set_history(String directory, int hot_months){
+    if(directory != NULL && hot_months < 1)
+        return false;
+    if(disease_monitor != NULL && (set_size(disease_monitor) > 0 || (history != NULL && partitions_size(history) > 0)))
+        return false;
 
-    MapNode Mnode = map_find_node(top,record->country);
-    if(Mnode != NULL){
+    free(history_directory);
+    history_directory = directory != NULL ? strdup(directory) : NULL;
+    history_months = hot_months;
 
-        Set OutSet = map_node_value(top,Mnode);
-        struct top_node search = {.disease = record->disease};
-        SetNode find = set_find_node(OutSet,&search);
+    // Αν ο monitor είναι ήδη αρχικοποιημένος, τα partitions δημιουργούνται / καταστρέφονται τώρα
+    if(disease_monitor != NULL){
+        history_destroy();
+        history_create();
+    }
+    return true;
+}
 
-        if(find != NULL){
-            TopNode node = set_node_value(OutSet,find);
-            node->counter --;
-            set_insert(OutSet,node);
-            pqueue_remove_node(pqueue,(PriorityQueueNode)node);
-            if(node->counter != 0)
-                pqueue_insert(pqueue,node);
-        }     
-    } 
+void dm_set_threads(int n){
+    if(n < 1)
+        n = 1;
 
-    if(set_size(set) == 0){
-        set_destroy(set);
-        map_remove(ids,&id);
+    if(pool != NULL && pool_threads(pool) != n){
+        pool_destroy(pool);
+        pool = NULL;
     }
+    threads = n;
+}
+
+// Παράλληλη διάσχιση του disease_monitor ///////////////////////////////////////
+
+// Κάτω από αυτό το πλήθος εγγραφών το κόστος συγχρονισμού ξεπερνά το όφελος
+#define PARALLEL_MIN_RECORDS 4096
+
+// Κάθε thread παίρνει περισσότερα από ένα τμήματα, ώστε η δουλειά να μοιράζεται ομοιόμορφα
+#define CHUNKS_PER_THREAD 4
+
+// Ένα τμήμα της διάσχισης: οι εγγραφές στις θέσεις [start, start + count) του disease_monitor
+struct scan_chunk {
+    int start;
+    int count;
+    Date date_from;
+    Date date_to;
+    List result;        // οι εγγραφές που ικανοποιούν τα κριτήρια, NULL αν χρειαζόμαστε μόνο το πλήθος
+    int matches;
+};
+
+static bool parallel_scan_enabled(){
+    return threads > 1 && set_size(disease_monitor) >= PARALLEL_MIN_RECORDS;
+}
+
+static void scan_chunk(struct scan_chunk* chunk){
+    chunk->matches = 0;
 
+    SetNode node = set_node_at(disease_monitor,chunk->start);
+    for(int i = 0; i < chunk->count; i++, node = set_next(disease_monitor,node)){
+        Record r = ((Entry)set_node_value(disease_monitor,node))->record;
+        if((chunk->date_from != NULL && strcmp(r->date,chunk->date_from) < 0) || (chunk->date_to != NULL && strcmp(r->date,chunk->date_to) > 0))
+            continue;
 
-    MapNode node1 = map_find_node(countries,record->country);
-    if(node1 == NULL)
-        return false; 
+        chunk->matches++;
+        if(chunk->result != NULL)
+            list_insert_next(chunk->result,list_last(chunk->result),r);
+    }
+}
 
-    Set set1 = map_node_value(countries,node1);   
-    set_remove(set1,record);   
-    if(set_size(set1) == 0){
-        set_destroy(set1);
-        map_remove(countries,record->country);
-    }    
+// Φιλτράρει παράλληλα όλες τις εγγραφές με βάση τις ημερομηνίες. Αν result != NULL οι εγγραφές
+// προστίθενται στο τέλος της. Επιστρέφει το πλήθος τους.
 
-    MapNode node2 = map_find_node(diseases,record->disease);
-    if(node2 == NULL)
-        return false; 
+static int parallel_scan(Date date_from, Date date_to, List result){
+    if(pool == NULL)
+        pool = pool_create(threads);
 
-    Set set2 = map_node_value(diseases,node2);    
-    if(set_size(set2) == 0){
-        set_destroy(set2);
-        map_remove(diseases,record->disease);
-    }           
-    set_remove(set2,record);    
+    int size = set_size(disease_monitor);
+    int n = threads * CHUNKS_PER_THREAD;
+
+    struct scan_chunk chunks[n];
+    Pointer args[n];
+    for(int i = 0; i < n; i++){
+        chunks[i].start = (long)size * i / n;
+        chunks[i].count = (long)size * (i + 1) / n - chunks[i].start;
+        chunks[i].date_from = date_from;
+        chunks[i].date_to = date_to;
+        chunks[i].result = result != NULL ? list_create(NULL) : NULL;
+        args[i] = &chunks[i];
+    }
 
-    set_remove(disease_monitor,record);
-    return true;   
+    pool_run(pool,(TaskFunc)scan_chunk,args,n);
 
+    // Συνένωση με τη σειρά των τμημάτων
+    int matches = 0;
+    for(int i = 0; i < n; i++){
+        matches += chunks[i].matches;
+        if(result != NULL)
+            list_append(result,chunks[i].result);
+    }
+    return matches;
 }
 
+// Η scan_records για μια περιοχή, βλ. Order statistics
+static int scan_region(String disease, Region region, Date date_from, Date date_to, List result);
+
+// Βρίσκει τις εγγραφές που ικανοποιούν τα κριτήρια, τις προσθέτει στη result (αν δεν είναι
+// NULL) και επιστρέφει το πλήθος τους. Το country μπορεί να είναι και περιοχή (βλ. dm_set_region). Η πλήρης διάσχιση γίνεται παράλληλα μόνο αν parallel
+// == true, αφού η pool_run δεν μπορεί να κληθεί μέσα από εργασία του ίδιου pool.
+
+static int scan_records(String disease, String country, Date date_from, Date date_to, List result, bool parallel){
+    int matches = 0;
+
+    Region region = country != NULL ? map_find(regions,country) : NULL;
+    if(region != NULL)
+        return scan_region(disease,region,date_from,date_to,result);
 
+    if(disease != NULL){
+        Disease Dis = map_find(diseases,disease);
+        if(Dis == NULL)
+            return 0;
+
+        Set DisSet = Dis->records;
+        for(SetNode node = set_first(DisSet); node != SET_EOF; node = set_next(DisSet,node)){
+            Record record = ((Entry)set_node_value(DisSet,node))->record;
+            if((date_from != NULL && strcmp(record->date,date_from) < 0) || (date_to != NULL && strcmp(record->date,date_to) > 0) ){
+                continue;
+            }
+            else{
+                if(country == NULL || strcmp(record->country,country)==0){
+                    matches++;
+                    if(result != NULL)
+                        list_insert_next(result,LIST_EOF,record);
+                }
+            }
+        }
+    }
+    else if(country != NULL){
+        Country C = map_find(countries,country);
+        if(C == NULL)
+            return 0;
+        Set CSet = C->records;
+        for(SetNode node = set_first(CSet); node != SET_EOF; node = set_next(CSet,node)){
+            Record record = ((Entry)set_node_value(CSet,node))->record;
+            if((date_from != NULL && strcmp(record->date,date_from)<0) || (date_to != NULL && strcmp(record->date,date_to) > 0) ){
+                continue;
+            }
+            else{
+                matches++;
+                if(result != NULL)
+                    list_insert_next(result,LIST_EOF,record);
+            }
+        }
+    }
+    else if(parallel && parallel_scan_enabled()){
+        matches = parallel_scan(date_from,date_to,result);
+    }
+    else{
+        for(SetNode node = set_first(disease_monitor);node!=SET_EOF;node=set_next(disease_monitor,node)){
+            Record r = ((Entry)set_node_value(disease_monitor,node))->record;
+            if((date_from == NULL || strcmp(r->date,date_from)>=0) && (date_to == NULL || strcmp(r->date,date_to)<=0)){
+                matches++;
+                if(result != NULL)
+                    list_insert_next(result,LIST_EOF,r);
+            }   
+        }
+    }
+
+    return matches;
+}
+
+// Επιστρέφει true αν το record (από τα partitions του history) είναι το αντίγραφο που ισχύει
+
+static bool history_live(Record record){
+    Archived a = map_find(archived,&record->id);
+    return a != NULL && strcmp(a->date,record->date) == 0;
+}
+
+// Επιστρέφει ένα αντίγραφο του record σε ένα μόνο block (το struct και μετά τα strings), ώστε να
+// αποδεσμεύεται με free
+
+static Record record_copy(Record record){
+    String fields[] = { record->name, record->disease, record->country, record->date };
+    size_t size = sizeof(struct record);
+    for(int i = 0; i < 4; i++)
+        size += strlen(fields[i]) + 1;
+
+    Record copy = malloc(size);
+    copy->id = record->id;
+    String* targets[] = { &copy->name, &copy->disease, &copy->country, &copy->date };
+    char* next = (char*)(copy + 1);
+    for(int i = 0; i < 4; i++){
+        *targets[i] = strcpy(next,fields[i]);
+        next += strlen(fields[i]) + 1;
+    }
+    return copy;
+}
+
+// Η κατάσταση της history_scan για τις εγγραφές του ιστορικού
+
+struct history_scan{
+    Region region;      // η περιοχή του query, NULL αν το country είναι χώρα
+    List result;
+    int matches;
+};
+
+static bool history_visit(Record record, struct history_scan* scan){
+    if(!history_live(record))
+        return true;
+    if(scan->region != NULL && !region_contains(scan->region,map_find(country_regions,record->country)))
+        return true;
+
+    scan->matches++;
+    if(scan->result != NULL)
+        list_insert_next(scan->result,LIST_EOF,record_copy(record));
+    return true;
+}
+
+// Η scan_records για τις εγγραφές του ιστορικού (βλ. dm_set_history). Στη result προστίθενται αντίγραφα
+// (record_copy), γιατί τα records των partitions στο δίσκο είναι προσωρινά. Για μια χώρα (ή χωρίς
+// country) χωρίς result οι εγγραφές απλά μετράνε, αν δεν υπάρχουν αντίγραφα που δεν ισχύουν, αλλιώς
+// (και για μια περιοχή) εξετάζονται όλες στο διάστημα.
+
+static int history_scan(String disease, String country, Date date_from, Date date_to, List result){
+    Region region = country != NULL ? map_find(regions,country) : NULL;
+    if(region == NULL && result == NULL && partitions_size(history) == map_size(archived))
+        return partitions_scan(history,disease,country,date_from,date_to,NULL,NULL);
+
+    struct history_scan scan = { .region = region, .result = result, .matches = 0 };
+    partitions_scan(history,disease,region != NULL ? NULL : country,date_from,date_to,(PartitionsVisitFunc)history_visit,&scan);
+    return scan.matches;
+}
+
+static List get_records(String disease, String country, Date date_from, Date date_to){
+    List list = list_create(NULL);
+    scan_records(disease,country,date_from,date_to,list,true);
+    if(history == NULL)
+        return list;
+
+    // Στο history mode η λίστα περιέχει αντίγραφα όλων των εγγραφών, που ανήκουν σε αυτή (τα αποδεσμεύει
+    // η list_destroy), ώστε να ισχύουν όσο και η λίστα ανεξάρτητα από τις επόμενες κλήσεις
+    List copies = list_create(free);
+    for(ListNode node = list_first(list); node != LIST_EOF; node = list_next(list,node))
+        list_insert_next(copies,LIST_EOF,record_copy(list_node_value(list,node)));
+    list_destroy(list);
+
+    history_scan(disease,country,date_from,date_to,copies);
+    return copies;
+}
+
+static int count_records(String disease, String country, Date date_from, Date date_to){
+    int count = scan_records(disease,country,date_from,date_to,NULL,true);
+    if(history != NULL)
+        count += history_scan(disease,country,date_from,date_to,NULL);
+    return count;
+}
+
+// Ένα query της dm_count_records_batch, εκτελείται ως εργασία του thread pool
+struct count_task {
+    DMQuery query;
+    int* result;
+};
+
+static void count_task(struct count_task* task){
+    DMQuery q = task->query;
+    *task->result = scan_records(q->disease,q->country,q->date_from,q->date_to,NULL,false);
+}
+
+static void count_records_batch(struct dm_query queries[], int n, int results[]){
+    // Με ένα thread (ή ένα query) κάθε query μπορεί να χρησιμοποιήσει το ίδιο την παράλληλη διάσχιση
+    if(threads == 1 || n == 1){
+        for(int i = 0; i < n; i++)
+            results[i] = count_records(queries[i].disease,queries[i].country,queries[i].date_from,queries[i].date_to);
+        return;
+    }
+
+    if(pool == NULL)
+        pool = pool_create(threads);
+
+    struct count_task* tasks = malloc(n * sizeof(*tasks));
+    Pointer* args = malloc(n * sizeof(*args));
+    for(int i = 0; i < n; i++){
+        tasks[i] = (struct count_task){ .query = &queries[i], .result = &results[i] };
+        args[i] = &tasks[i];
+    }
+
+    pool_run(pool,(TaskFunc)count_task,args,n);
+
+    // Τα partitions του ιστορικού δεν μπορούν να εξεταστούν από πολλά threads μαζί
+    if(history != NULL)
+        for(int i = 0; i < n; i++)
+            results[i] += history_scan(queries[i].disease,queries[i].country,queries[i].date_from,queries[i].date_to,NULL);
+
+    free(tasks);
+    free(args);
+}
+
+static List top_diseases(int k, String country){
+    List list = list_create(NULL);
+
+    // Χωρίς country χρησιμοποιούμε τους συνολικούς μετρητές των ασθενειών
+    Set set = ranking;
+    Region region = country != NULL ? map_find(regions,country) : NULL;
+    if(region != NULL){
+        set = region->ranking;
+    }
+    else if(country != NULL){
+        Country C = map_find(countries,country);
+        if(C == NULL)
+            return list;
+        set = C->ranking;
+    }
+
+    // Οι μεγαλύτεροι μετρητές είναι στο τέλος του ranking
+    for(SetNode node = set_last(set); node != SET_BOF && list_size(list) < k; node = set_previous(set,node)){
+        TopNode top = set_node_value(set,node);
+        list_insert_next(list,list_last(list),top->disease);
+    }
+    return list;
+}
+
+static List top_countries(int k, String disease){
+    List list = list_create(NULL);
+
+    // Χωρίς disease χρησιμοποιούμε τους συνολικούς μετρητές των χωρών
+    Set set = country_ranking;
+    if(disease != NULL){
+        Disease D = map_find(diseases,disease);
+        if(D == NULL)
+            return list;
+        set = D->countries;
+    }
+
+    for(SetNode node = set_last(set); node != SET_BOF && list_size(list) < k; node = set_previous(set,node)){
+        TopNode top = set_node_value(set,node);
+        list_insert_next(list,list_last(list),top->country);
+    }
+    return list;
+}
+
+// Order statistics /////////////////////////////////////////////////////////////
+//
+// Τα sets κατά ημερομηνία (dates, country->records, disease->records, top->records) δίνουν σε
+// O(log n) τη θέση μιας ημερομηνίας (set_rank) και την εγγραφή μιας θέσης (set_node_at), οπότε
+// οι εγγραφές μέσα σε ένα διάστημα ημερομηνιών είναι ένα συνεχές τμήμα θέσεων του set.
+
+// Οι θέσεις [start, end) των εγγραφών ενός set μέσα στο διάστημα ημερομηνιών, και το τμήμα
+// [lo, hi) αυτών όπου μπορεί ακόμα να βρίσκεται η εγγραφή που αναζητούμε (βλ. select_entry).
+
+struct date_range{
+    Set set;
+    int start, end;
+    int lo, hi;
+    int rank;
+};
+
+// Επιστρέφει το πλήθος των εγγραφών του set με ημερομηνία < date, ή <= date αν inclusive == true
+
+static int date_rank(Set set, Date date, bool inclusive){
+    struct record record = { .date = date };
+    struct entry probe = { .id = inclusive ? INT_MAX : INT_MIN, .record = &record };
+
+    // Το probe είναι μετά (ή πριν) από όλες τις εγγραφές της ημερομηνίας, εκτός από μια με το ίδιο id
+    int rank = set_rank(set,&probe);
+    if(inclusive && set_find_node(set,&probe) != SET_EOF)
+        rank++;
+    return rank;
+}
+
+static void date_range_init(struct date_range* range, Set set, Date date_from, Date date_to){
+    range->set = set;
+    range->start = date_from != NULL ? date_rank(set,date_from,false) : 0;
+    range->end = date_to != NULL ? date_rank(set,date_to,true) : set_size(set);
+    if(range->end < range->start)
+        range->end = range->start;
+    range->lo = range->start;
+    range->hi = range->end;
+}
+
+// Επιστρέφει την k-οστή (0-based) κατά ημερομηνία από τις εγγραφές όλων των ranges[0 .. n-1].
+// Με ένα set είναι απλά η θέση start + k. Με περισσότερα, επιλέγουμε κάθε φορά τη μεσαία εγγραφή
+// του μεγαλύτερου [lo, hi) και μετράμε πόσες εγγραφές όλων των sets είναι πριν από αυτή: ανάλογα
+// με το αν είναι λιγότερες ή περισσότερες από k, απορρίπτονται σε κάθε set οι εγγραφές πριν ή
+// μετά από αυτή. Πολυπλοκότητα O(n log n) για κάθε επανάληψη, και O(n log n) επαναλήψεις.
+
+static Entry select_entry(struct date_range ranges[], int n, int k){
+    if(n == 1)
+        return set_node_value(ranges[0].set,set_node_at(ranges[0].set,ranges[0].start + k));
+
+    while(true){
+        int best = 0;
+        for(int i = 1; i < n; i++)
+            if(ranges[i].hi - ranges[i].lo > ranges[best].hi - ranges[best].lo)
+                best = i;
+
+        int mid = (ranges[best].lo + ranges[best].hi) / 2;
+        Entry entry = set_node_value(ranges[best].set,set_node_at(ranges[best].set,mid));
+
+        int before = 0;
+        for(int i = 0; i < n; i++){
+            int rank = i == best ? mid : set_rank(ranges[i].set,entry);
+            ranges[i].rank = rank < ranges[i].start ? ranges[i].start : rank > ranges[i].end ? ranges[i].end : rank;
+            before += ranges[i].rank - ranges[i].start;
+        }
+
+        if(before == k)
+            return entry;
+
+        for(int i = 0; i < n; i++){
+            if(before < k && ranges[i].lo < ranges[i].rank)
+                ranges[i].lo = ranges[i].rank;
+            else if(before > k && ranges[i].hi > ranges[i].rank)
+                ranges[i].hi = ranges[i].rank;
+        }
+        if(before < k)
+            ranges[best].lo = mid + 1;
+    }
+}
+
+// Αποθηκεύει στο ranges (με χώρο για map_size(countries) + 1 στοιχεία) τα διαστήματα των sets με τις
+// εγγραφές που ικανοποιούν τα κριτήρια της dm_get_records, και επιστρέφει το πλήθος τους. Μόνο μια
+// περιοχή χρειάζεται περισσότερα από ένα set.
+
+static int date_ranges(struct date_range ranges[], String disease, String country, Date date_from, Date date_to){
+    int n = 0;
+
+    Region region = country != NULL ? map_find(regions,country) : NULL;
+    if(region != NULL){
+        Country* members = malloc((map_size(countries) + 1) * sizeof(*members));
+        int m = region_countries(region,members,0);
+        for(int i = 0; i < m; i++){
+            TopNode top = disease != NULL ? map_find(members[i]->tops,disease) : NULL;
+            if(disease == NULL || top != NULL)
+                date_range_init(&ranges[n++],disease != NULL ? top->records : members[i]->records,date_from,date_to);
+        }
+        free(members);
+    }
+    else if(disease != NULL && country != NULL){
+        Country C = map_find(countries,country);
+        TopNode top = C != NULL ? map_find(C->tops,disease) : NULL;
+        if(top != NULL)
+            date_range_init(&ranges[n++],top->records,date_from,date_to);
+    }
+    else if(disease != NULL){
+        Disease Dis = map_find(diseases,disease);
+        if(Dis != NULL)
+            date_range_init(&ranges[n++],Dis->records,date_from,date_to);
+    }
+    else if(country != NULL){
+        Country C = map_find(countries,country);
+        if(C != NULL)
+            date_range_init(&ranges[n++],C->records,date_from,date_to);
+    }
+    else{
+        date_range_init(&ranges[n++],dates,date_from,date_to);
+    }
+    return n;
+}
+
+// Υλοποιεί τη scan_records όταν το country είναι περιοχή. Χωρίς ημερομηνίες το πλήθος προκύπτει
+// απευθείας από τους μετρητές της περιοχής. Αλλιώς, για κάθε χώρα της περιοχής, το διάστημα των
+// εγγραφών της (ή του ζεύγους χώρα, ασθένεια) βρίσκεται με rank, και διασχίζονται μόνο αυτές.
+
+static int scan_region(String disease, Region region, Date date_from, Date date_to, List result){
+    if(result == NULL && date_from == NULL && date_to == NULL){
+        if(disease == NULL)
+            return region->total;
+        TopNode top = map_find(region->tops,disease);
+        return top != NULL ? top->counter : 0;
+    }
+
+    struct date_range* ranges = malloc((map_size(countries) + 1) * sizeof(*ranges));
+    int n = date_ranges(ranges,disease,region->name,date_from,date_to);
+
+    int matches = 0;
+    for(int i = 0; i < n; i++){
+        matches += ranges[i].end - ranges[i].start;
+        if(result == NULL)
+            continue;
+
+        SetNode node = set_node_at(ranges[i].set,ranges[i].start);
+        for(int j = ranges[i].start; j < ranges[i].end; j++, node = set_next(ranges[i].set,node))
+            list_insert_next(result,list_last(result),((Entry)set_node_value(ranges[i].set,node))->record);
+    }
+    free(ranges);
+    return matches;
+}
+
+static Date date_percentile(String disease, String country, Date date_from, Date date_to, double p){
+    if(!(p >= 0 && p <= 100))
+        return NULL;
+
+    struct date_range* ranges = malloc((map_size(countries) + 1) * sizeof(*ranges));
+    int n = date_ranges(ranges,disease,country,date_from,date_to);
+
+    int total = 0;
+    for(int i = 0; i < n; i++)
+        total += ranges[i].end - ranges[i].start;
+
+    // Nearest rank: η εγγραφή στη θέση ceil(p/100 * total) (1-based), η πρώτη για p == 0
+    Date date = NULL;
+    if(total > 0){
+        int k = (int)ceil(p / 100 * total) - 1;
+        date = select_entry(ranges,n,k < 0 ? 0 : k)->record->date;
+    }
+
+    free(ranges);
+    return date;
+}
+
+// Σελιδοποίηση: η εγγραφή στη θέση offset του αποτελέσματος βρίσκεται με τη select_entry, και οι
+// επόμενες με set_next / set_previous σε κάθε set. Με περισσότερα από ένα sets (περιοχή) σε κάθε
+// βήμα επιλέγεται η μικρότερη (ή μεγαλύτερη) από τις τρέχουσες εγγραφές των sets.
+
+static List get_records_page(String disease, String country, Date date_from, Date date_to, bool newest_first, int offset, int limit){
+    List list = list_create(NULL);
+
+    struct date_range* ranges = malloc((map_size(countries) + 1) * sizeof(*ranges));
+    int n = date_ranges(ranges,disease,country,date_from,date_to);
+
+    int total = 0;
+    for(int i = 0; i < n; i++)
+        total += ranges[i].end - ranges[i].start;
+
+    int count = limit >= 0 && limit < total - offset ? limit : total - offset;
+    if(offset < 0 || count <= 0){
+        free(ranges);
+        return list;
+    }
+
+    // Η πρώτη εγγραφή της σελίδας, και σε κάθε set η πρώτη του εγγραφή που ανήκει στη σελίδα: η πρώτη
+    // που δεν είναι πριν από το first (για newest_first η τελευταία που δεν είναι μετά από αυτό).
+    // Το ranges[i].rank είναι η θέση του nodes[i] στο set, SET_EOF αν το set δεν έχει άλλες εγγραφές.
+    Entry first = select_entry(ranges,n,newest_first ? total - 1 - offset : offset);
+    SetNode* nodes = malloc(n * sizeof(*nodes));
+    for(int i = 0; i < n; i++){
+        int rank = set_rank(ranges[i].set,first);
+        if(newest_first && set_find_node(ranges[i].set,first) == SET_EOF)
+            rank--;
+        ranges[i].rank = rank;
+        nodes[i] = rank >= ranges[i].start && rank < ranges[i].end ? set_node_at(ranges[i].set,rank) : SET_EOF;
+    }
+
+    for(int j = 0; j < count; j++){
+        int best = -1;
+        for(int i = 0; i < n; i++){
+            if(nodes[i] == SET_EOF)
+                continue;
+            int cmp = best < 0 ? 0 : compare_date(set_node_value(ranges[i].set,nodes[i]),set_node_value(ranges[best].set,nodes[best]));
+            if(best < 0 || (newest_first ? cmp > 0 : cmp < 0))
+                best = i;
+        }
+
+        Entry entry = set_node_value(ranges[best].set,nodes[best]);
+        list_insert_next(list,list_last(list),entry->record);
+
+        ranges[best].rank += newest_first ? -1 : 1;
+        if(ranges[best].rank < ranges[best].start || ranges[best].rank >= ranges[best].end)
+            nodes[best] = SET_EOF;
+        else
+            nodes[best] = newest_first ? set_previous(ranges[best].set,nodes[best]) : set_next(ranges[best].set,nodes[best]);
+    }
+
+    free(nodes);
+    free(ranges);
+    return list;
+}
+
+// Δειγματοληψία: επιλέγονται k διαφορετικές θέσεις από τις total με τον αλγόριθμο του Floyd (k
+// επαναλήψεις, χωρίς να δημιουργηθεί ποτέ πίνακας με όλες τις θέσεις), και για καθεμία η εγγραφή
+// της μέσω της select_entry.
+
+// xorshift64*, η κατάσταση δεν πρέπει να είναι 0
+static uint64_t next_random(uint64_t* state){
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static List sample_records(int k, String disease, String country, Date date_from, Date date_to, uint64_t seed){
+    List list = list_create(NULL);
+
+    struct date_range* ranges = malloc((map_size(countries) + 1) * sizeof(*ranges));
+    int n = date_ranges(ranges,disease,country,date_from,date_to);
+
+    int total = 0;
+    for(int i = 0; i < n; i++)
+        total += ranges[i].end - ranges[i].start;
+    if(k > total)
+        k = total;
+    if(k <= 0){
+        free(ranges);
+        return list;
+    }
+
+    // Για κάθε j = total-k .. total-1 επιλέγεται τυχαία μια θέση t <= j, ή η j αν η t έχει ήδη επιλεγεί
+    // Υπάρχει ακριβώς ένα seed για το οποίο η κατάσταση βγαίνει 0, οπότε τότε παίρνει μια σταθερή μη μηδενική τιμή
+    uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+    if(state == 0)
+        state = 0x2545F4914F6CDD1DULL;
+    int* positions = malloc(k * sizeof(int));
+    Set chosen = set_create(compare_ids,NULL);
+    for(int j = total - k, i = 0; j < total; j++, i++){
+        positions[i] = (int)(next_random(&state) % (uint64_t)(j + 1));
+        if(set_find_node(chosen,&positions[i]) != SET_EOF)
+            positions[i] = j;
+        set_insert(chosen,&positions[i]);
+    }
+
+    // Οι θέσεις του chosen είναι ταξινομημένες, οπότε και οι εγγραφές κατά ημερομηνία
+    for(SetNode node = set_first(chosen); node != SET_EOF; node = set_next(chosen,node)){
+        for(int i = 0; i < n; i++){
+            ranges[i].lo = ranges[i].start;
+            ranges[i].hi = ranges[i].end;
+        }
+        Entry entry = select_entry(ranges,n,*(int*)set_node_value(chosen,node));
+        list_insert_next(list,list_last(list),entry->record);
+    }
+
+    set_destroy(chosen);
+    free(positions);
+    free(ranges);
+    return list;
+}
+
+// Group by /////////////////////////////////////////////////////////////////////
+//
+// Το πλήθος των εγγραφών κάθε ομάδας μέσα στο διάστημα ημερομηνιών είναι το μήκος ενός
+// date_range στο set της ομάδας (top->records, country->records ή disease->records), οπότε
+// κάθε ομάδα κοστίζει O(log n) ανεξάρτητα από το πλήθος των εγγραφών της.
+
+static int range_count(Set set, Date date_from, Date date_to){
+    struct date_range range;
+    date_range_init(&range,set,date_from,date_to);
+    return range.end - range.start;
+}
+
+static int compare_groups(const void* a, const void* b){
+    return strcmp(((DMGroupCount)a)->key,((DMGroupCount)b)->key);
+}
+
+// Προσθέτει την ομάδα key στο groups, αν έχει εγγραφές
+
+static void group_add(DMGroupCount groups, int* n, String key, int count){
+    if(count > 0)
+        groups[(*n)++] = (struct dm_group_count){ .key = key, .count = count };
+}
+
+static DMGroupCount count_by_country(String disease, Date date_from, Date date_to, int* n){
+    *n = 0;
+    DMGroupCount groups = malloc((map_size(countries) + 1) * sizeof(*groups));
+
+    if(disease == NULL){
+        for(MapNode node = map_first(countries); node != MAP_EOF; node = map_next(countries,node)){
+            Country C = map_node_value(countries,node);
+            group_add(groups,n,C->name,range_count(C->records,date_from,date_to));
+        }
+    }
+    else{
+        // Οι μετρητές (χώρα, ασθένεια) της ασθένειας, με τις εγγραφές τους κατά ημερομηνία
+        Disease D = map_find(diseases,disease);
+        Set set = D != NULL ? D->countries : NULL;
+        for(SetNode node = set != NULL ? set_first(set) : SET_EOF; node != SET_EOF; node = set_next(set,node)){
+            TopNode top = set_node_value(set,node);
+            group_add(groups,n,top->country,range_count(top->records,date_from,date_to));
+        }
+    }
+
+    qsort(groups,*n,sizeof(*groups),compare_groups);
+    return groups;
+}
+
+static DMGroupCount count_by_disease(String country, Date date_from, Date date_to, int* n){
+    *n = 0;
+    DMGroupCount groups = malloc((map_size(diseases) + 1) * sizeof(*groups));
+
+    Region region = country != NULL ? map_find(regions,country) : NULL;
+    if(region != NULL){
+        // Οι μετρητές των χωρών της περιοχής αθροίζονται ανά ασθένεια (disease => DMGroupCount)
+        Map sums = map_create((CompareFunc)compare_strings,NULL,NULL);
+        map_set_hash_function(sums,hash_string);
+
+        Country* members = malloc((map_size(countries) + 1) * sizeof(*members));
+        int m = region_countries(region,members,0);
+        for(int i = 0; i < m; i++){
+            Country C = members[i];
+            for(MapNode t = map_first(C->tops); t != MAP_EOF; t = map_next(C->tops,t)){
+                TopNode top = map_node_value(C->tops,t);
+                int count = range_count(top->records,date_from,date_to);
+                if(count == 0)
+                    continue;
+
+                DMGroupCount group = map_find(sums,top->disease);
+                if(group == NULL){
+                    group = &groups[(*n)++];
+                    *group = (struct dm_group_count){ .key = top->disease, .count = 0 };
+                    map_insert(sums,group->key,group);
+                }
+                group->count += count;
+            }
+        }
+        free(members);
+        map_destroy(sums);
+    }
+    else if(country != NULL){
+        Country C = map_find(countries,country);
+        Map tops = C != NULL ? C->tops : NULL;
+        for(MapNode t = tops != NULL ? map_first(tops) : MAP_EOF; t != MAP_EOF; t = map_next(tops,t)){
+            TopNode top = map_node_value(tops,t);
+            group_add(groups,n,top->disease,range_count(top->records,date_from,date_to));
+        }
+    }
+    else{
+        for(MapNode node = map_first(diseases); node != MAP_EOF; node = map_next(diseases,node)){
+            Disease D = map_node_value(diseases,node);
+            group_add(groups,n,D->name,range_count(D->records,date_from,date_to));
+        }
+    }
+
+    qsort(groups,*n,sizeof(*groups),compare_groups);
+    return groups;
+}
+
+static List find_by_name_prefix(String prefix, int limit){
+    List entries = trie_find_prefix(names,prefix,limit);
+
+    List list = list_create(NULL);
+    for(ListNode node = list_first(entries); node != LIST_EOF; node = list_next(entries,node))
+        list_insert_next(list,list_last(list),((Entry)list_node_value(entries,node))->record);
+
+    list_destroy(entries);
+    return list;
+}
+
+// Καταστρέφει τα indexes της εγγραφής που έμειναν κενά μετά την αφαίρεσή της από αυτά: τον
+// μετρητή top, τη χώρα country και την ασθένεια disease (μέσω της destroy_value των maps).
+
+static void destroy_empty_indexes(Country country, Disease disease, TopNode top){
+    if(top->counter == 0)
+        map_remove(country->tops,top->disease);
+    if(set_size(country->records) == 0)
+        map_remove(countries,country->name);
+    if(set_size(disease->records) == 0)
+        map_remove(diseases,disease->name);
+}
+
+// Ανίχνευση εξάρσεων ///////////////////////////////////////////////////////////
+
+// Περνάει την εγγραφή record στον detector του μετρητή top (χώρα, ασθένεια), δημιουργώντας τον
+// αν χρειάζεται, και καλεί το callback αν η ημέρα της εγγραφής μόλις έγινε έξαρση.
+
+static void outbreak_check(Record record, TopNode top){
+    if(top->detector == NULL){
+        top->detector = outbreak_create();
+        detectors++;
+    }
+
+    struct outbreak_params params = {
+        .alpha = outbreak_config.alpha, .threshold = outbreak_config.threshold,
+        .min_count = outbreak_config.min_count, .warmup = outbreak_config.warmup,
+    };
+    OutbreakDetector detector = top->detector;
+    if(!outbreak_add(detector,outbreak_day(record->date),&params))
+        return;
+
+    struct dm_outbreak outbreak = {
+        .disease = record->disease, .country = record->country, .date = record->date,
+        .count = detector->count, .mean = detector->mean, .deviation = outbreak_deviation(detector),
+    };
+    outbreak_config.callback(&outbreak,outbreak_config.context);
+}
+
+// Καταστρέφει όλους τους detectors, ώστε η ανίχνευση να ξεκινήσει από την αρχή
+
+static void outbreak_reset(){
+    if(disease_monitor == NULL)
+        return;
+
+    for(MapNode node = map_first(countries); node != MAP_EOF; node = map_next(countries,node)){
+        Map tops = ((Country)map_node_value(countries,node))->tops;
+        for(MapNode t = map_first(tops); t != MAP_EOF; t = map_next(tops,t)){
+            TopNode top = map_node_value(tops,t);
+            if(top->detector != NULL){
+                outbreak_destroy(top->detector);
+                top->detector = NULL;
+                detectors--;
+            }
+        }
+    }
+}
+
+static void set_outbreak_detection(DMOutbreakConfig config){
+    outbreak_reset();
+    outbreak_enabled = config != NULL && config->callback != NULL;
+    if(outbreak_enabled)
+        outbreak_config = *config;
+}
+
+static bool remove_record(int id);
+
+// Προσθέτει στα indexes την εγγραφή record, η οποία ανήκει στα country, disease και top
+// (και δεν υπάρχει άλλη εγγραφή με το ίδιο id).
+
+static void insert_entry(Record record, Country country, Disease disease, TopNode top){
+    Entry entry = malloc(sizeof(*entry));
+    entry->id = record->id;
+    entry->record = record;
+    entry->country = country;
+    entry->disease = disease;
+    entry->top = top;
+
+    pair_update(country,disease,top,1);
+    top_update(ranking,&entry->disease->total,1);
+    regions_update(country,disease->name,1);
+
+    entry->monitor_node = set_insert_node(disease_monitor,entry);
+    entry->country_node = set_insert_node(entry->country->records,entry);
+    entry->disease_node = set_insert_node(entry->disease->records,entry);
+    entry->top_node = set_insert_node(top_records(top),entry);
+    entry->date_node = set_insert_node(dates,entry);
+    map_insert(ids,&entry->id,entry);
+    trie_insert(names,record->name,entry);
+    if(versions != NULL)
+        vset_insert(versions,record);
+
+    if(outbreak_enabled)
+        outbreak_check(record,top);
+    notify(record,DM_RECORD_INSERTED);
+}
+
+static bool insert_record(Record record){
+    // Στο owned mode αποθηκεύουμε αντίγραφο. Το αντίγραφο γίνεται πριν το remove,
+    // γιατί το record μπορεί να είναι η ίδια η εγγραφή που αντικαθίσταται.
+    if(arena != NULL)
+        record = arena_copy(arena,record);
+
+    // Η παλιά εγγραφή με το ίδιο id αφαιρείται από όλα τα indexes, αφού τα πεδία της
+    // μπορεί να διαφέρουν από αυτά της νέας.
+    bool replaced = remove_record(record->id);
+
+    Country country = country_get(record->country);
+    Disease disease = disease_get(record->disease);
+    insert_entry(record,country,disease,pair_get(country,disease));
+
+    return replaced;
+}
+
+static int insert_records(Record records[], int n, bool replaced[]){
+    int replaced_no = 0;
+
+    // Σε ένα bulk load διαδοχικές εγγραφές έχουν συνήθως την ίδια χώρα / ασθένεια, οπότε
+    // κρατάμε τα indexes της προηγούμενης και τα αναζητούμε μόνο όταν αλλάξουν.
+    Country country = NULL;
+    Disease disease = NULL;
+    TopNode top = NULL;
+
+    for(int i = 0; i < n; i++){
+        Record record = arena != NULL ? arena_copy(arena,records[i]) : records[i];
+
+        bool r = remove_record(record->id);
+        if(replaced != NULL)
+            replaced[i] = r;
+        if(r){
+            // Η αφαίρεση μπορεί να κατέστρεψε τα indexes που έμειναν κενά
+            replaced_no++;
+            country = NULL;
+            disease = NULL;
+        }
+
+        if(country == NULL || strcmp(country->name,record->country) != 0){
+            country = country_get(record->country);
+            top = NULL;
+        }
+        if(disease == NULL || strcmp(disease->name,record->disease) != 0){
+            disease = disease_get(record->disease);
+            top = NULL;
+        }
+        if(top == NULL)
+            top = pair_get(country,disease);
+
+        insert_entry(record,country,disease,top);
+    }
+    return replaced_no;
+}
+
+// Αφαιρεί το entry από όλα τα indexes. Αν archived == true η εγγραφή μεταφέρθηκε στο ιστορικό (βλ.
+// dm_set_history), οπότε δεν έχει αφαιρεθεί από τον monitor και τα subscriptions δεν ειδοποιούνται.
+
+static void remove_entry(Entry entry, bool archived){
+    Country country = entry->country;
+    Disease disease = entry->disease;
+
+    set_remove_node(disease_monitor,entry->monitor_node);
+    set_remove_node(country->records,entry->country_node);
+    set_remove_node(disease->records,entry->disease_node);
+    set_remove_node(entry->top->records,entry->top_node);
+    set_remove_node(dates,entry->date_node);
+
+    pair_update(country,disease,entry->top,-1);
+    top_update(ranking,&disease->total,-1);
+    regions_update(country,disease->name,-1);
+
+    destroy_empty_indexes(country,disease,entry->top);
+    trie_remove(names,entry->record->name,entry);
+    if(!archived)
+        notify(entry->record,DM_RECORD_REMOVED);
+
+    // Στο mvcc mode το record αποδεσμεύεται από το versions, όταν δεν το βλέπει κανένα snapshot
+    if(versions != NULL)
+        vset_remove(versions,entry->record);
+    else if(arena != NULL)
+        arena_release(arena,entry->record);
+
+    int id = entry->id;
+    map_remove(ids,&id);        // κάνει free το entry
+}
+
+static bool notify_archived(Record record, Archived a){
+    if(record->id != a->id)
+        return true;
+
+    notify(record,DM_RECORD_REMOVED);
+    return false;
+}
+
+// Αφαιρεί την εγγραφή id του ιστορικού: το αντίγραφό της μένει στα partitions, αλλά δεν ισχύει πλέον.
+// Ο μήνας της φορτώνεται μόνο αν υπάρχουν subscriptions, για να ειδοποιηθούν. Επιστρέφει false αν
+// δεν υπάρχει τέτοια εγγραφή.
+
+static bool unarchive(int id){
+    Archived a = map_find(archived,&id);
+    if(a == NULL)
+        return false;
+
+    if(map_size(channels) > 0)
+        partitions_scan(history,NULL,NULL,a->date,a->date,(PartitionsVisitFunc)notify_archived,a);
+    map_remove(archived,&id);       // κάνει free το a
+    return true;
+}
+
+static bool remove_record(int id){
+    Entry entry = map_find(ids,&id);
+    if(entry == NULL)
+        return history != NULL && unarchive(id);
+
+    remove_entry(entry,false);
+    return true;
+}
+
+static bool update_record(int id, Record record){
+    Entry entry = map_find(ids,&id);
+
+    // Μια εγγραφή του ιστορικού δεν έχει entry, οπότε αλλάζει με remove + insert
+    if(entry == NULL){
+        if(!remove_record(id))
+            return false;
+        insert_record(record);
+        return true;
+    }
+
+    // Αλλαγή του id σημαίνει αλλαγή σε όλα τα indexes, οπότε δεν κερδίζουμε κάτι σε σχέση με remove + insert
+    if(record->id != id){
+        remove_record(id);
+        insert_record(record);
+        return true;
+    }
+
+    if(arena != NULL)
+        record = arena_copy(arena,record);
+
+    Record old = entry->record;
+    Country old_country = entry->country;
+    Disease old_disease = entry->disease;
+    TopNode old_top = entry->top;
+
+    bool disease_changed = strcmp(old->disease,record->disease) != 0;
+    bool country_changed = strcmp(old->country,record->country) != 0;
+    bool date_changed = strcmp(old->date,record->date) != 0;
+    bool name_changed = strcmp(old->name,record->name) != 0;
+
+    // Η διάταξη κάθε index εξαρτάται από συγκεκριμένα πεδία. Το entry μετακινείται μόνο στα indexes
+    // όπου άλλαξε κάποιο από αυτά, στα υπόλοιπα απλά αλλάζει το entry->record.
+    bool move_monitor = disease_changed || country_changed || name_changed;
+    bool move_country = country_changed || date_changed;
+    bool move_disease = disease_changed || date_changed;
+    bool move_top = country_changed || disease_changed || date_changed;
+
+    if(move_monitor)
+        set_remove_node(disease_monitor,entry->monitor_node);
+    if(move_country)
+        set_remove_node(old_country->records,entry->country_node);
+    if(move_disease)
+        set_remove_node(old_disease->records,entry->disease_node);
+    if(move_top)
+        set_remove_node(old_top->records,entry->top_node);
+    if(date_changed)
+        set_remove_node(dates,entry->date_node);
+
+    entry->record = record;
+    if(country_changed)
+        entry->country = country_get(record->country);
+    if(disease_changed)
+        entry->disease = disease_get(record->disease);
+
+    if(name_changed){
+        trie_remove(names,old->name,entry);
+        trie_insert(names,record->name,entry);
+    }
+
+    if(move_monitor)
+        entry->monitor_node = set_insert_node(disease_monitor,entry);
+    if(move_country)
+        entry->country_node = set_insert_node(entry->country->records,entry);
+    if(move_disease)
+        entry->disease_node = set_insert_node(entry->disease->records,entry);
+
+    // Μετρητές: ο (country, disease) αλλάζει αν άλλαξε οποιοδήποτε από τα δύο, ο συνολικός μόνο με την ασθένεια
+    if(country_changed || disease_changed){
+        entry->top = pair_get(entry->country,entry->disease);
+        entry->top_node = set_insert_node(top_records(entry->top),entry);
+        pair_update(entry->country,entry->disease,entry->top,1);
+        pair_update(old_country,old_disease,old_top,-1);
+        regions_update(entry->country,entry->disease->name,1);
+        regions_update(old_country,old_disease->name,-1);
+    }
+    if(disease_changed){
+        top_update(ranking,&entry->disease->total,1);
+        top_update(ranking,&old_disease->total,-1);
+    }
+    if(date_changed){
+        if(!country_changed && !disease_changed)
+            entry->top_node = set_insert_node(entry->top->records,entry);
+        entry->date_node = set_insert_node(dates,entry);
+    }
+
+    destroy_empty_indexes(old_country,old_disease,old_top);
+    notify(old,DM_RECORD_REMOVED);
+    notify(record,DM_RECORD_INSERTED);
+
+    if(versions != NULL){
+        vset_remove(versions,old);
+        vset_insert(versions,record);
+    }
+    else if(arena != NULL)
+        arena_release(arena,old);
+    return true;
+}
+
+// Μεταφέρει την εγγραφή του entry στο ιστορικό και την αφαιρεί από τη μνήμη. Επιστρέφει false (και
+// την αφήνει στη μνήμη) αν το history δεν τη δέχεται.
+
+static bool archive_entry(Entry entry){
+    if(!partitions_insert(history,entry->record))
+        return false;
+
+    Archived a = malloc(sizeof(*a));
+    a->id = entry->id;
+    strcpy(a->date,entry->record->date);
+    map_insert(archived,&a->id,a);
+    remove_entry(entry,true);
+    return true;
+}
+
+// Στέλνει στο δίσκο τους μήνες του ιστορικού που είναι ακόμα στη μνήμη. Πολυπλοκότητα O(μήνες) συν
+// O(εγγραφές) για κάθε μήνα που γράφεται.
+
+static void history_spill(){
+    List months = partitions_months(history);
+    for(ListNode node = list_first(months); node != LIST_EOF; node = list_next(months,node)){
+        String month = list_node_value(months,node);
+        if(!partitions_spilled(history,month))
+            partitions_spill(history,month);
+    }
+    list_destroy(months);
+}
+
+// Καλείται μετά την προσθήκη (ή αλλαγή) του record στο history mode. Αν η πιο πρόσφατη εγγραφή είναι σε
+// νέο μήνα, μεταφέρει στο ιστορικό όλες τις εγγραφές πριν από τους hot_months τελευταίους μήνες (οι
+// οποίες είναι οι πρώτες του dates), αλλιώς μόνο το record αν είναι τόσο παλιό. Οι νέοι μήνες του
+// ιστορικού στέλνονται αμέσως στο δίσκο.
+
+static void history_update(Record record){
+    if(history == NULL || set_size(dates) == 0)
+        return;
+
+    // Οι ημερομηνίες YYYY-MM-DD συγκρίνονται ως strings, οπότε παλιές είναι όσες είναι μικρότερες από το YYYY-MM
+    Record newest = ((Entry)set_node_value(dates,set_last(dates)))->record;
+    int year, month;
+    if(sscanf(newest->date,"%4d-%2d",&year,&month) != 2 || month < 1 || month > 12)
+        return;
+    int first = year * 12 + month - history_months;
+    char cutoff[16];
+    snprintf(cutoff,sizeof(cutoff),"%04d-%02d",first / 12,first % 12 + 1);
+
+    bool archived = false;
+    if(first >= 0 && strcmp(cutoff,history_cutoff) > 0){
+        strcpy(history_cutoff,cutoff);
+
+        // Όσες δεν μεταφέρονται μένουν στην αρχή του dates, οπότε η επόμενη βρίσκεται με τη θέση της
+        int kept = 0;
+        for(SetNode node = set_first(dates); node != SET_EOF; node = set_node_at(dates,kept)){
+            Entry entry = set_node_value(dates,node);
+            if(strcmp(entry->record->date,history_cutoff) >= 0)
+                break;
+            if(archive_entry(entry))
+                archived = true;
+            else
+                kept++;
+        }
+    }
+    else if(record != NULL && strcmp(record->date,history_cutoff) < 0){
+        Entry entry = map_find(ids,&record->id);
+        archived = entry != NULL && archive_entry(entry);
+    }
+
+    if(archived)
+        history_spill();
+}
+
+
+// Public λειτουργίες //////////////////////////////////////////////////////////
+//
+// Οι υλοποιήσεις καλούν η μία την άλλη (πχ η insert_record την remove_record), οπότε
+// χρονομετρούμε και καταγράφουμε στο trace μόνο εδώ, ώστε κάθε κλήση του χρήστη να
+// μετράει μία φορά.
+//
+// Στο history mode τα queries που απαντούν μόνο από τα indexes στη μνήμη αποτυγχάνουν (μετά την
+// καταγραφή τους στο trace), αφού το αποτέλεσμά τους δεν θα περιλάμβανε τις εγγραφές του ιστορικού.
+
+List dm_get_records(String disease, String country, Date date_from, Date date_to){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_GET_RECORDS, .disease = disease, .country = country, .date_from = date_from, .date_to = date_to });
+
+    STATS_TIMER_START(start);
+    List list = get_records(disease,country,date_from,date_to);
+    STATS_TIMER_STOP(STAT_OP_GET_RECORDS,start);
+    return list;
+}
+
+int dm_count_records(String disease, String country, Date date_from, Date date_to){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_COUNT_RECORDS, .disease = disease, .country = country, .date_from = date_from, .date_to = date_to });
+
+    STATS_TIMER_START(start);
+    int count = count_records(disease,country,date_from,date_to);
+    STATS_TIMER_STOP(STAT_OP_COUNT_RECORDS,start);
+    return count;
+}
+
+List dm_top_diseases(int k, String country){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_TOP_DISEASES, .k = k, .country = country });
+
+    if(history != NULL)
+        return NULL;
+
+    STATS_TIMER_START(start);
+    List list = top_diseases(k,country);
+    STATS_TIMER_STOP(STAT_OP_TOP_DISEASES,start);
+    return list;
+}
+
+DMGroupCount dm_count_by_country(String disease, Date date_from, Date date_to, int* n){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_COUNT_BY_COUNTRY, .disease = disease, .date_from = date_from, .date_to = date_to });
+
+    if(history != NULL){
+        *n = 0;
+        return NULL;
+    }
+
+    STATS_TIMER_START(start);
+    DMGroupCount groups = count_by_country(disease,date_from,date_to,n);
+    STATS_TIMER_STOP(STAT_OP_COUNT_BY_COUNTRY,start);
+    return groups;
+}
+
+DMGroupCount dm_count_by_disease(String country, Date date_from, Date date_to, int* n){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_COUNT_BY_DISEASE, .country = country, .date_from = date_from, .date_to = date_to });
+
+    if(history != NULL){
+        *n = 0;
+        return NULL;
+    }
+
+    STATS_TIMER_START(start);
+    DMGroupCount groups = count_by_disease(country,date_from,date_to,n);
+    STATS_TIMER_STOP(STAT_OP_COUNT_BY_DISEASE,start);
+    return groups;
+}
+
+List dm_get_records_page(String disease, String country, Date date_from, Date date_to, bool newest_first, int offset, int limit){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_GET_RECORDS_PAGE, .disease = disease, .country = country, .date_from = date_from, .date_to = date_to, .newest_first = newest_first, .offset = offset, .limit = limit });
+
+    if(history != NULL)
+        return NULL;
+
+    STATS_TIMER_START(start);
+    List list = get_records_page(disease,country,date_from,date_to,newest_first,offset,limit);
+    STATS_TIMER_STOP(STAT_OP_GET_RECORDS_PAGE,start);
+    return list;
+}
+
+List dm_sample_records(int k, String disease, String country, Date date_from, Date date_to, uint64_t seed){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_SAMPLE_RECORDS, .k = k, .disease = disease, .country = country, .date_from = date_from, .date_to = date_to, .seed = seed });
+
+    if(history != NULL)
+        return NULL;
+
+    STATS_TIMER_START(start);
+    List list = sample_records(k,disease,country,date_from,date_to,seed);
+    STATS_TIMER_STOP(STAT_OP_SAMPLE_RECORDS,start);
+    return list;
+}
+
+List dm_top_countries(int k, String disease){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_TOP_COUNTRIES, .k = k, .disease = disease });
+
+    if(history != NULL)
+        return NULL;
+
+    STATS_TIMER_START(start);
+    List list = top_countries(k,disease);
+    STATS_TIMER_STOP(STAT_OP_TOP_COUNTRIES,start);
+    return list;
+}
+
+List dm_find_by_name_prefix(String prefix, int limit){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_FIND_BY_NAME_PREFIX, .prefix = prefix, .limit = limit });
+
+    if(history != NULL)
+        return NULL;
+
+    STATS_TIMER_START(start);
+    List list = find_by_name_prefix(prefix,limit);
+    STATS_TIMER_STOP(STAT_OP_FIND_BY_NAME,start);
+    return list;
+}
+
+Date dm_date_percentile(String disease, String country, Date date_from, Date date_to, double p){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_DATE_PERCENTILE, .disease = disease, .country = country, .date_from = date_from, .date_to = date_to, .p = p });
+
+    if(history != NULL)
+        return NULL;
+
+    STATS_TIMER_START(start);
+    Date date = date_percentile(disease,country,date_from,date_to,p);
+    STATS_TIMER_STOP(STAT_OP_DATE_PERCENTILE,start);
+    return date;
+}
+
+bool dm_insert_record(Record record){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_INSERT, .record = *record });
+
+    STATS_TIMER_START(start);
+    bool replaced = insert_record(record);
+    history_update(record);
+    STATS_TIMER_STOP(STAT_OP_INSERT,start);
+    return replaced;
+}
+
+int dm_insert_records(Record records[], int n, bool replaced[]){
+    if(trace != NULL)
+        for(int i = 0; i < n; i++)
+            trace_write(trace,&(struct trace_op){ .type = TRACE_INSERT, .record = *records[i] });
+
+    STATS_TIMER_START(start);
+    int replaced_no = insert_records(records,n,replaced);
+    if(history != NULL)
+        for(int i = 0; i < n; i++)
+            history_update(records[i]);
+    STATS_TIMER_STOP(STAT_OP_INSERT_BATCH,start);
+    return replaced_no;
+}
+
+void dm_count_records_batch(struct dm_query queries[], int n, int results[]){
+    if(trace != NULL)
+        for(int i = 0; i < n; i++)
+            trace_write(trace,&(struct trace_op){ .type = TRACE_COUNT_RECORDS, .disease = queries[i].disease, .country = queries[i].country, .date_from = queries[i].date_from, .date_to = queries[i].date_to });
+
+    STATS_TIMER_START(start);
+    count_records_batch(queries,n,results);
+    STATS_TIMER_STOP(STAT_OP_COUNT_BATCH,start);
+}
+
+bool dm_remove_record(int id){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_REMOVE, .id = id });
+
+    STATS_TIMER_START(start);
+    bool removed = remove_record(id);
+    STATS_TIMER_STOP(STAT_OP_REMOVE,start);
+    return removed;
+}
+
+bool dm_update_record(int id, Record record){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_UPDATE, .id = id, .record = *record });
+
+    STATS_TIMER_START(start);
+    bool updated = update_record(id,record);
+    if(updated)
+        history_update(record);
+    STATS_TIMER_STOP(STAT_OP_UPDATE,start);
+    return updated;
+}
+
+
+void dm_set_outbreak_detection(DMOutbreakConfig config){
+    set_outbreak_detection(config);
+}
+
+int dm_subscribe(String disease, String country, DMSubscriptionFunc callback, Pointer context){
+    return subscribe(disease,country,callback,context);
+}
+
+bool dm_unsubscribe(int id){
+    return unsubscribe(id);
+}
+
+bool dm_set_region(String country, String region, String continent){
+    if(trace != NULL)
+        trace_write(trace,&(struct trace_op){ .type = TRACE_SET_REGION, .country = country, .region = region, .continent = continent });
+
+    return set_region(country,region,continent);
+}
+
+bool dm_load_regions(String path){
+    return load_regions(path);
+}
+
+
+// Snapshots ///////////////////////////////////////////////////////////////////
+
+struct dm_snapshot {
+    VSetSnapshot version;
+};
+
+// Τα κριτήρια και το αποτέλεσμα ενός query σε snapshot
+struct snapshot_query {
+    String disease;
+    String country;
+    Date date_from;
+    Date date_to;
+    List result;        // NULL αν χρειαζόμαστε μόνο το πλήθος
+    int matches;
+};
+
+// Οι εγγραφές είναι ταξινομημένες κατά disease και country, οπότε με disease != NULL η διάσχιση
+// περιορίζεται στο αντίστοιχο διάστημα
+
+static int snapshot_range(Record record, struct snapshot_query* query){
+    if(query->disease == NULL)
+        return 0;
+
+    int res = strcmp(record->disease,query->disease);
+    if(res != 0 || query->country == NULL)
+        return res;
+    return strcmp(record->country,query->country);
+}
+
+static bool snapshot_visit(Record record, struct snapshot_query* query){
+    if(query->disease == NULL && query->country != NULL && strcmp(record->country,query->country) != 0)
+        return true;
+    if((query->date_from != NULL && strcmp(record->date,query->date_from) < 0) || (query->date_to != NULL && strcmp(record->date,query->date_to) > 0))
+        return true;
+
+    query->matches++;
+    if(query->result != NULL)
+        list_insert_next(query->result,list_last(query->result),record);
+    return true;
+}
+
+static int snapshot_scan(DMSnapshot snapshot, String disease, String country, Date date_from, Date date_to, List result){
+    struct snapshot_query query = { .disease = disease, .country = country, .date_from = date_from, .date_to = date_to, .result = result, .matches = 0 };
+
+    // Χωρίς κανένα κριτήριο το πλήθος είναι γνωστό
+    if(result == NULL && disease == NULL && country == NULL && date_from == NULL && date_to == NULL)
+        return vset_snapshot_size(snapshot->version);
+
+    vset_visit(snapshot->version,(VSetRangeFunc)snapshot_range,(VSetVisitFunc)snapshot_visit,&query);
+    return query.matches;
+}
+
+DMSnapshot dm_snapshot_open(){
+    if(versions == NULL || history != NULL)
+        return NULL;
+
+    DMSnapshot snapshot = malloc(sizeof(*snapshot));
+    snapshot->version = vset_snapshot(versions);
+    return snapshot;
+}
+
+List dm_snapshot_get_records(DMSnapshot snapshot, String disease, String country, Date date_from, Date date_to){
+    List list = list_create(NULL);
+    snapshot_scan(snapshot,disease,country,date_from,date_to,list);
+    return list;
+}
+
+int dm_snapshot_count_records(DMSnapshot snapshot, String disease, String country, Date date_from, Date date_to){
+    return snapshot_scan(snapshot,disease,country,date_from,date_to,NULL);
+}
+
+void dm_snapshot_release(DMSnapshot snapshot){
+    vset_release(versions,snapshot->version);
+    free(snapshot);
+}
+
+
+// Trace ///////////////////////////////////////////////////////////////////////
+
+bool dm_trace_start(String path){
+    dm_trace_stop();
+    trace = trace_writer_create(path);
+    return trace != NULL;
+}
+
+bool dm_trace_stop(){
+    if(trace == NULL)
+        return false;
+
+    bool ok = trace_writer_destroy(trace);
+    trace = NULL;
+    return ok;
+}
+
+
+// Checkpoints ////////////////////////////////////////////////////////////////
+
+// Το αποτέλεσμα που στέλνει το child στον parent μέσω του checkpoint_pipe
+
+struct checkpoint_result{
+    bool ok;
+    int records;
+    uint64_t bytes;
+    uint64_t duration;
+};
+
+// Γράφει την ιεραρχία των περιοχών ως κλήσεις της dm_set_region. Η dm_set_region ορίζει τη γονική
+// περιοχή μόνο μαζί με μια χώρα, οπότε για κάθε περιοχή με γονική χρησιμοποιείται (προσωρινά) μια από
+// τις χώρες της, και μετά κάθε χώρα τοποθετείται στην περιοχή της. Οι περιοχές χωρίς καμία χώρα δεν
+// αφορούν κανένα query, και παραλείπονται.
+
+static void checkpoint_regions(TraceWriter writer){
+    for(MapNode node = map_first(regions); node != MAP_EOF; node = map_next(regions,node)){
+        Region region = map_node_value(regions,node);
+        if(region->parent == NULL)
+            continue;
+
+        for(MapNode cnode = map_first(country_regions); cnode != MAP_EOF; cnode = map_next(country_regions,cnode)){
+            if(region_contains(region,map_node_value(country_regions,cnode))){
+                trace_write(writer,&(struct trace_op){ .type = TRACE_SET_REGION, .country = map_node_key(country_regions,cnode), .region = region->name, .continent = region->parent->name });
+                break;
+            }
+        }
+    }
+
+    for(MapNode node = map_first(country_regions); node != MAP_EOF; node = map_next(country_regions,node)){
+        Region region = map_node_value(country_regions,node);
+        trace_write(writer,&(struct trace_op){ .type = TRACE_SET_REGION, .country = map_node_key(country_regions,node), .region = region->name });
+    }
+}
+
+// Γράφει στο checkpoint μια εγγραφή του ιστορικού
+
+static bool checkpoint_record(Record record, TraceWriter writer){
+    if(history_live(record))
+        trace_write(writer,&(struct trace_op){ .type = TRACE_INSERT, .record = *record });
+    return true;
+}
+
+// Εκτελείται στο child: γράφει την ιεραρχία των περιοχών και όλες τις εγγραφές κατά ημερομηνία στο path.tmp, το μετονομάζει σε path
+// και στέλνει το αποτέλεσμα στο fd. Το start είναι η στιγμή της dm_checkpoint_async. Επιστρέφει true
+// αν όλα αυτά πέτυχαν.
+
+static bool checkpoint_write(String path, uint64_t start, int fd){
+    struct checkpoint_result result = { .ok = false, .records = 0, .bytes = 0 };
+    String temp = malloc(strlen(path) + 5);
+    sprintf(temp,"%s.tmp",path);
+
+    TraceWriter writer = trace_writer_create(temp);
+    if(writer != NULL){
+        checkpoint_regions(writer);
+        if(history != NULL){
+            partitions_scan(history,NULL,NULL,NULL,NULL,(PartitionsVisitFunc)checkpoint_record,writer);
+            result.records += map_size(archived);
+        }
+        for(SetNode node = set_first(dates); node != SET_EOF; node = set_next(dates,node)){
+            Entry entry = set_node_value(dates,node);
+            trace_write(writer,&(struct trace_op){ .type = TRACE_INSERT, .record = *entry->record });
+            result.records++;
+        }
+        // Το αρχείο μετονομάζεται μόνο αν γράφτηκε ολόκληρο και έφτασε στο δίσκο (fsync), ώστε ένα
+        // checkpoint στο path να είναι πάντα πλήρες
+        bool written = trace_writer_destroy(writer);
+        int file = written ? open(temp,O_RDONLY) : -1;
+        written = file >= 0 && fsync(file) == 0;
+        if(file >= 0)
+            close(file);
+
+        struct stat st;
+        result.ok = written && stat(temp,&st) == 0 && rename(temp,path) == 0;
+        if(result.ok)
+            result.bytes = st.st_size;
+        else
+            remove(temp);
+    }
+    free(temp);
+
+    result.duration = stats_now() - start;
+    return write(fd,&result,sizeof(result)) == sizeof(result) && result.ok;
+}
+
+static bool checkpoint_async(String path){
+    int fds[2];
+    if(checkpoint_pid != 0 || pipe(fds) != 0)
+        return false;
+
+    uint64_t start = stats_now();
+    pid_t pid = fork();
+    if(pid < 0){
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if(pid == 0){
+        // Με _exit, ώστε να μη γραφτούν ξανά τα buffers του stdio (π.χ. του trace) που αντιγράφηκαν
+        close(fds[0]);
+        _exit(checkpoint_write(path,start,fds[1]) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    checkpoint_pid = pid;
+    checkpoint_pipe = fds[0];
+    checkpoint_info = (struct dm_checkpoint){ .state = DM_CHECKPOINT_RUNNING, .pause = stats_now() - start };
+    return true;
+}
+
+bool dm_checkpoint_async(String path){
+    STATS_TIMER_START(start);
+    bool started = checkpoint_async(path);
+    STATS_TIMER_STOP(STAT_OP_CHECKPOINT,start);
+    return started;
+}
+
+DMCheckpointState dm_checkpoint_status(DMCheckpoint checkpoint, bool wait){
+    if(checkpoint_pid != 0){
+        int status = 0;
+        pid_t pid;
+        while((pid = waitpid(checkpoint_pid,&status,wait ? 0 : WNOHANG)) < 0 && errno == EINTR)
+            ;
+
+        // pid < 0 μόνο αν το child έχει ήδη μαζευτεί αλλού, οπότε το pipe έχει κλείσει από τη μεριά του
+        if(pid != 0){
+            struct checkpoint_result result;
+            bool ok = read(checkpoint_pipe,&result,sizeof(result)) == sizeof(result);
+            if(ok){
+                checkpoint_info.records = result.records;
+                checkpoint_info.bytes = result.bytes;
+                checkpoint_info.duration = result.duration;
+            }
+            ok = ok && result.ok && (pid < 0 || (WIFEXITED(status) && WEXITSTATUS(status) == 0));
+            checkpoint_info.state = ok ? DM_CHECKPOINT_DONE : DM_CHECKPOINT_FAILED;
+
+            close(checkpoint_pipe);
+            checkpoint_pipe = -1;
+            checkpoint_pid = 0;
+        }
+    }
+
+    if(checkpoint != NULL)
+        *checkpoint = checkpoint_info;
+    return checkpoint_info.state;
+}
+
+
+// Read replicas //////////////////////////////////////////////////////////////
+
+bool dm_replica_create(String name, size_t capacity){
+    dm_replica_close();
+    replica = replica_writer_create(name,capacity);
+    if(replica != NULL && !dm_replica_publish())
+        dm_replica_close();
+    return replica != NULL;
+}
+
+// Προσθέτει στο *next ένα αντίγραφο της εγγραφής του ιστορικού, αν ισχύει
+
+static bool collect_archived(Record record, Record** next){
+    if(history_live(record))
+        *(*next)++ = record_copy(record);
+    return true;
+}
+
+bool dm_replica_publish(){
+    if(replica == NULL)
+        return false;
+
+    // Οι εγγραφές του ιστορικού (που τα partitions δίνουν κατά ημερομηνία και id) αντιγράφονται, γιατί
+    // στο δίσκο είναι προσωρινές
+    int h = history != NULL ? map_size(archived) : 0;
+    Record* old = malloc((h > 0 ? h : 1) * sizeof(Record));
+    Record* next = old;
+    if(history != NULL)
+        partitions_scan(history,NULL,NULL,NULL,NULL,(PartitionsVisitFunc)collect_archived,&next);
+
+    // Το dates είναι ήδη κατά ημερομηνία και id, όπως τα θέλει η replica_publish, οπότε απλά
+    // συγχωνεύεται με το ιστορικό
+    int m = dates != NULL ? set_size(dates) : 0;
+    Record* records = malloc((h + m > 0 ? h + m : 1) * sizeof(Record));
+    SetNode node = dates != NULL ? set_first(dates) : SET_EOF;
+    int n = 0;
+    for(int i = 0; i < h || node != SET_EOF; ){
+        Entry entry = node != SET_EOF ? set_node_value(dates,node) : NULL;
+        int cmp = i == h ? 1 : entry == NULL ? -1 : strcmp(old[i]->date,entry->record->date);
+        if(cmp < 0 || (cmp == 0 && compare_ids(&old[i]->id,&entry->id) < 0))
+            records[n++] = old[i++];
+        else{
+            records[n++] = entry->record;
+            node = set_next(dates,node);
+        }
+    }
+
+    bool published = replica_publish(replica,records,n);
+    for(int i = 0; i < h; i++)
+        free(old[i]);
+    free(old);
+    free(records);
+    return published;
+}
+
+void dm_replica_close(){
+    if(replica != NULL){
+        replica_writer_destroy(replica);
+        replica = NULL;
+    }
+}
+
+
+// Στατιστικά /////////////////////////////////////////////////////////////////
+
+void dm_stats(DMStats stats){
+    stats->enabled = STATS_ENABLED;
+    stats->records = 0;
+    stats->countries = stats->diseases = stats->pairs = 0;
+
+    if(disease_monitor != NULL){
+        stats->records = set_size(disease_monitor);
+        stats->countries = map_size(countries);
+        stats->diseases = map_size(diseases);
+        for(MapNode node = map_first(countries); node != MAP_EOF; node = map_next(countries,node))
+            stats->pairs += map_size(((Country)map_node_value(countries,node))->tops);
+    }
+
+    for(int i = 0; i < STAT_COUNTERS_NO; i++)
+        stats->counters[i] = __atomic_load_n(&stat_counters[i],__ATOMIC_RELAXED);
+    for(int i = 0; i < STAT_OPS_NO; i++)
+        stats->operations[i] = stat_histograms[i];
+}
+
+void dm_memory_usage(DMMemory memory){
+    *memory = (struct dm_memory){ 0 };
+    if(disease_monitor == NULL)
+        return;
+
+    memory->entries = set_size(disease_monitor) * sizeof(struct entry);
+    memory->ids = map_memory(ids);
+    memory->names = trie_memory(names);
+    memory->monitor = set_memory(disease_monitor);
+    memory->dates = set_memory(dates);
+    memory->ranking = set_memory(ranking) + set_memory(country_ranking);
+
+    memory->countries = map_memory(countries);
+    for(MapNode node = map_first(countries); node != MAP_EOF; node = map_next(countries,node)){
+        Country country = map_node_value(countries,node);
+        memory->countries += sizeof(*country) + strlen(country->name) + 1 + set_memory(country->records);
+        memory->tops += map_memory(country->tops) + map_size(country->tops) * sizeof(struct top_node) + set_memory(country->ranking);
+        for(MapNode t = map_first(country->tops); t != MAP_EOF; t = map_next(country->tops,t)){
+            TopNode top = map_node_value(country->tops,t);
+            if(top->records != NULL)
+                memory->tops += set_memory(top->records);
+        }
+    }
+    memory->tops += detectors * sizeof(struct outbreak_detector);
+
+    memory->diseases = map_memory(diseases);
+    for(MapNode node = map_first(diseases); node != MAP_EOF; node = map_next(diseases,node)){
+        Disease disease = map_node_value(diseases,node);
+        memory->diseases += sizeof(*disease) + strlen(disease->name) + 1 + set_memory(disease->records) + set_memory(disease->countries);
+    }
+
+    memory->regions = map_memory(regions) + map_memory(country_regions);
+    for(MapNode node = map_first(regions); node != MAP_EOF; node = map_next(regions,node)){
+        Region region = map_node_value(regions,node);
+        memory->regions += sizeof(*region) + strlen(region->name) + 1 + map_memory(region->tops)
+            + map_size(region->tops) * sizeof(struct top_node) + set_memory(region->ranking);
+    }
+    for(MapNode node = map_first(country_regions); node != MAP_EOF; node = map_next(country_regions,node))
+        memory->regions += strlen(map_node_key(country_regions,node)) + 1;
+
+    if(versions != NULL)
+        memory->versions = vset_memory(versions);
+    if(arena != NULL)
+        memory->arena = arena_memory(arena);
+    if(history != NULL)
+        memory->history = partitions_memory(history) + map_memory(archived) + map_size(archived) * sizeof(struct archived);
+
+    memory->total = memory->entries + memory->ids + memory->names + memory->monitor + memory->dates + memory->ranking
+        + memory->countries + memory->tops + memory->diseases + memory->regions + memory->versions + memory->arena + memory->history;
+}
+
+void dm_stats_reset(){
+    stats_reset();
+}
+
+void dm_stats_print(FILE* file, bool json){
+    struct dm_stats* stats = malloc(sizeof(*stats));     // ~50KB, όχι στο stack
+    dm_stats(stats);
+
+    // Τα percentiles που τυπώνονται για κάθε λειτουργία
+    double percentiles[] = { 50, 99, 99.9 };
+    char* percentile_names[] = { "p50", "p99", "p999" };
+
+    if(json){
+        fprintf(file,"{\"enabled\":%s,",stats->enabled ? "true" : "false");
+        fprintf(file,"\"indexes\":{\"records\":%d,\"countries\":%d,\"diseases\":%d,\"pairs\":%d},",
+            stats->records,stats->countries,stats->diseases,stats->pairs);
+
+        fprintf(file,"\"counters\":{");
+        for(int i = 0; i < STAT_COUNTERS_NO; i++)
+            fprintf(file,"%s\"%s\":%lu",i > 0 ? "," : "",stat_counter_names[i],(unsigned long)stats->counters[i]);
+
+        fprintf(file,"},\"operations\":{");
+        for(int i = 0; i < STAT_OPS_NO; i++){
+            Histogram h = &stats->operations[i];
+            fprintf(file,"%s\"%s\":{\"count\":%lu,\"mean_ns\":%lu",i > 0 ? "," : "",stat_op_names[i],
+                (unsigned long)h->count,(unsigned long)(h->count > 0 ? h->sum / h->count : 0));
+            for(int j = 0; j < 3; j++)
+                fprintf(file,",\"%s_ns\":%lu",percentile_names[j],(unsigned long)histogram_percentile(h,percentiles[j]));
+            fprintf(file,",\"max_ns\":%lu}",(unsigned long)h->max);
+        }
+        fprintf(file,"}}\n");
+
+    }else{
+        fprintf(file,"indexes: records %d, countries %d, diseases %d, pairs %d\n",
+            stats->records,stats->countries,stats->diseases,stats->pairs);
+
+        if(!stats->enabled)
+            fprintf(file,"counters and latencies disabled (compile with -DDM_STATS)\n");
+        else{
+            for(int i = 0; i < STAT_COUNTERS_NO; i++)
+                fprintf(file,"%-20s %lu\n",stat_counter_names[i],(unsigned long)stats->counters[i]);
+
+            fprintf(file,"%-16s %10s %10s %10s %10s %10s %10s\n","operation","count","mean (us)","p50 (us)","p99 (us)","p999 (us)","max (us)");
+            for(int i = 0; i < STAT_OPS_NO; i++){
+                Histogram h = &stats->operations[i];
+                fprintf(file,"%-16s %10lu %10.2f",stat_op_names[i],(unsigned long)h->count,h->count > 0 ? h->sum / 1000.0 / h->count : 0);
+                for(int j = 0; j < 3; j++)
+                    fprintf(file," %10.2f",histogram_percentile(h,percentiles[j]) / 1000.0);
+                fprintf(file," %10.2f\n",h->max / 1000.0);
+            }
+        }
+    }
+    free(stats);
+}
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του Outbreak detector μέσω EWMA.
+//
+///////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Outbreak.h"
+
+
+// Μετά από τόσες ημέρες χωρίς εγγραφές η baseline έχει ουσιαστικά μηδενιστεί (πχ 0.9^64 < 0.002),
+// οπότε δεν χρειάζεται να προσθέσουμε περισσότερες. Έτσι κάθε outbreak_add είναι O(1).
+#define MAX_GAP 64
+
+int outbreak_day(String date) {
+	int y = 0, m = 1, d = 1;
+	sscanf(date, "%d-%d-%d", &y, &m, &d);
+
+	// Ο αλγόριθμος days_from_civil: το έτος αρχίζει την 1η Μαρτίου, ώστε η 29η Φεβρουαρίου να είναι η
+	// τελευταία ημέρα του, και οι ημέρες μετρώνται σε κύκλους 400 ετών (146097 ημέρες)
+	y -= m <= 2;
+	int era = (y >= 0 ? y : y - 399) / 400;
+	int year_of_era = y - era * 400;
+	int day_of_year = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+	int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+	return era * 146097 + day_of_era - 719468;
+}
+
+OutbreakDetector outbreak_create() {
+	OutbreakDetector detector = malloc(sizeof(*detector));
+	*detector = (struct outbreak_detector){ .count = 0, .days = 0, .mean = 0, .variance = 0, .alerted = false };
+	return detector;
+}
+
+// Προσθέτει στη baseline μια ημέρα με count εγγραφές
+
+static void add_to_baseline(OutbreakDetector detector, double count, double alpha) {
+	if (detector->days == 0) {
+		detector->mean = count;
+		detector->variance = 0;
+	} else {
+		// Incremental EWMA μέσης τιμής και διασποράς (Finch, "Incremental calculation of weighted mean and variance")
+		double diff = count - detector->mean;
+		double increment = alpha * diff;
+		detector->mean += increment;
+		detector->variance = (1 - alpha) * (detector->variance + diff * increment);
+	}
+	detector->days++;
+}
+
+bool outbreak_add(OutbreakDetector detector, int day, OutbreakParams params) {
+	if (detector->count == 0 && detector->days == 0) {
+		detector->day = day;		// η πρώτη εγγραφή
+
+	} else if (day > detector->day) {
+		add_to_baseline(detector, detector->count, params->alpha);
+
+		int gap = day - detector->day - 1;
+		for (int i = 0; i < gap && i < MAX_GAP; i++)
+			add_to_baseline(detector, 0, params->alpha);
+
+		detector->day = day;
+		detector->count = 0;
+		detector->alerted = false;
+
+	} else if (day < detector->day) {
+		return false;
+	}
+
+	detector->count++;
+	if (detector->alerted || detector->days < params->warmup || detector->count < params->min_count)
+		return false;
+
+	detector->alerted = detector->count > detector->mean + params->threshold * outbreak_deviation(detector);
+	return detector->alerted;
+}
+
+double outbreak_deviation(OutbreakDetector detector) {
+	return sqrt(detector->variance);
+}
+
+void outbreak_destroy(OutbreakDetector detector) {
+	free(detector);
+}
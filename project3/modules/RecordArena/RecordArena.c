@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του Record Arena μέσω slabs και free list.
+//
+///////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "RecordArena.h"
+#include "ADTMap.h"
+#include "ADTVector.h"
+#include "Stats.h"
+
+
+// Πόσα slots δεσμεύονται με μία malloc
+#define SLAB_SLOTS 1024
+
+// Χώρος μέσα στο slot για το date και το name. Αρκεί για ένα date σε μορφή YYYY-MM-DD
+// και ένα name έως 36 χαρακτήρες, μεγαλύτερα strings αποθηκεύονται σε ξεχωριστή malloc.
+#define SLOT_STRINGS 48
+
+typedef struct slot* Slot;
+
+struct slot {
+	struct record record;			// Πρώτο πεδίο, ώστε ένα Record του arena να είναι και pointer στο slot του
+	union {
+		char strings[SLOT_STRINGS];	// Το date και το name, το ένα αμέσως μετά το άλλο
+		Slot next_free;				// Για τα ελεύθερα slots, το επόμενο στη free list
+	};
+};
+
+struct record_arena {
+	Vector slabs;					// Όλα τα slabs, το τελευταίο είναι το τρέχον
+	int used;						// Πόσα slots του τρέχοντος slab έχουν δοθεί
+	Slot free_list;					// Slots που αποδεσμεύτηκαν και μπορούν να ξαναχρησιμοποιηθούν
+	int size;
+	Map strings;					// Intern strings (disease, country), key == value
+	size_t strings_memory;			// Bytes των intern strings
+	size_t overflow_memory;			// Bytes των buffers για date και name που δεν χώρεσαν στο slot
+};
+
+
+static int compare_strings(Pointer a, Pointer b) {
+	return strcmp(a, b);
+}
+
+// Επιστρέφει το μοναδικό αντίγραφο του string s στο arena, δημιουργώντας το αν δεν υπάρχει
+
+static String intern(RecordArena arena, String s) {
+	String found = map_find(arena->strings, s);
+	if (found != NULL)
+		return found;
+
+	String copy = strdup(s);
+	map_insert(arena->strings, copy, copy);
+	arena->strings_memory += strlen(s) + 1;
+	return copy;
+}
+
+// Επιστρέφει ένα ελεύθερο slot, από τη free list ή από το τρέχον slab
+
+static Slot slot_alloc(RecordArena arena) {
+	if (arena->free_list != NULL) {
+		Slot slot = arena->free_list;
+		arena->free_list = slot->next_free;
+		return slot;
+	}
+
+	if (vector_size(arena->slabs) == 0 || arena->used == SLAB_SLOTS) {
+		STATS_ADD(STAT_ARENA_SLAB_ALLOCS, 1);
+		vector_insert_last(arena->slabs, malloc(SLAB_SLOTS * sizeof(struct slot)));
+		arena->used = 0;
+	}
+
+	Slot slab = vector_get_at(arena->slabs, vector_size(arena->slabs) - 1);
+	return &slab[arena->used++];
+}
+
+RecordArena arena_create() {
+	RecordArena arena = malloc(sizeof(*arena));
+	arena->slabs = vector_create(0, free);
+	arena->used = 0;
+	arena->free_list = NULL;
+	arena->size = 0;
+	arena->strings_memory = arena->overflow_memory = 0;
+
+	arena->strings = map_create(compare_strings, free, NULL);
+	map_set_hash_function(arena->strings, hash_string);
+
+	return arena;
+}
+
+int arena_size(RecordArena arena) {
+	return arena->size;
+}
+
+Record arena_copy(RecordArena arena, Record record) {
+	Slot slot = slot_alloc(arena);
+	arena->size++;
+
+	size_t date_len = strlen(record->date) + 1;
+	size_t name_len = strlen(record->name) + 1;
+
+	// Date και name σε ένα συνεχόμενο buffer, μέσα στο slot αν χωράνε
+	char* buffer = slot->strings;
+	if (date_len + name_len > SLOT_STRINGS) {
+		buffer = malloc(date_len + name_len);
+		arena->overflow_memory += date_len + name_len;
+	}
+	memcpy(buffer, record->date, date_len);
+	memcpy(buffer + date_len, record->name, name_len);
+
+	slot->record.id = record->id;
+	slot->record.date = buffer;
+	slot->record.name = buffer + date_len;
+	slot->record.disease = intern(arena, record->disease);
+	slot->record.country = intern(arena, record->country);
+
+	return &slot->record;
+}
+
+void arena_release(RecordArena arena, Record record) {
+	Slot slot = (Slot)record;
+
+	// Αν τα strings δεν χώρεσαν στο slot, το date είναι η αρχή του εξωτερικού buffer
+	if (record->date != slot->strings) {
+		arena->overflow_memory -= strlen(record->date) + strlen(record->name) + 2;
+		free(record->date);
+	}
+
+	slot->next_free = arena->free_list;
+	arena->free_list = slot;
+	arena->size--;
+}
+
+size_t arena_memory(RecordArena arena) {
+	return sizeof(*arena)
+		+ vector_size(arena->slabs) * SLAB_SLOTS * sizeof(struct slot) + vector_memory(arena->slabs)
+		+ map_memory(arena->strings) + arena->strings_memory
+		+ arena->overflow_memory;
+}
+
+void arena_destroy(RecordArena arena) {
+	// Ελευθερώνουμε τα εξωτερικά buffers των records που είναι ακόμα στο arena. Τα
+	// ελεύθερα slots τα σημαδεύουμε πρώτα (date == NULL) ώστε να τα ξεχωρίζουμε.
+	for (Slot slot = arena->free_list; slot != NULL; ) {
+		Slot next = slot->next_free;
+		slot->record.date = NULL;
+		slot = next;
+	}
+
+	for (int i = 0; i < vector_size(arena->slabs); i++) {
+		Slot slab = vector_get_at(arena->slabs, i);
+		int used = i == vector_size(arena->slabs) - 1 ? arena->used : SLAB_SLOTS;
+
+		for (int j = 0; j < used; j++)
+			if (slab[j].record.date != NULL && slab[j].record.date != slab[j].strings)
+				free(slab[j].record.date);
+	}
+
+	vector_destroy(arena->slabs);
+	map_destroy(arena->strings);
+	free(arena);
+}
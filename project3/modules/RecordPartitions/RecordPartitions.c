@@ -0,0 +1,841 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση των Record Partitions μέσω ενός AVL με τα
+// partitions, και indexes ανά partition. Τα partitions
+// στο δίσκο διαβάζονται μέσω mmap.
+//
+///////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "RecordPartitions.h"
+#include "RecordArena.h"
+#include "ADTMap.h"
+#include "ADTSet.h"
+
+
+// Οι εγγραφές ενός key (όλες, μιας χώρας, ασθένειας ή ζεύγους) μέσα σε ένα partition, κατά
+// ημερομηνία. Στο ανοιχτό partition βρίσκονται σε ένα AVL, στο παγωμένο σε έναν πίνακα, και
+// σε αυτό στο δίσκο σε έναν πίνακα θέσεων μέσα στο αρχείο.
+
+typedef struct index* Index;
+
+struct index {
+	Set set;						// Records, compare_records, NULL αν το partition έχει παγώσει
+	Record* array;					// Τα ίδια records ταξινομημένα, μόνο στο παγωμένο partition
+	const int32_t* positions;		// Μόνο στο partition στο δίσκο: θέσεις στον πίνακα records του αρχείου
+	int size;
+	Map diseases;					// Μόνο στα indexes των χωρών: disease => Index του ζεύγους
+};
+
+typedef struct partition* Partition;
+
+struct partition {
+	int month;						// YYYYMM
+	char name[8];					// YYYY-MM
+	bool frozen;
+	RecordArena arena;				// Τα αντίγραφα των records, NULL στο partition στο δίσκο
+	struct index all;
+	Map countries;					// country => Index, τα keys ανήκουν στο arena (ή στο αρχείο)
+	Map diseases;					// disease => Index
+	int indexes;					// Πλήθος indexes, για την partitions_memory
+	String path;					// Το αρχείο του partition στο δίσκο, αλλιώς NULL
+	uint8_t* file;					// Το mmap του αρχείου, NULL όσο δεν έχει φορτωθεί
+	size_t file_size;
+	uint64_t used;					// Η τιμή του clock στην τελευταία χρήση του (στο δίσκο), για το LRU
+};
+
+struct record_partitions {
+	Set partitions;					// Partitions, compare_partitions
+	Partition last;					// Το partition της τελευταίας εισαγωγής
+	int size;
+	String directory;				// Ο φάκελος για τα partitions στο δίσκο, NULL χωρίς spill
+	int hot_months;					// Πόσοι από τους πιο πρόσφατους μήνες μένουν στη μνήμη
+	int loaded;						// Πόσα partitions στο δίσκο είναι φορτωμένα
+	int max_loaded;
+	uint64_t clock;					// Αυξάνεται σε κάθε χρήση ενός partition στο δίσκο
+};
+
+#define MAX_LOADED_DEFAULT 4
+
+
+// Το αρχείο ενός partition στο δίσκο: header, records (κατά ημερομηνία και id), indexes, θέσεις των
+// records κάθε index και στο τέλος τα strings (το καθένα μία φορά, με '\0'). Όλες οι αναφορές είναι
+// offsets από την αρχή του αρχείου, ώστε να χρησιμοποιείται απευθείας μέσω mmap χωρίς μετατροπή.
+
+// Κάθε αρχείο αρχίζει με αυτά τα 8 bytes (το τελευταίο είναι η έκδοση του format)
+static const char magic[8] = { 'D', 'M', 'P', 'A', 'R', 'T', 'S', 1 };
+
+#define NO_STRING UINT32_MAX		// Για τα κριτήρια που δεν ισχύουν σε ένα file_index
+
+struct file_header {
+	char magic[8];
+	int32_t month;
+	int32_t size;					// Πλήθος records
+	int32_t indexes;				// Πλήθος indexes (το πρώτο είναι όλες οι εγγραφές)
+	uint32_t records;				// Offset του πίνακα με τα file_record
+	uint32_t index_table;			// Offset του πίνακα με τα file_index
+	uint64_t file_size;
+};
+
+struct file_record {
+	int32_t id;
+	uint32_t name, date, disease, country;		// Offsets των strings
+};
+
+struct file_index {
+	uint32_t country, disease;		// Offsets των strings, ή NO_STRING
+	int32_t size;
+	uint32_t positions;				// Offset πίνακα με size int32_t, θέσεις στον πίνακα records
+};
+
+
+static int compare_strings(Pointer a, Pointer b) {
+	return strcmp(a, b);
+}
+
+static int compare_records(Record a, Record b) {
+	int res = strcmp(a->date, b->date);
+	if (res != 0)
+		return res;
+	return (a->id > b->id) - (a->id < b->id);
+}
+
+static int compare_partitions(Partition a, Partition b) {
+	return a->month - b->month;
+}
+
+// Επιστρέφει τον μήνα (YYYYMM) μιας ημερομηνίας YYYY-MM-DD (ή YYYY-MM), ή -1 αν δεν είναι σε αυτή τη μορφή
+
+static int month_of(String date) {
+	size_t length = strlen(date);
+	if ((length != 7 && length != 10) || date[4] != '-' || (length == 10 && date[7] != '-'))
+		return -1;
+
+	int month = 0;
+	for (size_t i = 0; i < length; i++) {
+		if (i == 4 || i == 7)
+			continue;
+		if (date[i] < '0' || date[i] > '9')
+			return -1;
+		if (i < 7)
+			month = month * 10 + date[i] - '0';
+	}
+	return month;
+}
+
+
+// Indexes ///////////////////////////////////////////////////////////////////////
+
+static void index_init(Index index) {
+	index->set = set_create((CompareFunc)compare_records, NULL);
+	index->array = NULL;
+	index->positions = NULL;
+	index->size = 0;
+	index->diseases = NULL;
+}
+
+static Index index_create(Partition partition) {
+	Index index = malloc(sizeof(*index));
+	index_init(index);
+	partition->indexes++;
+	return index;
+}
+
+static void index_destroy_contents(Index index) {
+	if (index->set != NULL)
+		set_destroy(index->set);
+	free(index->array);
+	if (index->diseases != NULL)
+		map_destroy(index->diseases);
+}
+
+static void index_destroy(Index index) {
+	index_destroy_contents(index);
+	free(index);
+}
+
+// Επιστρέφει το index του key στο map, δημιουργώντας το αν δεν υπάρχει
+
+static Index index_get(Partition partition, Map map, String key) {
+	Index index = map_find(map, key);
+	if (index == NULL) {
+		index = index_create(partition);
+		map_insert(map, key, index);
+	}
+	return index;
+}
+
+static void index_insert(Index index, Record record) {
+	set_insert(index->set, record);
+	index->size++;
+}
+
+// Μετατρέπει το AVL του index σε ταξινομημένο πίνακα
+
+static void index_freeze(Index index) {
+	index->array = malloc((index->size > 0 ? index->size : 1) * sizeof(Record));
+	int i = 0;
+	for (SetNode node = set_first(index->set); node != SET_EOF; node = set_next(index->set, node))
+		index->array[i++] = set_node_value(index->set, node);
+	set_destroy(index->set);
+	index->set = NULL;
+
+	if (index->diseases != NULL)
+		for (MapNode node = map_first(index->diseases); node != MAP_EOF; node = map_next(index->diseases, node))
+			index_freeze(map_node_value(index->diseases, node));
+}
+
+// Το i-οστό record ενός index παγωμένου partition. Στο partition στο δίσκο δημιουργείται στο buffer,
+// με τα strings του αρχείου.
+
+static Record index_record(Partition partition, Index index, int i, struct record* buffer) {
+	if (index->positions == NULL)
+		return index->array[i];
+
+	struct file_header* header = (struct file_header*)partition->file;
+	struct file_record* record = (struct file_record*)(partition->file + header->records) + index->positions[i];
+	*buffer = (struct record){
+		.id = record->id,
+		.name = (String)partition->file + record->name,
+		.date = (String)partition->file + record->date,
+		.disease = (String)partition->file + record->disease,
+		.country = (String)partition->file + record->country,
+	};
+	return buffer;
+}
+
+// Το πλήθος των records του index με ημερομηνία < date, ή <= date αν inclusive == true
+
+static int index_rank(Partition partition, Index index, Date date, bool inclusive) {
+	if (index->set != NULL) {
+		// Το probe είναι μετά (ή πριν) από όλα τα records της ημερομηνίας, εκτός από ένα με το ίδιο id
+		struct record probe = { .id = inclusive ? INT_MAX : INT_MIN, .date = date };
+		int rank = set_rank(index->set, &probe);
+		if (inclusive && set_find_node(index->set, &probe) != SET_EOF)
+			rank++;
+		return rank;
+	}
+
+	// Δυαδική αναζήτηση για το πρώτο record που δεν ικανοποιεί τη συνθήκη
+	struct record buffer;
+	int lo = 0, hi = index->size;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		int res = strcmp(index_record(partition, index, mid, &buffer)->date, date);
+		if (res < 0 || (inclusive && res == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// Καλεί τη visit για τα records του index μέσα στο [date_from, date_to] (NULL χωρίς όριο), και επιστρέφει το
+// πλήθος τους. Αν η visit επιστρέψει false, το *stop γίνεται true.
+
+static int index_scan(Partition partition, Index index, Date date_from, Date date_to, PartitionsVisitFunc visit, Pointer context, bool* stop) {
+	int start = date_from != NULL ? index_rank(partition, index, date_from, false) : 0;
+	int end = date_to != NULL ? index_rank(partition, index, date_to, true) : index->size;
+	if (end <= start)
+		return 0;
+	if (visit == NULL)
+		return end - start;
+
+	int count = 0;
+	if (index->set != NULL) {
+		SetNode node = set_node_at(index->set, start);
+		for (int i = start; i < end && !*stop; i++, node = set_next(index->set, node)) {
+			count++;
+			*stop = !visit(set_node_value(index->set, node), context);
+		}
+	} else {
+		struct record buffer;
+		for (int i = start; i < end && !*stop; i++) {
+			count++;
+			*stop = !visit(index_record(partition, index, i, &buffer), context);
+		}
+	}
+	return count;
+}
+
+
+// Partitions ////////////////////////////////////////////////////////////////////
+
+// Δημιουργεί τα maps με τα indexes ενός partition
+
+static void partition_create_maps(Partition partition) {
+	partition->countries = map_create(compare_strings, NULL, (DestroyFunc)index_destroy);
+	map_set_hash_function(partition->countries, hash_string);
+	partition->diseases = map_create(compare_strings, NULL, (DestroyFunc)index_destroy);
+	map_set_hash_function(partition->diseases, hash_string);
+}
+
+// Δημιουργεί το partition του μήνα της ημερομηνίας date (YYYY-MM-DD)
+
+static Partition partition_create(String date) {
+	Partition partition = malloc(sizeof(*partition));
+	partition->month = month_of(date);
+	memcpy(partition->name, date, 7);
+	partition->name[7] = '\0';
+	partition->frozen = false;
+	partition->arena = arena_create();
+	partition->indexes = 0;
+	partition->path = NULL;
+	partition->file = NULL;
+	partition->file_size = 0;
+	partition->used = 0;
+	index_init(&partition->all);
+
+	partition_create_maps(partition);
+	return partition;
+}
+
+// Αποδεσμεύει τα indexes και τα records του partition, κρατώντας μόνο το πλήθος τους
+
+static void partition_release(Partition partition) {
+	index_destroy_contents(&partition->all);
+	partition->all.set = NULL;
+	partition->all.array = NULL;
+	partition->all.positions = NULL;
+	partition->all.diseases = NULL;
+
+	if (partition->countries != NULL) {
+		map_destroy(partition->countries);
+		map_destroy(partition->diseases);
+		partition->countries = partition->diseases = NULL;
+	}
+	if (partition->arena != NULL) {
+		arena_destroy(partition->arena);
+		partition->arena = NULL;
+	}
+	if (partition->file != NULL) {
+		munmap(partition->file, partition->file_size);
+		partition->file = NULL;
+	}
+	partition->indexes = 0;
+}
+
+static void partition_destroy(Partition partition) {
+	partition_release(partition);
+	if (partition->path != NULL) {
+		unlink(partition->path);
+		free(partition->path);
+	}
+	free(partition);
+}
+
+// Επιστρέφει το partition του μήνα month (YYYYMM), ή NULL αν δεν υπάρχει
+
+static Partition partition_find(RecordPartitions partitions, int month) {
+	if (partitions->last != NULL && partitions->last->month == month)
+		return partitions->last;
+
+	struct partition probe = { .month = month };
+	return set_find(partitions->partitions, &probe);
+}
+
+// Το index του partition με τα records που ικανοποιούν τα κριτήρια disease, country, ή NULL αν δεν υπάρχουν
+
+static Index partition_index(Partition partition, String disease, String country) {
+	if (country != NULL) {
+		Index index = map_find(partition->countries, country);
+		return index == NULL || disease == NULL ? index : map_find(index->diseases, disease);
+	}
+	return disease != NULL ? map_find(partition->diseases, disease) : &partition->all;
+}
+
+static void partition_freeze(Partition partition) {
+	if (partition->frozen)
+		return;
+
+	index_freeze(&partition->all);
+	for (MapNode node = map_first(partition->countries); node != MAP_EOF; node = map_next(partition->countries, node))
+		index_freeze(map_node_value(partition->countries, node));
+	for (MapNode node = map_first(partition->diseases); node != MAP_EOF; node = map_next(partition->diseases, node))
+		index_freeze(map_node_value(partition->diseases, node));
+
+	partition->frozen = true;
+}
+
+
+// Partitions στο δίσκο //////////////////////////////////////////////////////////
+
+// Το αρχείο που γράφεται, μαζί με το λεξικό των strings του
+
+struct file_writer {
+	uint8_t* data;
+	Partition partition;
+	Map strings;					// String => offset στο data (ποτέ 0, τα strings είναι μετά το header)
+	uint64_t end;					// Το τέλος των strings που έχουν γραφτεί
+	int32_t* positions;				// Η επόμενη ελεύθερη θέση στον πίνακα θέσεων
+};
+
+// Επιστρέφει το offset του s στο αρχείο, γράφοντάς το αν δεν υπάρχει ήδη. Με data == NULL απλά μετράει
+// το μήκος των strings.
+
+static uint32_t write_string(struct file_writer* writer, String s) {
+	if (s == NULL)
+		return NO_STRING;
+
+	uint32_t offset = (uintptr_t)map_find(writer->strings, s);
+	if (offset == 0) {
+		offset = writer->end;
+		size_t length = strlen(s) + 1;
+		if (writer->data != NULL)
+			memcpy(writer->data + offset, s, length);
+		writer->end += length;
+		map_insert(writer->strings, s, (Pointer)(uintptr_t)offset);
+	}
+	return offset;
+}
+
+// Η θέση ενός record του partition στον πίνακα όλων των records (που είναι ταξινομημένος όπως κάθε index)
+
+static int32_t record_position(Partition partition, Record record) {
+	int lo = 0, hi = partition->all.size - 1;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (compare_records(partition->all.array[mid], record) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// Γράφει στο αρχείο το index με τα κριτήρια country, disease (NULL αν δεν ισχύει)
+
+static void write_index(struct file_writer* writer, struct file_index* entry, Index index, String country, String disease) {
+	entry->country = write_string(writer, country);
+	entry->disease = write_string(writer, disease);
+	entry->size = index->size;
+	entry->positions = (uint8_t*)writer->positions - writer->data;
+
+	for (int i = 0; i < index->size; i++)
+		*writer->positions++ = index == &writer->partition->all ? i : record_position(writer->partition, index->array[i]);
+}
+
+// Γράφει το παγωμένο partition στο path. Επιστρέφει false αν το αρχείο δεν γράφτηκε.
+
+static bool partition_write(Partition partition, String path) {
+	int size = partition->all.size;
+	int indexes = partition->indexes + 1;
+	uint64_t positions = 4 * (uint64_t)size;	// Κάθε record είναι σε 4 indexes: όλες, χώρα, ασθένεια, ζεύγος
+
+	// Πρώτα μετράμε το μήκος των strings, για να ξέρουμε το μέγεθος του αρχείου
+	uint64_t strings = sizeof(struct file_header) + size * sizeof(struct file_record)
+		+ indexes * sizeof(struct file_index) + positions * sizeof(int32_t);
+	struct file_writer writer = { .data = NULL, .partition = partition, .end = strings };
+	writer.strings = map_create(compare_strings, NULL, NULL);
+	map_set_hash_function(writer.strings, hash_string);
+	for (int i = 0; i < size && writer.end <= UINT32_MAX; i++) {
+		Record record = partition->all.array[i];
+		write_string(&writer, record->name);
+		write_string(&writer, record->date);
+		write_string(&writer, record->disease);
+		write_string(&writer, record->country);
+	}
+	uint64_t file_size = writer.end;
+	map_destroy(writer.strings);
+	if (file_size > UINT32_MAX)
+		return false;			// τα offsets είναι 32 bits
+
+	writer.data = calloc(1, file_size);
+	writer.end = strings;
+	writer.strings = map_create(compare_strings, NULL, NULL);
+	map_set_hash_function(writer.strings, hash_string);
+
+	struct file_header* header = (struct file_header*)writer.data;
+	memcpy(header->magic, magic, sizeof(magic));
+	header->month = partition->month;
+	header->size = size;
+	header->indexes = indexes;
+	header->records = sizeof(struct file_header);
+	header->index_table = header->records + size * sizeof(struct file_record);
+	header->file_size = file_size;
+
+	struct file_record* records = (struct file_record*)(writer.data + header->records);
+	for (int i = 0; i < size; i++) {
+		Record record = partition->all.array[i];
+		records[i] = (struct file_record){
+			.id = record->id,
+			.name = write_string(&writer, record->name),
+			.date = write_string(&writer, record->date),
+			.disease = write_string(&writer, record->disease),
+			.country = write_string(&writer, record->country),
+		};
+	}
+
+	// Κάθε χώρα ακολουθείται από τα ζεύγη της, ώστε στο διάβασμα να υπάρχει ήδη το index της
+	struct file_index* entry = (struct file_index*)(writer.data + header->index_table);
+	writer.positions = (int32_t*)(entry + indexes);
+	write_index(&writer, entry++, &partition->all, NULL, NULL);
+	for (MapNode node = map_first(partition->countries); node != MAP_EOF; node = map_next(partition->countries, node)) {
+		String country = map_node_key(partition->countries, node);
+		Index index = map_node_value(partition->countries, node);
+		write_index(&writer, entry++, index, country, NULL);
+		for (MapNode d = map_first(index->diseases); d != MAP_EOF; d = map_next(index->diseases, d))
+			write_index(&writer, entry++, map_node_value(index->diseases, d), country, map_node_key(index->diseases, d));
+	}
+	for (MapNode node = map_first(partition->diseases); node != MAP_EOF; node = map_next(partition->diseases, node))
+		write_index(&writer, entry++, map_node_value(partition->diseases, node), NULL, map_node_key(partition->diseases, node));
+	map_destroy(writer.strings);
+
+	FILE* file = fopen(path, "wb");
+	bool ok = file != NULL && fwrite(writer.data, 1, file_size, file) == file_size;
+	if (file != NULL && fclose(file) != 0)
+		ok = false;
+	if (!ok)
+		unlink(path);
+	free(writer.data);
+	return ok;
+}
+
+// Φορτώνει (μέσω mmap) το αρχείο ενός partition στο δίσκο και δημιουργεί τα indexes του, που δείχνουν
+// μέσα στο αρχείο. Επιστρέφει false αν το αρχείο δεν μπορεί να διαβαστεί.
+
+static bool partition_load(Partition partition) {
+	if (partition->file != NULL)
+		return true;
+
+	int fd = open(partition->path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	uint8_t* file = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(struct file_header))
+		file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (file == MAP_FAILED)
+		return false;
+
+	struct file_header* header = (struct file_header*)file;
+	if (memcmp(header->magic, magic, sizeof(magic)) != 0 || header->file_size != (uint64_t)st.st_size
+		|| header->month != partition->month || header->size != partition->all.size) {
+		munmap(file, st.st_size);
+		return false;
+	}
+	partition->file = file;
+	partition->file_size = st.st_size;
+	partition_create_maps(partition);
+
+	struct file_index* entries = (struct file_index*)(file + header->index_table);
+	for (int i = 0; i < header->indexes; i++) {
+		struct file_index* entry = &entries[i];
+		String country = entry->country != NO_STRING ? (String)file + entry->country : NULL;
+		String disease = entry->disease != NO_STRING ? (String)file + entry->disease : NULL;
+
+		Index index;
+		if (country == NULL && disease == NULL)
+			index = &partition->all;
+		else if (country == NULL)
+			index = index_get(partition, partition->diseases, disease);
+		else {
+			index = index_get(partition, partition->countries, country);
+			if (disease != NULL) {
+				if (index->diseases == NULL) {
+					index->diseases = map_create(compare_strings, NULL, (DestroyFunc)index_destroy);
+					map_set_hash_function(index->diseases, hash_string);
+				}
+				index = index_get(partition, index->diseases, disease);
+			}
+		}
+
+		// Τα indexes δεν χρειάζονται AVL, οι θέσεις είναι ήδη ταξινομημένες
+		if (index->set != NULL) {
+			set_destroy(index->set);
+			index->set = NULL;
+		}
+		index->positions = (int32_t*)(file + entry->positions);
+		index->size = entry->size;
+	}
+	return true;
+}
+
+// Αποφορτώνει τα partitions στο δίσκο που χρησιμοποιήθηκαν λιγότερο πρόσφατα, μέχρι να μείνουν το πολύ
+// max φορτωμένα. Επιστρέφουν στην κατάσταση πριν την partition_load: χωρίς indexes και mmap, μόνο με το
+// αρχείο και το πλήθος των records. Πολυπλοκότητα O(partitions) για κάθε αποφόρτωση.
+
+static void unload_lru(RecordPartitions partitions, int max) {
+	while (partitions->loaded > max) {
+		Partition lru = NULL;
+		for (SetNode node = set_first(partitions->partitions); node != SET_EOF; node = set_next(partitions->partitions, node)) {
+			Partition partition = set_node_value(partitions->partitions, node);
+			if (partition->path != NULL && partition->file != NULL && (lru == NULL || partition->used < lru->used))
+				lru = partition;
+		}
+		partition_release(lru);
+		partitions->loaded--;
+	}
+}
+
+// Φορτώνει (αν χρειάζεται) ένα partition στο δίσκο για ένα query. Το ίδιο είναι πάντα το πιο πρόσφατα
+// χρησιμοποιημένο, οπότε δεν αποφορτώνεται για να χωρέσει.
+
+static bool partition_use(RecordPartitions partitions, Partition partition) {
+	partition->used = ++partitions->clock;
+	if (partition->file != NULL)
+		return true;
+	if (!partition_load(partition))
+		return false;
+
+	partitions->loaded++;
+	unload_lru(partitions, partitions->max_loaded);
+	return true;
+}
+
+// Παγώνει το partition, το γράφει σε ένα αρχείο στο directory των partitions και αποδεσμεύει τη μνήμη του.
+// Αν το αρχείο δεν γραφτεί, το partition μένει (παγωμένο) στη μνήμη.
+
+static bool partition_spill(RecordPartitions partitions, Partition partition) {
+	partition_freeze(partition);
+
+	String path = malloc(strlen(partitions->directory) + strlen(partition->name) + 7);
+	sprintf(path, "%s/%s.part", partitions->directory, partition->name);
+	if (!partition_write(partition, path)) {
+		free(path);
+		return false;
+	}
+
+	partition_release(partition);
+	partition->path = path;
+	return true;
+}
+
+// Μετράει τους μήνες από το έτος 0, ώστε η διαφορά δύο μηνών YYYYMM να είναι το πλήθος των μηνών ανάμεσά τους
+
+static int month_index(int month) {
+	return month / 100 * 12 + month % 100 - 1;
+}
+
+// Κάνει spill όσα partitions είναι εκτός των hot_months πιο πρόσφατων μηνών
+
+static void spill_cold(RecordPartitions partitions) {
+	Set set = partitions->partitions;
+	if (partitions->directory == NULL || set_size(set) == 0)
+		return;
+
+	Partition newest = set_node_value(set, set_last(set));
+	int limit = month_index(newest->month) - partitions->hot_months;
+	for (SetNode node = set_first(set); node != SET_EOF; node = set_next(set, node)) {
+		Partition partition = set_node_value(set, node);
+		if (month_index(partition->month) > limit)
+			break;
+		if (partition->path == NULL)
+			partition_spill(partitions, partition);
+	}
+}
+
+
+RecordPartitions partitions_create() {
+	RecordPartitions partitions = malloc(sizeof(*partitions));
+	partitions->partitions = set_create((CompareFunc)compare_partitions, (DestroyFunc)partition_destroy);
+	partitions->last = NULL;
+	partitions->size = 0;
+	partitions->directory = NULL;
+	partitions->hot_months = 0;
+	partitions->loaded = 0;
+	partitions->max_loaded = MAX_LOADED_DEFAULT;
+	partitions->clock = 0;
+	return partitions;
+}
+
+int partitions_size(RecordPartitions partitions) {
+	return partitions->size;
+}
+
+bool partitions_insert(RecordPartitions partitions, Record record) {
+	int month = record->date != NULL && strlen(record->date) == 10 ? month_of(record->date) : -1;
+	if (month < 0)
+		return false;
+
+	Partition partition = partition_find(partitions, month);
+	if (partition == NULL) {
+		partition = partition_create(record->date);
+		set_insert(partitions->partitions, partition);
+
+		// Ένας νέος πιο πρόσφατος μήνας μπορεί να αφήνει κάποιους παλαιότερους εκτός μνήμης
+		if (set_node_value(partitions->partitions, set_last(partitions->partitions)) == partition)
+			spill_cold(partitions);
+	}
+	// Ένα record με ίδια ημερομηνία και id θα αντικαθιστούσε το υπάρχον στα AVL, οπότε απορρίπτεται
+	if (partition->frozen || set_find_node(partition->all.set, record) != SET_EOF)
+		return false;
+	partitions->last = partition;
+
+	// Τα keys των maps είναι τα strings του αντιγράφου, που ζουν όσο και το partition
+	Record copy = arena_copy(partition->arena, record);
+	Index country = index_get(partition, partition->countries, copy->country);
+	if (country->diseases == NULL) {
+		country->diseases = map_create(compare_strings, NULL, (DestroyFunc)index_destroy);
+		map_set_hash_function(country->diseases, hash_string);
+	}
+
+	index_insert(&partition->all, copy);
+	index_insert(country, copy);
+	index_insert(index_get(partition, partition->diseases, copy->disease), copy);
+	index_insert(index_get(partition, country->diseases, copy->disease), copy);
+	partitions->size++;
+	return true;
+}
+
+int partitions_scan(RecordPartitions partitions, String disease, String country, Date date_from, Date date_to, PartitionsVisitFunc visit, Pointer context) {
+	int from = date_from != NULL ? month_of(date_from) : -1;
+	int to = date_to != NULL ? month_of(date_to) : -1;
+
+	// Το πρώτο partition που μπορεί να τέμνει το διάστημα (αν το date_from δεν είναι σε μορφή
+	// YYYY-MM-DD απλά εξετάζονται όλα)
+	Set set = partitions->partitions;
+	struct partition probe = { .month = from };
+	SetNode node = from >= 0 ? set_node_at(set, set_rank(set, &probe)) : set_first(set);
+
+	int count = 0;
+	bool stop = false;
+	for (; node != SET_EOF && !stop; node = set_next(set, node)) {
+		Partition partition = set_node_value(set, node);
+		if (date_to != NULL && to >= 0 && partition->month > to)
+			break;
+		if (partition->path != NULL && !partition_use(partitions, partition))
+			continue;
+
+		Index index = partition_index(partition, disease, country);
+		if (index == NULL)
+			continue;
+
+		// Τα όρια χρειάζονται μόνο στα partitions των μηνών date_from, date_to
+		Date start = date_from != NULL && (from < 0 || partition->month <= from) ? date_from : NULL;
+		Date end = date_to != NULL && (to < 0 || partition->month >= to) ? date_to : NULL;
+		count += index_scan(partition, index, start, end, visit, context, &stop);
+	}
+	return count;
+}
+
+List partitions_months(RecordPartitions partitions) {
+	List list = list_create(NULL);
+	for (SetNode node = set_first(partitions->partitions); node != SET_EOF; node = set_next(partitions->partitions, node)) {
+		Partition partition = set_node_value(partitions->partitions, node);
+		list_insert_next(list, list_last(list), partition->name);
+	}
+	return list;
+}
+
+bool partitions_freeze(RecordPartitions partitions, String month) {
+	int m = strlen(month) == 7 ? month_of(month) : -1;
+	Partition partition = m >= 0 ? partition_find(partitions, m) : NULL;
+	if (partition == NULL)
+		return false;
+
+	partition_freeze(partition);
+	return true;
+}
+
+bool partitions_frozen(RecordPartitions partitions, String month) {
+	int m = strlen(month) == 7 ? month_of(month) : -1;
+	Partition partition = m >= 0 ? partition_find(partitions, m) : NULL;
+	return partition != NULL && partition->frozen;
+}
+
+bool partitions_drop(RecordPartitions partitions, String month) {
+	int m = strlen(month) == 7 ? month_of(month) : -1;
+	Partition partition = m >= 0 ? partition_find(partitions, m) : NULL;
+	if (partition == NULL)
+		return false;
+
+	if (partitions->last == partition)
+		partitions->last = NULL;
+	partitions->size -= partition->all.size;
+	if (partition->path != NULL && partition->file != NULL)
+		partitions->loaded--;
+	set_remove(partitions->partitions, partition);		// κάνει destroy το partition (και το αρχείο του)
+	return true;
+}
+
+bool partitions_set_spill(RecordPartitions partitions, String directory, int hot_months) {
+	if (directory != NULL && hot_months < 1)
+		return false;
+
+	free(partitions->directory);
+	partitions->directory = directory != NULL ? strdup(directory) : NULL;
+	partitions->hot_months = hot_months;
+	spill_cold(partitions);
+	return true;
+}
+
+bool partitions_spill(RecordPartitions partitions, String month) {
+	int m = strlen(month) == 7 ? month_of(month) : -1;
+	Partition partition = m >= 0 ? partition_find(partitions, m) : NULL;
+	if (partition == NULL || partitions->directory == NULL)
+		return false;
+
+	return partition->path != NULL || partition_spill(partitions, partition);
+}
+
+bool partitions_set_max_loaded(RecordPartitions partitions, int max_loaded) {
+	if (max_loaded < 1)
+		return false;
+
+	partitions->max_loaded = max_loaded;
+	unload_lru(partitions, max_loaded);
+	return true;
+}
+
+int partitions_loaded(RecordPartitions partitions) {
+	return partitions->loaded;
+}
+
+bool partitions_spilled(RecordPartitions partitions, String month) {
+	int m = strlen(month) == 7 ? month_of(month) : -1;
+	Partition partition = m >= 0 ? partition_find(partitions, m) : NULL;
+	return partition != NULL && partition->path != NULL;
+}
+
+// Τα bytes ενός index (χωρίς το ίδιο το struct)
+
+static size_t index_memory(Index index) {
+	size_t memory = index->set != NULL ? set_memory(index->set) : index->array != NULL ? index->size * sizeof(Record) : 0;
+	if (index->diseases != NULL)
+		memory += map_memory(index->diseases);
+	return memory;
+}
+
+size_t partitions_memory(RecordPartitions partitions) {
+	size_t memory = sizeof(*partitions) + set_memory(partitions->partitions);
+
+	for (SetNode node = set_first(partitions->partitions); node != SET_EOF; node = set_next(partitions->partitions, node)) {
+		Partition partition = set_node_value(partitions->partitions, node);
+		memory += sizeof(*partition) + index_memory(&partition->all) + partition->indexes * sizeof(struct index);
+		if (partition->arena != NULL)
+			memory += arena_memory(partition->arena);
+		if (partition->path != NULL)
+			memory += strlen(partition->path) + 1;
+		if (partition->countries == NULL)
+			continue;			// στο δίσκο, δεν έχει φορτωθεί
+
+		memory += map_memory(partition->countries) + map_memory(partition->diseases);
+
+		for (MapNode c = map_first(partition->countries); c != MAP_EOF; c = map_next(partition->countries, c)) {
+			Index country = map_node_value(partition->countries, c);
+			memory += index_memory(country);
+			for (MapNode d = map_first(country->diseases); d != MAP_EOF; d = map_next(country->diseases, d))
+				memory += index_memory(map_node_value(country->diseases, d));
+		}
+		for (MapNode d = map_first(partition->diseases); d != MAP_EOF; d = map_next(partition->diseases, d))
+			memory += index_memory(map_node_value(partition->diseases, d));
+	}
+	return memory;
+}
+
+void partitions_destroy(RecordPartitions partitions) {
+	set_destroy(partitions->partitions);
+	free(partitions->directory);
+	free(partitions);
+}
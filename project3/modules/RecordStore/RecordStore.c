@@ -0,0 +1,456 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του Record Store μέσω συμπιεσμένων blocks.
+//
+///////////////////////////////////////////////////////////
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "RecordStore.h"
+#include "ADTMap.h"
+#include "ADTVector.h"
+
+
+// Records ανά block
+#define BLOCK_RECORDS 1024
+
+// Τα strings των λεξικών αποθηκεύονται σε chunks των τόσων bytes (ή σε δικό τους, αν είναι μεγαλύτερα)
+#define CHUNK_SIZE 65536
+
+// Ένα record του ανοιχτού block, με τους κωδικούς των strings και την ημερομηνία ως αριθμό (βλ. date_pack)
+
+struct pending {
+	int32_t id;
+	int32_t date;
+	uint32_t name, disease, country;
+};
+
+// Ένα συμπιεσμένο block. Το data περιέχει διαδοχικά τις στήλες ids, names, diseases, countries
+// (κάθε τιμή με width bytes, little endian) και dates (διαφορές ως varints).
+
+typedef struct block* Block;
+
+struct block {
+	int count;
+	int32_t date_min, date_max;		// Για να παραλείπονται blocks εκτός του διαστήματος ενός scan
+	int32_t id_base;				// Τα ids αποθηκεύονται ως διαφορά από το μικρότερο
+	uint8_t id_width, name_width, disease_width, country_width;
+	uint8_t* names;					// Η αρχή κάθε στήλης μέσα στο data
+	uint8_t* diseases;
+	uint8_t* countries;
+	uint8_t* dates;
+	size_t size;					// Bytes του data
+	uint8_t data[];
+};
+
+// Λεξικό: κάθε διαφορετικό string έχει έναν κωδικό 0, 1, 2, ...
+
+struct dictionary {
+	Map codes;						// String => κωδικός + 1 (ώστε NULL να σημαίνει ότι δεν υπάρχει)
+	String* strings;				// Κωδικός => String
+	int size, capacity;
+};
+
+struct record_store {
+	Vector blocks;					// Τα συμπιεσμένα blocks
+	size_t blocks_memory;
+	struct pending* open;			// Το ανοιχτό block, BLOCK_RECORDS θέσεις
+	int open_count;
+	int size;
+
+	struct dictionary names, diseases, countries;
+
+	Vector chunks;					// Τα strings των λεξικών
+	size_t chunk_used;				// Bytes του τελευταίου chunk που έχουν χρησιμοποιηθεί
+	size_t chunks_memory;
+};
+
+
+// Ημερομηνίες ///////////////////////////////////////////////////////////////
+//
+// Μια ημερομηνία YYYY-MM-DD αποθηκεύεται ως ο αριθμός YYYYMMDD, ο οποίος έχει την ίδια
+// διάταξη με το string και μετατρέπεται ξανά ακριβώς στο ίδιο string.
+
+static int32_t date_pack(String date) {
+	if (strlen(date) != 10 || date[4] != '-' || date[7] != '-')
+		return -1;
+
+	int32_t packed = 0;
+	for (int i = 0; i < 10; i++) {
+		if (i == 4 || i == 7)
+			continue;
+		if (date[i] < '0' || date[i] > '9')
+			return -1;
+		packed = packed * 10 + date[i] - '0';
+	}
+	return packed;
+}
+
+static void date_unpack(int32_t packed, char date[11]) {
+	for (int i = 9; i >= 0; i--) {
+		if (i == 4 || i == 7) {
+			date[i] = '-';
+		} else {
+			date[i] = '0' + packed % 10;
+			packed /= 10;
+		}
+	}
+	date[10] = '\0';
+}
+
+// Varints: 7 bits ανά byte, το υψηλότερο bit δηλώνει ότι ακολουθεί κι άλλο byte
+
+static uint8_t* varint_put(uint8_t* pos, uint32_t value) {
+	while (value >= 0x80) {
+		*pos++ = value | 0x80;
+		value >>= 7;
+	}
+	*pos++ = value;
+	return pos;
+}
+
+static const uint8_t* varint_get(const uint8_t* pos, uint32_t* value) {
+	*value = 0;
+	for (int shift = 0; ; shift += 7) {
+		uint8_t byte = *pos++;
+		*value |= (uint32_t)(byte & 0x7F) << shift;
+		if (byte < 0x80)
+			return pos;
+	}
+}
+
+static int varint_size(uint32_t value) {
+	int size = 1;
+	for (; value >= 0x80; value >>= 7)
+		size++;
+	return size;
+}
+
+// Τιμές σταθερού πλάτους (1 έως 4 bytes, little endian)
+
+static uint8_t width_of(uint32_t max) {
+	return max < (1u << 8) ? 1 : max < (1u << 16) ? 2 : max < (1u << 24) ? 3 : 4;
+}
+
+static void fixed_put(uint8_t* column, int i, uint8_t width, uint32_t value) {
+	uint8_t* pos = column + i * width;
+	for (int b = 0; b < width; b++, value >>= 8)
+		pos[b] = value;
+}
+
+static inline uint32_t fixed_get(const uint8_t* column, int i, uint8_t width) {
+	const uint8_t* pos = column + i * width;
+	switch (width) {
+		case 1: return pos[0];
+		case 2: return pos[0] | pos[1] << 8;
+		case 3: return pos[0] | pos[1] << 8 | pos[2] << 16;
+		default: return pos[0] | pos[1] << 8 | pos[2] << 16 | (uint32_t)pos[3] << 24;
+	}
+}
+
+
+// Λεξικά ////////////////////////////////////////////////////////////////////
+
+static int compare_strings(Pointer a, Pointer b) {
+	return strcmp(a, b);
+}
+
+static void dictionary_init(struct dictionary* dict) {
+	dict->codes = map_create(compare_strings, NULL, NULL);
+	map_set_hash_function(dict->codes, hash_string);
+	dict->size = 0;
+	dict->capacity = 16;
+	dict->strings = malloc(dict->capacity * sizeof(String));
+}
+
+// Αντιγράφει το s στα chunks του store
+
+static String store_string(RecordStore store, String s) {
+	size_t len = strlen(s) + 1;
+	char* chunk;
+
+	if (len > CHUNK_SIZE / 4) {
+		// Μεγάλο string, σε δικό του chunk πριν από το τρέχον ώστε αυτό να συνεχίσει να γεμίζει
+		chunk = malloc(len);
+		store->chunks_memory += len;
+		int last = vector_size(store->chunks) - 1;
+		if (last >= 0) {
+			vector_insert_last(store->chunks, vector_get_at(store->chunks, last));
+			vector_set_at(store->chunks, last, chunk);
+		} else {
+			vector_insert_last(store->chunks, chunk);
+			store->chunk_used = CHUNK_SIZE;		// δεν υπάρχει τρέχον chunk με χώρο
+		}
+		memcpy(chunk, s, len);
+		return chunk;
+	}
+
+	if (vector_size(store->chunks) == 0 || store->chunk_used + len > CHUNK_SIZE) {
+		vector_insert_last(store->chunks, malloc(CHUNK_SIZE));
+		store->chunks_memory += CHUNK_SIZE;
+		store->chunk_used = 0;
+	}
+
+	chunk = vector_get_at(store->chunks, vector_size(store->chunks) - 1);
+	String copy = chunk + store->chunk_used;
+	memcpy(copy, s, len);
+	store->chunk_used += len;
+	return copy;
+}
+
+// Επιστρέφει τον κωδικό του s, δημιουργώντας τον αν δεν υπάρχει
+
+static uint32_t dictionary_code(RecordStore store, struct dictionary* dict, String s) {
+	uintptr_t found = (uintptr_t)map_find(dict->codes, s);
+	if (found != 0)
+		return found - 1;
+
+	if (dict->size == dict->capacity) {
+		dict->capacity *= 2;
+		dict->strings = realloc(dict->strings, dict->capacity * sizeof(String));
+	}
+	String copy = store_string(store, s);
+	dict->strings[dict->size] = copy;
+	map_insert(dict->codes, copy, (Pointer)(uintptr_t)(dict->size + 1));
+	return dict->size++;
+}
+
+// Επιστρέφει τον κωδικό του s, ή -1 αν δεν υπάρχει στο λεξικό
+
+static int64_t dictionary_find(struct dictionary* dict, String s) {
+	uintptr_t found = (uintptr_t)map_find(dict->codes, s);
+	return found != 0 ? (int64_t)found - 1 : -1;
+}
+
+static size_t dictionary_memory(struct dictionary* dict) {
+	return map_memory(dict->codes) + dict->capacity * sizeof(String);
+}
+
+static void dictionary_destroy(struct dictionary* dict) {
+	map_destroy(dict->codes);
+	free(dict->strings);
+}
+
+
+// Blocks ////////////////////////////////////////////////////////////////////
+
+static int compare_pending(const void* a, const void* b) {
+	const struct pending* x = a;
+	const struct pending* y = b;
+	if (x->date != y->date)
+		return x->date < y->date ? -1 : 1;
+	return x->id < y->id ? -1 : x->id > y->id;
+}
+
+// Συμπιέζει το ανοιχτό block σε ένα νέο Block
+
+static void seal(RecordStore store) {
+	struct pending* open = store->open;
+	int count = store->open_count;
+	qsort(open, count, sizeof(*open), compare_pending);
+
+	int32_t id_base = INT32_MAX;
+	uint32_t name_max = 0, disease_max = 0, country_max = 0;
+	for (int i = 0; i < count; i++) {
+		if (open[i].id < id_base)
+			id_base = open[i].id;
+		if (open[i].name > name_max) name_max = open[i].name;
+		if (open[i].disease > disease_max) disease_max = open[i].disease;
+		if (open[i].country > country_max) country_max = open[i].country;
+	}
+
+	uint32_t id_max = 0;
+	size_t dates_size = varint_size(0);
+	for (int i = 0; i < count; i++) {
+		uint32_t diff = (uint32_t)((int64_t)open[i].id - id_base);
+		if (diff > id_max)
+			id_max = diff;
+		if (i > 0)
+			dates_size += varint_size(open[i].date - open[i - 1].date);
+	}
+
+	uint8_t id_width = width_of(id_max), name_width = width_of(name_max);
+	uint8_t disease_width = width_of(disease_max), country_width = width_of(country_max);
+	size_t size = count * (id_width + name_width + disease_width + country_width) + dates_size;
+
+	Block block = malloc(sizeof(*block) + size);
+	*block = (struct block){
+		.count = count, .date_min = open[0].date, .date_max = open[count - 1].date, .id_base = id_base,
+		.id_width = id_width, .name_width = name_width, .disease_width = disease_width, .country_width = country_width,
+		.size = size,
+	};
+	block->names = block->data + count * id_width;
+	block->diseases = block->names + count * name_width;
+	block->countries = block->diseases + count * disease_width;
+	block->dates = block->countries + count * country_width;
+
+	// Η πρώτη ημερομηνία είναι η date_min, οπότε η πρώτη διαφορά είναι 0
+	uint8_t* pos = block->dates;
+	for (int i = 0; i < count; i++) {
+		fixed_put(block->data, i, id_width, (uint32_t)((int64_t)open[i].id - id_base));
+		fixed_put(block->names, i, name_width, open[i].name);
+		fixed_put(block->diseases, i, disease_width, open[i].disease);
+		fixed_put(block->countries, i, country_width, open[i].country);
+		pos = varint_put(pos, i > 0 ? open[i].date - open[i - 1].date : 0);
+	}
+
+	vector_insert_last(store->blocks, block);
+	store->blocks_memory += sizeof(*block) + size;
+	store->open_count = 0;
+}
+
+
+// Public συναρτήσεις ////////////////////////////////////////////////////////
+
+RecordStore store_create() {
+	RecordStore store = malloc(sizeof(*store));
+	store->blocks = vector_create(0, free);
+	store->blocks_memory = 0;
+	store->open = malloc(BLOCK_RECORDS * sizeof(struct pending));
+	store->open_count = 0;
+	store->size = 0;
+
+	dictionary_init(&store->names);
+	dictionary_init(&store->diseases);
+	dictionary_init(&store->countries);
+
+	store->chunks = vector_create(0, free);
+	store->chunk_used = 0;
+	store->chunks_memory = 0;
+	return store;
+}
+
+int store_size(RecordStore store) {
+	return store->size;
+}
+
+bool store_append(RecordStore store, Record record) {
+	int32_t date = date_pack(record->date);
+	if (date < 0)
+		return false;
+
+	store->open[store->open_count++] = (struct pending){
+		.id = record->id,
+		.date = date,
+		.name = dictionary_code(store, &store->names, record->name),
+		.disease = dictionary_code(store, &store->diseases, record->disease),
+		.country = dictionary_code(store, &store->countries, record->country),
+	};
+	store->size++;
+
+	if (store->open_count == BLOCK_RECORDS)
+		seal(store);
+	return true;
+}
+
+// Τα κριτήρια ενός scan, με τα strings μετατρεμμένα σε κωδικούς (-1 για οποιονδήποτε)
+
+struct scan {
+	int64_t disease, country;
+	int32_t date_from, date_to;
+	StoreVisitFunc visit;
+	Pointer context;
+	int matches;
+	bool stopped;
+	char date[11];					// Η ημερομηνία του τελευταίου record που δόθηκε στη visit, ως string
+	int32_t packed;					// και ως αριθμός (διαδοχικά records συχνά έχουν την ίδια)
+};
+
+// Ελέγχει τα strings ενός record που ικανοποιεί τα κριτήρια και καλεί τη visit
+
+static void scan_match(RecordStore store, struct scan* scan, int32_t id, uint32_t name, uint32_t disease, uint32_t country, int32_t date) {
+	scan->matches++;
+	if (scan->visit == NULL)
+		return;
+
+	if (date != scan->packed) {
+		date_unpack(date, scan->date);
+		scan->packed = date;
+	}
+	struct record record = {
+		.id = id,
+		.name = store->names.strings[name],
+		.disease = store->diseases.strings[disease],
+		.country = store->countries.strings[country],
+		.date = scan->date,
+	};
+	if (!scan->visit(&record, scan->context))
+		scan->stopped = true;
+}
+
+static void scan_block(RecordStore store, Block block, struct scan* scan) {
+	const uint8_t* pos = block->dates;
+	int32_t date = block->date_min;
+
+	for (int i = 0; i < block->count && !scan->stopped; i++) {
+		uint32_t delta;
+		pos = varint_get(pos, &delta);
+		date += delta;
+
+		// Οι ημερομηνίες είναι ταξινομημένες, οπότε μετά το date_to δεν υπάρχει τίποτα άλλο
+		if (date > scan->date_to)
+			return;
+		if (date < scan->date_from)
+			continue;
+
+		uint32_t disease = fixed_get(block->diseases, i, block->disease_width);
+		if (scan->disease >= 0 && disease != scan->disease)
+			continue;
+		uint32_t country = fixed_get(block->countries, i, block->country_width);
+		if (scan->country >= 0 && country != scan->country)
+			continue;
+
+		int32_t id = (int32_t)(block->id_base + (int64_t)fixed_get(block->data, i, block->id_width));
+		scan_match(store, scan, id, fixed_get(block->names, i, block->name_width), disease, country, date);
+	}
+}
+
+int store_scan(RecordStore store, String disease, String country, Date date_from, Date date_to, StoreVisitFunc visit, Pointer context) {
+	struct scan scan = {
+		.disease = disease != NULL ? dictionary_find(&store->diseases, disease) : -1,
+		.country = country != NULL ? dictionary_find(&store->countries, country) : -1,
+		.date_from = date_from != NULL ? date_pack(date_from) : INT32_MIN,
+		.date_to = date_to != NULL ? date_pack(date_to) : INT32_MAX,
+		.visit = visit, .context = context, .matches = 0, .stopped = false, .packed = -1,
+	};
+
+	// Ένα string που δεν υπάρχει στο λεξικό, ή ένα όριο που δεν είναι ημερομηνία, δεν ταιριάζει με τίποτα
+	if ((disease != NULL && scan.disease < 0) || (country != NULL && scan.country < 0) || scan.date_from == -1 || scan.date_to == -1)
+		return 0;
+
+	for (int b = 0; b < vector_size(store->blocks) && !scan.stopped; b++) {
+		Block block = vector_get_at(store->blocks, b);
+		if (block->date_max >= scan.date_from && block->date_min <= scan.date_to)
+			scan_block(store, block, &scan);
+	}
+
+	for (int i = 0; i < store->open_count && !scan.stopped; i++) {
+		struct pending* p = &store->open[i];
+		if (p->date >= scan.date_from && p->date <= scan.date_to
+			&& (scan.disease < 0 || p->disease == scan.disease) && (scan.country < 0 || p->country == scan.country))
+			scan_match(store, &scan, p->id, p->name, p->disease, p->country, p->date);
+	}
+
+	return scan.matches;
+}
+
+size_t store_memory(RecordStore store) {
+	return sizeof(*store)
+		+ vector_memory(store->blocks) + store->blocks_memory
+		+ BLOCK_RECORDS * sizeof(struct pending)
+		+ dictionary_memory(&store->names) + dictionary_memory(&store->diseases) + dictionary_memory(&store->countries)
+		+ vector_memory(store->chunks) + store->chunks_memory;
+}
+
+void store_destroy(RecordStore store) {
+	vector_destroy(store->blocks);
+	free(store->open);
+	dictionary_destroy(&store->names);
+	dictionary_destroy(&store->diseases);
+	dictionary_destroy(&store->countries);
+	vector_destroy(store->chunks);
+	free(store);
+}
@@ -0,0 +1,523 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του Shared Replica μέσω POSIX shared memory,
+// με δύο slots και ένα seqlock ανά slot.
+//
+///////////////////////////////////////////////////////////
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SharedReplica.h"
+#include "ADTList.h"
+#include "ADTMap.h"
+
+
+// Κάθε region αρχίζει με αυτά τα 8 bytes (το τελευταίο είναι η έκδοση του format)
+static const char magic[8] = { 'D', 'M', 'R', 'E', 'P', 'L', 'C', 1 };
+
+#define NO_STRING UINT32_MAX		// Για τα κριτήρια που δεν ισχύουν σε ένα replica_index
+
+// Η αρχή του region. Ακολουθούν τα δύο slots, το καθένα capacity bytes. Το τελευταίο byte κάθε slot
+// δεν γράφεται ποτέ (μένει 0), ώστε κάθε string που αρχίζει μέσα στο slot να τελειώνει επίσης μέσα σε
+// αυτό, ακόμα και όταν ο reader διαβάζει ένα slot που ξαναγράφεται.
+
+struct region {
+	char magic[8];
+	uint64_t capacity;
+	_Atomic uint32_t current;				// Το slot με την πιο πρόσφατη εικόνα
+	_Atomic uint64_t sequences[2];			// Seqlock κάθε slot, μονό όσο γράφεται
+};
+
+// Η εικόνα σε ένα slot: header, records (κατά ημερομηνία και id), indexes ταξινομημένα κατά (country,
+// disease), οι θέσεις των records κάθε index και τα strings. Τα offsets είναι από την αρχή του slot.
+
+struct slot_header {
+	uint64_t version;
+	int32_t size;					// Πλήθος records
+	int32_t indexes;
+	uint32_t records;				// Offset του πίνακα με τα replica_record
+	uint32_t index_table;			// Offset του πίνακα με τα replica_index
+};
+
+struct replica_record {
+	int32_t id;
+	uint32_t name, date, disease, country;		// Offsets των strings
+};
+
+struct replica_index {
+	uint32_t country, disease;		// Offsets των strings, ή NO_STRING
+	int32_t size;
+	uint32_t positions;				// Offset πίνακα με size int32_t, θέσεις στον πίνακα records
+};
+
+struct replica_writer {
+	String name;
+	struct region* region;
+	size_t size;					// Το μέγεθος του mmap
+	uint64_t version;
+};
+
+struct replica {
+	struct region* region;
+	size_t size;
+};
+
+
+// Η αρχή των slots, στοιχισμένη στα 8 bytes
+#define SLOTS_OFFSET ((sizeof(struct region) + 7) / 8 * 8)
+
+static uint8_t* slot_data(struct region* region, uint32_t slot) {
+	return (uint8_t*)region + SLOTS_OFFSET + slot * region->capacity;
+}
+
+static int compare_strings(Pointer a, Pointer b) {
+	return strcmp(a, b);
+}
+
+// Τα NULL (όλες οι χώρες / ασθένειες) πριν από κάθε string
+
+static int compare_nullable(String a, String b) {
+	if (a == NULL || b == NULL)
+		return (a != NULL) - (b != NULL);
+	return strcmp(a, b);
+}
+
+
+// Writer //////////////////////////////////////////////////////////////////////
+
+// Ένα index της εικόνας που γράφεται
+
+typedef struct key_index* KeyIndex;
+
+struct key_index {
+	String country;					// NULL για όλες τις χώρες
+	String disease;					// NULL για όλες τις ασθένειες
+	int size;
+	int32_t* positions;				// Η επόμενη ελεύθερη θέση του index στο slot
+};
+
+static int compare_keys(KeyIndex a, KeyIndex b) {
+	int res = compare_nullable(a->country, b->country);
+	return res != 0 ? res : compare_nullable(a->disease, b->disease);
+}
+
+static int compare_key_pointers(const void* a, const void* b) {
+	return compare_keys(*(KeyIndex*)a, *(KeyIndex*)b);
+}
+
+static uint hash_key(KeyIndex key) {
+	return (key->country != NULL ? hash_string(key->country) : 0) * 31
+		+ (key->disease != NULL ? hash_string(key->disease) : 0);
+}
+
+// Επιστρέφει το index του (country, disease), δημιουργώντας το αν δεν υπάρχει
+
+static KeyIndex key_get(Map keys, String country, String disease) {
+	struct key_index probe = { .country = country, .disease = disease };
+	KeyIndex key = map_find(keys, &probe);
+	if (key == NULL) {
+		key = malloc(sizeof(*key));
+		*key = probe;
+		key->size = 0;
+		key->positions = NULL;
+		map_insert(keys, key, key);
+	}
+	return key;
+}
+
+// Προσθέτει το s στα strings (αν δεν υπάρχει ήδη) και επιστρέφει το offset του. Με data == NULL απλά
+// μετράει το μήκος τους.
+
+static uint32_t add_string(Map strings, uint8_t* data, uint64_t* end, String s) {
+	if (s == NULL)
+		return NO_STRING;
+
+	uint32_t offset = (uintptr_t)map_find(strings, s);		// ποτέ 0, τα strings είναι μετά το header
+	if (offset == 0) {
+		offset = *end;
+		size_t length = strlen(s) + 1;
+		if (data != NULL)
+			memcpy(data + offset, s, length);
+		*end += length;
+		map_insert(strings, s, (Pointer)(uintptr_t)offset);
+	}
+	return offset;
+}
+
+// Γράφει την εικόνα των records στο slot (αν χωράει), με τη σειρά που απαιτεί το seqlock
+
+static bool write_slot(ReplicaWriter writer, uint32_t slot, Record records[], int n) {
+	struct region* region = writer->region;
+
+	// Τα indexes: όλες οι εγγραφές, ανά χώρα, ανά ασθένεια και ανά ζεύγος
+	Map keys = map_create((CompareFunc)compare_keys, NULL, free);
+	map_set_hash_function(keys, (HashFunc)hash_key);
+	key_get(keys, NULL, NULL)->size = n;
+	for (int i = 0; i < n; i++) {
+		key_get(keys, records[i]->country, NULL)->size++;
+		key_get(keys, NULL, records[i]->disease)->size++;
+		key_get(keys, records[i]->country, records[i]->disease)->size++;
+	}
+
+	int indexes = map_size(keys);
+	KeyIndex* sorted = malloc(indexes * sizeof(KeyIndex));
+	int k = 0;
+	for (MapNode node = map_first(keys); node != MAP_EOF; node = map_next(keys, node))
+		sorted[k++] = map_node_value(keys, node);
+	qsort(sorted, indexes, sizeof(KeyIndex), compare_key_pointers);
+
+	// Πρώτα μετράμε το μήκος των strings, για να ξέρουμε αν η εικόνα χωράει
+	uint64_t strings = sizeof(struct slot_header) + (uint64_t)n * sizeof(struct replica_record)
+		+ indexes * sizeof(struct replica_index) + 4 * (uint64_t)n * sizeof(int32_t);
+	uint64_t end = strings;
+	Map offsets = map_create(compare_strings, NULL, NULL);
+	map_set_hash_function(offsets, hash_string);
+	for (int i = 0; i < n && end < region->capacity; i++) {
+		add_string(offsets, NULL, &end, records[i]->name);
+		add_string(offsets, NULL, &end, records[i]->date);
+		add_string(offsets, NULL, &end, records[i]->disease);
+		add_string(offsets, NULL, &end, records[i]->country);
+	}
+	map_destroy(offsets);
+
+	bool fits = end < region->capacity && end <= UINT32_MAX;
+	if (fits) {
+		// Το seqlock είναι μονό όσο γράφεται το slot, ώστε όποιος reader το διαβάζει να ξαναπροσπαθήσει
+		uint64_t sequence = atomic_load_explicit(&region->sequences[slot], memory_order_relaxed);
+		atomic_store_explicit(&region->sequences[slot], sequence + 1, memory_order_relaxed);
+		atomic_thread_fence(memory_order_release);
+
+		uint8_t* data = slot_data(region, slot);
+		struct slot_header* header = (struct slot_header*)data;
+		header->version = writer->version;
+		header->size = n;
+		header->indexes = indexes;
+		header->records = sizeof(struct slot_header);
+		header->index_table = header->records + n * sizeof(struct replica_record);
+
+		end = strings;
+		offsets = map_create(compare_strings, NULL, NULL);
+		map_set_hash_function(offsets, hash_string);
+
+		struct replica_index* table = (struct replica_index*)(data + header->index_table);
+		int32_t* positions = (int32_t*)(table + indexes);
+		for (int i = 0; i < indexes; i++) {
+			KeyIndex key = sorted[i];
+			table[i] = (struct replica_index){
+				.country = add_string(offsets, data, &end, key->country),
+				.disease = add_string(offsets, data, &end, key->disease),
+				.size = key->size,
+				.positions = (uint8_t*)positions - data,
+			};
+			key->positions = positions;
+			positions += key->size;
+		}
+
+		// Τα records είναι ήδη κατά ημερομηνία, οπότε και οι θέσεις κάθε index
+		struct replica_record* array = (struct replica_record*)(data + header->records);
+		KeyIndex all = key_get(keys, NULL, NULL);
+		for (int i = 0; i < n; i++) {
+			Record record = records[i];
+			array[i] = (struct replica_record){
+				.id = record->id,
+				.name = add_string(offsets, data, &end, record->name),
+				.date = add_string(offsets, data, &end, record->date),
+				.disease = add_string(offsets, data, &end, record->disease),
+				.country = add_string(offsets, data, &end, record->country),
+			};
+			*all->positions++ = i;
+			*key_get(keys, record->country, NULL)->positions++ = i;
+			*key_get(keys, NULL, record->disease)->positions++ = i;
+			*key_get(keys, record->country, record->disease)->positions++ = i;
+		}
+		map_destroy(offsets);
+
+		atomic_store_explicit(&region->sequences[slot], sequence + 2, memory_order_release);
+		atomic_store_explicit(&region->current, slot, memory_order_release);
+	}
+
+	free(sorted);
+	map_destroy(keys);
+	return fits;
+}
+
+ReplicaWriter replica_writer_create(String name, size_t capacity) {
+	capacity = ((capacity <= sizeof(struct slot_header) ? sizeof(struct slot_header) + 1 : capacity) + 7) / 8 * 8;
+	size_t size = SLOTS_OFFSET + 2 * capacity;
+
+	shm_unlink(name);
+	int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0)
+		return NULL;
+
+	struct region* region = MAP_FAILED;
+	if (ftruncate(fd, size) == 0)
+		region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (region == MAP_FAILED) {
+		shm_unlink(name);
+		return NULL;
+	}
+
+	ReplicaWriter writer = malloc(sizeof(*writer));
+	writer->name = strdup(name);
+	writer->region = region;
+	writer->size = size;
+	writer->version = 0;
+
+	// Το ftruncate γεμίζει με 0, οπότε αρκεί μια κενή εικόνα στο slot 0. Το magic γράφεται τελευταίο.
+	region->capacity = capacity;
+	write_slot(writer, 0, NULL, 0);
+	atomic_thread_fence(memory_order_release);
+	memcpy(region->magic, magic, sizeof(magic));
+	return writer;
+}
+
+bool replica_publish(ReplicaWriter writer, Record records[], int n) {
+	uint32_t slot = 1 - atomic_load_explicit(&writer->region->current, memory_order_relaxed);
+	writer->version++;
+	if (!write_slot(writer, slot, records, n)) {
+		writer->version--;
+		return false;
+	}
+	return true;
+}
+
+void replica_writer_destroy(ReplicaWriter writer) {
+	munmap(writer->region, writer->size);
+	shm_unlink(writer->name);
+	free(writer->name);
+	free(writer);
+}
+
+
+// Reader //////////////////////////////////////////////////////////////////////
+
+Replica replica_attach(String name) {
+	int fd = shm_open(name, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	struct region* region = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)SLOTS_OFFSET)
+		region = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (region == MAP_FAILED)
+		return NULL;
+
+	if (memcmp(region->magic, magic, sizeof(magic)) != 0 || SLOTS_OFFSET + 2 * region->capacity != (uint64_t)st.st_size) {
+		munmap(region, st.st_size);
+		return NULL;
+	}
+
+	Replica replica = malloc(sizeof(*replica));
+	replica->region = region;
+	replica->size = st.st_size;
+	return replica;
+}
+
+// Ένα query στην εικόνα ενός slot. Τα δεδομένα μπορεί να αλλάζουν την ώρα που τα διαβάζουμε (αν ο writer
+// ξαναγράφει το slot), οπότε κάθε offset ελέγχεται πριν χρησιμοποιηθεί: ένα άκυρο offset απλά κάνει το
+// query να αποτύχει, και το seqlock θα δείξει ότι πρέπει να επαναληφθεί.
+
+struct query {
+	uint8_t* data;					// Το slot
+	uint64_t capacity;
+	String disease;
+	String country;
+	Date date_from;
+	Date date_to;
+	List result;					// Αν δεν είναι NULL προστίθενται εδώ οι εγγραφές
+	int count;
+};
+
+// Το string στο offset του slot, ή NULL αν το offset είναι εκτός slot (τελειώνει πάντα μέσα στο slot,
+// λόγω του τελευταίου byte)
+
+static String slot_string(struct query* query, uint32_t offset) {
+	return offset < query->capacity ? (String)query->data + offset : NULL;
+}
+
+// Το record στη θέση position, ή NULL αν δεν είναι έγκυρο
+
+static struct replica_record* slot_record(struct query* query, int32_t size, uint32_t records, int32_t position) {
+	if (position < 0 || position >= size)
+		return NULL;
+	return (struct replica_record*)(query->data + records) + position;
+}
+
+// Το πλήθος των records του index με ημερομηνία < date, ή <= date αν inclusive == true, ή -1
+
+static int slot_rank(struct query* query, int32_t size, uint32_t records, int32_t* positions, int index_size, Date date, bool inclusive) {
+	int lo = 0, hi = index_size;
+	while (lo < hi) {
+		int mid = lo + (hi - lo) / 2;
+		struct replica_record* record = slot_record(query, size, records, positions[mid]);
+		String record_date = record != NULL ? slot_string(query, record->date) : NULL;
+		if (record_date == NULL)
+			return -1;
+
+		int res = strcmp(record_date, date);
+		if (res < 0 || (inclusive && res == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// Αντίγραφο του record, σε ένα μόνο block μαζί με τα strings του
+
+static Record record_copy(int id, String name, String date, String disease, String country) {
+	size_t lengths[] = { strlen(name) + 1, strlen(date) + 1, strlen(disease) + 1, strlen(country) + 1 };
+	Record record = malloc(sizeof(*record) + lengths[0] + lengths[1] + lengths[2] + lengths[3]);
+	char* s = (char*)(record + 1);
+
+	record->id = id;
+	record->name = memcpy(s, name, lengths[0]);
+	record->date = memcpy(s += lengths[0], date, lengths[1]);
+	record->disease = memcpy(s += lengths[1], disease, lengths[2]);
+	record->country = memcpy(s += lengths[2], country, lengths[3]);
+	return record;
+}
+
+// Εκτελεί το query στο slot. Επιστρέφει false αν η εικόνα δεν είναι έγκυρη.
+
+static bool slot_query(struct query* query) {
+	struct slot_header* header = (struct slot_header*)query->data;
+	uint64_t capacity = query->capacity;
+	query->count = 0;
+
+	// Κάθε τιμή διαβάζεται μία φορά, ώστε να χρησιμοποιείται αυτή που ελέγχθηκε
+	int32_t size = header->size, indexes = header->indexes;
+	uint32_t records = header->records, index_table = header->index_table;
+	if (size < 0 || indexes < 0 || records > capacity || index_table > capacity
+		|| (uint64_t)size * sizeof(struct replica_record) > capacity - records
+		|| (uint64_t)indexes * sizeof(struct replica_index) > capacity - index_table)
+		return false;
+
+	// Δυαδική αναζήτηση του index (country, disease)
+	struct replica_index* table = (struct replica_index*)(query->data + index_table);
+	struct replica_index* index = NULL;
+	int lo = 0, hi = indexes;
+	while (lo < hi && index == NULL) {
+		int mid = lo + (hi - lo) / 2;
+		uint32_t country_offset = table[mid].country, disease_offset = table[mid].disease;
+		String country = country_offset != NO_STRING ? slot_string(query, country_offset) : NULL;
+		String disease = disease_offset != NO_STRING ? slot_string(query, disease_offset) : NULL;
+		if ((country == NULL && country_offset != NO_STRING) || (disease == NULL && disease_offset != NO_STRING))
+			return false;
+
+		int res = compare_nullable(country, query->country);
+		if (res == 0)
+			res = compare_nullable(disease, query->disease);
+		if (res == 0)
+			index = &table[mid];
+		else if (res < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (index == NULL)
+		return true;			// καμία εγγραφή
+
+	int32_t index_size = index->size;
+	uint32_t index_positions = index->positions;
+	if (index_size < 0 || index_positions > capacity || (uint64_t)index_size * sizeof(int32_t) > capacity - index_positions)
+		return false;
+	int32_t* positions = (int32_t*)(query->data + index_positions);
+
+	int start = query->date_from != NULL ? slot_rank(query, size, records, positions, index_size, query->date_from, false) : 0;
+	int end = query->date_to != NULL ? slot_rank(query, size, records, positions, index_size, query->date_to, true) : index_size;
+	if (start < 0 || end < 0)
+		return false;
+	if (end <= start)
+		return true;
+
+	query->count = end - start;
+	if (query->result == NULL)
+		return true;
+
+	for (int i = start; i < end; i++) {
+		struct replica_record* record = slot_record(query, size, records, positions[i]);
+		if (record == NULL)
+			return false;
+
+		String name = slot_string(query, record->name);
+		String date = slot_string(query, record->date);
+		String disease = slot_string(query, record->disease);
+		String country = slot_string(query, record->country);
+		if (name == NULL || date == NULL || disease == NULL || country == NULL)
+			return false;
+		list_insert_next(query->result, list_last(query->result), record_copy(record->id, name, date, disease, country));
+	}
+	return true;
+}
+
+// Εκτελεί το query στο τρέχον slot, μέχρι να ολοκληρωθεί χωρίς να το αλλάξει ο writer. Επιστρέφει false
+// μόνο αν η εικόνα δεν είναι έγκυρη ενώ κανείς δεν τη γράφει.
+
+static bool replica_query(Replica replica, struct query* query) {
+	struct region* region = replica->region;
+	query->capacity = region->capacity;
+
+	while (true) {
+		uint32_t slot = atomic_load_explicit(&region->current, memory_order_acquire) & 1;
+		uint64_t sequence = atomic_load_explicit(&region->sequences[slot], memory_order_acquire);
+		if (sequence & 1)
+			continue;				// ο writer γράφει ακόμα το slot
+
+		query->data = slot_data(region, slot);
+		if (query->result != NULL && list_size(query->result) > 0) {
+			list_destroy(query->result);
+			query->result = list_create(free);
+		}
+		bool valid = slot_query(query);
+
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&region->sequences[slot], memory_order_relaxed) == sequence)
+			return valid;
+	}
+}
+
+uint64_t replica_version(Replica replica) {
+	struct region* region = replica->region;
+	while (true) {
+		uint32_t slot = atomic_load_explicit(&region->current, memory_order_acquire) & 1;
+		uint64_t sequence = atomic_load_explicit(&region->sequences[slot], memory_order_acquire);
+		if (sequence & 1)
+			continue;
+
+		uint64_t version = ((struct slot_header*)slot_data(region, slot))->version;
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&region->sequences[slot], memory_order_relaxed) == sequence)
+			return version;
+	}
+}
+
+List replica_get_records(Replica replica, String disease, String country, Date date_from, Date date_to) {
+	struct query query = { .disease = disease, .country = country, .date_from = date_from, .date_to = date_to };
+	query.result = list_create(free);
+	if (!replica_query(replica, &query)) {
+		list_destroy(query.result);
+		return list_create(free);
+	}
+	return query.result;
+}
+
+int replica_count_records(Replica replica, String disease, String country, Date date_from, Date date_to) {
+	struct query query = { .disease = disease, .country = country, .date_from = date_from, .date_to = date_to, .result = NULL };
+	return replica_query(replica, &query) ? query.count : 0;
+}
+
+void replica_detach(Replica replica) {
+	munmap(replica->region, replica->size);
+	free(replica);
+}
@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση των histograms και των μετρητών του Stats.
+//
+///////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <time.h>
+
+#include "Stats.h"
+
+
+const char* stat_counter_names[STAT_COUNTERS_NO] = {
+	"set_compares", "set_rotations", "set_node_allocs",
+	"map_lookups", "map_compares", "map_rehashes", "map_node_allocs",
+	"list_node_allocs", "vector_resizes", "arena_slab_allocs",
+	"trie_node_allocs", "vset_node_allocs", "vset_node_copies",
+};
+
+const char* stat_op_names[STAT_OPS_NO] = {
+	"insert_record", "remove_record", "update_record",
+	"get_records", "count_records", "top_diseases",
+	"insert_records", "count_records_batch", "find_by_name_prefix",
+	"date_percentile", "top_countries", "count_by_country", "count_by_disease",
+	"get_records_page", "sample_records", "checkpoint",
+};
+
+uint64_t stat_counters[STAT_COUNTERS_NO];
+struct histogram stat_histograms[STAT_OPS_NO];
+
+
+// Επιστρέφει το bucket στο οποίο ανήκει η τιμή value
+
+static int bucket_index(uint64_t value) {
+	if (value < HISTOGRAM_SUB_BUCKETS)
+		return value;
+
+	// Η θέση του μεγαλύτερου bit καθορίζει τη δύναμη του 2, τα επόμενα HISTOGRAM_SUB_BITS bits το bucket μέσα σε αυτή
+	int exp = 63 - __builtin_clzll(value);
+	if (exp > HISTOGRAM_MAX_BITS)
+		return HISTOGRAM_BUCKETS - 1;
+
+	int shift = exp - HISTOGRAM_SUB_BITS;
+	return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)(value >> shift) - HISTOGRAM_SUB_BUCKETS;
+}
+
+// Επιστρέφει μια αντιπροσωπευτική τιμή (το μέσο) του bucket index
+
+static uint64_t bucket_value(int index) {
+	if (index < HISTOGRAM_SUB_BUCKETS)
+		return index;
+
+	int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+	uint64_t low = (uint64_t)(HISTOGRAM_SUB_BUCKETS + index % HISTOGRAM_SUB_BUCKETS) << shift;
+	return low + ((uint64_t)1 << shift) / 2;
+}
+
+void histogram_record(Histogram histogram, uint64_t value) {
+	__atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&histogram->buckets[bucket_index(value)], 1, __ATOMIC_RELAXED);
+
+	uint64_t max = __atomic_load_n(&histogram->max, __ATOMIC_RELAXED);
+	while (value > max && !__atomic_compare_exchange_n(&histogram->max, &max, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+
+uint64_t histogram_percentile(Histogram histogram, double p) {
+	if (histogram->count == 0)
+		return 0;
+
+	// Η θέση (1-based) της τιμής στη σειρά διάταξης
+	uint64_t rank = (uint64_t)(p / 100 * histogram->count + 0.5);
+	if (rank < 1)
+		rank = 1;
+
+	uint64_t seen = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += histogram->buckets[i];
+		if (seen >= rank) {
+			// Η τιμή του bucket είναι κατά προσέγγιση, δεν ξεπερνάμε όμως το πραγματικό max
+			uint64_t value = bucket_value(i);
+			return value < histogram->max ? value : histogram->max;
+		}
+	}
+	return histogram->max;
+}
+
+void histogram_merge(Histogram histogram, Histogram other) {
+	histogram->count += other->count;
+	histogram->sum += other->sum;
+	if (other->max > histogram->max)
+		histogram->max = other->max;
+
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		histogram->buckets[i] += other->buckets[i];
+}
+
+void histogram_reset(Histogram histogram) {
+	memset(histogram, 0, sizeof(*histogram));
+}
+
+uint64_t stats_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void stats_reset() {
+	memset(stat_counters, 0, sizeof(stat_counters));
+	for (int i = 0; i < STAT_OPS_NO; i++)
+		histogram_reset(&stat_histograms[i]);
+}
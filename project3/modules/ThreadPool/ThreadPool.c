@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του Thread Pool μέσω POSIX threads.
+//
+///////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "ThreadPool.h"
+
+
+// Οι workers περιμένουν στο work_ready μέχρι να αλλάξει το generation (νέα pool_run)
+// ή να ζητηθεί τερματισμός. Οι εργασίες μιας pool_run μοιράζονται δυναμικά μέσω του
+// next: κάθε νήμα παίρνει την επόμενη ελεύθερη θέση του args μέχρι να τελειώσουν.
+struct thread_pool {
+	pthread_t* workers;			// threads - 1 workers
+	int threads;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t work_ready;	// σήμα προς τους workers: νέες εργασίες ή τερματισμός
+	pthread_cond_t work_done;	// σήμα προς την pool_run: ένας worker τελείωσε
+
+	TaskFunc task;				// Οι εργασίες της τρέχουσας pool_run
+	Pointer* args;
+	int n;
+	int next;					// Η επόμενη εργασία που δεν έχει ανατεθεί
+	int busy;					// Πόσοι workers δουλεύουν ακόμα στην τρέχουσα pool_run
+	int generation;				// Αυξάνεται σε κάθε pool_run
+	bool stop;
+};
+
+
+// Εκτελεί εργασίες της τρέχουσας pool_run μέχρι να μην υπάρχουν άλλες.
+// Καλείται με το mutex κλειδωμένο, και επιστρέφει επίσης με αυτό κλειδωμένο.
+
+static void run_tasks(ThreadPool pool) {
+	while (pool->next < pool->n) {
+		int i = pool->next++;
+
+		pthread_mutex_unlock(&pool->mutex);
+		pool->task(pool->args[i]);
+		pthread_mutex_lock(&pool->mutex);
+	}
+}
+
+static void* worker(void* arg) {
+	ThreadPool pool = arg;
+	int seen = 0;				// το τελευταίο generation που εξυπηρετήσαμε
+
+	pthread_mutex_lock(&pool->mutex);
+	while (true) {
+		while (!pool->stop && pool->generation == seen)
+			pthread_cond_wait(&pool->work_ready, &pool->mutex);
+
+		if (pool->stop)
+			break;
+
+		seen = pool->generation;
+		run_tasks(pool);
+
+		if (--pool->busy == 0)
+			pthread_cond_signal(&pool->work_done);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	return NULL;
+}
+
+ThreadPool pool_create(int threads) {
+	assert(threads >= 1);		// LCOV_EXCL_LINE
+
+	ThreadPool pool = malloc(sizeof(*pool));
+	pool->threads = threads;
+	pool->n = pool->next = pool->busy = pool->generation = 0;
+	pool->stop = false;
+
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->work_ready, NULL);
+	pthread_cond_init(&pool->work_done, NULL);
+
+	pool->workers = malloc((threads - 1) * sizeof(pthread_t));
+	for (int i = 0; i < threads - 1; i++)
+		pthread_create(&pool->workers[i], NULL, worker, pool);
+
+	return pool;
+}
+
+int pool_threads(ThreadPool pool) {
+	return pool->threads;
+}
+
+void pool_run(ThreadPool pool, TaskFunc task, Pointer args[], int n) {
+	pthread_mutex_lock(&pool->mutex);
+
+	pool->task = task;
+	pool->args = args;
+	pool->n = n;
+	pool->next = 0;
+	pool->busy = pool->threads - 1;
+	pool->generation++;
+	pthread_cond_broadcast(&pool->work_ready);
+
+	// Το thread που καλεί δουλεύει κι αυτό, και μετά περιμένει τους workers
+	run_tasks(pool);
+	while (pool->busy > 0)
+		pthread_cond_wait(&pool->work_done, &pool->mutex);
+
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void pool_destroy(ThreadPool pool) {
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = true;
+	pthread_cond_broadcast(&pool->work_ready);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (int i = 0; i < pool->threads - 1; i++)
+		pthread_join(pool->workers[i], NULL);
+
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_cond_destroy(&pool->work_ready);
+	pthread_cond_destroy(&pool->work_done);
+	free(pool->workers);
+	free(pool);
+}
@@ -0,0 +1,422 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του Trace μέσω buffered stdio και varints.
+//
+///////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Trace.h"
+#include "ADTMap.h"
+#include "ADTVector.h"
+#include "Stats.h"
+
+
+// Κάθε trace αρχίζει με αυτά τα 8 bytes (το τελευταίο είναι η έκδοση του format)
+static const char magic[8] = { 'D', 'M', 'T', 'R', 'A', 'C', 'E', 1 };
+
+// Τα bits του byte που δείχνει ποια κριτήρια ενός query δεν είναι NULL
+#define HAS_DISEASE		1
+#define HAS_COUNTRY		2
+#define HAS_DATE_FROM	4
+#define HAS_DATE_TO		8
+#define NEWEST_FIRST	16			// μόνο στην TRACE_GET_RECORDS_PAGE
+
+struct trace_writer {
+	FILE* file;
+	uint64_t start;				// Ο χρόνος δημιουργίας του writer
+	uint64_t last;				// Ο χρόνος της τελευταίας λειτουργίας, από το start
+	Map strings;				// Το λεξικό: String => int* (η θέση του string)
+};
+
+// Τα strings που διαβάζονται σε κάθε trace_read, εκτός λεξικού
+enum { BUFFER_NAME, BUFFER_DATE, BUFFER_DATE_FROM, BUFFER_DATE_TO, BUFFER_PREFIX, BUFFERS_NO };
+#define STRING_CHUNK	4096		// Τα bytes ενός string διαβάζονται σε κομμάτια το πολύ τόσων
+
+struct trace_reader {
+	FILE* file;
+	uint64_t time;				// Ο χρόνος της τελευταίας λειτουργίας
+	Vector strings;				// Το λεξικό, με τη σειρά που εμφανίζονται τα strings
+	char* buffers[BUFFERS_NO];
+	uint64_t capacities[BUFFERS_NO];
+};
+
+
+static int compare_strings(Pointer a, Pointer b) {
+	return strcmp(a, b);
+}
+
+// Zigzag κωδικοποίηση, ώστε και οι μικροί αρνητικοί να γράφονται σε λίγα bytes
+
+static uint64_t zigzag_encode(int value) {
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int zigzag_decode(uint64_t value) {
+	return (int)((uint32_t)(value >> 1) ^ -(uint32_t)(value & 1));
+}
+
+
+// Writer //////////////////////////////////////////////////////////////////////
+
+// Varint (LEB128): 7 bits ανά byte, το μεγαλύτερο bit δείχνει ότι ακολουθούν κι άλλα
+
+static void write_uint(TraceWriter writer, uint64_t value) {
+	while (value >= 0x80) {
+		putc((value & 0x7F) | 0x80, writer->file);
+		value >>= 7;
+	}
+	putc(value, writer->file);
+}
+
+static void write_string(TraceWriter writer, String s) {
+	size_t len = strlen(s);
+	write_uint(writer, len);
+	fwrite(s, 1, len, writer->file);
+}
+
+// Γράφει τη θέση του s στο λεξικό. Αν το s δεν υπάρχει, η θέση είναι το μέγεθος του λεξικού,
+// και ακολουθεί το ίδιο το string.
+
+static void write_dict(TraceWriter writer, String s) {
+	int* pos = map_find(writer->strings, s);
+	if (pos != NULL) {
+		write_uint(writer, *pos);
+		return;
+	}
+
+	pos = malloc(sizeof(*pos));
+	*pos = map_size(writer->strings);
+	map_insert(writer->strings, strdup(s), pos);
+
+	write_uint(writer, *pos);
+	write_string(writer, s);
+}
+
+// Ένα double ως τα 8 bytes της αναπαράστασής του, από το λιγότερο σημαντικό
+
+static void write_double(TraceWriter writer, double value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	for (int i = 0; i < 8; i++)
+		putc((bits >> (8 * i)) & 0xFF, writer->file);
+}
+
+// Τα κριτήρια ενός query: ένα byte με τα bits HAS_* (και όσα extra δοθούν), και μετά όσα δεν είναι NULL
+
+static void write_query(TraceWriter writer, TraceOp op, int extra) {
+	putc((op->disease != NULL ? HAS_DISEASE : 0) | (op->country != NULL ? HAS_COUNTRY : 0) |
+		(op->date_from != NULL ? HAS_DATE_FROM : 0) | (op->date_to != NULL ? HAS_DATE_TO : 0) | extra, writer->file);
+	if (op->disease != NULL)
+		write_dict(writer, op->disease);
+	if (op->country != NULL)
+		write_dict(writer, op->country);
+	if (op->date_from != NULL)
+		write_string(writer, op->date_from);
+	if (op->date_to != NULL)
+		write_string(writer, op->date_to);
+}
+
+static void write_record(TraceWriter writer, Record record) {
+	write_uint(writer, zigzag_encode(record->id));
+	write_dict(writer, record->disease);
+	write_dict(writer, record->country);
+	write_string(writer, record->name);
+	write_string(writer, record->date);
+}
+
+TraceWriter trace_writer_create(String path) {
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+		return NULL;
+
+	TraceWriter writer = malloc(sizeof(*writer));
+	writer->file = file;
+	writer->start = stats_now();
+	writer->last = 0;
+	writer->strings = map_create(compare_strings, free, free);
+	map_set_hash_function(writer->strings, hash_string);
+
+	fwrite(magic, 1, sizeof(magic), file);
+	return writer;
+}
+
+void trace_write(TraceWriter writer, TraceOp op) {
+	op->time = stats_now() - writer->start;
+
+	putc(op->type, writer->file);
+	write_uint(writer, op->time - writer->last);
+	writer->last = op->time;
+
+	switch (op->type) {
+		case TRACE_INSERT:
+			write_record(writer, &op->record);
+			break;
+
+		case TRACE_REMOVE:
+			write_uint(writer, zigzag_encode(op->id));
+			break;
+
+		case TRACE_UPDATE:
+			write_uint(writer, zigzag_encode(op->id));
+			write_record(writer, &op->record);
+			break;
+
+		case TRACE_GET_RECORDS:
+		case TRACE_COUNT_RECORDS:
+		case TRACE_COUNT_BY_COUNTRY:
+		case TRACE_COUNT_BY_DISEASE:
+			write_query(writer, op, 0);
+			break;
+
+		// Στις top τα κριτήρια είναι μόνο το country ή μόνο το disease
+		case TRACE_TOP_DISEASES:
+		case TRACE_TOP_COUNTRIES:
+			write_uint(writer, zigzag_encode(op->k));
+			write_query(writer, op, 0);
+			break;
+
+		case TRACE_GET_RECORDS_PAGE:
+			write_query(writer, op, op->newest_first ? NEWEST_FIRST : 0);
+			write_uint(writer, zigzag_encode(op->offset));
+			write_uint(writer, zigzag_encode(op->limit));
+			break;
+
+		case TRACE_SAMPLE_RECORDS:
+			write_uint(writer, zigzag_encode(op->k));
+			write_query(writer, op, 0);
+			write_uint(writer, op->seed);
+			break;
+
+		case TRACE_FIND_BY_NAME_PREFIX:
+			write_string(writer, op->prefix);
+			write_uint(writer, zigzag_encode(op->limit));
+			break;
+
+		case TRACE_DATE_PERCENTILE:
+			write_query(writer, op, 0);
+			write_double(writer, op->p);
+			break;
+
+		// Τα ονόματα των περιοχών επαναλαμβάνονται, οπότε μπαίνουν κι αυτά στο λεξικό
+		case TRACE_SET_REGION:
+			write_dict(writer, op->country);
+			write_dict(writer, op->region);
+			putc(op->continent != NULL, writer->file);
+			if (op->continent != NULL)
+				write_dict(writer, op->continent);
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool trace_writer_destroy(TraceWriter writer) {
+	// Τα λάθη των putc / fwrite μένουν στο ferror, και της εγγραφής του buffer στο fclose
+	bool ok = !ferror(writer->file);
+	ok = fclose(writer->file) == 0 && ok;
+	map_destroy(writer->strings);
+	free(writer);
+	return ok;
+}
+
+
+// Reader //////////////////////////////////////////////////////////////////////
+
+static bool read_uint(TraceReader reader, uint64_t* value) {
+	*value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		int c = getc(reader->file);
+		if (c == EOF)
+			return false;
+
+		*value |= (uint64_t)(c & 0x7F) << shift;
+		if (!(c & 0x80))
+			return true;
+	}
+	return false;			// πάνω από 10 bytes, κατεστραμμένο αρχείο
+}
+
+static bool read_int(TraceReader reader, int* value) {
+	uint64_t u;
+	if (!read_uint(reader, &u))
+		return false;
+	*value = zigzag_decode(u);
+	return true;
+}
+
+// Μεγαλώνει το buffer i ώστε να χωράει τουλάχιστον size bytes. Επιστρέφει false αν η realloc αποτύχει.
+
+static bool reserve_buffer(TraceReader reader, int i, uint64_t size) {
+	if (size <= reader->capacities[i])
+		return true;
+
+	uint64_t capacity = size > 2 * reader->capacities[i] ? size : 2 * reader->capacities[i];
+	char* buffer = realloc(reader->buffers[i], capacity);
+	if (buffer == NULL)
+		return false;
+
+	reader->buffers[i] = buffer;
+	reader->capacities[i] = capacity;
+	return true;
+}
+
+// Διαβάζει ένα string στο buffer i
+
+static bool read_string(TraceReader reader, int i, String* s) {
+	uint64_t len;
+	if (!read_uint(reader, &len))
+		return false;
+
+	// Το buffer μεγαλώνει μόνο όσο διαβάζονται πραγματικά bytes, ώστε ένα αλλοιωμένο len (μεγαλύτερο από
+	// όσα απομένουν στο αρχείο) να καταλήγει στο τέλος του αρχείου και όχι σε μια τεράστια δέσμευση
+	uint64_t done = 0;
+	do {
+		uint64_t chunk = len - done < STRING_CHUNK ? len - done : STRING_CHUNK;
+		if (!reserve_buffer(reader, i, done + chunk + 1) || fread(reader->buffers[i] + done, 1, chunk, reader->file) != chunk)
+			return false;
+		done += chunk;
+	} while (done < len);
+
+	reader->buffers[i][len] = '\0';
+	*s = reader->buffers[i];
+	return true;
+}
+
+static bool read_dict(TraceReader reader, String* s) {
+	uint64_t pos;
+	if (!read_uint(reader, &pos) || pos > (uint64_t)vector_size(reader->strings))
+		return false;
+
+	// Νέο string, το διαβάζουμε και το προσθέτουμε στο λεξικό
+	if (pos == (uint64_t)vector_size(reader->strings)) {
+		String temp;
+		if (!read_string(reader, BUFFER_NAME, &temp))
+			return false;
+		vector_insert_last(reader->strings, strdup(temp));
+	}
+
+	*s = vector_get_at(reader->strings, pos);
+	return true;
+}
+
+static bool read_double(TraceReader reader, double* value) {
+	uint64_t bits = 0;
+	for (int i = 0; i < 8; i++) {
+		int c = getc(reader->file);
+		if (c == EOF)
+			return false;
+		bits |= (uint64_t)c << (8 * i);
+	}
+	memcpy(value, &bits, sizeof(bits));
+	return true;
+}
+
+// Διαβάζει τα κριτήρια που έγραψε η write_query, και αποθηκεύει στο flags το byte με τα bits
+
+static bool read_query(TraceReader reader, TraceOp op, int* flags) {
+	if ((*flags = getc(reader->file)) == EOF)
+		return false;
+	return (!(*flags & HAS_DISEASE) || read_dict(reader, &op->disease))
+		&& (!(*flags & HAS_COUNTRY) || read_dict(reader, &op->country))
+		&& (!(*flags & HAS_DATE_FROM) || read_string(reader, BUFFER_DATE_FROM, &op->date_from))
+		&& (!(*flags & HAS_DATE_TO) || read_string(reader, BUFFER_DATE_TO, &op->date_to));
+}
+
+static bool read_record(TraceReader reader, Record record) {
+	return read_int(reader, &record->id)
+		&& read_dict(reader, &record->disease)
+		&& read_dict(reader, &record->country)
+		&& read_string(reader, BUFFER_NAME, &record->name)
+		&& read_string(reader, BUFFER_DATE, &record->date);
+}
+
+TraceReader trace_reader_create(String path) {
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return NULL;
+
+	char header[sizeof(magic)];
+	if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, magic, sizeof(magic)) != 0) {
+		fclose(file);
+		return NULL;
+	}
+
+	TraceReader reader = malloc(sizeof(*reader));
+	reader->file = file;
+	reader->time = 0;
+	reader->strings = vector_create(0, free);
+	for (int i = 0; i < BUFFERS_NO; i++) {
+		reader->buffers[i] = NULL;
+		reader->capacities[i] = 0;
+	}
+	return reader;
+}
+
+bool trace_read(TraceReader reader, TraceOp op) {
+	int type = getc(reader->file);
+	uint64_t delta;
+	if (type == EOF || type >= TRACE_OPS_NO || !read_uint(reader, &delta))
+		return false;
+
+	reader->time += delta;
+	op->type = type;
+	op->time = reader->time;
+	op->disease = op->country = op->date_from = op->date_to = op->prefix = op->region = op->continent = NULL;
+
+	int flags;
+	switch (op->type) {
+		case TRACE_INSERT:
+			return read_record(reader, &op->record);
+
+		case TRACE_REMOVE:
+			return read_int(reader, &op->id);
+
+		case TRACE_UPDATE:
+			return read_int(reader, &op->id) && read_record(reader, &op->record);
+
+		case TRACE_GET_RECORDS:
+		case TRACE_COUNT_RECORDS:
+		case TRACE_COUNT_BY_COUNTRY:
+		case TRACE_COUNT_BY_DISEASE:
+			return read_query(reader, op, &flags);
+
+		case TRACE_TOP_DISEASES:
+		case TRACE_TOP_COUNTRIES:
+			return read_int(reader, &op->k) && read_query(reader, op, &flags);
+
+		case TRACE_GET_RECORDS_PAGE:
+			if (!read_query(reader, op, &flags))
+				return false;
+			op->newest_first = (flags & NEWEST_FIRST) != 0;
+			return read_int(reader, &op->offset) && read_int(reader, &op->limit);
+
+		case TRACE_SAMPLE_RECORDS:
+			return read_int(reader, &op->k) && read_query(reader, op, &flags) && read_uint(reader, &op->seed);
+
+		case TRACE_FIND_BY_NAME_PREFIX:
+			return read_string(reader, BUFFER_PREFIX, &op->prefix) && read_int(reader, &op->limit);
+
+		case TRACE_DATE_PERCENTILE:
+			return read_query(reader, op, &flags) && read_double(reader, &op->p);
+
+		case TRACE_SET_REGION:
+			if (!read_dict(reader, &op->country) || !read_dict(reader, &op->region) || (flags = getc(reader->file)) == EOF)
+				return false;
+			return !flags || read_dict(reader, &op->continent);
+
+		default:
+			return false;
+	}
+}
+
+void trace_reader_destroy(TraceReader reader) {
+	fclose(reader->file);
+	vector_destroy(reader->strings);
+	for (int i = 0; i < BUFFERS_NO; i++)
+		free(reader->buffers[i]);
+	free(reader);
+}
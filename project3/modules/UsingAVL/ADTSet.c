@@ -8,6 +8,7 @@
 #include <assert.h>
 
 #include "ADTSet.h"
+#include "Stats.h"
 
 typedef void (*VisitFunc)(Pointer value);
 
@@ -22,8 +23,10 @@ struct set {
 // Ενώ το struct set_node είναι κόμβος ενός AVL Δέντρου Αναζήτησης
 struct set_node {
 	SetNode left, right;		// Παιδιά
+	SetNode parent;				// Πατέρας, NULL για τη ρίζα. Επιτρέπει διάσχιση και διαγραφή χωρίς αναζήτηση από τη ρίζα
 	Pointer value;				// Τιμή κόμβου
 	int height;					// Ύψος που βρίσκεται ο κόμβος στο δέντρο
+	int size;					// Πλήθος κόμβων του υποδέντρου με ρίζα τον κόμβο (για εύρεση κόμβου βάσει θέσης)
 };
 
 
@@ -35,6 +38,20 @@ static int int_max(int a, int b) {
 	return (a > b) ? a : b ;
 }
 
+// Θέτουν το αριστερό / δεξί παιδί του node, ενημερώνοντας και τον πατέρα του παιδιού
+
+static void node_set_left(SetNode node, SetNode child) {
+	node->left = child;
+	if (child != NULL)
+		child->parent = node;
+}
+
+static void node_set_right(SetNode node, SetNode child) {
+	node->right = child;
+	if (child != NULL)
+		child->parent = node;
+}
+
 // Επιστρέφει το ύψος που βρίσκεται ο κόμβος στο δέντρο
 
 static int node_height(SetNode node) {
@@ -48,6 +65,19 @@ static void node_update_height(SetNode node) {
 	node->height = 1 + int_max(node_height(node->left), node_height(node->right));
 }
 
+// Επιστρέφει το πλήθος κόμβων του υποδέντρου με ρίζα node
+
+static int node_size(SetNode node) {
+	if (!node) return 0;
+	return node->size;
+}
+
+// Ενημερώνει το πλήθος κόμβων του υποδέντρου ενός κόμβου
+
+static void node_update_size(SetNode node) {
+	node->size = 1 + node_size(node->left) + node_size(node->right);
+}
+
 // Επιστρέφει τη διαφορά ύψους μεταξύ αριστερού και δεξιού υπόδεντρου
 
 static int node_balance(SetNode node) {
@@ -58,19 +88,23 @@ static int node_balance(SetNode node) {
 // μεγαλύτερη του 1 το δέντρο δεν είναι πια AVL. Υπάρχουν 4 διαφορετικά
 // rotations που εφαρμόζονται ανάλογα με την περίπτωση για να αποκατασταθεί η
 // ισορροπία. Η κάθε συνάρτηση παίρνει ως όρισμα τον κόμβο που πρέπει να γίνει
-// rotate, και επιστρέφει τη ρίζα του νέου υποδέντρου.
+// rotate, και επιστρέφει τη ρίζα του νέου υποδέντρου (ο πατέρας της ενημερώνεται από τον caller).
 
 // Single left rotation
 
 static SetNode node_rotate_left(SetNode node) {
+	STATS_ADD(STAT_SET_ROTATIONS, 1);
+
 	SetNode right_node = node->right;
 	SetNode left_subtree = right_node->left;
 
-	right_node->left = node;
-	node->right = left_subtree;
+	node_set_right(node, left_subtree);
+	node_set_left(right_node, node);
 
 	node_update_height(node);
 	node_update_height(right_node);
+	node_update_size(node);
+	node_update_size(right_node);
 	
 	return right_node;
 }
@@ -78,14 +112,18 @@ static SetNode node_rotate_left(SetNode node) {
 // Single right rotation
 
 static SetNode node_rotate_right(SetNode node) {
+	STATS_ADD(STAT_SET_ROTATIONS, 1);
+
 	SetNode left_node = node->left;
 	SetNode left_right = left_node->right;
 
-	left_node->right = node;
-	node->left = left_right;
+	node_set_left(node, left_right);
+	node_set_right(left_node, node);
 
 	node_update_height(node);
 	node_update_height(left_node);
+	node_update_size(node);
+	node_update_size(left_node);
 	
 	return left_node;
 }
@@ -93,14 +131,14 @@ static SetNode node_rotate_right(SetNode node) {
 // Double left-right rotation
 
 static SetNode node_rotate_left_right(SetNode node) {
-	node->left = node_rotate_left(node->left);
+	node_set_left(node, node_rotate_left(node->left));
 	return node_rotate_right(node);
 }
 
 // Double right-left rotation
 
 static SetNode node_rotate_right_left(SetNode node) {
-	node->right = node_rotate_right(node->right);
+	node_set_right(node, node_rotate_right(node->right));
 	return node_rotate_left(node);
 }
 
@@ -108,6 +146,7 @@ static SetNode node_rotate_right_left(SetNode node) {
 
 static SetNode node_repair_balance(SetNode node) {
 	node_update_height(node);
+	node_update_size(node);
 
 	int balance = node_balance(node);
 	if (balance > 1) {
@@ -140,11 +179,15 @@ static SetNode node_repair_balance(SetNode node) {
 // Δημιουργεί και επιστρέφει έναν κόμβο με τιμή value (χωρίς παιδιά)
 //
 static SetNode node_create(Pointer value) {
+	STATS_ADD(STAT_SET_NODE_ALLOCS, 1);
+
 	SetNode node = malloc(sizeof(*node));
 	node->left = NULL;
 	node->right = NULL;
+	node->parent = NULL;
 	node->value = value;
 	node->height = 1;			// AVL
+	node->size = 1;
 	return node;
 }
 
@@ -158,6 +201,7 @@ static SetNode node_find_equal(SetNode node, CompareFunc compare, Pointer value)
 	// Το πού βρίσκεται ο κόμβος που ψάχνουμε εξαρτάται από τη διάταξη της τιμής
 	// value σε σχέση με την τιμή του τρέχοντος κόμβο (node->value)
 	//
+	STATS_ADD(STAT_SET_COMPARES, 1);
 	int compare_res = compare(value, node->value);			// αποθήκευση για να μην καλέσουμε την compare 2 φορές
 	if (compare_res == 0)									// value ισοδύναμη της node->value, βρήκαμε τον κόμβο
 		return node;
@@ -183,80 +227,65 @@ static SetNode node_find_max(SetNode node) {
 		: node;									// Αλλιώς η μεγαλύτερη τιμή είναι στο ίδιο το node
 }
 
-// Επιστρέφει τον προηγούμενο (στη σειρά διάταξης) του κόμβου target στο υποδέντρο με ρίζα node,
-// ή NULL αν ο target είναι ο μικρότερος του υποδέντρου. Το υποδέντρο πρέπει να περιέχει τον κόμβο
-// target, οπότε δεν μπορεί να είναι κενό.
+// Επιστρέφει τον προηγούμενο (στη σειρά διάταξης) του κόμβου node, ή NULL αν ο node είναι ο
+// μικρότερος του δέντρου. Χάρη στους δείκτες στον πατέρα δε χρειάζεται αναζήτηση από τη ρίζα.
 
-static SetNode node_find_previous(SetNode node, CompareFunc compare, SetNode target) {
-	if (node == target) {
-		// Ο target είναι η ρίζα του υποδέντρου, o προηγούμενός του είναι ο μεγαλύτερος του αριστερού υποδέντρου.
-		// (Aν δεν υπάρχει αριστερό παιδί, τότε ο κόμβος με τιμή value είναι ο μικρότερος του υποδέντρου, οπότε
-		// η node_find_max θα επιστρέψει NULL όπως θέλουμε.)
+static SetNode node_find_previous(SetNode node) {
+	// Αν υπάρχει αριστερό υποδέντρο, ο προηγούμενος είναι ο μεγαλύτερος κόμβος του
+	if (node->left != NULL)
 		return node_find_max(node->left);
 
-	} else if (compare(target->value, node->value) < 0) {
-		// Ο target είναι στο αριστερό υποδέντρο, οπότε και ο προηγούμενός του είναι εκεί.
-		return node_find_previous(node->left, compare, target);
-
-	} else {
-		// Ο target είναι στο δεξί υποδέντρο, ο προηγούμενός του μπορεί να είναι επίσης εκεί, διαφορετικά
-		// ο προηγούμενός του είναι ο ίδιος ο node.
-		SetNode res = node_find_previous(node->right, compare, target);
-		return res != NULL ? res : node;
-	}
+	// Αλλιώς είναι ο πρώτος πρόγονος του οποίου το δεξί υποδέντρο περιέχει τον node
+	while (node->parent != NULL && node->parent->left == node)
+		node = node->parent;
+	return node->parent;
 }
 
-// Επιστρέφει τον επόμενο (στη σειρά διάταξης) του κόμβου target στο υποδέντρο με ρίζα node,
-// ή NULL αν ο target είναι ο μεγαλύτερος του υποδέντρου. Το υποδέντρο πρέπει να περιέχει τον κόμβο
-// target, οπότε δεν μπορεί να είναι κενό.
+// Επιστρέφει τον επόμενο (στη σειρά διάταξης) του κόμβου node, ή NULL αν ο node είναι ο
+// μεγαλύτερος του δέντρου.
 
-static SetNode node_find_next(SetNode node, CompareFunc compare, SetNode target) {
-	if (node == target) {
-		// Ο target είναι η ρίζα του υποδέντρου, o προηγούμενός του είναι ο μεγαλύτερος του αριστερού υποδέντρου.
-		// (Aν δεν υπάρχει αριστερό παιδί, τότε ο κόμβος με τιμή value είναι ο μικρότερος του υποδέντρου, οπότε
-		// η node_find_max θα επιστρέψει NULL όπως θέλουμε.)
+static SetNode node_find_next(SetNode node) {
+	// Αν υπάρχει δεξί υποδέντρο, ο επόμενος είναι ο μικρότερος κόμβος του
+	if (node->right != NULL)
 		return node_find_min(node->right);
 
-	} else if (compare(target->value, node->value) > 0) {
-		// Ο target είναι στο αριστερό υποδέντρο, οπότε και ο προηγούμενός του είναι εκεί.
-		return node_find_next(node->right, compare, target);
-
-	} else {
-		// Ο target είναι στο δεξί υποδέντρο, ο προηγούμενός του μπορεί να είναι επίσης εκεί, διαφορετικά
-		// ο προηγούμενός του είναι ο ίδιος ο node.
-		SetNode res = node_find_next(node->left, compare, target);
-		return res != NULL ? res : node;
-	}
+	// Αλλιώς είναι ο πρώτος πρόγονος του οποίου το αριστερό υποδέντρο περιέχει τον node
+	while (node->parent != NULL && node->parent->right == node)
+		node = node->parent;
+	return node->parent;
 }
 
 // Αν υπάρχει κόμβος με τιμή ισοδύναμη της value, αλλάζει την τιμή του σε value, διαφορετικά προσθέτει
 // νέο κόμβο με τιμή value. Επιστρέφει τη νέα ρίζα του υποδέντρου, και θέτει το *inserted σε true
-// αν έγινε προσθήκη, ή false αν έγινε ενημέρωση.
+// αν έγινε προσθήκη, ή false αν έγινε ενημέρωση. Στο *result αποθηκεύεται ο κόμβος με τιμή value.
 
-static SetNode node_insert(SetNode node, CompareFunc compare, Pointer value, bool* inserted, Pointer* old_value) {
+static SetNode node_insert(SetNode node, CompareFunc compare, Pointer value, bool* inserted, Pointer* old_value, SetNode* result) {
 	// Αν το υποδέντρο είναι κενό, δημιουργούμε νέο κόμβο ο οποίος γίνεται ρίζα του υποδέντρου
 	if (node == NULL) {
 		*inserted = true;			// κάναμε προσθήκη
-		return node_create(value);
+		*result = node_create(value);
+		return *result;
 	}
 
 	// Το πού θα γίνει η προσθήκη εξαρτάται από τη διάταξη της τιμής
 	// value σε σχέση με την τιμή του τρέχοντος κόμβου (node->value)
 	//
+	STATS_ADD(STAT_SET_COMPARES, 1);
 	int compare_res = compare(value, node->value);
 	if (compare_res == 0) {
 		// βρήκαμε ισοδύναμη τιμή, κάνουμε update
 		*inserted = false;
 		*old_value = node->value;
 		node->value = value;
+		*result = node;
 
 	} else if (compare_res < 0) {
 		// value < node->value, συνεχίζουμε αριστερά.
-		node->left = node_insert(node->left, compare, value, inserted, old_value);
+		node_set_left(node, node_insert(node->left, compare, value, inserted, old_value, result));
 
 	} else {
 		// value > node->value, συνεχίζουμε δεξιά
-		node->right = node_insert(node->right, compare, value, inserted, old_value);
+		node_set_right(node, node_insert(node->right, compare, value, inserted, old_value, result));
 	}
 
 	return node_repair_balance(node);	// AVL
@@ -274,7 +303,7 @@ static SetNode node_remove_min(SetNode node, SetNode* min_node) {
 	} else {
 		// Εχουμε αριστερό υποδέντρο, οπότε η μικρότερη τιμή είναι εκεί. Συνεχίζουμε αναδρομικά
 		// και ενημερώνουμε το node->left με τη νέα ρίζα του υποδέντρου.
-		node->left = node_remove_min(node->left, min_node);
+		node_set_left(node, node_remove_min(node->left, min_node));
 
 		return node_repair_balance(node);	// AVL
 	}
@@ -289,6 +318,7 @@ static SetNode node_remove(SetNode node, CompareFunc compare, Pointer value, boo
 		return NULL;
 	}
 
+	STATS_ADD(STAT_SET_COMPARES, 1);
 	int compare_res = compare(value, node->value);
 	if (compare_res == 0) {
 		// Βρέθηκε ισοδύναμη τιμή στον node, οπότε τον διαγράφουμε. Το πώς θα γίνει αυτό εξαρτάται από το αν έχει παιδιά.
@@ -312,11 +342,11 @@ static SetNode node_remove(SetNode node, CompareFunc compare, Pointer value, boo
 			// αφαιρείται. Η συνάρτηση node_remove_min κάνει ακριβώς αυτή τη δουλειά.
 
 			SetNode min_right;
-			node->right = node_remove_min(node->right, &min_right);
+			node_set_right(node, node_remove_min(node->right, &min_right));
 
 			// Σύνδεση του min_right στη θέση του node
-			min_right->left = node->left;
-			min_right->right = node->right;
+			node_set_left(min_right, node->left);
+			node_set_right(min_right, node->right);
 
 			free(node);
 
@@ -326,13 +356,111 @@ static SetNode node_remove(SetNode node, CompareFunc compare, Pointer value, boo
 
 	// compare_res != 0, συνεχίζουμε στο αριστερό ή δεξί υποδέντρο, η ρίζα δεν αλλάζει.
 	if (compare_res < 0)
-		node->left  = node_remove(node->left,  compare, value, removed, old_value);
+		node_set_left(node, node_remove(node->left, compare, value, removed, old_value));
 	else
-		node->right = node_remove(node->right, compare, value, removed, old_value);
+		node_set_right(node, node_remove(node->right, compare, value, removed, old_value));
 
 	return node_repair_balance(node);	// AVL
 }
 
+// Επιστρέφει τον κόμβο που βρίσκεται στη θέση pos (0-based, με τη σειρά διάταξης) του
+// υποδέντρου με ρίζα node, ή NULL αν δεν υπάρχει τέτοια θέση.
+
+static SetNode node_find_at(SetNode node, int pos) {
+	if (node == NULL)
+		return NULL;
+
+	int left_size = node_size(node->left);
+	if (pos < left_size)					// η θέση βρίσκεται στο αριστερό υποδέντρο
+		return node_find_at(node->left, pos);
+	else if (pos == left_size)				// πριν από τον node υπάρχουν ακριβώς pos κόμβοι
+		return node;
+	else									// στο δεξί υποδέντρο, παραλείποντας τον node και το αριστερό υποδέντρο
+		return node_find_at(node->right, pos - left_size - 1);
+}
+
+// Επιστρέφει το πλήθος των στοιχείων του υποδέντρου με ρίζα node που είναι μικρότερα από value
+
+static int node_rank(SetNode node, CompareFunc compare, Pointer value) {
+	int rank = 0;
+	while (node != NULL) {
+		if (compare(node->value, value) < 0) {	// ο node και το αριστερό υποδέντρο είναι μικρότερα
+			rank += node_size(node->left) + 1;
+			node = node->right;
+		} else {
+			node = node->left;
+		}
+	}
+	return rank;
+}
+
+// Τοποθετεί τον replacement (μπορεί να είναι NULL) στη θέση του node, ως παιδί του πατέρα του node ή ως ρίζα του set
+
+static void node_replace(Set set, SetNode node, SetNode replacement) {
+	SetNode parent = node->parent;
+	if (parent == NULL) {
+		set->root = replacement;
+		if (replacement != NULL)
+			replacement->parent = NULL;
+	} else if (parent->left == node) {
+		node_set_left(parent, replacement);
+	} else {
+		node_set_right(parent, replacement);
+	}
+}
+
+// Επισκευάζει ύψη, μεγέθη και AVL ιδιότητα σε όλους τους κόμβους από τον node μέχρι τη ρίζα.
+// Χρησιμοποιείται μετά από αλλαγές στο υποδέντρο του node που δεν έγιναν αναδρομικά από τη ρίζα.
+
+static void node_repair_path(Set set, SetNode node) {
+	while (node != NULL) {
+		// Τα rotations αλλάζουν τον πατέρα του node, οπότε τον κρατάμε πριν την επισκευή
+		SetNode parent = node->parent;
+		bool is_left = parent != NULL && parent->left == node;
+
+		SetNode root = node_repair_balance(node);
+		if (parent == NULL) {
+			set->root = root;
+			root->parent = NULL;
+		} else if (is_left) {
+			node_set_left(parent, root);
+		} else {
+			node_set_right(parent, root);
+		}
+
+		node = parent;
+	}
+}
+
+// Αφαιρεί τον κόμβο node από το δέντρο (χωρίς free), αλλάζοντας μόνο δείκτες. Οι υπόλοιποι
+// κόμβοι διατηρούν τις τιμές τους, οπότε οι SetNodes που έχει κρατήσει ο χρήστης παραμένουν έγκυροι.
+
+static void node_unlink(Set set, SetNode node) {
+	SetNode repair_from;		// ο χαμηλότερος κόμβος του οποίου άλλαξε το υποδέντρο
+
+	if (node->left == NULL || node->right == NULL) {
+		// Το πολύ ένα παιδί, παίρνει τη θέση του node
+		repair_from = node->parent;
+		node_replace(set, node, node->left != NULL ? node->left : node->right);
+
+	} else {
+		// Δύο παιδιά. Ο επόμενος του node είναι ο μικρότερος του δεξιού υποδέντρου, δεν έχει
+		// αριστερό παιδί, και μπαίνει στη θέση του node.
+		SetNode next = node_find_min(node->right);
+		if (next->parent == node) {
+			repair_from = next;
+		} else {
+			repair_from = next->parent;
+			node_set_left(next->parent, next->right);
+			node_set_right(next, node->right);
+		}
+		node_set_left(next, node->left);
+		node_replace(set, node, next);
+	}
+
+	node_repair_path(set, repair_from);
+}
+
 // Καταστρέφει όλο το υποδέντρο με ρίζα node
 
 static void node_destroy(SetNode node, DestroyFunc destroy_value) {
@@ -372,21 +500,31 @@ int set_size(Set set) {
 } 
 
 void set_insert(Set set, Pointer value) {
+	set_insert_node(set, value);
+}
+
+SetNode set_insert_node(Set set, Pointer value) {
 	bool inserted;
 	Pointer old_value;
-	set->root = node_insert(set->root, set->compare, value, &inserted, &old_value);
+	SetNode node;
+	set->root = node_insert(set->root, set->compare, value, &inserted, &old_value, &node);
+	set->root->parent = NULL;
 	
 	// Το size αλλάζει μόνο αν μπει νέος κόμβος. Στα updates κάνουμε destroy την παλιά τιμή
 	if (inserted)
 		set->size++;
 	else if (set->destroy_value != NULL)
 		set->destroy_value(old_value); 
+
+	return node;
 }
 
 bool set_remove(Set set, Pointer value) {
 	bool removed;
 	Pointer old_value = NULL;
 	set->root = node_remove(set->root, set->compare, value, &removed, &old_value);
+	if (set->root != NULL)
+		set->root->parent = NULL;
 
 	// Το size αλλάζει μόνο αν πραγματικά αφαιρεθεί ένας κόμβος
 	if (removed) {
@@ -399,6 +537,15 @@ bool set_remove(Set set, Pointer value) {
 	return removed;
 }
 
+void set_remove_node(Set set, SetNode node) {
+	node_unlink(set, node);
+	set->size--;
+
+	if (set->destroy_value != NULL)
+		set->destroy_value(node->value);
+	free(node);
+}
+
 Pointer set_find(Set set, Pointer value) {
 	SetNode node = node_find_equal(set->root, set->compare, value);
 	return node == NULL ? NULL : node->value;
@@ -415,6 +562,10 @@ void set_destroy(Set set) {
 	free(set);
 }
 
+size_t set_memory(Set set) {
+	return sizeof(*set) + set->size * sizeof(struct set_node);
+}
+
 SetNode set_first(Set set) {
 	return node_find_min(set->root);
 }
@@ -424,11 +575,11 @@ SetNode set_last(Set set) {
 }
 
 SetNode set_previous(Set set, SetNode node) {
-	return node_find_previous(set->root, set->compare, node);
+	return node_find_previous(node);
 }
 
 SetNode set_next(Set set, SetNode node) {
-	return node_find_next(set->root, set->compare, node);
+	return node_find_next(node);
 }
 
 Pointer set_node_value(Set set, SetNode node) {
@@ -439,6 +590,16 @@ SetNode set_find_node(Set set, Pointer value) {
 	return node_find_equal(set->root, set->compare, value);
 }
 
+SetNode set_node_at(Set set, int pos) {
+	if (pos < 0)
+		return SET_EOF;
+	return node_find_at(set->root, pos);
+}
+
+int set_rank(Set set, Pointer value) {
+	return node_rank(set->root, set->compare, value);
+}
+
 
 
 // Συναρτήσεις που δεν υπάρχουν στο public interface αλλά χρησιμοποιούνται στα tests
@@ -459,8 +620,12 @@ bool node_is_avl(SetNode node, CompareFunc compare) {
 	if(node->right != NULL)
 		res = res && compare(node->right->value, node->value) > 0 && compare(node_find_min(node->right)->value, node->value) > 0;
 
-	// Το ύψος είναι σωστό
+	// Οι δείκτες στον πατέρα είναι σωστοί
+	res = res && (node->left == NULL || node->left->parent == node) && (node->right == NULL || node->right->parent == node);
+
+	// Το ύψος και το μέγεθος του υποδέντρου είναι σωστά
 	res = res && node->height == 1 + int_max(node_height(node->left), node_height(node->right));
+	res = res && node->size == 1 + node_size(node->left) + node_size(node->right);
 
 	// Ο κόμβος έχει την AVL ιδιότητα
 	int balance = node_balance(node);
@@ -475,7 +640,7 @@ bool node_is_avl(SetNode node, CompareFunc compare) {
 }
 
 bool set_is_proper(Set node) {
-	return node_is_avl(node->root, node->compare);
+	return (node->root == NULL || node->root->parent == NULL) && node_size(node->root) == node->size && node_is_avl(node->root, node->compare);
 }
 
 // LCOV_EXCL_STOP
@@ -9,6 +9,7 @@
 #include <stdio.h>
 
 #include "ADTVector.h"
+#include "Stats.h"
 
 
 // Το αρχικό μέγεθος που δεσμεύουμε
@@ -76,6 +77,7 @@ void vector_insert_last(Vector vec, Pointer value) {
 	if (vec->capacity == vec->size) {
 		// Προσοχή: δεν πρέπει να κάνουμε free τον παλιό pointer, το κάνει η realloc
 		vec->capacity *= 2;
+		STATS_ADD(STAT_VECTOR_RESIZES, 1);
 		vec->array = realloc(vec->array, vec->capacity * sizeof(*vec->array));
 		vec->steps += vector_size(vec); //λογω των copy που κανει η realloc
 	}
@@ -101,6 +103,7 @@ void vector_remove_last(Vector vec) {
 	//
 	if (vec->capacity > vec->size * 4 && vec->capacity > 2*VECTOR_MIN_CAPACITY) {
 		vec->capacity /= 2;
+		STATS_ADD(STAT_VECTOR_RESIZES, 1);
 		vec->array = realloc(vec->array, vec->capacity * sizeof(*vec->array));
 		vec->steps+=vector_size(vec);
 	}
@@ -135,6 +138,10 @@ void vector_destroy(Vector vec) {
 	free(vec);			// τελευταίο το vec!
 }
 
+size_t vector_memory(Vector vec) {
+	return sizeof(*vec) + vec->capacity * sizeof(*vec->array);
+}
+
 
 // Συναρτήσεις για διάσχιση μέσω node /////////////////////////////////////////////////////
 
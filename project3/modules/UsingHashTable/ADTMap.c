@@ -10,6 +10,7 @@
 
 #include "ADTMap.h"
 #include "ADTList.h"
+#include "Stats.h"
 
 // Οι κόμβοι του map στην υλοποίηση με hash table, μπορούν να είναι σε 3 διαφορετικές καταστάσεις,
 // ώστε αν διαγράψουμε κάποιον κόμβο, αυτός να μην είναι empty, ώστε να μην επηρεάζεται η αναζήτηση
@@ -44,6 +45,7 @@ struct map {
 };
 
 static int compare_map_nodes(MapNode a, MapNode b) {
+	STATS_ADD(STAT_MAP_COMPARES, 1);
 	return a->owner->compare(a->key, b->key);
 }
 
@@ -83,6 +85,8 @@ int map_size(Map map) {
 
 // Συνάρτηση για την επέκταση του Hash Table σε περίπτωση που ο load factor μεγαλώσει πολύ.
 static void rehash(Map map) {
+	STATS_ADD(STAT_MAP_REHASHES, 1);
+
 	// Αποθήκευση των παλιών δεδομένων
 	int old_capacity = map->capacity;
 	List* old_array = map->array;
@@ -124,12 +128,14 @@ static void rehash(Map map) {
 
 void map_insert(Map map, Pointer key, Pointer value) {
 
+	STATS_ADD(STAT_MAP_LOOKUPS, 1);
 	uint pos = map->hash_function(key) % map->capacity;
 
 	struct map_node search_node = { .key = key, .value = value, .owner = map};
 
 	MapNode node = (MapNode)list_find_node(map->array[pos], &search_node, (CompareFunc)(compare_map_nodes));
 	if(node == NULL){
+		STATS_ADD(STAT_MAP_NODE_ALLOCS, 1);
 		MapNode node1 = malloc(sizeof(*node1));
 		node1->key = key;
 		node1->value = value;
@@ -155,6 +161,7 @@ void map_insert(Map map, Pointer key, Pointer value) {
 		list_set_destroy_value(map->array[pos],(DestroyFunc)destroy_map_node);
 		list_remove(map->array[pos],(ListNode)node);
 		list_set_destroy_value(map->array[pos],free);
+		STATS_ADD(STAT_MAP_NODE_ALLOCS, 1);
 		MapNode node1 = malloc(sizeof(*node1));
 		node1->key = key;
 		node1->value = value;
@@ -186,6 +193,7 @@ void map_insert(Map map, Pointer key, Pointer value) {
 
 // Διαργραφή απο το Hash Table του κλειδιού με τιμή key
 bool map_remove(Map map, Pointer key) {
+	STATS_ADD(STAT_MAP_LOOKUPS, 1);
 	uint pos = map->hash_function(key) % map->capacity;
 	struct map_node search_node = {.key = key, .value = NULL, .owner = map};
 	ListNode node = list_find_node(map->array[pos], &search_node, (CompareFunc)compare_map_nodes);
@@ -203,6 +211,7 @@ bool map_remove(Map map, Pointer key) {
 // Αναζήτηση στο map, με σκοπό να επιστραφεί το value του κλειδιού που περνάμε σαν όρισμα.
 
 Pointer map_find(Map map, Pointer key) {
+	STATS_ADD(STAT_MAP_LOOKUPS, 1);
 	uint pos = map->hash_function(key) % map->capacity;
 	struct map_node search_node = {.key = key, .value = NULL, .owner = map};
 	ListNode node = list_find_node(map->array[pos], &search_node, (CompareFunc)compare_map_nodes);
@@ -237,6 +246,14 @@ void map_destroy(Map map) {
 	free(map);
 }
 
+size_t map_memory(Map map) {
+	// Κάθε bucket είναι μια λίστα (που περιέχει και τους κόμβους της), και κάθε entry ένα struct map_node
+	size_t memory = sizeof(*map) + map->capacity * sizeof(List) + map->size * sizeof(struct map_node);
+	for (int i = 0; i < map->capacity; i++)
+		memory += list_memory(map->array[i]);
+	return memory;
+}
+
 /////////////////////// Διάσχιση του map μέσω κόμβων ///////////////////////////
 
 MapNode map_first(Map map) {
@@ -283,13 +300,14 @@ Pointer map_node_value(Map map, MapNode node) {
 }
 
 MapNode map_find_node(Map map, Pointer key) {
+	// Με separate chaining το key μπορεί να βρίσκεται μόνο στη λίστα της θέσης pos
+	STATS_ADD(STAT_MAP_LOOKUPS, 1);
 	uint pos = map->hash_function(key) % map->capacity;
-	for(int i = pos; i < map->capacity; i++){
-		for(ListNode node = list_first(map->array[i]); node!= LIST_EOF; node = list_next(map->array[i],node)){
-			MapNode temp = (MapNode)list_node_value(map->array[i],node);
-			if(map->compare(temp->key,key)==0)
-				return temp;
-		}
+	for(ListNode node = list_first(map->array[pos]); node!= LIST_EOF; node = list_next(map->array[pos],node)){
+		MapNode temp = (MapNode)list_node_value(map->array[pos],node);
+		STATS_ADD(STAT_MAP_COMPARES, 1);
+		if(map->compare(temp->key,key)==0)
+			return temp;
 	}
 	return MAP_EOF;
 }
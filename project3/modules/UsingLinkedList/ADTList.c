@@ -8,6 +8,7 @@
 #include <assert.h>
 
 #include "ADTList.h"
+#include "Stats.h"
 
 
 // Ενα List είναι pointer σε αυτό το struct
@@ -53,6 +54,7 @@ void list_insert_next(List list, ListNode node, Pointer value) {
 		node = list->dummy;
 
 	// Δημιουργία του νέου κόμβου
+	STATS_ADD(STAT_LIST_NODE_ALLOCS, 1);
 	ListNode new = malloc(sizeof(*new));
 	new->value = value;
 
@@ -95,12 +97,30 @@ Pointer list_find(List list, Pointer value, CompareFunc compare) {
 	return node == NULL ? NULL : node->value;
 }
 
+void list_append(List list, List other) {
+	// Οι κόμβοι της other συνδέονται μετά τον τελευταίο της list, οπότε
+	// από την other μένουν μόνο το struct και ο dummy κόμβος της.
+	if (other->size > 0) {
+		list->last->next = other->dummy->next;
+		list->last = other->last;
+		list->size += other->size;
+	}
+
+	free(other->dummy);
+	free(other);
+}
+
 DestroyFunc list_set_destroy_value(List list, DestroyFunc destroy_value) {
 	DestroyFunc old = list->destroy_value;
 	list->destroy_value = destroy_value;
 	return old;
 }
 
+size_t list_memory(List list) {
+	// Ο dummy είναι επιπλέον κόμβος
+	return sizeof(*list) + (list->size + 1) * sizeof(struct list_node);
+}
+
 void list_destroy(List list) {
 	// Διασχίζουμε όλη τη λίστα και κάνουμε free όλους τους κόμβους,
 	// συμπεριλαμβανομένου και του dummy!
@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του ADT VersionedSet μέσω persistent AVL Tree
+// (path copying).
+//
+///////////////////////////////////////////////////////////
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ADTVersionedSet.h"
+#include "Stats.h"
+
+
+typedef struct vset_node* VSetNode;
+
+// Κόμβος του AVL. Δεν υπάρχει pointer στον πατέρα, αφού ένας κόμβος μπορεί να ανήκει σε πολλές
+// εκδόσεις του δέντρου (με διαφορετικούς πατέρες).
+struct vset_node {
+	VSetNode left, right;
+	Pointer value;
+	int height;
+	uint64_t birth;				// το vset->stamp τη στιγμή της δημιουργίας του κόμβου
+};
+
+// Ένας κόμβος ή ένα στοιχείο που αφαιρέθηκε από την τρέχουσα έκδοση, αλλά μπορεί να το βλέπει
+// κάποιο snapshot. Ελευθερώνεται όταν όλα τα snapshots έχουν stamp >= retired->stamp.
+struct retired {
+	Pointer pointer;
+	bool is_value;				// στοιχείο (destroy_value) ή κόμβος (free)
+	uint64_t stamp;
+	struct retired* next;
+};
+
+struct vset_snapshot {
+	VSetNode root;
+	int size;
+	uint64_t stamp;				// βλέπει ακριβώς τους κόμβους με birth <= stamp που δεν είχαν αφαιρεθεί
+	VSetSnapshot prev, next;	// στη λίστα των ανοιχτών snapshots, με σειρά δημιουργίας
+};
+
+// Κάθε vset_snapshot αυξάνει το stamp. Ένας κόμβος της τρέχουσας έκδοσης μπορεί να τροποποιηθεί
+// επί τόπου μόνο αν δημιουργήθηκε μετά το νεότερο ανοιχτό snapshot, αλλιώς αντιγράφεται και ο
+// αρχικός μπαίνει στη λίστα retired, η οποία είναι ταξινομημένη κατά stamp.
+struct vset {
+	VSetNode root;
+	int size;
+	CompareFunc compare;
+	DestroyFunc destroy_value;
+	uint64_t stamp;
+	VSetSnapshot oldest, newest;
+	struct retired* retired_first;
+	struct retired* retired_last;
+	int nodes;					// όλοι οι κόμβοι, μαζί με τους retired
+	int retired_no;
+	int snapshots;
+	pthread_mutex_t lock;		// για τα snapshots, και κάθε αλλαγή του δέντρου
+};
+
+
+// Κρατάει το pointer μέχρι να μην το βλέπει κανένα snapshot, ή το ελευθερώνει αμέσως αν δεν υπάρχουν snapshots
+
+static void retire(VSet vset, Pointer pointer, bool is_value) {
+	if (vset->newest == NULL) {
+		if (!is_value) {
+			free(pointer);
+			vset->nodes--;
+		} else if (vset->destroy_value != NULL) {
+			vset->destroy_value(pointer);
+		}
+		return;
+	}
+
+	struct retired* retired = malloc(sizeof(*retired));
+	*retired = (struct retired){ .pointer = pointer, .is_value = is_value, .stamp = vset->stamp, .next = NULL };
+	if (vset->retired_last != NULL)
+		vset->retired_last->next = retired;
+	else
+		vset->retired_first = retired;
+	vset->retired_last = retired;
+	vset->retired_no++;
+}
+
+// Ελευθερώνει όσα retired δεν τα βλέπει πλέον κανένα snapshot
+
+static void drain(VSet vset) {
+	while (vset->retired_first != NULL && (vset->oldest == NULL || vset->retired_first->stamp <= vset->oldest->stamp)) {
+		struct retired* retired = vset->retired_first;
+		vset->retired_first = retired->next;
+
+		if (!retired->is_value) {
+			free(retired->pointer);
+			vset->nodes--;
+		} else if (vset->destroy_value != NULL) {
+			vset->destroy_value(retired->pointer);
+		}
+		free(retired);
+		vset->retired_no--;
+	}
+	if (vset->retired_first == NULL)
+		vset->retired_last = NULL;
+}
+
+
+//// Κόμβοι /////////////////////////////////////////////////////////////////////
+
+static int int_max(int a, int b) {
+	return (a > b) ? a : b ;
+}
+
+static int node_height(VSetNode node) {
+	return node != NULL ? node->height : 0;
+}
+
+static void node_update_height(VSetNode node) {
+	node->height = 1 + int_max(node_height(node->left), node_height(node->right));
+}
+
+static int node_balance(VSetNode node) {
+	return node_height(node->left) - node_height(node->right);
+}
+
+static VSetNode node_create(VSet vset, Pointer value) {
+	STATS_ADD(STAT_VSET_NODE_ALLOCS, 1);
+	VSetNode node = malloc(sizeof(*node));
+	*node = (struct vset_node){ .left = NULL, .right = NULL, .value = value, .height = 1, .birth = vset->stamp };
+	vset->nodes++;
+	return node;
+}
+
+// Επιστρέφει έναν κόμβο ίδιο με τον node που μπορεί να τροποποιηθεί: τον ίδιο τον node αν δεν τον
+// βλέπει κανένα snapshot, αλλιώς ένα αντίγραφό του (και ο node γίνεται retire).
+
+static VSetNode node_own(VSet vset, VSetNode node) {
+	if (vset->newest == NULL || node->birth > vset->newest->stamp)
+		return node;
+
+	STATS_ADD(STAT_VSET_NODE_COPIES, 1);
+	VSetNode copy = node_create(vset, node->value);
+	copy->left = node->left;
+	copy->right = node->right;
+	copy->height = node->height;
+	retire(vset, node, false);
+	return copy;
+}
+
+// Rotations, όπως στο ADTSet. Ο node πρέπει να μπορεί να τροποποιηθεί (node_own), το παιδί
+// που ανεβαίνει γίνεται own εδώ. Επιστρέφουν τη νέα ρίζα του υποδέντρου.
+
+static VSetNode node_rotate_left(VSet vset, VSetNode node) {
+	STATS_ADD(STAT_SET_ROTATIONS, 1);
+
+	VSetNode right = node_own(vset, node->right);
+	node->right = right->left;
+	right->left = node;
+
+	node_update_height(node);
+	node_update_height(right);
+	return right;
+}
+
+static VSetNode node_rotate_right(VSet vset, VSetNode node) {
+	STATS_ADD(STAT_SET_ROTATIONS, 1);
+
+	VSetNode left = node_own(vset, node->left);
+	node->left = left->right;
+	left->right = node;
+
+	node_update_height(node);
+	node_update_height(left);
+	return left;
+}
+
+// Ενημερώνει το ύψος του node (που μπορεί να τροποποιηθεί) και αποκαθιστά την ισορροπία του
+
+static VSetNode node_repair_balance(VSet vset, VSetNode node) {
+	node_update_height(node);
+
+	int balance = node_balance(node);
+	if (balance > 1) {
+		if (node_balance(node->left) < 0)
+			node->left = node_rotate_left(vset, node_own(vset, node->left));
+		return node_rotate_right(vset, node);
+
+	} else if (balance < -1) {
+		if (node_balance(node->right) > 0)
+			node->right = node_rotate_right(vset, node_own(vset, node->right));
+		return node_rotate_left(vset, node);
+	}
+	return node;
+}
+
+static VSetNode node_insert(VSet vset, VSetNode node, Pointer value, bool* inserted) {
+	if (node == NULL) {
+		*inserted = true;
+		return node_create(vset, value);
+	}
+
+	STATS_ADD(STAT_SET_COMPARES, 1);
+	int compare = vset->compare(value, node->value);
+	node = node_own(vset, node);
+
+	if (compare == 0) {
+		// Αντικατάσταση, το ύψος δεν αλλάζει
+		*inserted = false;
+		if (node->value != value)
+			retire(vset, node->value, true);
+		node->value = value;
+		return node;
+	}
+
+	if (compare < 0)
+		node->left = node_insert(vset, node->left, value, inserted);
+	else
+		node->right = node_insert(vset, node->right, value, inserted);
+	return node_repair_balance(vset, node);
+}
+
+// Αφαιρεί τον μικρότερο κόμβο του υποδέντρου node, αποθηκεύοντας την τιμή του στο min
+
+static VSetNode node_remove_min(VSet vset, VSetNode node, Pointer* min) {
+	if (node->left == NULL) {
+		*min = node->value;
+		VSetNode right = node->right;
+		retire(vset, node, false);
+		return right;
+	}
+
+	node = node_own(vset, node);
+	node->left = node_remove_min(vset, node->left, min);
+	return node_repair_balance(vset, node);
+}
+
+// Αφαιρεί την value, η οποία πρέπει να υπάρχει στο υποδέντρο node
+
+static VSetNode node_remove(VSet vset, VSetNode node, Pointer value) {
+	STATS_ADD(STAT_SET_COMPARES, 1);
+	int compare = vset->compare(value, node->value);
+
+	if (compare == 0) {
+		retire(vset, node->value, true);
+
+		if (node->left == NULL || node->right == NULL) {
+			VSetNode child = node->left != NULL ? node->left : node->right;
+			retire(vset, node, false);
+			return child;
+		}
+
+		// Με δύο παιδιά, τη θέση της value παίρνει η επόμενη τιμή
+		node = node_own(vset, node);
+		node->right = node_remove_min(vset, node->right, &node->value);
+		return node_repair_balance(vset, node);
+	}
+
+	node = node_own(vset, node);
+	if (compare < 0)
+		node->left = node_remove(vset, node->left, value);
+	else
+		node->right = node_remove(vset, node->right, value);
+	return node_repair_balance(vset, node);
+}
+
+static bool node_contains(VSet vset, VSetNode node, Pointer value) {
+	while (node != NULL) {
+		STATS_ADD(STAT_SET_COMPARES, 1);
+		int compare = vset->compare(value, node->value);
+		if (compare == 0)
+			return true;
+		node = compare < 0 ? node->left : node->right;
+	}
+	return false;
+}
+
+static bool node_visit(VSetNode node, VSetRangeFunc range, VSetVisitFunc visit, Pointer context) {
+	if (node == NULL)
+		return true;
+
+	// Τα υποδέντρα που είναι εξ ολοκλήρου εκτός διαστήματος παραλείπονται
+	int position = range != NULL ? range(node->value, context) : 0;
+	if (position >= 0 && !node_visit(node->left, range, visit, context))
+		return false;
+	if (position == 0 && !visit(node->value, context))
+		return false;
+	if (position <= 0)
+		return node_visit(node->right, range, visit, context);
+	return true;
+}
+
+static void node_destroy(VSetNode node, DestroyFunc destroy_value) {
+	if (node == NULL)
+		return;
+
+	node_destroy(node->left, destroy_value);
+	node_destroy(node->right, destroy_value);
+	if (destroy_value != NULL)
+		destroy_value(node->value);
+	free(node);
+}
+
+
+//// Συναρτήσεις του ADT VersionedSet //////////////////////////////////////////
+
+VSet vset_create(CompareFunc compare, DestroyFunc destroy_value) {
+	VSet vset = malloc(sizeof(*vset));
+	*vset = (struct vset){
+		.root = NULL, .size = 0, .compare = compare, .destroy_value = destroy_value, .stamp = 0,
+		.oldest = NULL, .newest = NULL, .retired_first = NULL, .retired_last = NULL,
+		.nodes = 0, .retired_no = 0, .snapshots = 0,
+	};
+	pthread_mutex_init(&vset->lock, NULL);
+	return vset;
+}
+
+int vset_size(VSet vset) {
+	return vset->size;
+}
+
+void vset_insert(VSet vset, Pointer value) {
+	pthread_mutex_lock(&vset->lock);
+	drain(vset);
+
+	bool inserted = false;
+	vset->root = node_insert(vset, vset->root, value, &inserted);
+	if (inserted)
+		vset->size++;
+
+	pthread_mutex_unlock(&vset->lock);
+}
+
+bool vset_remove(VSet vset, Pointer value) {
+	pthread_mutex_lock(&vset->lock);
+	drain(vset);
+
+	// Ελέγχουμε πρώτα αν υπάρχει, ώστε να μην αντιγραφούν κόμβοι χωρίς λόγο
+	bool found = node_contains(vset, vset->root, value);
+	if (found) {
+		vset->root = node_remove(vset, vset->root, value);
+		vset->size--;
+	}
+
+	pthread_mutex_unlock(&vset->lock);
+	return found;
+}
+
+void vset_destroy(VSet vset) {
+	// Κάθε κόμβος ανήκει είτε στην τρέχουσα έκδοση είτε στη λίστα retired (ποτέ και στα δύο)
+	while (vset->oldest != NULL) {
+		VSetSnapshot next = vset->oldest->next;
+		free(vset->oldest);
+		vset->oldest = next;
+	}
+	vset->newest = NULL;
+	drain(vset);
+
+	node_destroy(vset->root, vset->destroy_value);
+	pthread_mutex_destroy(&vset->lock);
+	free(vset);
+}
+
+size_t vset_memory(VSet vset) {
+	pthread_mutex_lock(&vset->lock);
+	size_t memory = sizeof(*vset) + vset->nodes * sizeof(struct vset_node)
+		+ vset->retired_no * sizeof(struct retired) + vset->snapshots * sizeof(struct vset_snapshot);
+	pthread_mutex_unlock(&vset->lock);
+	return memory;
+}
+
+
+//// Snapshots //////////////////////////////////////////////////////////////////
+
+VSetSnapshot vset_snapshot(VSet vset) {
+	VSetSnapshot snapshot = malloc(sizeof(*snapshot));
+
+	pthread_mutex_lock(&vset->lock);
+	*snapshot = (struct vset_snapshot){ .root = vset->root, .size = vset->size, .stamp = vset->stamp++, .prev = vset->newest, .next = NULL };
+	if (vset->newest != NULL)
+		vset->newest->next = snapshot;
+	else
+		vset->oldest = snapshot;
+	vset->newest = snapshot;
+	vset->snapshots++;
+	pthread_mutex_unlock(&vset->lock);
+
+	return snapshot;
+}
+
+void vset_release(VSet vset, VSetSnapshot snapshot) {
+	pthread_mutex_lock(&vset->lock);
+	if (snapshot->prev != NULL)
+		snapshot->prev->next = snapshot->next;
+	else
+		vset->oldest = snapshot->next;
+	if (snapshot->next != NULL)
+		snapshot->next->prev = snapshot->prev;
+	else
+		vset->newest = snapshot->prev;
+	vset->snapshots--;
+	pthread_mutex_unlock(&vset->lock);
+
+	free(snapshot);
+}
+
+int vset_snapshot_size(VSetSnapshot snapshot) {
+	return snapshot->size;
+}
+
+void vset_visit(VSetSnapshot snapshot, VSetRangeFunc range, VSetVisitFunc visit, Pointer context) {
+	node_visit(snapshot->root, range, visit, context);
+}
+
+
+// Συναρτήσεις που δεν υπάρχουν στο public interface αλλά χρησιμοποιούνται στα tests.
+// Ελέγχουν ότι η τρέχουσα έκδοση είναι σωστό AVL.
+
+static bool node_is_avl(VSet vset, VSetNode node, Pointer* previous, int* count) {
+	if (node == NULL)
+		return true;
+
+	if (!node_is_avl(vset, node->left, previous, count))
+		return false;
+	if (*previous != NULL && vset->compare(*previous, node->value) >= 0)
+		return false;
+	*previous = node->value;
+	(*count)++;
+
+	int balance = node_balance(node);
+	return node_is_avl(vset, node->right, previous, count)
+		&& node->height == 1 + int_max(node_height(node->left), node_height(node->right))
+		&& balance >= -1 && balance <= 1;
+}
+
+bool vset_is_proper(VSet vset) {
+	Pointer previous = NULL;
+	int count = 0;
+	return node_is_avl(vset, vset->root, &previous, &count) && count == vset->size;
+}
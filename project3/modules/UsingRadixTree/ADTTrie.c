@@ -0,0 +1,414 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση του ADT Trie μέσω Radix Tree
+//
+///////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ADTTrie.h"
+#include "Stats.h"
+
+typedef struct trie_node* TrieNode;
+
+// Το radix tree είναι ένα trie στο οποίο οι αλυσίδες από κόμβους με ένα μόνο παιδί (και χωρίς
+// τιμές) συμπτύσσονται σε έναν κόμβο. Κάθε ακμή έχει λοιπόν ένα label με έναν ή περισσότερους
+// χαρακτήρες, και ένα key είναι η συνένωση των labels από τη ρίζα μέχρι τον κόμβο του.
+struct trie {
+	TrieNode root;				// η ρίζα, με κενό label
+	int size;					// πλήθος ζευγών (key, value)
+	size_t memory;				// bytes των κόμβων και των πινάκων τους, για την trie_memory
+	DestroyFunc destroy_value;
+};
+
+// Για να πιάνει λίγη μνήμη ο κάθε κόμβος (τα keys είναι συνήθως πολλά και μικρά), το label
+// αποθηκεύεται μέσα στο ίδιο το struct, μία τιμή αποθηκεύεται χωρίς πίνακα, και οι πίνακες
+// έχουν χωρητικότητα την μικρότερη δύναμη του 2 που χωράει τα στοιχεία τους.
+struct trie_node {
+	union {
+		Pointer value;			// αν values_no == 1
+		Pointer* values;		// αν values_no > 1
+	};
+	TrieNode* children;			// ταξινομημένα κατά τον πρώτο χαρακτήρα του label τους
+	uint32_t values_no;			// οι τιμές του key που τελειώνει σε αυτόν τον κόμβο
+	uint32_t label_len;
+	uint16_t children_no;
+	char label[];				// η ακμή από τον πατέρα, χωρίς '\0'
+};
+
+
+// Επιστρέφει τη χωρητικότητα ενός πίνακα με n στοιχεία: 0 ή τη μικρότερη δύναμη του 2 >= n
+
+static size_t capacity(size_t n) {
+	size_t cap = n > 0 ? 1 : 0;
+	while (cap < n)
+		cap *= 2;
+	return cap;
+}
+
+static size_t node_bytes(uint32_t label_len) {
+	return offsetof(struct trie_node, label) + label_len;
+}
+
+static TrieNode node_create(Trie trie, const char* label, uint32_t label_len) {
+	TrieNode node = malloc(node_bytes(label_len));
+	node->value = NULL;
+	node->children = NULL;
+	node->values_no = 0;
+	node->children_no = 0;
+	node->label_len = label_len;
+	memcpy(node->label, label, label_len);
+
+	trie->memory += node_bytes(label_len);
+	STATS_ADD(STAT_TRIE_NODE_ALLOCS, 1);
+	return node;
+}
+
+static void node_free(Trie trie, TrieNode node) {
+	trie->memory -= node_bytes(node->label_len) + capacity(node->children_no) * sizeof(TrieNode);
+	if (node->values_no > 1)
+		trie->memory -= capacity(node->values_no) * sizeof(Pointer);
+
+	if (node->values_no > 1)
+		free(node->values);
+	free(node->children);
+	free(node);
+}
+
+// Καταστρέφει όλο το υποδέντρο του node, μαζί με τις τιμές του
+
+static void node_destroy(Trie trie, TrieNode node) {
+	for (int i = 0; i < node->children_no; i++)
+		node_destroy(trie, node->children[i]);
+
+	if (trie->destroy_value != NULL) {
+		for (uint32_t i = 0; i < node->values_no; i++)
+			trie->destroy_value(node->values_no == 1 ? node->value : node->values[i]);
+	}
+	node_free(trie, node);
+}
+
+
+// Τιμές ///////////////////////////////////////////////////////////////////////
+
+static void values_add(Trie trie, TrieNode node, Pointer value) {
+	uint32_t n = node->values_no;
+	if (n == 0) {
+		node->value = value;
+	} else if (n == 1) {
+		Pointer first = node->value;
+		node->values = malloc(2 * sizeof(Pointer));
+		node->values[0] = first;
+		node->values[1] = value;
+		trie->memory += 2 * sizeof(Pointer);
+	} else {
+		if (capacity(n + 1) != capacity(n)) {
+			node->values = realloc(node->values, capacity(n + 1) * sizeof(Pointer));
+			trie->memory += (capacity(n + 1) - capacity(n)) * sizeof(Pointer);
+		}
+		node->values[n] = value;
+	}
+	node->values_no++;
+}
+
+// Αφαιρεί τη value (αν υπάρχει) από τις τιμές του node. Η τελευταία τιμή παίρνει τη θέση της.
+
+static bool values_remove(Trie trie, TrieNode node, Pointer value) {
+	uint32_t n = node->values_no;
+	if (n == 0) {
+		return false;
+	} else if (n == 1) {
+		if (node->value != value)
+			return false;
+		node->value = NULL;
+	} else {
+		uint32_t i = 0;
+		while (i < n && node->values[i] != value)
+			i++;
+		if (i == n)
+			return false;
+
+		node->values[i] = node->values[n - 1];
+		if (n == 2) {
+			Pointer last = node->values[0];
+			free(node->values);
+			node->value = last;
+			trie->memory -= 2 * sizeof(Pointer);
+		} else if (capacity(n - 1) != capacity(n)) {
+			node->values = realloc(node->values, capacity(n - 1) * sizeof(Pointer));
+			trie->memory -= (capacity(n) - capacity(n - 1)) * sizeof(Pointer);
+		}
+	}
+	node->values_no--;
+	return true;
+}
+
+
+// Παιδιά //////////////////////////////////////////////////////////////////////
+
+// Επιστρέφει τη θέση του παιδιού του node με label που αρχίζει από c, ή (αν δεν υπάρχει)
+// τη θέση στην οποία θα έπρεπε να προστεθεί, με found == false.
+
+static int child_position(TrieNode node, char c, bool* found) {
+	int low = 0, high = node->children_no;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		unsigned char first = node->children[mid]->label[0];
+		if (first == (unsigned char)c) {
+			*found = true;
+			return mid;
+		}
+		if (first < (unsigned char)c)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	*found = false;
+	return low;
+}
+
+static void children_insert(Trie trie, TrieNode node, int pos, TrieNode child) {
+	int n = node->children_no;
+	if (capacity(n + 1) != capacity(n)) {
+		node->children = realloc(node->children, capacity(n + 1) * sizeof(TrieNode));
+		trie->memory += (capacity(n + 1) - capacity(n)) * sizeof(TrieNode);
+	}
+	memmove(&node->children[pos + 1], &node->children[pos], (n - pos) * sizeof(TrieNode));
+	node->children[pos] = child;
+	node->children_no++;
+}
+
+static void children_remove(Trie trie, TrieNode node, int pos) {
+	int n = node->children_no;
+	memmove(&node->children[pos], &node->children[pos + 1], (n - pos - 1) * sizeof(TrieNode));
+	if (capacity(n - 1) != capacity(n)) {
+		trie->memory -= (capacity(n) - capacity(n - 1)) * sizeof(TrieNode);
+		if (n == 1) {
+			free(node->children);
+			node->children = NULL;
+		} else {
+			node->children = realloc(node->children, capacity(n - 1) * sizeof(TrieNode));
+		}
+	}
+	node->children_no--;
+}
+
+// Επιστρέφει το μήκος του κοινού prefix του label (μήκους len) με το string s
+
+static uint32_t common_prefix(const char* label, uint32_t len, const char* s) {
+	uint32_t i = 0;
+	while (i < len && label[i] == s[i])		// το '\0' του s δεν ταιριάζει με κανέναν χαρακτήρα του label
+		i++;
+	return i;
+}
+
+// Χωρίζει το label του child στη θέση common: επιστρέφει νέο κόμβο με label τους common πρώτους
+// χαρακτήρες, και μοναδικό παιδί τον child με το υπόλοιπο label.
+
+static TrieNode node_split(Trie trie, TrieNode child, uint32_t common) {
+	TrieNode parent = node_create(trie, child->label, common);
+
+	memmove(child->label, child->label + common, child->label_len - common);
+	child->label_len -= common;
+	child = realloc(child, node_bytes(child->label_len));
+	trie->memory -= common;
+
+	children_insert(trie, parent, 0, child);
+	return parent;
+}
+
+// Αν ο node (όχι η ρίζα) δεν χρειάζεται πια, τον καταργεί: χωρίς τιμές και παιδιά αφαιρείται,
+// χωρίς τιμές και με ένα παιδί συγχωνεύεται με αυτό. Επιστρέφει τον κόμβο που παίρνει τη
+// θέση του (NULL αν αφαιρέθηκε).
+
+static TrieNode node_compact(Trie trie, TrieNode node) {
+	if (node->values_no > 0 || node->children_no > 1)
+		return node;
+
+	if (node->children_no == 0) {
+		node_free(trie, node);
+		return NULL;
+	}
+
+	// Το label του node μπαίνει μπροστά από αυτό του παιδιού
+	TrieNode child = node->children[0];
+	uint32_t len = node->label_len;
+	child = realloc(child, node_bytes(child->label_len + len));
+	memmove(child->label + len, child->label, child->label_len);
+	memcpy(child->label, node->label, len);
+	child->label_len += len;
+	trie->memory += len;
+
+	node_free(trie, node);
+	return child;
+}
+
+
+// Λειτουργίες του Trie ////////////////////////////////////////////////////////
+
+Trie trie_create(DestroyFunc destroy_value) {
+	Trie trie = malloc(sizeof(*trie));
+	trie->size = 0;
+	trie->memory = 0;
+	trie->destroy_value = destroy_value;
+	trie->root = node_create(trie, "", 0);
+	return trie;
+}
+
+int trie_size(Trie trie) {
+	return trie->size;
+}
+
+void trie_insert(Trie trie, String key, Pointer value) {
+	TrieNode node = trie->root;
+	const char* p = key;
+
+	while (*p != '\0') {
+		bool found;
+		int pos = child_position(node, *p, &found);
+
+		// Κανένα παιδί δεν ξεκινάει με τον επόμενο χαρακτήρα, οπότε το υπόλοιπο key γίνεται ένα νέο φύλλο
+		if (!found) {
+			TrieNode leaf = node_create(trie, p, strlen(p));
+			children_insert(trie, node, pos, leaf);
+			node = leaf;
+			break;
+		}
+
+		// Αν το key αποκλίνει από το label μέσα σε αυτό, το label χωρίζεται στο σημείο της απόκλισης
+		TrieNode child = node->children[pos];
+		uint32_t common = common_prefix(child->label, child->label_len, p);
+		if (common < child->label_len) {
+			child = node_split(trie, child, common);
+			node->children[pos] = child;
+		}
+
+		node = child;
+		p += common;
+	}
+
+	values_add(trie, node, value);
+	trie->size++;
+}
+
+// Αφαιρεί το ζεύγος (p, value) από το υποδέντρο του node, όπου p το υπόλοιπο του key μετά το
+// label του node. Επιστρέφει τον κόμβο που παίρνει τη θέση του node (βλ. node_compact).
+
+static TrieNode node_remove(Trie trie, TrieNode node, const char* p, Pointer value, bool* removed) {
+	if (*p == '\0') {
+		*removed = values_remove(trie, node, value);
+	} else {
+		bool found;
+		int pos = child_position(node, *p, &found);
+		if (!found)
+			return node;
+
+		TrieNode child = node->children[pos];
+		uint32_t common = common_prefix(child->label, child->label_len, p);
+		if (common < child->label_len)
+			return node;
+
+		TrieNode new_child = node_remove(trie, child, p + common, value, removed);
+		if (new_child == NULL)
+			children_remove(trie, node, pos);
+		else
+			node->children[pos] = new_child;
+	}
+
+	return *removed && node != trie->root ? node_compact(trie, node) : node;
+}
+
+bool trie_remove(Trie trie, String key, Pointer value) {
+	bool removed = false;
+	node_remove(trie, trie->root, key, value, &removed);
+	if (!removed)
+		return false;
+
+	if (trie->destroy_value != NULL)
+		trie->destroy_value(value);
+	trie->size--;
+	return true;
+}
+
+// Προσθέτει στη list τις τιμές όλου του υποδέντρου του node, με τη σειρά των keys, μέχρι
+// να μηδενιστεί το remaining (αν είναι αρνητικό, χωρίς όριο)
+
+static void node_collect(TrieNode node, List list, int* remaining) {
+	for (uint32_t i = 0; i < node->values_no && *remaining != 0; i++) {
+		list_insert_next(list, list_last(list), node->values_no == 1 ? node->value : node->values[i]);
+		(*remaining)--;
+	}
+
+	for (int i = 0; i < node->children_no && *remaining != 0; i++)
+		node_collect(node->children[i], list, remaining);
+}
+
+List trie_find_prefix(Trie trie, String prefix, int limit) {
+	List list = list_create(NULL);
+
+	TrieNode node = trie->root;
+	const char* p = prefix;
+	while (*p != '\0') {
+		bool found;
+		int pos = child_position(node, *p, &found);
+		if (!found)
+			return list;
+
+		// Αν το prefix τελειώνει μέσα στο label, όλο το υποδέντρο του παιδιού ταιριάζει
+		node = node->children[pos];
+		uint32_t common = common_prefix(node->label, node->label_len, p);
+		if (p[common] == '\0')
+			break;
+		if (common < node->label_len)
+			return list;
+		p += common;
+	}
+
+	int remaining = limit;
+	node_collect(node, list, &remaining);
+	return list;
+}
+
+DestroyFunc trie_set_destroy_value(Trie trie, DestroyFunc destroy_value) {
+	DestroyFunc old = trie->destroy_value;
+	trie->destroy_value = destroy_value;
+	return old;
+}
+
+void trie_destroy(Trie trie) {
+	node_destroy(trie, trie->root);
+	free(trie);
+}
+
+size_t trie_memory(Trie trie) {
+	return sizeof(*trie) + trie->memory;
+}
+
+
+// Συναρτήσεις για έλεγχο της δομής (χρησιμοποιούνται από τα tests) ///////////
+
+// Ελέγχει το υποδέντρο του node και επιστρέφει το πλήθος των τιμών του, ή -1 αν δεν είναι σωστό
+
+static int node_check(Trie trie, TrieNode node) {
+	if (node != trie->root && (node->label_len == 0 || (node->values_no == 0 && node->children_no < 2)))
+		return -1;
+
+	int count = node->values_no;
+	for (int i = 0; i < node->children_no; i++) {
+		if (i > 0 && (unsigned char)node->children[i - 1]->label[0] >= (unsigned char)node->children[i]->label[0])
+			return -1;
+
+		int child_count = node_check(trie, node->children[i]);
+		if (child_count < 0)
+			return -1;
+		count += child_count;
+	}
+	return count;
+}
+
+bool trie_is_proper(Trie trie) {
+	return trie->root->label_len == 0 && node_check(trie, trie->root) == trie->size;
+}
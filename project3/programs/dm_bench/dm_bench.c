@@ -0,0 +1,419 @@
+//////////////////////////////////////////////////////////////////
+//
+// Benchmark του DiseaseMonitor με συνθετικό φόρτο εργασίας.
+//
+// Δημιουργεί εγγραφές με ασθένειες και χώρες κατανεμημένες κατά Zipf
+// και ημερομηνίες συγκεντρωμένες σε "κύματα" επιδημίας, φορτώνει ένα
+// αρχικό dataset και εκτελεί μια μίξη από insert / remove / update /
+// get / count / top. Για κάθε λειτουργία τυπώνει throughput και
+// latency percentiles (p50, p99, p999).
+//
+// Χρήση: ./dm_bench [options]
+//   -n <records>     αρχικές εγγραφές (default 1000000)
+//   -o <ops>         λειτουργίες μετά τη φόρτωση (default 1000000)
+//   -d <diseases>    πλήθος ασθενειών (default 200)
+//   -c <countries>   πλήθος χωρών (default 200)
+//   -z <s>           εκθέτης της κατανομής Zipf (default 1.0)
+//   -D <days>        εύρος ημερομηνιών σε μέρες από 2020-01-01 (default 730)
+//   -w <waves>       κύματα επιδημίας μέσα στο εύρος (default 3)
+//   -m <mix>         ποσοστά insert:remove:update:get:count:top (default 40:20:10:10:15:5)
+//   -t <threads>     dm_set_threads (default 1)
+//   -O               owned mode (dm_set_owned)
+//   -s <seed>        seed της γεννήτριας (default 1)
+//   -T <path>        καταγραφή όλων των λειτουργιών σε trace (βλ. dm_replay)
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "DiseaseMonitor.h"
+
+
+// Γεννήτρια τυχαίων αριθμών (xorshift64*), ανεξάρτητη από την rand() ώστε το
+// ίδιο seed να δίνει τον ίδιο φόρτο σε κάθε πλατφόρμα.
+
+static uint64_t rng_state;
+
+static uint64_t rng_next() {
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return rng_state * 2685821657736338717ULL;
+}
+
+// Ομοιόμορφα στο [0, 1)
+static double rng_uniform() {
+	return (rng_next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Κανονική κατανομή (Box-Muller)
+static double rng_normal() {
+	double u = rng_uniform() + 1e-12, v = rng_uniform();
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+
+// Κατανομή Zipf πάνω σε n στοιχεία: το στοιχείο i (0-based) έχει πιθανότητα ανάλογη του 1 / (i+1)^s.
+// Κρατάμε την αθροιστική κατανομή και κάνουμε δυαδική αναζήτηση.
+
+typedef struct {
+	double* cdf;
+	int n;
+} Zipf;
+
+static Zipf zipf_create(int n, double s) {
+	Zipf zipf = { .cdf = malloc(n * sizeof(double)), .n = n };
+	double sum = 0;
+	for (int i = 0; i < n; i++)
+		zipf.cdf[i] = sum += 1 / pow(i + 1, s);
+	for (int i = 0; i < n; i++)
+		zipf.cdf[i] /= sum;
+	return zipf;
+}
+
+static int zipf_sample(Zipf* zipf) {
+	double u = rng_uniform();
+	int lo = 0, hi = zipf->n - 1;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (zipf->cdf[mid] < u)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+
+// Ημερομηνίες ////////////////////////////////////////////////////////////////
+
+// Γράφει στο buffer (τουλάχιστον 11 chars) την ημερομηνία days μέρες μετά το 2020-01-01
+static void format_date(char* buffer, int days) {
+	// Μετατροπή από αριθμό ημερών σε ημερομηνία του Γρηγοριανού ημερολογίου (civil_from_days)
+	long z = days + 18262 + 719468;			// 18262: μέρες από 1970-01-01 μέχρι 2020-01-01
+	long era = z / 146097;
+	long doe = z - era * 146097;
+	long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	long mp = (5 * doy + 2) / 153;
+	long day = doy - (153 * mp + 2) / 5 + 1;
+	long month = mp < 10 ? mp + 3 : mp - 9;
+	long year = yoe + era * 400 + (month <= 2);
+
+	sprintf(buffer, "%04ld-%02ld-%02ld", year, month, day);
+}
+
+static int days_range;		// -D
+static int waves;			// -w
+
+// Τυχαία μέρα: το 80% των κρουσμάτων ανήκει σε κάποιο κύμα (κανονική κατανομή γύρω από
+// το κέντρο του), το υπόλοιπο 20% είναι ομοιόμορφα κατανεμημένο σε όλο το εύρος.
+static int random_day() {
+	int day;
+	if (waves > 0 && rng_uniform() < 0.8) {
+		int wave = rng_next() % waves;
+		double center = (wave + 0.5) * days_range / waves;
+		day = (int)(center + rng_normal() * days_range / (6.0 * waves));
+	} else {
+		day = rng_next() % days_range;
+	}
+	return day < 0 ? 0 : day >= days_range ? days_range - 1 : day;
+}
+
+
+// Εγγραφές ////////////////////////////////////////////////////////////////////
+
+static String* disease_names;
+static String* country_names;
+static Zipf disease_zipf, country_zipf;
+
+// Οι εγγραφές που δημιουργούνται κατά το benchmark. Δεν κάνουμε ποτέ free ένα record πριν το
+// τέλος, αφού (εκτός από το owned mode) ο monitor μπορεί να το κρατάει ακόμα.
+typedef struct {
+	struct record record;
+	char name[16];
+	char date[11];
+} Slot;
+
+static Slot* slots;
+static int slots_used;
+
+static Record new_record(int id) {
+	Slot* slot = &slots[slots_used++];
+	sprintf(slot->name, "p%d", id);
+	format_date(slot->date, random_day());
+
+	slot->record = (struct record){
+		.id = id, .name = slot->name, .date = slot->date,
+		.disease = disease_names[zipf_sample(&disease_zipf)],
+		.country = country_names[zipf_sample(&country_zipf)],
+	};
+	return &slot->record;
+}
+
+static String* create_names(char* prefix, int n) {
+	String* names = malloc(n * sizeof(String));
+	for (int i = 0; i < n; i++) {
+		names[i] = malloc(strlen(prefix) + 12);
+		sprintf(names[i], "%s%d", prefix, i);
+	}
+	return names;
+}
+
+
+// Μετρήσεις ///////////////////////////////////////////////////////////////////
+
+enum { OP_INSERT, OP_REMOVE, OP_UPDATE, OP_GET, OP_COUNT, OP_TOP, OP_NO };
+static char* op_names[OP_NO] = { "insert", "remove", "update", "get", "count", "top" };
+
+// Οι latencies κάθε λειτουργίας, σε nanoseconds
+typedef struct {
+	uint64_t* samples;
+	int size;
+	int capacity;
+} Samples;
+
+static Samples samples[OP_NO];
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void add_sample(int op, uint64_t ns) {
+	Samples* s = &samples[op];
+	if (s->size == s->capacity) {
+		s->capacity = s->capacity == 0 ? 1024 : 2 * s->capacity;
+		s->samples = realloc(s->samples, s->capacity * sizeof(uint64_t));
+	}
+	s->samples[s->size++] = ns;
+}
+
+static int compare_u64(const void* a, const void* b) {
+	uint64_t x = *(uint64_t*)a, y = *(uint64_t*)b;
+	return (x > y) - (x < y);
+}
+
+// Το p-οστό percentile (0 <= p <= 1) ενός ταξινομημένου πίνακα, σε microseconds
+static double percentile(Samples* s, double p) {
+	int pos = (int)(p * (s->size - 1) + 0.5);
+	return s->samples[pos] / 1000.0;
+}
+
+static void print_report() {
+	printf("%-8s %10s %12s %10s %10s %10s %10s\n", "op", "count", "ops/sec", "p50 (us)", "p99 (us)", "p999 (us)", "max (us)");
+
+	for (int op = 0; op < OP_NO; op++) {
+		Samples* s = &samples[op];
+		if (s->size == 0)
+			continue;
+
+		qsort(s->samples, s->size, sizeof(uint64_t), compare_u64);
+		uint64_t total = 0;
+		for (int i = 0; i < s->size; i++)
+			total += s->samples[i];
+
+		printf("%-8s %10d %12.0f %10.2f %10.2f %10.2f %10.2f\n", op_names[op], s->size,
+			s->size / (total / 1e9), percentile(s, 0.5), percentile(s, 0.99), percentile(s, 0.999), percentile(s, 1));
+	}
+}
+
+
+// Η μνήμη κάθε index του monitor, συνολικά και ανά εγγραφή
+static void print_memory() {
+	struct dm_memory memory;
+	dm_memory_usage(&memory);
+
+	// Όλα τα πεδία του struct dm_memory, με τη σειρά τους
+	char* names[] = { "entries", "ids", "names", "monitor", "dates", "countries", "tops", "diseases", "regions", "versions", "ranking", "arena", "history", "total" };
+	size_t values[] = { memory.entries, memory.ids, memory.names, memory.monitor, memory.dates, memory.countries, memory.tops, memory.diseases,
+		memory.regions, memory.versions, memory.ranking, memory.arena, memory.history, memory.total };
+	int records = dm_count_records(NULL, NULL, NULL, NULL);
+
+	printf("\n%-10s %12s %12s\n", "index", "MB", "bytes/rec");
+	for (int i = 0; i < (int)(sizeof(values) / sizeof(values[0])); i++)
+		printf("%-10s %12.2f %12.1f\n", names[i], values[i] / 1048576.0, records > 0 ? (double)values[i] / records : 0);
+}
+
+
+// Φόρτος εργασίας /////////////////////////////////////////////////////////////
+
+// Τα ids που υπάρχουν στον monitor, ώστε τα remove / update να επιλέγουν υπαρκτές εγγραφές
+static int* live;
+static int live_size;
+static int next_id;
+
+// Τυχαίο εύρος ημερομηνιών 30 ημερών, ή NULL με πιθανότητα 30%
+static void random_range(char* from, char* to, Date* date_from, Date* date_to) {
+	*date_from = *date_to = NULL;
+	if (rng_uniform() < 0.3)
+		return;
+
+	int day = rng_next() % days_range;
+	format_date(from, day);
+	format_date(to, day + 30);
+	*date_from = from;
+	*date_to = to;
+}
+
+static void run_op(int op) {
+	char from[11], to[11];
+	Date date_from, date_to;
+	String disease = rng_uniform() < 0.5 ? disease_names[zipf_sample(&disease_zipf)] : NULL;
+	String country = rng_uniform() < 0.5 ? country_names[zipf_sample(&country_zipf)] : NULL;
+
+	// Χωρίς εγγραφές, τα remove / update γίνονται insert
+	if ((op == OP_REMOVE || op == OP_UPDATE) && live_size == 0)
+		op = OP_INSERT;
+
+	// Η προετοιμασία των ορισμάτων γίνεται εκτός μέτρησης
+	Record record = NULL;
+	int pos = 0;
+	if (op == OP_INSERT)
+		record = new_record(next_id);
+	else if (op == OP_UPDATE)
+		record = new_record(live[pos = rng_next() % live_size]);
+	else if (op == OP_REMOVE)
+		pos = rng_next() % live_size;
+	else if (op == OP_GET || op == OP_COUNT)
+		random_range(from, to, &date_from, &date_to);
+
+	uint64_t start = now_ns();
+	switch (op) {
+		case OP_INSERT:
+			dm_insert_record(record);
+			break;
+		case OP_REMOVE:
+			dm_remove_record(live[pos]);
+			break;
+		case OP_UPDATE:
+			dm_update_record(record->id, record);
+			break;
+		case OP_GET:
+			list_destroy(dm_get_records(disease, country, date_from, date_to));
+			break;
+		case OP_COUNT:
+			dm_count_records(disease, country, date_from, date_to);
+			break;
+		case OP_TOP:
+			list_destroy(dm_top_diseases(10, country));
+			break;
+	}
+	add_sample(op, now_ns() - start);
+
+	if (op == OP_INSERT)
+		live[live_size++] = next_id++;
+	else if (op == OP_REMOVE)
+		live[pos] = live[--live_size];
+}
+
+int main(int argc, char* argv[]) {
+	int records = 1000000, ops = 1000000, disease_no = 200, country_no = 200, threads = 1;
+	double zipf_s = 1.0;
+	int mix[OP_NO] = { 40, 20, 10, 10, 15, 5 };
+	bool owned = false;
+	uint64_t seed = 1;
+	char* trace = NULL;
+	days_range = 730;
+	waves = 3;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:o:d:c:z:D:w:m:t:Os:T:")) != -1) {
+		switch (opt) {
+			case 'n': records = atoi(optarg); break;
+			case 'o': ops = atoi(optarg); break;
+			case 'd': disease_no = atoi(optarg); break;
+			case 'c': country_no = atoi(optarg); break;
+			case 'z': zipf_s = atof(optarg); break;
+			case 'D': days_range = atoi(optarg); break;
+			case 'w': waves = atoi(optarg); break;
+			case 't': threads = atoi(optarg); break;
+			case 'O': owned = true; break;
+			case 's': seed = strtoull(optarg, NULL, 10); break;
+			case 'T': trace = optarg; break;
+			case 'm':
+				if (sscanf(optarg, "%d:%d:%d:%d:%d:%d", &mix[0], &mix[1], &mix[2], &mix[3], &mix[4], &mix[5]) != OP_NO) {
+					fprintf(stderr, "invalid mix: %s\n", optarg);
+					return 1;
+				}
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-n records] [-o ops] [-d diseases] [-c countries] [-z zipf_s] [-D days] [-w waves] [-m mix] [-t threads] [-O] [-s seed] [-T trace]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	int mix_total = 0;
+	for (int op = 0; op < OP_NO; op++)
+		mix_total += mix[op];
+	if (mix_total <= 0 || days_range <= 0) {
+		fprintf(stderr, "invalid parameters\n");
+		return 1;
+	}
+
+	rng_state = seed * 0x9E3779B97F4A7C15ULL + 1;
+	disease_names = create_names("disease-", disease_no);
+	country_names = create_names("country-", country_no);
+	disease_zipf = zipf_create(disease_no, zipf_s);
+	country_zipf = zipf_create(country_no, zipf_s);
+
+	// Κάθε λειτουργία δημιουργεί το πολύ μία εγγραφή
+	slots = malloc((size_t)(records + ops) * sizeof(Slot));
+	live = malloc((size_t)(records + ops) * sizeof(int));
+	slots_used = live_size = next_id = 0;
+
+	dm_set_owned(owned);
+	dm_set_threads(threads);
+	dm_init();
+
+	if (trace != NULL && !dm_trace_start(trace)) {
+		fprintf(stderr, "cannot create trace %s\n", trace);
+		return 1;
+	}
+
+	// Φόρτωση
+	uint64_t start = now_ns();
+	for (int i = 0; i < records; i++)
+		run_op(OP_INSERT);
+	double load_time = (now_ns() - start) / 1e9;
+	printf("load: %d records in %.3f sec (%.0f inserts/sec)\n", records, load_time, records / load_time);
+
+	// Οι μετρήσεις της φόρτωσης δεν περιλαμβάνονται στην αναφορά
+	samples[OP_INSERT].size = 0;
+
+	start = now_ns();
+	for (int i = 0; i < ops; i++) {
+		int r = rng_next() % mix_total, op = 0;
+		while (r >= mix[op])
+			r -= mix[op++];
+		run_op(op);
+	}
+	double wall_time = (now_ns() - start) / 1e9;
+
+	printf("mixed: %d ops in %.3f sec (%.0f ops/sec), %d records at the end\n", ops, wall_time, ops / wall_time, live_size);
+	print_report();
+	print_memory();
+
+	dm_trace_stop();
+	dm_destroy();
+	for (int i = 0; i < disease_no; i++)
+		free(disease_names[i]);
+	for (int i = 0; i < country_no; i++)
+		free(country_names[i]);
+	for (int op = 0; op < OP_NO; op++)
+		free(samples[op].samples);
+	free(disease_names);
+	free(country_names);
+	free(disease_zipf.cdf);
+	free(country_zipf.cdf);
+	free(slots);
+	free(live);
+	return 0;
+}
@@ -0,0 +1,349 @@
+//////////////////////////////////////////////////////////////////
+//
+// Command line interface του DiseaseMonitor.
+//
+// Διαβάζει εντολές (μία ανά γραμμή) από ένα αρχείο ή το stdin, τις
+// εκτελεί και τυπώνει τα αποτελέσματα στο stdout:
+//
+//   insert <id> <name> <disease> <country> <date>   => inserted | replaced
+//   remove <id>                                      => removed | not found
+//   get <disease> <country> <date_from> <date_to>    => το πλήθος, και μετά μία γραμμή ανά εγγραφή:
+//                                                       id, name, disease, country, date (με tabs)
+//   count <disease> <country> <date_from> <date_to>  => το πλήθος
+//   page <newest|oldest> <offset> <limit> <disease> <country> <date_from> <date_to>
+//                                                    => όπως η get, για μια σελίδα κατά ημερομηνία (βλ. dm_get_records_page)
+//   sample <k> <seed> <disease> <country> <date_from> <date_to>
+//                                                    => όπως η get, για ένα τυχαίο δείγμα (βλ. dm_sample_records)
+//   bycountry <disease> <date_from> <date_to>        => το πλήθος των χωρών, και μετά μία γραμμή ανά χώρα:
+//                                                       country, count (με tabs, βλ. dm_count_by_country)
+//   bydisease <country> <date_from> <date_to>        => το ίδιο ανά ασθένεια (βλ. dm_count_by_disease)
+//   top <k> <country>                                => οι ασθένειες, χωρισμένες με tabs
+//   countries <k> <disease>                          => οι χώρες, χωρισμένες με tabs (βλ. dm_top_countries)
+//   percentile <p> <disease> <country> <date_from> <date_to>
+//                                                    => η ημερομηνία (βλ. dm_date_percentile), ή -
+//   region <country> <region> <continent>            => ok (βλ. dm_set_region, η continent μπορεί να είναι -)
+//
+// Τα ορίσματα χωρίζονται με κενά, ή γράφονται σε "εισαγωγικά" αν περιέχουν
+// κενά. Το "-" σημαίνει NULL (χωρίς φίλτρο). Οι κενές γραμμές και όσες
+// αρχίζουν με # αγνοούνται. Σε λάθος τυπώνεται μια γραμμή "error: ...".
+//
+// Χρήση: ./dm_cli [-b] [-t threads] [file]
+//   -b           Batch mode: διαδοχικές insert εκτελούνται ως ένα bulk load (dm_insert_records)
+//                και διαδοχικές count ως ένα batch (dm_count_records_batch). Η έξοδος είναι ίδια.
+//   -t <threads> dm_set_threads (default 1)
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "DiseaseMonitor.h"
+
+
+#define MAX_ARGS 8
+
+// Μέγιστο μέγεθος batch, ώστε η έξοδος να μην καθυστερεί απεριόριστα
+#define MAX_BATCH 4096
+
+// Μια εντολή που περιμένει να εκτελεστεί στο τρέχον batch. Κρατάει δικό της αντίγραφο της
+// γραμμής, στο οποίο δείχνουν τα ορίσματα.
+typedef struct {
+	char* line;
+	struct record record;			// insert
+	struct dm_query query;			// count
+} Pending;
+
+static Pending batch[MAX_BATCH];
+static int batch_size;
+static enum { BATCH_NONE, BATCH_INSERT, BATCH_COUNT } batch_type;
+
+
+// Χωρίζει τη line (την οποία τροποποιεί) σε ορίσματα. Επιστρέφει το πλήθος τους, ή -1 αν
+// υπάρχουν περισσότερα από MAX_ARGS ή εισαγωγικά που δεν κλείνουν.
+
+static int split(char* line, char* args[]) {
+	int n = 0;
+	char* p = line;
+
+	while (true) {
+		while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+			p++;
+		if (*p == '\0' || *p == '#')
+			return n;
+		if (n == MAX_ARGS)
+			return -1;
+
+		if (*p == '"') {
+			args[n++] = ++p;
+			if ((p = strchr(p, '"')) == NULL)
+				return -1;
+		} else {
+			args[n++] = p;
+			while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+				p++;
+			if (*p == '\0')
+				return n;
+		}
+		*p++ = '\0';
+	}
+}
+
+static char* nullable(char* arg) {
+	return strcmp(arg, "-") == 0 ? NULL : arg;
+}
+
+static bool parse_int(char* arg, int* value) {
+	char* end;
+	long l = strtol(arg, &end, 10);
+	*value = (int)l;
+	return *end == '\0' && end != arg && l == *value;
+}
+
+static void print_record(Record record) {
+	printf("%d\t%s\t%s\t%s\t%s\n", record->id, record->name, record->disease, record->country, record->date);
+}
+
+
+// Batch ///////////////////////////////////////////////////////////////////////
+
+// Εκτελεί όλες τις εντολές του batch και τυπώνει τα αποτελέσματά τους
+
+static void flush_batch() {
+	if (batch_size == 0)
+		return;
+
+	if (batch_type == BATCH_INSERT) {
+		Record records[batch_size];
+		bool replaced[batch_size];
+		for (int i = 0; i < batch_size; i++)
+			records[i] = &batch[i].record;
+
+		dm_insert_records(records, batch_size, replaced);
+		for (int i = 0; i < batch_size; i++)
+			puts(replaced[i] ? "replaced" : "inserted");
+
+	} else {
+		struct dm_query queries[batch_size];
+		int results[batch_size];
+		for (int i = 0; i < batch_size; i++)
+			queries[i] = batch[i].query;
+
+		dm_count_records_batch(queries, batch_size, results);
+		for (int i = 0; i < batch_size; i++)
+			printf("%d\n", results[i]);
+	}
+
+	// Στο owned mode ο monitor έχει κρατήσει αντίγραφα, οπότε οι γραμμές δεν χρειάζονται πια
+	for (int i = 0; i < batch_size; i++)
+		free(batch[i].line);
+	batch_size = 0;
+	batch_type = BATCH_NONE;
+}
+
+// Προσθέτει μια εντολή στο batch, εκτελώντας πρώτα το τρέχον αν είναι άλλου τύπου ή γεμάτο.
+// Το batch αναλαμβάνει τη line (στην οποία δείχνουν τα ορίσματα της εντολής).
+
+static Pending* add_to_batch(int type, char* line) {
+	if (batch_type != type || batch_size == MAX_BATCH)
+		flush_batch();
+
+	batch_type = type;
+	Pending* pending = &batch[batch_size++];
+	pending->line = line;
+	return pending;
+}
+
+
+// Εκτέλεση εντολών ////////////////////////////////////////////////////////////
+
+static void execute(char* line, bool batch_mode) {
+	// Τα ορίσματα δείχνουν μέσα σε ένα αντίγραφο της γραμμής, το οποίο στο batch mode
+	// κρατάει το batch μέχρι να εκτελεστεί η εντολή.
+	char* copy = strdup(line);
+	char* args[MAX_ARGS];
+	int n = split(copy, args);
+
+	if (n == 0) {
+		free(copy);
+		return;
+	}
+
+	char* command = n > 0 ? args[0] : "";
+	int id;
+	bool is_insert = strcmp(command, "insert") == 0;
+	bool is_count = strcmp(command, "count") == 0;
+
+	// Οι εντολές που δεν μπαίνουν σε batch πρέπει να δουν τα αποτελέσματα όλων των προηγούμενων
+	if (batch_mode && !is_insert && !is_count)
+		flush_batch();
+
+	if (n < 0) {
+		puts("error: too many arguments or unterminated quote");
+
+	} else if (is_insert) {
+		if (n != 6 || !parse_int(args[1], &id)) {
+			puts("error: usage: insert <id> <name> <disease> <country> <date>");
+		} else if (batch_mode) {
+			Pending* pending = add_to_batch(BATCH_INSERT, copy);
+			pending->record = (struct record){ .id = id, .name = args[2], .disease = args[3], .country = args[4], .date = args[5] };
+			copy = NULL;
+		} else {
+			struct record record = { .id = id, .name = args[2], .disease = args[3], .country = args[4], .date = args[5] };
+			puts(dm_insert_record(&record) ? "replaced" : "inserted");
+		}
+
+	} else if (strcmp(command, "remove") == 0) {
+		if (n != 2 || !parse_int(args[1], &id))
+			puts("error: usage: remove <id>");
+		else
+			puts(dm_remove_record(id) ? "removed" : "not found");
+
+	} else if (is_count || strcmp(command, "get") == 0) {
+		if (n != 5) {
+			printf("error: usage: %s <disease> <country> <date_from> <date_to>\n", command);
+		} else if (is_count && batch_mode) {
+			Pending* pending = add_to_batch(BATCH_COUNT, copy);
+			pending->query = (struct dm_query){
+				.disease = nullable(args[1]), .country = nullable(args[2]), .date_from = nullable(args[3]), .date_to = nullable(args[4]),
+			};
+			copy = NULL;
+		} else if (is_count) {
+			printf("%d\n", dm_count_records(nullable(args[1]), nullable(args[2]), nullable(args[3]), nullable(args[4])));
+		} else {
+			List list = dm_get_records(nullable(args[1]), nullable(args[2]), nullable(args[3]), nullable(args[4]));
+			printf("%d\n", list_size(list));
+			for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+				print_record(list_node_value(list, node));
+			list_destroy(list);
+		}
+
+	} else if (strcmp(command, "page") == 0) {
+		int offset, limit;
+		if (n != 8 || (strcmp(args[1], "newest") != 0 && strcmp(args[1], "oldest") != 0) || !parse_int(args[2], &offset) || !parse_int(args[3], &limit)) {
+			puts("error: usage: page <newest|oldest> <offset> <limit> <disease> <country> <date_from> <date_to>");
+		} else {
+			List list = dm_get_records_page(nullable(args[4]), nullable(args[5]), nullable(args[6]), nullable(args[7]), strcmp(args[1], "newest") == 0, offset, limit);
+			printf("%d\n", list_size(list));
+			for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+				print_record(list_node_value(list, node));
+			list_destroy(list);
+		}
+
+	} else if (strcmp(command, "sample") == 0) {
+		int k, seed;
+		if (n != 7 || !parse_int(args[1], &k) || !parse_int(args[2], &seed)) {
+			puts("error: usage: sample <k> <seed> <disease> <country> <date_from> <date_to>");
+		} else {
+			List list = dm_sample_records(k, nullable(args[3]), nullable(args[4]), nullable(args[5]), nullable(args[6]), seed);
+			printf("%d\n", list_size(list));
+			for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+				print_record(list_node_value(list, node));
+			list_destroy(list);
+		}
+
+	} else if (strcmp(command, "bycountry") == 0 || strcmp(command, "bydisease") == 0) {
+		bool by_country = strcmp(command, "bycountry") == 0;
+		if (n != 4) {
+			puts(by_country ? "error: usage: bycountry <disease> <date_from> <date_to>" : "error: usage: bydisease <country> <date_from> <date_to>");
+		} else {
+			int size;
+			DMGroupCount groups = by_country
+				? dm_count_by_country(nullable(args[1]), nullable(args[2]), nullable(args[3]), &size)
+				: dm_count_by_disease(nullable(args[1]), nullable(args[2]), nullable(args[3]), &size);
+			printf("%d\n", size);
+			for (int i = 0; i < size; i++)
+				printf("%s\t%d\n", groups[i].key, groups[i].count);
+			free(groups);
+		}
+
+	} else if (strcmp(command, "top") == 0 || strcmp(command, "countries") == 0) {
+		int k;
+		bool top = strcmp(command, "top") == 0;
+		if (n != 3 || !parse_int(args[1], &k)) {
+			puts(top ? "error: usage: top <k> <country>" : "error: usage: countries <k> <disease>");
+		} else {
+			List list = top ? dm_top_diseases(k, nullable(args[2])) : dm_top_countries(k, nullable(args[2]));
+			for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+				printf("%s%s", node == list_first(list) ? "" : "\t", (String)list_node_value(list, node));
+			putchar('\n');
+			list_destroy(list);
+		}
+
+	} else if (strcmp(command, "percentile") == 0) {
+		char* end;
+		double p = n == 6 ? strtod(args[1], &end) : 0;
+		if (n != 6 || *args[1] == '\0' || *end != '\0') {
+			puts("error: usage: percentile <p> <disease> <country> <date_from> <date_to>");
+		} else {
+			Date date = dm_date_percentile(nullable(args[2]), nullable(args[3]), nullable(args[4]), nullable(args[5]), p);
+			puts(date != NULL ? date : "-");
+		}
+
+	} else if (strcmp(command, "region") == 0) {
+		if (n != 4 || strcmp(args[1], "-") == 0 || strcmp(args[2], "-") == 0)
+			puts("error: usage: region <country> <region> <continent>");
+		else if (!dm_set_region(args[1], args[2], nullable(args[3])))
+			puts("error: conflicting region names");
+		else
+			puts("ok");
+
+	} else {
+		printf("error: unknown command %s\n", command);
+	}
+
+	free(copy);
+}
+
+int main(int argc, char* argv[]) {
+	bool batch_mode = false;
+	int threads = 1;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "bt:")) != -1) {
+		switch (opt) {
+			case 'b': batch_mode = true; break;
+			case 't': threads = atoi(optarg); break;
+			default:
+				fprintf(stderr, "usage: %s [-b] [-t threads] [file]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	FILE* input = stdin;
+	if (optind < argc && (input = fopen(argv[optind], "r")) == NULL) {
+		fprintf(stderr, "cannot open %s\n", argv[optind]);
+		return 1;
+	}
+
+	// Σε terminal τυπώνουμε prompt και κάθε αποτέλεσμα αμέσως, αλλιώς η έξοδος γίνεται σε μεγάλα blocks
+	bool interactive = input == stdin && isatty(STDIN_FILENO);
+	if (!interactive)
+		setvbuf(stdout, NULL, _IOFBF, 1 << 16);
+
+	// Οι γραμμές της εισόδου δεν ζουν όσο ο monitor, οπότε αυτός κρατάει δικά του αντίγραφα
+	dm_set_owned(true);
+	dm_set_threads(threads);
+	dm_init();
+
+	char* line = NULL;
+	size_t capacity = 0;
+	while (true) {
+		if (interactive) {
+			printf("> ");
+			fflush(stdout);
+		}
+		if (getline(&line, &capacity, input) == -1)
+			break;
+
+		execute(line, batch_mode && !interactive);
+	}
+	flush_batch();
+
+	free(line);
+	if (input != stdin)
+		fclose(input);
+	dm_destroy();
+	return 0;
+}
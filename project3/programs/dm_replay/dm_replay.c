@@ -0,0 +1,216 @@
+//////////////////////////////////////////////////////////////////
+//
+// Επανεκτέλεση ενός trace (βλ. dm_trace_start) πάνω στον
+// DiseaseMonitor, με καταγραφή των latencies κάθε λειτουργίας.
+//
+// Χρήση: ./dm_replay [options] <trace>
+//   -p           Εκτέλεση με τον ρυθμό του αρχικού trace (default: όσο πιο γρήγορα γίνεται)
+//   -x <speed>   Με το -p: πολλαπλασιαστής ταχύτητας, πχ -x 2 για διπλάσιο ρυθμό (default 1)
+//   -t <threads> dm_set_threads (default 1)
+//   -O           owned mode (dm_set_owned)
+//   -j           Αναφορά σε JSON
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "DiseaseMonitor.h"
+#include "ADTVector.h"
+#include "Stats.h"
+#include "Trace.h"
+
+
+static const char* op_names[TRACE_OPS_NO] = {
+	"insert", "remove", "update", "get", "count", "top", "page", "sample", "by_country", "by_disease",
+	"top_countries", "prefix", "percentile", "set_region"
+};
+
+// Latencies ανά λειτουργία, και (με -p) η καθυστέρηση κάθε λειτουργίας σε σχέση με τη στιγμή
+// που έπρεπε να ξεκινήσει, πχ επειδή οι προηγούμενες άργησαν
+static struct histogram latencies[TRACE_OPS_NO];
+static struct histogram lag;
+
+
+// Δημιουργεί ένα αντίγραφο του record, με τα name και date στην ίδια malloc. Τα disease
+// και country ανήκουν στο λεξικό του reader, οπότε ισχύουν μέχρι το τέλος.
+
+static Record copy_record(Record record) {
+	size_t name_len = strlen(record->name) + 1;
+	size_t date_len = strlen(record->date) + 1;
+
+	Record copy = malloc(sizeof(*copy) + name_len + date_len);
+	*copy = *record;
+	copy->name = (char*)(copy + 1);
+	copy->date = copy->name + name_len;
+	memcpy(copy->name, record->name, name_len);
+	memcpy(copy->date, record->date, date_len);
+	return copy;
+}
+
+// Η nanosleep μπορεί να κοιμηθεί αρκετά παραπάνω από όσο ζητήθηκε (συνήθως δεκάδες ή
+// εκατοντάδες μs), που με πολλές μικρές αναμονές θα καθυστερούσε όλο το replay. Κοιμόμαστε
+// λοιπόν μέχρι SPIN_NS πριν το target, και περιμένουμε το υπόλοιπο ενεργά.
+#define SPIN_NS 1000000
+
+static void sleep_until(uint64_t target) {
+	uint64_t now = stats_now();
+	if (target > now + SPIN_NS) {
+		uint64_t wait = target - now - SPIN_NS;
+		struct timespec ts = { .tv_sec = wait / 1000000000, .tv_nsec = wait % 1000000000 };
+		nanosleep(&ts, NULL);
+	}
+
+	while (stats_now() < target)
+		;
+}
+
+static void print_histogram(const char* name, Histogram h, bool json, bool first) {
+	double mean = h->count > 0 ? (double)h->sum / h->count : 0;
+	if (json)
+		printf("%s\"%s\":{\"count\":%lu,\"mean_ns\":%.0f,\"p50_ns\":%lu,\"p99_ns\":%lu,\"p999_ns\":%lu,\"max_ns\":%lu}",
+			first ? "" : ",", name, (unsigned long)h->count, mean, (unsigned long)histogram_percentile(h, 50),
+			(unsigned long)histogram_percentile(h, 99), (unsigned long)histogram_percentile(h, 99.9), (unsigned long)h->max);
+	else
+		printf("%-13s %10lu %10.2f %10.2f %10.2f %10.2f %10.2f\n", name, (unsigned long)h->count, mean / 1000,
+			histogram_percentile(h, 50) / 1000.0, histogram_percentile(h, 99) / 1000.0,
+			histogram_percentile(h, 99.9) / 1000.0, h->max / 1000.0);
+}
+
+int main(int argc, char* argv[]) {
+	bool paced = false, owned = false, json = false;
+	double speed = 1;
+	int threads = 1;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "px:t:Oj")) != -1) {
+		switch (opt) {
+			case 'p': paced = true; break;
+			case 'x': speed = atof(optarg); break;
+			case 't': threads = atoi(optarg); break;
+			case 'O': owned = true; break;
+			case 'j': json = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-p] [-x speed] [-t threads] [-O] [-j] <trace>\n", argv[0]);
+				return 1;
+		}
+	}
+	if (optind != argc - 1 || speed <= 0) {
+		fprintf(stderr, "usage: %s [-p] [-x speed] [-t threads] [-O] [-j] <trace>\n", argv[0]);
+		return 1;
+	}
+
+	TraceReader reader = trace_reader_create(argv[optind]);
+	if (reader == NULL) {
+		fprintf(stderr, "cannot read trace %s\n", argv[optind]);
+		return 1;
+	}
+
+	dm_set_owned(owned);
+	dm_set_threads(threads);
+	dm_init();
+
+	// Εκτός από το owned mode, τα records πρέπει να ζουν όσο τα κρατάει ο monitor, οπότε
+	// τα αντίγραφα ελευθερώνονται στο τέλος.
+	Vector copies = vector_create(0, free);
+
+	struct trace_op op;
+	uint64_t start = stats_now();
+	int ops = 0;
+
+	while (trace_read(reader, &op)) {
+		if (paced) {
+			uint64_t target = start + (uint64_t)(op.time / speed);
+			sleep_until(target);
+			uint64_t now = stats_now();
+			histogram_record(&lag, now > target ? now - target : 0);
+		}
+
+		Record record = &op.record;
+		if ((op.type == TRACE_INSERT || op.type == TRACE_UPDATE) && !owned) {
+			record = copy_record(record);
+			vector_insert_last(copies, record);
+		}
+
+		uint64_t op_start = stats_now();
+		switch (op.type) {
+			case TRACE_INSERT:
+				dm_insert_record(record);
+				break;
+			case TRACE_REMOVE:
+				dm_remove_record(op.id);
+				break;
+			case TRACE_UPDATE:
+				dm_update_record(op.id, record);
+				break;
+			case TRACE_GET_RECORDS:
+				list_destroy(dm_get_records(op.disease, op.country, op.date_from, op.date_to));
+				break;
+			case TRACE_COUNT_RECORDS:
+				dm_count_records(op.disease, op.country, op.date_from, op.date_to);
+				break;
+			case TRACE_TOP_DISEASES:
+				list_destroy(dm_top_diseases(op.k, op.country));
+				break;
+			case TRACE_GET_RECORDS_PAGE:
+				list_destroy(dm_get_records_page(op.disease, op.country, op.date_from, op.date_to, op.newest_first, op.offset, op.limit));
+				break;
+			case TRACE_SAMPLE_RECORDS:
+				list_destroy(dm_sample_records(op.k, op.disease, op.country, op.date_from, op.date_to, op.seed));
+				break;
+			case TRACE_COUNT_BY_COUNTRY: {
+				int n;
+				free(dm_count_by_country(op.disease, op.date_from, op.date_to, &n));
+				break;
+			}
+			case TRACE_COUNT_BY_DISEASE: {
+				int n;
+				free(dm_count_by_disease(op.country, op.date_from, op.date_to, &n));
+				break;
+			}
+			case TRACE_TOP_COUNTRIES:
+				list_destroy(dm_top_countries(op.k, op.disease));
+				break;
+			case TRACE_FIND_BY_NAME_PREFIX:
+				list_destroy(dm_find_by_name_prefix(op.prefix, op.limit));
+				break;
+			case TRACE_DATE_PERCENTILE:
+				dm_date_percentile(op.disease, op.country, op.date_from, op.date_to, op.p);
+				break;
+			case TRACE_SET_REGION:
+				dm_set_region(op.country, op.region, op.continent);
+				break;
+			default:
+				break;
+		}
+		histogram_record(&latencies[op.type], stats_now() - op_start);
+		ops++;
+	}
+	double wall_time = (stats_now() - start) / 1e9;
+
+	if (json) {
+		printf("{\"ops\":%d,\"seconds\":%.6f,\"ops_per_sec\":%.0f,\"operations\":{", ops, wall_time, ops / wall_time);
+		for (int i = 0; i < TRACE_OPS_NO; i++)
+			print_histogram(op_names[i], &latencies[i], true, i == 0);
+		printf("}");
+		if (paced)
+			print_histogram("lag", &lag, true, false);
+		printf("}\n");
+	} else {
+		printf("replayed %d ops in %.3f sec (%.0f ops/sec)%s\n", ops, wall_time, ops / wall_time, paced ? ", paced" : "");
+		printf("%-13s %10s %10s %10s %10s %10s %10s\n", "op", "count", "mean (us)", "p50 (us)", "p99 (us)", "p999 (us)", "max (us)");
+		for (int i = 0; i < TRACE_OPS_NO; i++)
+			if (latencies[i].count > 0)
+				print_histogram(op_names[i], &latencies[i], false, false);
+		if (paced)
+			print_histogram("lag", &lag, false, false);
+	}
+
+	dm_destroy();
+	vector_destroy(copies);
+	trace_reader_destroy(reader);
+	return 0;
+}
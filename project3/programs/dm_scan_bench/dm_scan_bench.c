@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////
+//
+// Benchmark κλιμάκωσης της παράλληλης διάσχισης του DiseaseMonitor.
+//
+// Φορτώνει n εγγραφές και εκτελεί ερωτήματα μόνο με ημερομηνίες
+// (disease == country == NULL) με 1, 2, 4, ... max_threads threads,
+// τυπώνοντας το χρόνο και την επιτάχυνση σε σχέση με το 1 thread.
+//
+// Χρήση: ./dm_scan_bench [records] [max_threads] [repeat]
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "DiseaseMonitor.h"
+
+static String diseases[] = { "COVID-19", "Influenza", "Measles", "Cholera", "Malaria", "Dengue", "Ebola", "Zika" };
+static String countries[] = { "Greece", "Italy", "Spain", "France", "Germany", "Cyprus", "Portugal", "Austria", "Belgium" };
+
+// Χρόνος σε δευτερόλεπτα από ένα σταθερό σημείο
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Τα ερωτήματα του benchmark: ολόκληρο το dataset και ένα εύρος ημερομηνιών
+static Date ranges[][2] = { { NULL, NULL }, { "2020-03-01", "2020-09-30" } };
+#define RANGE_NO (int)(sizeof(ranges) / sizeof(ranges[0]))
+
+// Εκτελεί repeat φορές κάθε ερώτημα (get & count) και επιστρέφει το συνολικό χρόνο
+static double run_queries(int repeat, int* total) {
+	*total = 0;
+	double start = now();
+
+	for (int i = 0; i < repeat; i++) {
+		for (int r = 0; r < RANGE_NO; r++) {
+			List list = dm_get_records(NULL, NULL, ranges[r][0], ranges[r][1]);
+			*total += list_size(list);
+			list_destroy(list);
+
+			*total += dm_count_records(NULL, NULL, ranges[r][0], ranges[r][1]);
+		}
+	}
+
+	return now() - start;
+}
+
+int main(int argc, char* argv[]) {
+	int n = argc > 1 ? atoi(argv[1]) : 200000;
+	int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+	int repeat = argc > 3 ? atoi(argv[3]) : 3;
+
+	// Δημιουργία των εγγραφών, οι ημερομηνίες μοιράζονται σε όλο το 2020
+	struct record* records = malloc(n * sizeof(*records));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	char (*names)[16] = malloc(n * sizeof(*names));
+	srand(42);
+
+	for (int i = 0; i < n; i++) {
+		int day = rand() % 365;
+		sprintf(dates[i], "2020-%02d-%02d", 1 + day / 31, 1 + day % 31 % 28);
+		sprintf(names[i], "patient%d", i);
+
+		records[i] = (struct record){
+			.id = i, .name = names[i], .date = dates[i],
+			.disease = diseases[rand() % (sizeof(diseases) / sizeof(String))],
+			.country = countries[rand() % (sizeof(countries) / sizeof(String))],
+		};
+	}
+
+	dm_init();
+	double start = now();
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&records[i]);
+	printf("loaded %d records in %.3f sec\n", n, now() - start);
+
+	printf("%8s %12s %10s %10s\n", "threads", "time (sec)", "speedup", "results");
+
+	double base = 0;
+	for (int t = 1; t <= max_threads; t *= 2) {
+		dm_set_threads(t);
+
+		int total;
+		double time = run_queries(repeat, &total);
+		if (t == 1)
+			base = time;
+
+		printf("%8d %12.4f %9.2fx %10d\n", t, time, base / time, total);
+	}
+
+	dm_destroy();
+	free(records);
+	free(dates);
+	free(names);
+	return 0;
+}
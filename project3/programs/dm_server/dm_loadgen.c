@@ -0,0 +1,381 @@
+//////////////////////////////////////////////////////////////////
+//
+// Load generator για τον dm_server.
+//
+// Φορτώνει πρώτα -r εγγραφές (pipelined inserts από μία σύνδεση), και
+// μετά ανοίγει -c συνδέσεις, κάθε μία σε δικό της thread, που στέλνουν
+// από -n αιτήματα με το mix -m, κρατώντας έως -P αιτήματα σε εξέλιξη
+// (pipelining). Τυπώνει το throughput και τα latencies ανά λειτουργία.
+//
+// Χρήση: ./dm_loadgen [options]
+//   -s <path>    Unix domain socket του server (default dm_server.sock)
+//   -p <port>    TCP στο 127.0.0.1:port, αντί για Unix socket
+//   -c <conns>   Συνδέσεις (default 4)
+//   -n <reqs>    Αιτήματα ανά σύνδεση (default 10000)
+//   -P <depth>   Μέγιστα αιτήματα σε εξέλιξη ανά σύνδεση (default 16, 1 = χωρίς pipelining)
+//   -r <records> Εγγραφές που φορτώνονται πριν τη μέτρηση (default 10000)
+//   -m <mix>     Αναλογία insert:remove:count:get:top (default 10:5:60:5:20)
+//   -S <seed>    Seed της γεννήτριας τυχαίων αριθμών (default 1)
+//   -q           Τερματισμός του server (MSG_SHUTDOWN) στο τέλος
+//
+//////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Stats.h"
+#include "protocol.h"
+
+
+#define DISEASES 20
+#define COUNTRIES 50
+
+// Οι λειτουργίες του mix, με τη σειρά του -m
+enum { OP_INSERT, OP_REMOVE, OP_COUNT, OP_GET, OP_TOP, OPS_NO };
+static const char* op_names[OPS_NO] = { "insert", "remove", "count", "get", "top" };
+static const uint8_t op_types[OPS_NO] = { MSG_INSERT, MSG_REMOVE, MSG_COUNT, MSG_GET, MSG_TOP };
+
+static String path = "dm_server.sock";
+static int port = 0;
+static int requests = 10000;
+static int depth = 16;
+static int records = 10000;
+static int mix[OPS_NO] = { 10, 5, 60, 5, 20 };
+static int mix_total;
+
+static struct histogram latencies[OPS_NO];
+static long errors = 0;
+
+// Ένα αίτημα σε εξέλιξη: ο τύπος του και η στιγμή που στάλθηκε
+struct pending {
+	int op;
+	uint64_t sent;
+};
+
+// Μια σύνδεση με τον server, με blocking socket
+struct client {
+	int fd;
+	uint64_t seed;
+	struct buffer out;
+	struct buffer in;
+	size_t in_pos;
+};
+typedef struct client* Client;
+
+
+// xorshift64*, ανεξάρτητη γεννήτρια ανά σύνδεση
+static uint64_t next_random(Client client) {
+	client->seed ^= client->seed >> 12;
+	client->seed ^= client->seed << 25;
+	client->seed ^= client->seed >> 27;
+	return client->seed * 0x2545F4914F6CDD1DULL;
+}
+
+static int random_int(Client client, int n) {
+	return next_random(client) % n;
+}
+
+// Συνδέεται στον server, περιμένοντας έως 5 sec αν δεν έχει ξεκινήσει ακόμα
+
+static int connect_server() {
+	for (int attempt = 0; attempt < 500; attempt++) {
+		int fd;
+		int result;
+		if (port > 0) {
+			fd = socket(AF_INET, SOCK_STREAM, 0);
+			struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+			result = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+		} else {
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			struct sockaddr_un addr = { .sun_family = AF_UNIX };
+			strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+			result = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+		}
+		if (result == 0)
+			return fd;
+
+		close(fd);
+		if (errno != ENOENT && errno != ECONNREFUSED)
+			break;
+		usleep(10000);
+	}
+
+	perror("connect");
+	exit(1);
+}
+
+static void client_init(Client client, uint64_t seed) {
+	memset(client, 0, sizeof(*client));
+	client->fd = connect_server();
+	client->seed = seed * 0x9E3779B97F4A7C15ULL + 1;
+}
+
+static void client_close(Client client) {
+	close(client->fd);
+	buffer_free(&client->out);
+	buffer_free(&client->in);
+}
+
+// Στέλνει όλα τα αιτήματα που έχουν συσσωρευτεί στο out
+
+static void client_flush(Client client) {
+	for (size_t pos = 0; pos < client->out.size; ) {
+		ssize_t n = send(client->fd, client->out.data + pos, client->out.size - pos, MSG_NOSIGNAL);
+		if (n < 0) {
+			perror("send");
+			exit(1);
+		}
+		pos += n;
+	}
+	client->out.size = 0;
+}
+
+// Περιμένει την επόμενη απάντηση και επιστρέφει το status της. Αν payload != NULL, αποθηκεύει
+// εκεί τα πεδία της απάντησης (ισχύουν μέχρι την επόμενη κλήση).
+
+static uint8_t client_receive(Client client, Reader payload) {
+	long size;
+	while ((size = frame_complete(client->in.data + client->in_pos, client->in.size - client->in_pos, UINT32_MAX)) == 0) {
+		// Μετακινούμε την απάντηση που δεν έχει ολοκληρωθεί στην αρχή του buffer
+		memmove(client->in.data, client->in.data + client->in_pos, client->in.size - client->in_pos);
+		client->in.size -= client->in_pos;
+		client->in_pos = 0;
+
+		ssize_t n = recv(client->fd, buffer_reserve(&client->in, 65536), 65536, 0);
+		if (n <= 0) {
+			fprintf(stderr, "connection closed by server\n");
+			exit(1);
+		}
+		client->in.size += n;
+	}
+
+	char* frame = client->in.data + client->in_pos;
+	if (payload != NULL)
+		*payload = (struct reader){ frame + FRAME_HEADER, frame + size };
+	client->in_pos += size;
+	return frame[4];
+}
+
+static void format_date(Client client, char* date) {
+	sprintf(date, "2020-%02d-%02d", 1 + random_int(client, 12), 1 + random_int(client, 28));
+}
+
+static void put_insert(Client client, int id) {
+	char name[32], disease[32], country[32], date[16];
+	sprintf(name, "patient-%d", id);
+	sprintf(disease, "disease-%d", random_int(client, DISEASES));
+	sprintf(country, "country-%d", random_int(client, COUNTRIES));
+	format_date(client, date);
+
+	size_t pos = frame_begin(&client->out, MSG_INSERT);
+	buffer_put_u32(&client->out, id);
+	buffer_put_string(&client->out, name);
+	buffer_put_string(&client->out, disease);
+	buffer_put_string(&client->out, country);
+	buffer_put_string(&client->out, date);
+	frame_end(&client->out, pos);
+}
+
+// Προσθέτει στο out ένα αίτημα της λειτουργίας op με τυχαία ορίσματα
+
+static void put_request(Client client, int op) {
+	int ids = records > 0 ? 2 * records : 10000;
+	char disease[32], country[32], from[32], to[32];
+	sprintf(disease, "disease-%d", random_int(client, DISEASES));
+	sprintf(country, "country-%d", random_int(client, COUNTRIES));
+
+	if (op == OP_INSERT) {
+		put_insert(client, random_int(client, ids));
+		return;
+	}
+
+	size_t pos = frame_begin(&client->out, op_types[op]);
+	switch (op) {
+		case OP_REMOVE:
+			buffer_put_u32(&client->out, random_int(client, ids));
+			break;
+
+		case OP_COUNT:
+			// Ένα από τα disease / country, και κάποιες φορές διάστημα ημερομηνιών
+			format_date(client, from);
+			format_date(client, to);
+			if (strcmp(from, to) > 0) {
+				char temp[32];
+				strcpy(temp, from);
+				strcpy(from, to);
+				strcpy(to, temp);
+			}
+			bool by_disease = random_int(client, 2) == 0;
+			bool dates = random_int(client, 2) == 0;
+			buffer_put_string(&client->out, by_disease ? disease : NULL);
+			buffer_put_string(&client->out, by_disease ? NULL : country);
+			buffer_put_string(&client->out, dates ? from : NULL);
+			buffer_put_string(&client->out, dates ? to : NULL);
+			break;
+
+		case OP_GET:
+			// Ζεύγος (disease, country) σε ένα μήνα, ώστε η απάντηση να είναι μικρή
+			sprintf(from, "2020-%02d-01", 1 + random_int(client, 12));
+			sprintf(to, "%.8s31", from);
+			buffer_put_string(&client->out, disease);
+			buffer_put_string(&client->out, country);
+			buffer_put_string(&client->out, from);
+			buffer_put_string(&client->out, to);
+			break;
+
+		case OP_TOP:
+			buffer_put_u32(&client->out, 5);
+			buffer_put_string(&client->out, random_int(client, 4) == 0 ? NULL : country);
+			break;
+	}
+	frame_end(&client->out, pos);
+}
+
+static int random_op(Client client) {
+	int r = random_int(client, mix_total);
+	for (int op = 0; op < OPS_NO; op++) {
+		if (r < mix[op])
+			return op;
+		r -= mix[op];
+	}
+	return OP_COUNT;
+}
+
+// Μία σύνδεση του load: στέλνει requests αιτήματα, με έως depth σε εξέλιξη
+
+static void* run_client(void* arg) {
+	struct client client;
+	client_init(&client, (uintptr_t)arg);
+
+	struct pending pending[depth];
+	int sent = 0, received = 0;
+
+	while (received < requests) {
+		// Γεμίζουμε το pipeline, και στέλνουμε όλα τα νέα αιτήματα μαζί
+		while (sent < requests && sent - received < depth) {
+			int op = random_op(&client);
+			put_request(&client, op);
+			pending[sent % depth] = (struct pending){ .op = op, .sent = stats_now() };
+			sent++;
+		}
+		client_flush(&client);
+
+		uint8_t status = client_receive(&client, NULL);
+		struct pending* p = &pending[received % depth];
+		histogram_record(&latencies[p->op], stats_now() - p->sent);
+		if (status != STATUS_OK)
+			__atomic_fetch_add(&errors, 1, __ATOMIC_RELAXED);
+		received++;
+	}
+
+	client_close(&client);
+	return NULL;
+}
+
+// Επιστρέφει το πλήθος όλων των εγγραφών του server
+
+static uint32_t count_all(Client client) {
+	size_t pos = frame_begin(&client->out, MSG_COUNT);
+	for (int i = 0; i < 4; i++)
+		buffer_put_string(&client->out, NULL);
+	frame_end(&client->out, pos);
+	client_flush(client);
+
+	struct reader reader;
+	client_receive(client, &reader);
+	uint32_t count = 0;
+	reader_get_u32(&reader, &count);
+	return count;
+}
+
+int main(int argc, char* argv[]) {
+	int connections = 4;
+	uint64_t seed = 1;
+	bool shutdown = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "s:p:c:n:P:r:m:S:q")) != -1) {
+		switch (opt) {
+			case 's': path = optarg; break;
+			case 'p': port = atoi(optarg); break;
+			case 'c': connections = atoi(optarg); break;
+			case 'n': requests = atoi(optarg); break;
+			case 'P': depth = atoi(optarg); break;
+			case 'r': records = atoi(optarg); break;
+			case 'S': seed = strtoull(optarg, NULL, 10); break;
+			case 'q': shutdown = true; break;
+			case 'm':
+				if (sscanf(optarg, "%d:%d:%d:%d:%d", &mix[0], &mix[1], &mix[2], &mix[3], &mix[4]) == OPS_NO)
+					break;
+				// fallthrough
+			default:
+				fprintf(stderr, "usage: %s [-s socket | -p port] [-c conns] [-n requests] [-P depth] [-r records] [-m insert:remove:count:get:top] [-S seed] [-q]\n", argv[0]);
+				return 1;
+		}
+	}
+	for (int op = 0; op < OPS_NO; op++)
+		mix_total += mix[op];
+	if (connections < 1 || depth < 1 || mix_total <= 0) {
+		fprintf(stderr, "invalid parameters\n");
+		return 1;
+	}
+
+	// Φόρτωση, με όλες τις εγγραφές στο pipeline πριν διαβάσουμε τις απαντήσεις
+	struct client loader;
+	client_init(&loader, seed);
+
+	uint64_t start = stats_now();
+	for (int i = 0; i < records; i++) {
+		put_insert(&loader, i);
+		if (loader.out.size >= 65536)
+			client_flush(&loader);
+	}
+	client_flush(&loader);
+	for (int i = 0; i < records; i++)
+		if (client_receive(&loader, NULL) != STATUS_OK)
+			errors++;
+
+	double load_time = (stats_now() - start) / 1e9;
+	printf("loaded %d records in %.3f sec (%.0f inserts/sec), server has %u records\n",
+		records, load_time, records / load_time, count_all(&loader));
+
+	// Μέτρηση
+	pthread_t threads[connections];
+	start = stats_now();
+	for (int i = 0; i < connections; i++)
+		pthread_create(&threads[i], NULL, run_client, (void*)(uintptr_t)(seed + i + 1));
+	for (int i = 0; i < connections; i++)
+		pthread_join(threads[i], NULL);
+	double wall_time = (stats_now() - start) / 1e9;
+
+	long total = (long)connections * requests;
+	printf("%ld requests in %.3f sec (%.0f requests/sec), %d connections, pipeline depth %d, %ld errors\n",
+		total, wall_time, total / wall_time, connections, depth, errors);
+	printf("%-8s %10s %10s %10s %10s %10s %10s\n", "op", "count", "mean (us)", "p50 (us)", "p99 (us)", "p999 (us)", "max (us)");
+	for (int op = 0; op < OPS_NO; op++) {
+		Histogram h = &latencies[op];
+		if (h->count == 0)
+			continue;
+		printf("%-8s %10lu %10.2f %10.2f %10.2f %10.2f %10.2f\n", op_names[op], (unsigned long)h->count,
+			(double)h->sum / h->count / 1000, histogram_percentile(h, 50) / 1000.0, histogram_percentile(h, 99) / 1000.0,
+			histogram_percentile(h, 99.9) / 1000.0, h->max / 1000.0);
+	}
+
+	if (shutdown) {
+		size_t pos = frame_begin(&loader.out, MSG_SHUTDOWN);
+		frame_end(&loader.out, pos);
+		client_flush(&loader);
+		client_receive(&loader, NULL);
+	}
+	client_close(&loader);
+
+	return errors > 0 ? 1 : 0;
+}
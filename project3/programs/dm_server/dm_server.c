@@ -0,0 +1,664 @@
+//////////////////////////////////////////////////////////////////
+//
+// Server που εκτελεί αιτήματα προς τον DiseaseMonitor μέσω ενός
+// Unix domain socket (ή TCP στο localhost), με το protocol του
+// protocol.h.
+//
+// Ένα event loop (epoll, non-blocking sockets) δέχεται συνδέσεις, διαβάζει
+// αιτήματα και γράφει απαντήσεις. Οι αλλαγές (insert, remove) εκτελούνται
+// στο ίδιο το event loop, ενώ τα queries (count, get, top) σε ένα pool από
+// workers, παράλληλα μεταξύ τους. Ένα read-write lock εξασφαλίζει ότι κανένα
+// query δεν εκτελείται ταυτόχρονα με κάποια αλλαγή. Με το -m τα count / get
+// εκτελούνται πάνω σε ένα snapshot του monitor (βλ. dm_snapshot_open), χωρίς
+// το lock, οπότε δεν περιμένουν τις αλλαγές ούτε τις καθυστερούν.
+//
+// Σε κάθε σύνδεση τα αιτήματα εκτελούνται με τη σειρά τους: διαδοχικά
+// queries μοιράζονται στους workers, μια αλλαγή όμως περιμένει να
+// ολοκληρωθούν τα προηγούμενα queries της σύνδεσης. Οι απαντήσεις
+// στέλνονται πάντα με τη σειρά των αιτημάτων.
+//
+// Χρήση: ./dm_server [options]
+//   -s <path>    Unix domain socket (default dm_server.sock)
+//   -p <port>    TCP στο 127.0.0.1:port, αντί για Unix socket
+//   -w <workers> Threads για τα queries (default 2, 0 = όλα στο event loop)
+//   -r <file>    Ιεραρχία περιοχών (βλ. dm_load_regions), ώστε τα queries να δέχονται και περιοχές
+//   -m           Τα count / get εκτελούνται σε snapshots (δεν δέχονται περιοχές, μόνο χώρες)
+//
+// Ο server τερματίζει με SIGINT / SIGTERM ή με ένα αίτημα MSG_SHUTDOWN.
+//
+//////////////////////////////////////////////////////////////////
+
+#define _GNU_SOURCE			// accept4, pthread_rwlockattr_setkind_np
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "DiseaseMonitor.h"
+#include "protocol.h"
+
+
+// Όρια ανά σύνδεση: όσο ξεπερνιούνται δεν διαβάζουμε νέα αιτήματα από τον client
+#define MAX_JOBS 64					// queries που εκτελούνται ταυτόχρονα
+#define MAX_OUTPUT (4 << 20)		// bytes απαντήσεων που δεν έχουν σταλεί ακόμα
+#define MAX_INPUT (MAX_REQUEST + 4)	// bytes αιτημάτων που δεν έχουν εκτελεστεί ακόμα
+
+#define READ_SIZE 65536
+#define MAX_EVENTS 64
+
+typedef struct connection* Connection;
+typedef struct job* Job;
+
+// Ένα query που εκτελείται από κάποιον worker
+
+struct job {
+	Connection conn;
+	char* request;				// αντίγραφο του frame του αιτήματος
+	size_t size;
+	struct buffer response;
+	bool done;
+	Job next;					// το επόμενο query της ίδιας σύνδεσης
+	Job queue_next;				// το επόμενο στην ουρά των workers, ή στα ολοκληρωμένα
+};
+
+struct connection {
+	int fd;						// -1 αφού κλείσει
+	struct buffer in;			// τα bytes που λάβαμε, από τη θέση in_pos και μετά δεν έχουν εκτελεστεί
+	size_t in_pos;
+	struct buffer out;			// οι απαντήσεις, από τη θέση out_pos και μετά δεν έχουν σταλεί
+	size_t out_pos;
+	Job first, last;			// τα queries της σύνδεσης που δεν έχουν απαντηθεί, με τη σειρά τους
+	int jobs;					// πόσα από αυτά εκτελούνται ακόμα
+	bool eof;					// ο client δεν θα στείλει άλλα αιτήματα
+	uint32_t events;			// τα events που παρακολουθούμε στο epoll
+	Connection prev, next;		// όλες οι συνδέσεις
+	Connection ready_next;		// βλ. collect_completed
+	bool ready;
+};
+
+static int epoll_fd;
+static int wake_fd;				// eventfd, μέσω του οποίου οι workers ξυπνάνε το event loop
+static Connection connections = NULL;
+
+// Μια σύνδεση που έκλεισε μπορεί να έχει κι άλλα events στο ίδιο epoll_wait, οπότε το struct
+// καταστρέφεται στο τέλος κάθε κύκλου του event loop (βλ. destroy_closed).
+static bool closed_any = false;
+
+// Τα epoll events χαρακτηρίζονται από τον pointer τους, οι δύο αυτοί ξεχωρίζουν τα ειδικά fds
+static int listen_marker, wake_marker;
+
+static volatile sig_atomic_t running = 1;
+
+// Κανένα query δεν εκτελείται ταυτόχρονα με αλλαγή στον monitor
+static pthread_rwlock_t monitor_lock;
+
+// Η ουρά των workers και τα ολοκληρωμένα queries (με αντίστροφη σειρά, δεν μας ενδιαφέρει)
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static Job queue_first = NULL, queue_last = NULL;
+static Job completed = NULL;
+static bool stopping = false;
+
+static int workers_no = 2;
+static pthread_t* workers;
+
+// true αν τα count / get εκτελούνται σε snapshots (-m)
+static bool snapshots = false;
+
+static long requests = 0, accepted = 0;
+
+
+// Εκτέλεση αιτημάτων //////////////////////////////////////////////////////////
+
+static bool is_query(uint8_t type) {
+	return type == MSG_COUNT || type == MSG_GET || type == MSG_TOP;
+}
+
+// true αν το query εκτελείται σε snapshot, χωρίς το monitor_lock
+static bool uses_snapshot(uint8_t type) {
+	return snapshots && (type == MSG_COUNT || type == MSG_GET);
+}
+
+// Διαβάζει τα κριτήρια disease, country, date_from, date_to ενός query
+
+static bool get_query(Reader reader, DMQuery query) {
+	return reader_get_string(reader, &query->disease)
+		&& reader_get_string(reader, &query->country)
+		&& reader_get_string(reader, &query->date_from)
+		&& reader_get_string(reader, &query->date_to);
+}
+
+// Εκτελεί το αίτημα frame[0 .. size-1] (το οποίο τροποποιεί) και προσθέτει την απάντηση στο out
+
+static void execute(char* frame, size_t size, Buffer out) {
+	struct reader reader = { frame + FRAME_HEADER, frame + size };
+	uint8_t type = frame[4];
+
+	uint32_t id, k;
+	struct record record;
+	struct dm_query query;
+	bool ok;
+
+	size_t pos = frame_begin(out, STATUS_OK);
+	switch (type) {
+		case MSG_INSERT:
+			ok = reader_get_u32(&reader, &id)
+				&& reader_get_string(&reader, &record.name) && record.name != NULL
+				&& reader_get_string(&reader, &record.disease) && record.disease != NULL
+				&& reader_get_string(&reader, &record.country) && record.country != NULL
+				&& reader_get_string(&reader, &record.date) && record.date != NULL
+				&& reader.pos == reader.end;
+			if (ok) {
+				record.id = (int32_t)id;
+				buffer_put_u8(out, dm_insert_record(&record));
+			}
+			break;
+
+		case MSG_REMOVE:
+			ok = reader_get_u32(&reader, &id) && reader.pos == reader.end;
+			if (ok)
+				buffer_put_u8(out, dm_remove_record((int32_t)id));
+			break;
+
+		case MSG_COUNT:
+			ok = get_query(&reader, &query) && reader.pos == reader.end;
+			if (ok && uses_snapshot(type)) {
+				DMSnapshot snapshot = dm_snapshot_open();
+				buffer_put_u32(out, dm_snapshot_count_records(snapshot, query.disease, query.country, query.date_from, query.date_to));
+				dm_snapshot_release(snapshot);
+			} else if (ok)
+				buffer_put_u32(out, dm_count_records(query.disease, query.country, query.date_from, query.date_to));
+			break;
+
+		case MSG_GET:
+			ok = get_query(&reader, &query) && reader.pos == reader.end;
+			if (ok) {
+				// Τα records του snapshot μένουν έγκυρα μέχρι το release, άρα και μετά τη list_destroy
+				DMSnapshot snapshot = uses_snapshot(type) ? dm_snapshot_open() : NULL;
+				List list = snapshot != NULL
+					? dm_snapshot_get_records(snapshot, query.disease, query.country, query.date_from, query.date_to)
+					: dm_get_records(query.disease, query.country, query.date_from, query.date_to);
+				buffer_put_u32(out, list_size(list));
+				for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+					Record r = list_node_value(list, node);
+					buffer_put_u32(out, r->id);
+					buffer_put_string(out, r->name);
+					buffer_put_string(out, r->disease);
+					buffer_put_string(out, r->country);
+					buffer_put_string(out, r->date);
+				}
+				list_destroy(list);
+				if (snapshot != NULL)
+					dm_snapshot_release(snapshot);
+			}
+			break;
+
+		case MSG_TOP:
+			ok = reader_get_u32(&reader, &k) && reader_get_string(&reader, &query.country) && reader.pos == reader.end;
+			if (ok) {
+				List list = dm_top_diseases((int32_t)k, query.country);
+				buffer_put_u32(out, list_size(list));
+				for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+					buffer_put_string(out, list_node_value(list, node));
+				list_destroy(list);
+			}
+			break;
+
+		case MSG_SHUTDOWN:
+			ok = reader.pos == reader.end;
+			if (ok)
+				running = 0;
+			break;
+
+		default:
+			ok = false;
+	}
+
+	if (!ok) {
+		out->size = pos;
+		pos = frame_begin(out, STATUS_ERROR);
+		buffer_put_string(out, "malformed request");
+	}
+	frame_end(out, pos);
+}
+
+
+// Workers /////////////////////////////////////////////////////////////////////
+
+static void* worker(void* arg) {
+	while (true) {
+		pthread_mutex_lock(&queue_mutex);
+		while (queue_first == NULL && !stopping)
+			pthread_cond_wait(&queue_cond, &queue_mutex);
+
+		Job job = queue_first;
+		if (job == NULL) {						// stopping, και δεν έμεινε δουλειά
+			pthread_mutex_unlock(&queue_mutex);
+			return NULL;
+		}
+		queue_first = job->queue_next;
+		if (queue_first == NULL)
+			queue_last = NULL;
+		pthread_mutex_unlock(&queue_mutex);
+
+		if (uses_snapshot(job->request[4])) {
+			execute(job->request, job->size, &job->response);
+		} else {
+			pthread_rwlock_rdlock(&monitor_lock);
+			execute(job->request, job->size, &job->response);
+			pthread_rwlock_unlock(&monitor_lock);
+		}
+
+		pthread_mutex_lock(&queue_mutex);
+		job->queue_next = completed;
+		completed = job;
+		pthread_mutex_unlock(&queue_mutex);
+
+		uint64_t one = 1;
+		if (write(wake_fd, &one, sizeof(one)) < 0)
+			perror("write");
+	}
+}
+
+static void submit(Connection conn, char* frame, size_t size) {
+	Job job = calloc(1, sizeof(*job));
+	job->conn = conn;
+	job->request = malloc(size);
+	job->size = size;
+	memcpy(job->request, frame, size);
+
+	if (conn->last != NULL)
+		conn->last->next = job;
+	else
+		conn->first = job;
+	conn->last = job;
+	conn->jobs++;
+
+	pthread_mutex_lock(&queue_mutex);
+	if (queue_last != NULL)
+		queue_last->queue_next = job;
+	else
+		queue_first = job;
+	queue_last = job;
+	pthread_cond_signal(&queue_cond);
+	pthread_mutex_unlock(&queue_mutex);
+}
+
+static void job_destroy(Job job) {
+	free(job->request);
+	buffer_free(&job->response);
+	free(job);
+}
+
+
+// Συνδέσεις ///////////////////////////////////////////////////////////////////
+
+static void set_events(Connection conn, uint32_t events) {
+	if (conn->fd == -1 || conn->events == events)
+		return;
+
+	struct epoll_event ev = { .events = events, .data.ptr = conn };
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+	conn->events = events;
+}
+
+// Κλείνει το socket. Το struct καταστρέφεται αφού ολοκληρωθούν τα queries της σύνδεσης.
+
+static void connection_close(Connection conn) {
+	if (conn->fd == -1)
+		return;
+
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+	close(conn->fd);
+	conn->fd = -1;
+	closed_any = true;
+}
+
+static void connection_destroy(Connection conn) {
+	connection_close(conn);
+
+	// Μόνο queries που έχουν ολοκληρωθεί, αλλά περιμένουν κάποιο προηγούμενο
+	for (Job job = conn->first, next; job != NULL; job = next) {
+		next = job->next;
+		job_destroy(job);
+	}
+
+	if (conn->prev != NULL)
+		conn->prev->next = conn->next;
+	else
+		connections = conn->next;
+	if (conn->next != NULL)
+		conn->next->prev = conn->prev;
+
+	buffer_free(&conn->in);
+	buffer_free(&conn->out);
+	free(conn);
+}
+
+static void connection_accept(int listen_fd) {
+	int fd;
+	while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK)) != -1) {
+		Connection conn = calloc(1, sizeof(*conn));
+		conn->fd = fd;
+		conn->events = EPOLLIN;
+
+		conn->next = connections;
+		if (connections != NULL)
+			connections->prev = conn;
+		connections = conn;
+
+		struct epoll_event ev = { .events = conn->events, .data.ptr = conn };
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+		accepted++;
+	}
+}
+
+static void connection_read(Connection conn) {
+	while (conn->fd != -1 && conn->in.size - conn->in_pos < MAX_INPUT) {
+		ssize_t n = recv(conn->fd, buffer_reserve(&conn->in, READ_SIZE), READ_SIZE, 0);
+		if (n > 0) {
+			conn->in.size += n;
+		} else if (n == 0) {
+			conn->eof = true;
+			return;
+		} else {
+			if (errno != EAGAIN && errno != EINTR)
+				connection_close(conn);
+			return;
+		}
+	}
+}
+
+static void connection_write(Connection conn) {
+	while (conn->fd != -1 && conn->out_pos < conn->out.size) {
+		ssize_t n = send(conn->fd, conn->out.data + conn->out_pos, conn->out.size - conn->out_pos, MSG_NOSIGNAL);
+		if (n > 0) {
+			conn->out_pos += n;
+		} else {
+			if (errno != EAGAIN && errno != EINTR)
+				connection_close(conn);
+			break;
+		}
+	}
+
+	if (conn->out_pos == conn->out.size)
+		conn->out_pos = conn->out.size = 0;
+}
+
+// Προχωράει τη σύνδεση όσο γίνεται: μεταφέρει στο out τις απαντήσεις των queries που
+// ολοκληρώθηκαν, εκτελεί τα αιτήματα που έχουν ληφθεί και στέλνει τις απαντήσεις.
+
+static void connection_process(Connection conn) {
+	while (conn->first != NULL && conn->first->done) {
+		Job job = conn->first;
+		conn->first = job->next;
+		if (conn->first == NULL)
+			conn->last = NULL;
+
+		buffer_append(&conn->out, job->response.data, job->response.size);
+		job_destroy(job);
+	}
+
+	while (conn->fd != -1 && running && conn->jobs < MAX_JOBS && conn->out.size - conn->out_pos < MAX_OUTPUT) {
+		char* frame = conn->in.data + conn->in_pos;
+		long size = frame_complete(frame, conn->in.size - conn->in_pos, MAX_REQUEST);
+		if (size == 0)
+			break;
+		if (size < 0) {
+			connection_close(conn);
+			break;
+		}
+
+		uint8_t type = frame[4];
+		bool query = is_query(type);
+
+		// Οι αλλαγές περιμένουν τα προηγούμενα queries, ώστε αυτά να μη δουν τα αποτελέσματά τους
+		if (!query && conn->first != NULL)
+			break;
+
+		if (query && workers_no > 0) {
+			submit(conn, frame, size);
+		} else {
+			// Στο event loop, οπότε δεν υπάρχουν queries της σύνδεσης που εκτελούνται ακόμα
+			pthread_rwlock_wrlock(&monitor_lock);
+			execute(frame, size, &conn->out);
+			pthread_rwlock_unlock(&monitor_lock);
+		}
+		conn->in_pos += size;
+		requests++;
+	}
+
+	// Τα αιτήματα που εκτελέστηκαν δεν χρειάζονται πια
+	if (conn->in_pos == conn->in.size) {
+		conn->in_pos = conn->in.size = 0;
+	} else if (conn->in_pos > 0) {
+		memmove(conn->in.data, conn->in.data + conn->in_pos, conn->in.size - conn->in_pos);
+		conn->in.size -= conn->in_pos;
+		conn->in_pos = 0;
+	}
+
+	connection_write(conn);
+
+	// Η σύνδεση τελείωσε αν ο client έκλεισε και όλα τα αιτήματά του απαντήθηκαν (τα αιτήματα
+	// που δεν ολοκληρώθηκαν δεν θα ολοκληρωθούν ποτέ, αφού δεν υπάρχουν queries σε εξέλιξη)
+	if (conn->eof && conn->jobs == 0 && conn->out.size == 0)
+		connection_close(conn);
+
+	if (conn->fd == -1)
+		return;
+
+	uint32_t events = 0;
+	if (!conn->eof && conn->in.size < MAX_INPUT && conn->out.size < MAX_OUTPUT)
+		events |= EPOLLIN;
+	if (conn->out.size > 0)
+		events |= EPOLLOUT;
+	set_events(conn, events);
+}
+
+// Παραλαμβάνει τα queries που ολοκλήρωσαν οι workers
+
+static void collect_completed() {
+	uint64_t value;
+	if (read(wake_fd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+		perror("read");
+
+	pthread_mutex_lock(&queue_mutex);
+	Job jobs = completed;
+	completed = NULL;
+	pthread_mutex_unlock(&queue_mutex);
+
+	// Πρώτα σημειώνουμε όλα τα queries και μαζεύουμε τις συνδέσεις τους (η connection_process
+	// καταστρέφει τα jobs που απαντήθηκαν), ώστε κάθε σύνδεση να στείλει τις απαντήσεις της μαζί
+	Connection ready = NULL;
+	for (Job job = jobs; job != NULL; job = job->queue_next) {
+		job->done = true;
+		job->conn->jobs--;
+		if (!job->conn->ready) {
+			job->conn->ready = true;
+			job->conn->ready_next = ready;
+			ready = job->conn;
+		}
+	}
+
+	for (Connection conn = ready; conn != NULL; conn = conn->ready_next) {
+		conn->ready = false;
+		connection_process(conn);
+	}
+}
+
+// Καταστρέφει τις συνδέσεις που έκλεισαν και δεν έχουν queries σε εξέλιξη
+
+static void destroy_closed() {
+	if (!closed_any)
+		return;
+
+	closed_any = false;
+	for (Connection conn = connections, next; conn != NULL; conn = next) {
+		next = conn->next;
+		if (conn->fd != -1)
+			continue;
+		if (conn->jobs == 0)
+			connection_destroy(conn);
+		else
+			closed_any = true;		// θα ξαναελεγχθεί όταν ολοκληρωθούν τα queries της
+	}
+}
+
+
+// Main ////////////////////////////////////////////////////////////////////////
+
+static void on_signal(int signal) {
+	running = 0;
+}
+
+static int listen_unix(String path) {
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+	unlink(path);
+	if (fd == -1 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1) {
+		perror(path);
+		exit(1);
+	}
+	return fd;
+}
+
+static int listen_tcp(int port) {
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	int one = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+	if (fd == -1 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(fd, SOMAXCONN) == -1) {
+		perror("tcp");
+		exit(1);
+	}
+	return fd;
+}
+
+int main(int argc, char* argv[]) {
+	String path = "dm_server.sock";
+	int port = 0;
+	String regions = NULL;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "s:p:w:r:m")) != -1) {
+		switch (opt) {
+			case 's': path = optarg; break;
+			case 'p': port = atoi(optarg); break;
+			case 'w': workers_no = atoi(optarg); break;
+			case 'r': regions = optarg; break;
+			case 'm': snapshots = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-s socket | -p port] [-w workers] [-r regions] [-m]\n", argv[0]);
+				return 1;
+		}
+	}
+	if (workers_no < 0)
+		workers_no = 0;
+
+	// Τα αιτήματα ζουν μόνο όσο εκτελούνται, οπότε ο monitor κρατάει δικά του αντίγραφα. Τα
+	// queries εκτελούνται ταυτόχρονα από τους workers, άρα όχι μέσω του thread pool του monitor.
+	dm_set_owned(true);
+	dm_set_mvcc(snapshots);
+	dm_set_threads(1);
+	dm_init();
+
+	if (regions != NULL && !dm_load_regions(regions)) {
+		fprintf(stderr, "dm_server: cannot load regions from %s\n", regions);
+		dm_destroy();
+		return 1;
+	}
+
+	struct sigaction sa = { .sa_handler = on_signal };
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	// Με την default προτίμηση στους readers, ένα συνεχές ρεύμα από queries θα καθυστερούσε επ' αόριστον τις αλλαγές
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+	pthread_rwlock_init(&monitor_lock, &attr);
+	pthread_rwlockattr_destroy(&attr);
+
+	int listen_fd = port > 0 ? listen_tcp(port) : listen_unix(path);
+	epoll_fd = epoll_create1(0);
+	wake_fd = eventfd(0, EFD_NONBLOCK);
+
+	struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &listen_marker };
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+	ev.data.ptr = &wake_marker;
+	epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev);
+
+	workers = malloc(workers_no * sizeof(*workers));
+	for (int i = 0; i < workers_no; i++)
+		pthread_create(&workers[i], NULL, worker, NULL);
+
+	if (port > 0)
+		fprintf(stderr, "dm_server: listening on 127.0.0.1:%d, %d workers\n", port, workers_no);
+	else
+		fprintf(stderr, "dm_server: listening on %s, %d workers\n", path, workers_no);
+
+	struct epoll_event events[MAX_EVENTS];
+	while (running) {
+		int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+		for (int i = 0; i < n; i++) {
+			Pointer ptr = events[i].data.ptr;
+			if (ptr == &listen_marker) {
+				connection_accept(listen_fd);
+			} else if (ptr == &wake_marker) {
+				collect_completed();
+			} else {
+				Connection conn = ptr;
+				if (conn->fd == -1)
+					continue;		// έκλεισε από προηγούμενο event αυτού του epoll_wait
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+					connection_read(conn);
+				connection_process(conn);
+			}
+		}
+		destroy_closed();
+	}
+
+	// Τερματισμός: οι workers ολοκληρώνουν όσα queries έχουν ξεκινήσει
+	pthread_mutex_lock(&queue_mutex);
+	stopping = true;
+	pthread_cond_broadcast(&queue_cond);
+	pthread_mutex_unlock(&queue_mutex);
+	for (int i = 0; i < workers_no; i++)
+		pthread_join(workers[i], NULL);
+	collect_completed();
+
+	// Στέλνουμε ό,τι απαντήσεις έμειναν (πχ του MSG_SHUTDOWN), περιμένοντας αν χρειαστεί
+	while (connections != NULL) {
+		Connection conn = connections;
+		if (conn->fd != -1) {
+			fcntl(conn->fd, F_SETFL, fcntl(conn->fd, F_GETFL) & ~O_NONBLOCK);
+			connection_write(conn);
+		}
+		connection_destroy(conn);
+	}
+
+	fprintf(stderr, "dm_server: served %ld requests from %ld connections\n", requests, accepted);
+
+	close(listen_fd);
+	close(wake_fd);
+	close(epoll_fd);
+	if (port == 0)
+		unlink(path);
+	free(workers);
+	dm_destroy();
+	return 0;
+}
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////
+//
+// Υλοποίηση των buffers και των readers του protocol.
+//
+///////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "protocol.h"
+
+
+char* buffer_reserve(Buffer buffer, size_t n) {
+	if (buffer->size + n > buffer->capacity) {
+		size_t capacity = buffer->capacity > 0 ? buffer->capacity : 256;
+		while (capacity < buffer->size + n)
+			capacity *= 2;
+
+		buffer->data = realloc(buffer->data, capacity);
+		buffer->capacity = capacity;
+	}
+	return buffer->data + buffer->size;
+}
+
+void buffer_append(Buffer buffer, const void* data, size_t n) {
+	memcpy(buffer_reserve(buffer, n), data, n);
+	buffer->size += n;
+}
+
+void buffer_put_u8(Buffer buffer, uint8_t value) {
+	*buffer_reserve(buffer, 1) = value;
+	buffer->size++;
+}
+
+void buffer_put_u16(Buffer buffer, uint16_t value) {
+	uint8_t bytes[2] = { value, value >> 8 };
+	buffer_append(buffer, bytes, 2);
+}
+
+void buffer_put_u32(Buffer buffer, uint32_t value) {
+	uint8_t bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+	buffer_append(buffer, bytes, 4);
+}
+
+void buffer_put_string(Buffer buffer, String s) {
+	if (s == NULL) {
+		buffer_put_u16(buffer, NULL_STRING);
+		return;
+	}
+
+	// Τα μεγαλύτερα strings κόβονται (το NULL_STRING δεν μπορεί να είναι μήκος)
+	size_t len = strlen(s);
+	if (len >= NULL_STRING)
+		len = NULL_STRING - 1;
+
+	buffer_put_u16(buffer, len);
+	buffer_append(buffer, s, len);
+}
+
+size_t frame_begin(Buffer buffer, uint8_t type) {
+	size_t pos = buffer->size;
+	buffer_put_u32(buffer, 0);			// συμπληρώνεται στην frame_end
+	buffer_put_u8(buffer, type);
+	return pos;
+}
+
+void frame_end(Buffer buffer, size_t pos) {
+	uint32_t length = buffer->size - pos - 4;
+	uint8_t* p = (uint8_t*)buffer->data + pos;
+	p[0] = length;
+	p[1] = length >> 8;
+	p[2] = length >> 16;
+	p[3] = length >> 24;
+}
+
+void buffer_free(Buffer buffer) {
+	free(buffer->data);
+	buffer->data = NULL;
+	buffer->size = buffer->capacity = 0;
+}
+
+
+bool reader_get_u8(Reader reader, uint8_t* value) {
+	if (reader->end - reader->pos < 1)
+		return false;
+
+	*value = *(uint8_t*)reader->pos++;
+	return true;
+}
+
+bool reader_get_u16(Reader reader, uint16_t* value) {
+	if (reader->end - reader->pos < 2)
+		return false;
+
+	uint8_t* p = (uint8_t*)reader->pos;
+	*value = p[0] | p[1] << 8;
+	reader->pos += 2;
+	return true;
+}
+
+bool reader_get_u32(Reader reader, uint32_t* value) {
+	if (reader->end - reader->pos < 4)
+		return false;
+
+	uint8_t* p = (uint8_t*)reader->pos;
+	*value = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+	reader->pos += 4;
+	return true;
+}
+
+bool reader_get_string(Reader reader, String* s) {
+	char* start = reader->pos;
+	uint16_t len;
+	if (!reader_get_u16(reader, &len))
+		return false;
+
+	if (len == NULL_STRING) {
+		*s = NULL;
+		return true;
+	}
+	if (reader->end - reader->pos < len)
+		return false;
+
+	// Το string μετακινείται στη θέση του μήκους, ώστε να χωράει το '\0' πριν το επόμενο πεδίο
+	memmove(start, reader->pos, len);
+	start[len] = '\0';
+	reader->pos += len;
+	*s = start;
+	return true;
+}
+
+long frame_complete(const char* data, size_t size, size_t max) {
+	if (size < 4)
+		return 0;
+
+	const uint8_t* p = (const uint8_t*)data;
+	uint32_t length = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+	if (length < 1 || length > max)
+		return -1;
+
+	return size >= 4 + (size_t)length ? 4 + (long)length : 0;
+}
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////
+//
+// Το binary protocol του dm_server (κοινό για server και dm_loadgen).
+//
+// Κάθε μήνυμα (αίτημα ή απάντηση) είναι ένα frame:
+//   u32 length     Το μήκος του υπόλοιπου frame (χωρίς το ίδιο το length)
+//   u8  type       Αιτήματα: MSG_*, απαντήσεις: STATUS_*
+//   ...            Τα πεδία του μηνύματος
+//
+// Οι ακέραιοι είναι little-endian. Τα strings γράφονται ως u16 μήκος και τα bytes
+// τους (χωρίς '\0'), με μήκος NULL_STRING για NULL.
+//
+// Αιτήματα και απαντήσεις:
+//   MSG_INSERT   i32 id, name, disease, country, date   => u8 replaced
+//   MSG_REMOVE   i32 id                                 => u8 removed
+//   MSG_COUNT    disease, country, date_from, date_to   => i32 count
+//   MSG_GET      disease, country, date_from, date_to   => u32 n, n x (i32 id, name, disease, country, date)
+//   MSG_TOP      i32 k, country                         => u32 n, n x disease
+//   MSG_SHUTDOWN                                        => (κενή απάντηση), ο server τερματίζει
+//
+// Ένας client μπορεί να στείλει πολλά αιτήματα χωρίς να περιμένει απάντηση (pipelining).
+// Οι απαντήσεις έρχονται πάντα με τη σειρά των αιτημάτων της ίδιας σύνδεσης, και κάθε
+// αίτημα βλέπει τα αποτελέσματα όλων των προηγούμενων αιτημάτων της σύνδεσης.
+//
+///////////////////////////////////////////////////////////////////
+
+#pragma once // #include το πολύ μία φορά
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common_types.h"
+
+
+enum {
+	MSG_INSERT = 1,
+	MSG_REMOVE,
+	MSG_COUNT,
+	MSG_GET,
+	MSG_TOP,
+	MSG_SHUTDOWN,
+};
+
+enum {
+	STATUS_OK = 0,
+	STATUS_ERROR,				// Ακολουθεί ένα string με την περιγραφή του λάθους
+};
+
+#define NULL_STRING 0xFFFF
+
+// Το μέγιστο μήκος ενός αιτήματος (οι απαντήσεις της MSG_GET δεν έχουν όριο)
+#define MAX_REQUEST (1 << 20)
+
+// Το length και το type κάθε frame
+#define FRAME_HEADER 5
+
+
+// Ένα buffer που μεγαλώνει όσο χρειάζεται, για την κατασκευή μηνυμάτων
+
+struct buffer {
+	char* data;
+	size_t size;
+	size_t capacity;
+};
+typedef struct buffer* Buffer;
+
+// Εξασφαλίζει χώρο για n ακόμα bytes, και επιστρέφει pointer στο τέλος των δεδομένων
+
+char* buffer_reserve(Buffer buffer, size_t n);
+
+// Προσθέτει n bytes στο τέλος
+
+void buffer_append(Buffer buffer, const void* data, size_t n);
+
+void buffer_put_u8(Buffer buffer, uint8_t value);
+void buffer_put_u16(Buffer buffer, uint16_t value);
+void buffer_put_u32(Buffer buffer, uint32_t value);
+void buffer_put_string(Buffer buffer, String s);		// s μπορεί να είναι NULL
+
+// Ξεκινάει ένα frame με τύπο type. Επιστρέφει τη θέση του, για την frame_end.
+
+size_t frame_begin(Buffer buffer, uint8_t type);
+
+// Ολοκληρώνει το frame που ξεκίνησε στη θέση pos, συμπληρώνοντας το length του
+
+void frame_end(Buffer buffer, size_t pos);
+
+// Απελευθερώνει τη μνήμη του buffer (το ίδιο το struct ανήκει στον χρήστη)
+
+void buffer_free(Buffer buffer);
+
+
+// Ανάγνωση των πεδίων ενός μηνύματος. Οι συναρτήσεις επιστρέφουν false αν τα δεδομένα
+// δεν επαρκούν, οπότε το μήνυμα είναι κατεστραμμένο.
+
+struct reader {
+	char* pos;
+	char* end;
+};
+typedef struct reader* Reader;
+
+bool reader_get_u8(Reader reader, uint8_t* value);
+bool reader_get_u16(Reader reader, uint16_t* value);
+bool reader_get_u32(Reader reader, uint32_t* value);
+
+// Επιστρέφει στο s ένα string με '\0' στο τέλος, γραμμένο πάνω στα ίδια τα δεδομένα
+// (μετακινώντας τα 2 bytes πίσω, στη θέση του μήκους). Τα δεδομένα του μηνύματος
+// αλλάζουν, οπότε κάθε πεδίο διαβάζεται μία μόνο φορά.
+
+bool reader_get_string(Reader reader, String* s);
+
+// Αν το data[0 .. size-1] περιέχει ολόκληρο frame, επιστρέφει το μήκος του (μαζί με το
+// length). Αν όχι επιστρέφει 0, και -1 αν το length ξεπερνάει το max.
+
+long frame_complete(const char* data, size_t size, size_t max);
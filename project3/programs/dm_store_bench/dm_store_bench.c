@@ -0,0 +1,226 @@
+//////////////////////////////////////////////////////////////////
+//
+// Benchmark μνήμης και διάσχισης για τους τρεις τρόπους αποθήκευσης
+// records:
+//
+//   records  struct record με ξεχωριστή malloc για κάθε string
+//   arena    αντίγραφα μέσω του RecordArena
+//   store    συμπιεσμένα blocks του RecordStore
+//   months   τα partitions ανά μήνα του RecordPartitions
+//   frozen   τα ίδια partitions, όλα παγωμένα
+//   spilled  τα ίδια partitions, στη μνήμη μόνο οι 3 πιο πρόσφατοι μήνες
+//            και τα υπόλοιπα σε αρχεία (σε έναν προσωρινό φάκελο στο /tmp)
+//
+// Για καθένα τυπώνει τα bytes ανά record (όπως τα μετράει ο allocator,
+// μαζί με τα headers των mallocs) και το throughput της διάσχισης για
+// μερικά τυπικά κριτήρια, σε εκατομμύρια records ανά δευτερόλεπτο.
+//
+// Χρήση: ./dm_store_bench [records] [repeat]
+//
+//////////////////////////////////////////////////////////////////
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "RecordArena.h"
+#include "RecordStore.h"
+#include "RecordPartitions.h"
+
+static String diseases[] = { "COVID-19", "Influenza", "Measles", "Cholera", "Malaria", "Dengue", "Ebola", "Zika" };
+static String countries[] = { "Greece", "Italy", "Spain", "France", "Germany", "Cyprus", "Portugal", "Austria", "Belgium" };
+
+// Τα κριτήρια της διάσχισης: disease, country, date_from, date_to
+static String queries[][4] = {
+	{ NULL, NULL, NULL, NULL },
+	{ "Influenza", NULL, NULL, NULL },
+	{ "COVID-19", "Greece", "2020-03-01", "2020-09-30" },
+};
+#define QUERY_NO (int)(sizeof(queries) / sizeof(queries[0]))
+
+// Χρόνος σε δευτερόλεπτα από ένα σταθερό σημείο
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Bytes που έχει δώσει ο allocator
+static size_t heap_used() {
+	return mallinfo2().uordblks;
+}
+
+// Η visit όλων των διασχίσεων: "διαβάζει" το record, ώστε να μετράει και το κόστος της αποσυμπίεσης
+static bool visit(Record record, Pointer context) {
+	*(long*)context += record->id + record->date[9] + record->name[0];
+	return true;
+}
+
+// Διάσχιση ενός πίνακα από Records, με τα κριτήρια της store_scan
+static int scan_records(Record* records, int n, String* q, long* checksum) {
+	int matches = 0;
+	for (int i = 0; i < n; i++) {
+		Record r = records[i];
+		if ((q[0] == NULL || strcmp(r->disease, q[0]) == 0)
+			&& (q[1] == NULL || strcmp(r->country, q[1]) == 0)
+			&& (q[2] == NULL || strcmp(r->date, q[2]) >= 0)
+			&& (q[3] == NULL || strcmp(r->date, q[3]) <= 0)) {
+			visit(r, checksum);
+			matches++;
+		}
+	}
+	return matches;
+}
+
+// Τυπώνει μια γραμμή του πίνακα αποτελεσμάτων
+static void report(String name, size_t memory, int n, double times[], int matches[]) {
+	printf("%-8s %10.1f", name, (double)memory / n);
+	for (int q = 0; q < QUERY_NO; q++)
+		printf(" %12.1f", n / times[q] / 1e6);
+	printf("   (");
+	for (int q = 0; q < QUERY_NO; q++)
+		printf(q > 0 ? " %d" : "%d", matches[q]);
+	printf(")\n");
+}
+
+int main(int argc, char* argv[]) {
+	int n = argc > 1 ? atoi(argv[1]) : 1000000;
+	int repeat = argc > 2 ? atoi(argv[2]) : 5;
+
+	// Οι εγγραφές: ημερομηνίες σε όλο το 2020, και ονόματα που επαναλαμβάνονται (περίπου 8 εγγραφές ανά όνομα)
+	struct record* records = malloc(n * sizeof(*records));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	char (*names)[16] = malloc(n * sizeof(*names));
+	srand(42);
+
+	for (int i = 0; i < n; i++) {
+		int day = rand() % 365;
+		sprintf(dates[i], "2020-%02d-%02d", 1 + day / 31, 1 + day % 31 % 28);
+		sprintf(names[i], "patient%d", rand() % (n / 8 + 1));
+
+		records[i] = (struct record){
+			.id = i, .name = names[i], .date = dates[i],
+			.disease = diseases[rand() % (sizeof(diseases) / sizeof(String))],
+			.country = countries[rand() % (sizeof(countries) / sizeof(String))],
+		};
+	}
+
+	printf("%d records, %d repeats\n", n, repeat);
+	printf("%-8s %10s", "storage", "bytes/rec");
+	for (int q = 0; q < QUERY_NO; q++)
+		printf("   q%d Mrec/s", q + 1);
+	printf("   (matches)\n");
+
+	double times[QUERY_NO];
+	int matches[QUERY_NO];
+	long checksum = 0;
+
+	// records: struct record και strings, όλα σε ξεχωριστές mallocs
+	size_t before = heap_used();
+	Record* copies = malloc(n * sizeof(Record));
+	for (int i = 0; i < n; i++) {
+		Record r = malloc(sizeof(*r));
+		*r = (struct record){
+			.id = records[i].id,
+			.name = strdup(records[i].name),
+			.date = strdup(records[i].date),
+			.disease = strdup(records[i].disease),
+			.country = strdup(records[i].country),
+		};
+		copies[i] = r;
+	}
+	size_t memory = heap_used() - before;
+
+	for (int q = 0; q < QUERY_NO; q++) {
+		double start = now();
+		for (int k = 0; k < repeat; k++)
+			matches[q] = scan_records(copies, n, queries[q], &checksum);
+		times[q] = (now() - start) / repeat;
+	}
+	report("records", memory, n, times, matches);
+
+	for (int i = 0; i < n; i++) {
+		free(copies[i]->name);
+		free(copies[i]->date);
+		free(copies[i]->disease);
+		free(copies[i]->country);
+		free(copies[i]);
+	}
+
+	// arena: ο πίνακας με τους pointers μετράει, όπως τον χρειάζεται κάθε ευρετήριο που κρατάει Records
+	before = heap_used();
+	RecordArena arena = arena_create();
+	for (int i = 0; i < n; i++)
+		copies[i] = arena_copy(arena, &records[i]);
+	memory = heap_used() - before + n * sizeof(Record);
+
+	for (int q = 0; q < QUERY_NO; q++) {
+		double start = now();
+		for (int k = 0; k < repeat; k++)
+			matches[q] = scan_records(copies, n, queries[q], &checksum);
+		times[q] = (now() - start) / repeat;
+	}
+	report("arena", memory, n, times, matches);
+	arena_destroy(arena);
+	free(copies);
+
+	// store
+	before = heap_used();
+	RecordStore store = store_create();
+	for (int i = 0; i < n; i++)
+		store_append(store, &records[i]);
+	memory = heap_used() - before;
+
+	for (int q = 0; q < QUERY_NO; q++) {
+		String* query = queries[q];
+		double start = now();
+		for (int k = 0; k < repeat; k++)
+			matches[q] = store_scan(store, query[0], query[1], query[2], query[3], visit, &checksum);
+		times[q] = (now() - start) / repeat;
+	}
+	report("store", memory, n, times, matches);
+	printf("store_memory: %.1f bytes/rec (checksum %ld)\n", (double)store_memory(store) / n, checksum);
+	store_destroy(store);
+
+	// partitions, πρώτα ανοιχτά, μετά παγωμένα και τέλος στο δίσκο
+	before = heap_used();
+	RecordPartitions partitions = partitions_create();
+	for (int i = 0; i < n; i++)
+		partitions_insert(partitions, &records[i]);
+
+	char directory[] = "/tmp/dm_store_bench_XXXXXX";
+	String stages[] = { "months", "frozen", "spilled" };
+	for (int stage = 0; stage < 3; stage++) {
+		if (stage == 1) {
+			List months = partitions_months(partitions);
+			for (ListNode node = list_first(months); node != LIST_EOF; node = list_next(months, node))
+				partitions_freeze(partitions, list_node_value(months, node));
+			list_destroy(months);
+		} else if (stage == 2 && (mkdtemp(directory) == NULL || !partitions_set_spill(partitions, directory, 3))) {
+			fprintf(stderr, "cannot create %s\n", directory);
+			break;
+		}
+
+		for (int q = 0; q < QUERY_NO; q++) {
+			String* query = queries[q];
+			double start = now();
+			for (int k = 0; k < repeat; k++)
+				matches[q] = partitions_scan(partitions, query[0], query[1], query[2], query[3], visit, &checksum);
+			times[q] = (now() - start) / repeat;
+		}
+
+		// Μετά τα queries, ώστε να μετράνε και τα indexes των partitions που φορτώθηκαν από το δίσκο
+		memory = heap_used() - before;
+		report(stages[stage], memory, n, times, matches);
+	}
+	partitions_destroy(partitions);
+	rmdir(directory);
+
+	free(records);
+	free(dates);
+	free(names);
+	return 0;
+}
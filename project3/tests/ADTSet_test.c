@@ -0,0 +1,190 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για τον ADT Set.
+// Οποιαδήποτε υλοποίηση οφείλει να περνάει όλα τα tests.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "ADTSet.h"
+
+
+// Ελέγχει ότι το δέντρο είναι σωστό AVL (υλοποιείται στο ADTSet.c, δεν είναι μέρος του public interface)
+bool set_is_proper(Set set);
+
+int compare_ints(Pointer a, Pointer b) {
+	return *(int*)a - *(int*)b;
+}
+
+// Επιστρέφει έναν πίνακα με τους αριθμούς 0 .. n-1 ανακατεμένους
+int* create_shuffled(int n) {
+	int* array = malloc(n * sizeof(int));
+	for (int i = 0; i < n; i++)
+		array[i] = i;
+
+	for (int i = 0; i < n; i++) {
+		int j = i + rand() / (RAND_MAX / (n - i) + 1);
+		int t = array[j];
+		array[j] = array[i];
+		array[i] = t;
+	}
+	return array;
+}
+
+
+void test_create(void) {
+	Set set = set_create(compare_ints, NULL);
+
+	TEST_ASSERT(set != NULL);
+	TEST_ASSERT(set_size(set) == 0);
+	TEST_ASSERT(set_first(set) == SET_BOF);
+	TEST_ASSERT(set_last(set) == SET_EOF);
+	TEST_ASSERT(set_node_at(set, 0) == SET_EOF);
+
+	set_destroy(set);
+}
+
+void test_insert(void) {
+	int n = 1000;
+	int* values = create_shuffled(n);
+	Set set = set_create(compare_ints, NULL);
+
+	for (int i = 0; i < n; i++) {
+		SetNode node = set_insert_node(set, &values[i]);
+		TEST_ASSERT(set_node_value(set, node) == &values[i]);
+		TEST_ASSERT(set_size(set) == i + 1);
+		TEST_ASSERT(set_find(set, &values[i]) == &values[i]);
+	}
+	TEST_ASSERT(set_is_proper(set));
+
+	// Η μνήμη του set είναι ανάλογη του μεγέθους του
+	Set empty = set_create(compare_ints, NULL);
+	TEST_ASSERT(set_memory(set) > set_memory(empty));
+	TEST_ASSERT((set_memory(set) - set_memory(empty)) % n == 0);
+	set_destroy(empty);
+
+	// Ισοδύναμη τιμή αντικαθιστά την παλιά, στον ίδιο κόμβο
+	int value = values[0];
+	SetNode node = set_find_node(set, &value);
+	TEST_ASSERT(set_insert_node(set, &value) == node);
+	TEST_ASSERT(set_node_value(set, node) == &value);
+	TEST_ASSERT(set_size(set) == n);
+
+	set_destroy(set);
+	free(values);
+}
+
+void test_remove(void) {
+	int n = 1000;
+	int* values = create_shuffled(n);
+	Set set = set_create(compare_ints, NULL);
+
+	for (int i = 0; i < n; i++)
+		set_insert(set, &values[i]);
+
+	for (int i = 0; i < n; i++) {
+		TEST_ASSERT(set_remove(set, &values[i]));
+		TEST_ASSERT(!set_remove(set, &values[i]));
+		TEST_ASSERT(set_size(set) == n - i - 1);
+
+		if (i % 100 == 0)
+			TEST_ASSERT(set_is_proper(set));
+	}
+
+	set_destroy(set);
+	free(values);
+}
+
+void test_iterate(void) {
+	int n = 1000;
+	int* values = create_shuffled(n);
+	Set set = set_create(compare_ints, NULL);
+
+	for (int i = 0; i < n; i++)
+		set_insert(set, &values[i]);
+
+	// Διάσχιση προς τα εμπρός και προς τα πίσω με τη σειρά διάταξης
+	int i = 0;
+	for (SetNode node = set_first(set); node != SET_EOF; node = set_next(set, node))
+		TEST_ASSERT(*(int*)set_node_value(set, node) == i++);
+	TEST_ASSERT(i == n);
+
+	for (SetNode node = set_last(set); node != SET_BOF; node = set_previous(set, node))
+		TEST_ASSERT(*(int*)set_node_value(set, node) == --i);
+	TEST_ASSERT(i == 0);
+
+	// Κόμβοι βάσει θέσης
+	for (int pos = 0; pos < n; pos++)
+		TEST_ASSERT(*(int*)set_node_value(set, set_node_at(set, pos)) == pos);
+	TEST_ASSERT(set_node_at(set, -1) == SET_EOF);
+	TEST_ASSERT(set_node_at(set, n) == SET_EOF);
+
+	set_destroy(set);
+	free(values);
+}
+
+void test_rank(void) {
+	int n = 1000;
+	int* values = create_shuffled(n);
+	Set set = set_create(compare_ints, NULL);
+
+	// Μόνο οι ζυγοί, ώστε να ελέγξουμε και τιμές που δεν υπάρχουν στο set
+	for (int i = 0; i < n; i++)
+		if (values[i] % 2 == 0)
+			set_insert(set, &values[i]);
+
+	for (int i = -1; i <= n; i++) {
+		int rank = set_rank(set, &i);
+		TEST_ASSERT(rank == (i + 1) / 2);		// οι ζυγοί 0, 2, ..., που είναι < i
+		if (i >= 0 && i < n && i % 2 == 0)
+			TEST_ASSERT(*(int*)set_node_value(set, set_node_at(set, rank)) == i);
+	}
+
+	set_destroy(set);
+	free(values);
+}
+
+void test_remove_node(void) {
+	int n = 1000;
+	int* values = create_shuffled(n);
+	Set set = set_create(compare_ints, NULL);
+
+	// Κρατάμε τους κόμβους όπως τους επιστρέφει η set_insert_node
+	SetNode nodes[n];
+	for (int i = 0; i < n; i++)
+		nodes[values[i]] = set_insert_node(set, &values[i]);
+
+	// Αφαιρούμε πρώτα τους μονούς και μετά τους ζυγούς, απευθείας από τους κόμβους
+	for (int parity = 1; parity >= 0; parity--) {
+		for (int i = parity; i < n; i += 2) {
+			set_remove_node(set, nodes[i]);
+			TEST_ASSERT(set_find(set, &i) == NULL);
+
+			if (i % 50 == parity)
+				TEST_ASSERT(set_is_proper(set));
+		}
+
+		// Οι υπόλοιποι κόμβοι είναι ακόμα έγκυροι
+		for (int i = 0; i < n && parity == 1; i += 2)
+			TEST_ASSERT(set_node_value(set, nodes[i]) == set_find(set, &i));
+	}
+	TEST_ASSERT(set_size(set) == 0);
+
+	set_destroy(set);
+	free(values);
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "set_create", test_create },
+	{ "set_insert", test_insert },
+	{ "set_remove", test_remove },
+	{ "set_iterate", test_iterate },
+	{ "set_rank", test_rank },
+	{ "set_remove_node", test_remove_node },
+
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};
@@ -0,0 +1,197 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για τον ADT Trie.
+// Οποιαδήποτε υλοποίηση οφείλει να περνάει όλα τα tests.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "ADTTrie.h"
+
+
+// Ελέγχει ότι το radix tree είναι σωστό (υλοποιείται στο ADTTrie.c, δεν είναι μέρος του public interface)
+bool trie_is_proper(Trie trie);
+
+// Ένα key μαζί με μια τιμή, η οποία στα tests είναι ο pointer σε αυτό το struct
+struct pair {
+	char key[8];
+	int removed;
+};
+
+// Δημιουργεί n τυχαία keys από ένα μικρό αλφάβητο, ώστε να υπάρχουν πολλά κοινά prefixes
+// (και επαναλαμβανόμενα keys)
+static struct pair* create_pairs(int n) {
+	struct pair* pairs = calloc(n, sizeof(*pairs));
+	for (int i = 0; i < n; i++) {
+		int len = 1 + rand() % 6;
+		for (int j = 0; j < len; j++)
+			pairs[i].key[j] = "abc"[rand() % 3];
+	}
+	return pairs;
+}
+
+// Ελέγχει ότι η trie_find_prefix επιστρέφει ακριβώς τα ζεύγη που δεν έχουν αφαιρεθεί και
+// αρχίζουν από prefix, ταξινομημένα κατά key
+static void check_prefix(Trie trie, struct pair* pairs, int n, String prefix) {
+	List list = trie_find_prefix(trie, prefix, -1);
+
+	int expected = 0;
+	for (int i = 0; i < n; i++)
+		if (!pairs[i].removed && strncmp(pairs[i].key, prefix, strlen(prefix)) == 0)
+			expected++;
+	TEST_ASSERT(list_size(list) == expected);
+
+	struct pair* previous = NULL;
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+		struct pair* pair = list_node_value(list, node);
+		TEST_ASSERT(!pair->removed);
+		TEST_ASSERT(strncmp(pair->key, prefix, strlen(prefix)) == 0);
+		TEST_ASSERT(previous == NULL || strcmp(previous->key, pair->key) <= 0);
+		previous = pair;
+	}
+	list_destroy(list);
+}
+
+
+void test_create(void) {
+	Trie trie = trie_create(NULL);
+
+	TEST_ASSERT(trie != NULL);
+	TEST_ASSERT(trie_size(trie) == 0);
+	TEST_ASSERT(trie_is_proper(trie));
+
+	List list = trie_find_prefix(trie, "", -1);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+
+	trie_destroy(trie);
+}
+
+void test_insert(void) {
+	int n = 1000;
+	struct pair* pairs = create_pairs(n);
+	Trie trie = trie_create(NULL);
+
+	for (int i = 0; i < n; i++) {
+		trie_insert(trie, pairs[i].key, &pairs[i]);
+		TEST_ASSERT(trie_size(trie) == i + 1);
+	}
+	TEST_ASSERT(trie_is_proper(trie));
+
+	// Το trie κρατάει δικό του αντίγραφο των keys
+	char key[] = "abc";
+	trie_insert(trie, key, key);
+	strcpy(key, "xyz");
+
+	List list = trie_find_prefix(trie, "xyz", -1);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+	TEST_ASSERT(trie_remove(trie, "abc", key));
+
+	trie_destroy(trie);
+	free(pairs);
+}
+
+void test_find_prefix(void) {
+	int n = 1000;
+	struct pair* pairs = create_pairs(n);
+	Trie trie = trie_create(NULL);
+
+	for (int i = 0; i < n; i++)
+		trie_insert(trie, pairs[i].key, &pairs[i]);
+
+	String prefixes[] = { "", "a", "b", "ab", "abc", "cab", "aaaaaa", "aaaaaaa", "d", "ad" };
+	for (int i = 0; i < 10; i++)
+		check_prefix(trie, pairs, n, prefixes[i]);
+
+	// Με limit επιστρέφονται τα πρώτα keys
+	List all = trie_find_prefix(trie, "b", -1);
+	List some = trie_find_prefix(trie, "b", 10);
+	TEST_ASSERT(list_size(some) == 10);
+	for (ListNode a = list_first(all), s = list_first(some); s != LIST_EOF; a = list_next(all, a), s = list_next(some, s))
+		TEST_ASSERT(strcmp(((struct pair*)list_node_value(all, a))->key, ((struct pair*)list_node_value(some, s))->key) == 0);
+	list_destroy(all);
+	list_destroy(some);
+
+	List none = trie_find_prefix(trie, "", 0);
+	TEST_ASSERT(list_size(none) == 0);
+	list_destroy(none);
+
+	trie_destroy(trie);
+	free(pairs);
+}
+
+void test_remove(void) {
+	int n = 1000;
+	struct pair* pairs = create_pairs(n);
+	Trie trie = trie_create(NULL);
+	size_t empty_memory = trie_memory(trie);
+
+	for (int i = 0; i < n; i++)
+		trie_insert(trie, pairs[i].key, &pairs[i]);
+	TEST_ASSERT(trie_memory(trie) > empty_memory);
+
+	// Ζεύγη που δεν υπάρχουν (τα keys δεν περιέχουν 'd', και η τιμή συγκρίνεται ως pointer)
+	TEST_ASSERT(!trie_remove(trie, "d", &pairs[0]));
+	TEST_ASSERT(!trie_remove(trie, "abcd", &pairs[0]));
+	TEST_ASSERT(!trie_remove(trie, pairs[0].key, &n));
+
+	// Αφαίρεση με τυχαία σειρά, ελέγχοντας τη δομή και τα αποτελέσματα
+	for (int i = 0; i < n; i++) {
+		int j = rand() % n;
+		while (pairs[j].removed)
+			j = (j + 1) % n;
+
+		TEST_ASSERT(trie_remove(trie, pairs[j].key, &pairs[j]));
+		TEST_ASSERT(!trie_remove(trie, pairs[j].key, &pairs[j]));
+		pairs[j].removed = 1;
+		TEST_ASSERT(trie_size(trie) == n - i - 1);
+
+		if (i % 100 == 0) {
+			TEST_ASSERT(trie_is_proper(trie));
+			check_prefix(trie, pairs, n, "");
+			check_prefix(trie, pairs, n, "ab");
+		}
+	}
+
+	// Όλοι οι κόμβοι ελευθερώθηκαν
+	TEST_ASSERT(trie_is_proper(trie));
+	TEST_ASSERT(trie_memory(trie) == empty_memory);
+
+	trie_destroy(trie);
+	free(pairs);
+}
+
+void test_destroy_value(void) {
+	Trie trie = trie_create(free);
+
+	// Τα keys με κοινά prefixes, επαναλήψεις και κενό key
+	String keys[] = { "maria", "marios", "maria", "", "m", "nikos" };
+	for (int i = 0; i < 6; i++)
+		trie_insert(trie, keys[i], malloc(1));
+
+	List list = trie_find_prefix(trie, "mari", -1);
+	TEST_ASSERT(list_size(list) == 3);
+	TEST_ASSERT(trie_remove(trie, "maria", list_node_value(list, list_first(list))));
+	list_destroy(list);
+
+	TEST_ASSERT(trie_set_destroy_value(trie, free) == free);
+	TEST_ASSERT(trie_size(trie) == 5);
+	TEST_ASSERT(trie_is_proper(trie));
+
+	trie_destroy(trie);		// το valgrind / ASan ελέγχει ότι ελευθερώθηκαν όλες οι τιμές
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "trie_create", test_create },
+	{ "trie_insert", test_insert },
+	{ "trie_find_prefix", test_find_prefix },
+	{ "trie_remove", test_remove },
+	{ "trie_destroy_value", test_destroy_value },
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};
@@ -0,0 +1,312 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για τον ADT VersionedSet.
+// Οποιαδήποτε υλοποίηση οφείλει να περνάει όλα τα tests.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "ADTVersionedSet.h"
+
+
+// Ελέγχει ότι η τρέχουσα έκδοση είναι σωστό AVL (υλοποιείται στο ADTVersionedSet.c, δεν είναι μέρος του public interface)
+bool vset_is_proper(VSet vset);
+
+static int compare_ints(Pointer a, Pointer b) {
+	return *(int*)a - *(int*)b;
+}
+
+// Τα στοιχεία ενός snapshot, όπως τα συλλέγει η collect
+struct collected {
+	int values[4096];
+	int count;
+};
+
+static bool collect(Pointer value, Pointer context) {
+	struct collected* collected = context;
+	collected->values[collected->count++] = *(int*)value;
+	return true;
+}
+
+// Το διάστημα [from, to]
+struct range {
+	int from, to;
+	struct collected collected;
+};
+
+static int in_range(Pointer value, Pointer context) {
+	struct range* range = context;
+	int x = *(int*)value;
+	return x < range->from ? -1 : x > range->to ? 1 : 0;
+}
+
+static bool collect_range(Pointer value, Pointer context) {
+	return collect(value, &((struct range*)context)->collected);
+}
+
+// Ελέγχει ότι το snapshot περιέχει ακριβώς τις τιμές i για τις οποίες present[i] == true, με τη σειρά
+static void check_snapshot(VSetSnapshot snapshot, bool present[], int n) {
+	struct collected* collected = malloc(sizeof(*collected));
+	collected->count = 0;
+	vset_visit(snapshot, NULL, collect, collected);
+
+	int expected = 0;
+	for (int i = 0; i < n; i++) {
+		if (!present[i])
+			continue;
+		TEST_ASSERT(expected < collected->count && collected->values[expected] == i);
+		expected++;
+	}
+	TEST_ASSERT(collected->count == expected);
+	TEST_ASSERT(vset_snapshot_size(snapshot) == expected);
+	free(collected);
+}
+
+static int destroyed = 0;
+
+static void count_destroy(Pointer value) {
+	destroyed++;
+}
+
+
+void test_create(void) {
+	VSet vset = vset_create(compare_ints, NULL);
+	TEST_ASSERT(vset != NULL);
+	TEST_ASSERT(vset_size(vset) == 0);
+	TEST_ASSERT(vset_is_proper(vset));
+
+	VSetSnapshot snapshot = vset_snapshot(vset);
+	TEST_ASSERT(vset_snapshot_size(snapshot) == 0);
+	vset_release(vset, snapshot);
+
+	vset_destroy(vset);
+}
+
+void test_insert_remove(void) {
+	int n = 1000;
+	int* values = malloc(n * sizeof(*values));
+	bool* present = calloc(n, sizeof(*present));
+	for (int i = 0; i < n; i++)
+		values[i] = i;
+
+	VSet vset = vset_create(compare_ints, NULL);
+
+	// Εισαγωγή με τυχαία σειρά, με επαναλήψεις
+	for (int i = 0; i < 2 * n; i++) {
+		int j = rand() % n;
+		vset_insert(vset, &values[j]);
+		present[j] = true;
+	}
+	TEST_ASSERT(vset_is_proper(vset));
+
+	int size = 0;
+	for (int i = 0; i < n; i++)
+		size += present[i];
+	TEST_ASSERT(vset_size(vset) == size);
+
+	for (int i = 0; i < n; i++) {
+		int j = rand() % n;
+		TEST_ASSERT(vset_remove(vset, &values[j]) == present[j]);
+		present[j] = false;
+	}
+	TEST_ASSERT(vset_is_proper(vset));
+
+	VSetSnapshot snapshot = vset_snapshot(vset);
+	check_snapshot(snapshot, present, n);
+	vset_release(vset, snapshot);
+
+	vset_destroy(vset);
+	free(values);
+	free(present);
+}
+
+void test_snapshot(void) {
+	int n = 1000, snapshots_no = 5;
+	int* values = malloc(n * sizeof(*values));
+	bool* present = calloc(n, sizeof(*present));
+	bool* states[snapshots_no];
+	VSetSnapshot snapshots[snapshots_no];
+
+	for (int i = 0; i < n; i++)
+		values[i] = i;
+
+	VSet vset = vset_create(compare_ints, NULL);
+
+	// Ανάμεσα στα snapshots γίνονται τυχαίες αλλαγές, και κάθε snapshot κρατάει την εικόνα της στιγμής του
+	for (int s = 0; s < snapshots_no; s++) {
+		for (int i = 0; i < n; i++) {
+			int j = rand() % n;
+			if (rand() % 3 == 0) {
+				vset_remove(vset, &values[j]);
+				present[j] = false;
+			} else {
+				vset_insert(vset, &values[j]);
+				present[j] = true;
+			}
+		}
+		TEST_ASSERT(vset_is_proper(vset));
+
+		snapshots[s] = vset_snapshot(vset);
+		states[s] = malloc(n * sizeof(bool));
+		for (int i = 0; i < n; i++)
+			states[s][i] = present[i];
+
+		for (int t = 0; t <= s; t++)
+			check_snapshot(snapshots[t], states[t], n);
+	}
+
+	// Αποδέσμευση με διαφορετική σειρά από τη δημιουργία, με αλλαγές ενδιάμεσα
+	int order[] = { 2, 0, 4, 1, 3 };
+	for (int k = 0; k < snapshots_no; k++) {
+		vset_release(vset, snapshots[order[k]]);
+		free(states[order[k]]);
+		states[order[k]] = NULL;
+
+		for (int i = 0; i < n / 4; i++) {
+			int j = rand() % n;
+			vset_insert(vset, &values[j]);
+			present[j] = true;
+		}
+		for (int s = 0; s < snapshots_no; s++)
+			if (states[s] != NULL)
+				check_snapshot(snapshots[s], states[s], n);
+	}
+	TEST_ASSERT(vset_is_proper(vset));
+
+	vset_destroy(vset);
+	free(values);
+	free(present);
+}
+
+void test_visit_range(void) {
+	int n = 100;
+	int values[n];
+	VSet vset = vset_create(compare_ints, NULL);
+	for (int i = 0; i < n; i++) {
+		values[i] = 2 * i;
+		vset_insert(vset, &values[i]);
+	}
+
+	VSetSnapshot snapshot = vset_snapshot(vset);
+	struct range range = { .from = 15, .to = 40, .collected.count = 0 };
+	vset_visit(snapshot, in_range, collect_range, &range);
+
+	TEST_ASSERT(range.collected.count == 13);		// 16, 18, ..., 40
+	for (int i = 0; i < range.collected.count; i++)
+		TEST_ASSERT(range.collected.values[i] == 16 + 2 * i);
+
+	struct range empty = { .from = 41, .to = 41, .collected.count = 0 };
+	vset_visit(snapshot, in_range, collect_range, &empty);
+	TEST_ASSERT(empty.collected.count == 0);
+
+	vset_release(vset, snapshot);
+	vset_destroy(vset);
+}
+
+void test_release(void) {
+	int n = 1000;
+	int* values = malloc(n * sizeof(*values));
+	for (int i = 0; i < n; i++)
+		values[i] = i;
+
+	destroyed = 0;
+	VSet vset = vset_create(compare_ints, count_destroy);
+	for (int i = 0; i < n; i++)
+		vset_insert(vset, &values[i]);
+	size_t memory = vset_memory(vset);
+
+	// Χωρίς snapshots οι αφαιρέσεις καταστρέφουν αμέσως τις τιμές
+	vset_remove(vset, &values[0]);
+	TEST_ASSERT(destroyed == 1);
+	vset_insert(vset, &values[0]);
+	TEST_ASSERT(vset_memory(vset) == memory);
+
+	// Με ένα snapshot οι τιμές και οι κόμβοι κρατιούνται μέχρι το release
+	VSetSnapshot snapshot = vset_snapshot(vset);
+	for (int i = 0; i < n / 2; i++)
+		vset_remove(vset, &values[i]);
+	TEST_ASSERT(destroyed == 1);
+	TEST_ASSERT(vset_memory(vset) > memory);
+
+	vset_release(vset, snapshot);
+	for (int i = 0; i < n / 2; i++)
+		vset_insert(vset, &values[i]);
+	TEST_ASSERT(destroyed == 1 + n / 2);
+	TEST_ASSERT(vset_memory(vset) == memory);
+	TEST_ASSERT(vset_is_proper(vset));
+
+	// Το destroy καταστρέφει και όσα κρατάνε τα snapshots που δεν έγιναν release
+	snapshot = vset_snapshot(vset);
+	vset_remove(vset, &values[0]);
+	vset_destroy(vset);
+	TEST_ASSERT(destroyed == 1 + n / 2 + n);
+
+	free(values);
+}
+
+// Ένα thread κάνει αλλαγές, ενώ ένα άλλο ανοίγει snapshots και τα διασχίζει
+
+struct concurrent {
+	VSet vset;
+	int* values;
+	int n;
+	int rounds;
+};
+
+static void* writer(void* arg) {
+	struct concurrent* c = arg;
+	for (int r = 0; r < c->rounds; r++) {
+		for (int i = 0; i < c->n; i++)
+			vset_insert(c->vset, &c->values[i]);
+		for (int i = 0; i < c->n; i++)
+			vset_remove(c->vset, &c->values[i]);
+	}
+	return NULL;
+}
+
+void test_concurrent(void) {
+	struct concurrent c = { .n = 1000, .rounds = 50 };
+	c.values = malloc(c.n * sizeof(int));
+	for (int i = 0; i < c.n; i++)
+		c.values[i] = i;
+	c.vset = vset_create(compare_ints, NULL);
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, writer, &c);
+
+	// Σε κάθε snapshot τα στοιχεία είναι ταξινομημένα και ίσα σε πλήθος με το μέγεθός του
+	struct collected* collected = malloc(sizeof(*collected));
+	for (int k = 0; k < 200; k++) {
+		VSetSnapshot snapshot = vset_snapshot(c.vset);
+		collected->count = 0;
+		vset_visit(snapshot, NULL, collect, collected);
+
+		TEST_ASSERT(collected->count == vset_snapshot_size(snapshot));
+		for (int i = 1; i < collected->count; i++)
+			TEST_ASSERT(collected->values[i - 1] < collected->values[i]);
+		vset_release(c.vset, snapshot);
+	}
+
+	pthread_join(thread, NULL);
+	TEST_ASSERT(vset_size(c.vset) == 0);
+	TEST_ASSERT(vset_is_proper(c.vset));
+
+	vset_destroy(c.vset);
+	free(collected);
+	free(c.values);
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "vset_create", test_create },
+	{ "vset_insert_remove", test_insert_remove },
+	{ "vset_snapshot", test_snapshot },
+	{ "vset_visit", test_visit_range },
+	{ "vset_release", test_release },
+	{ "vset_concurrent", test_concurrent },
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};
@@ -7,9 +7,17 @@
 
 #include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
 #include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "ADTList.h"
 
 #include "DiseaseMonitor.h"
+#include "Outbreak.h"
+#include "SharedReplica.h"
+#include "Trace.h"
 
 // test records
 struct record records[] = {
@@ -193,8 +201,8 @@ void run_and_test_top_diseases(int k, String country) {
 
 	for (ListNode node = list_first(result); node != LIST_EOF; node = list_next(result, node)) {
 		String disease = list_node_value(result, node);
-		int count = dm_count_records(country, disease, NULL, NULL);
-		TEST_ASSERT(count <= last_count);
+		int count = dm_count_records(disease, country, NULL, NULL);
+		TEST_ASSERT(count > 0 && count <= last_count);
 		last_count = count;
 	}
 	
@@ -218,9 +226,1753 @@ void test_top_diseases(void) {
 	for (int k = 1; k <= 6; k++)
 		run_and_test_top_diseases(k, NULL);
 
+	// Υπάρχουν μόνο 6 ασθένειες
+	List list = dm_top_diseases(10, NULL);
+	TEST_ASSERT(list_size(list) == 6);
+	TEST_ASSERT(strcmp(list_node_value(list, list_first(list)), "Grayscale") == 0);
+	list_destroy(list);
+
+	// Μετά την αφαίρεση των εγγραφών με Pale Mare στη Stark, μένει μόνο το Headache
+	dm_remove_record(6);
+	dm_remove_record(10);
+	dm_remove_record(11);
+	list = dm_top_diseases(2, "Stark");
+	TEST_ASSERT(list_size(list) == 1);
+	TEST_ASSERT(strcmp(list_node_value(list, list_first(list)), "Headache") == 0);
+	list_destroy(list);
+
+	dm_destroy();
+}
+
+// Ελεγχος ότι κάθε χώρα έχει λιγότερες εγγραφές της disease από την προηγούμενη
+void run_and_test_top_countries(int k, String disease) {
+	List result = dm_top_countries(k, disease);
+	int last_count = INT_MAX;
+
+	TEST_ASSERT(list_size(result) == k);
+
+	for (ListNode node = list_first(result); node != LIST_EOF; node = list_next(result, node)) {
+		String country = list_node_value(result, node);
+		int count = dm_count_records(disease, country, NULL, NULL);
+		TEST_ASSERT(count > 0 && count <= last_count);
+		last_count = count;
+	}
+
+	list_destroy(result);
+}
+
+void test_top_countries(void) {
+	dm_init();
+
+	for(int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	for (int k = 1; k <= 5; k++)
+		run_and_test_top_countries(k, "Grayscale");
+
+	for (int k = 1; k <= 9; k++)
+		run_and_test_top_countries(k, NULL);
+
+	// Υπάρχουν 5 χώρες με Grayscale, και 9 συνολικά
+	List list = dm_top_countries(10, "Grayscale");
+	TEST_ASSERT(list_size(list) == 5);
+	TEST_ASSERT(strcmp(list_node_value(list, list_first(list)), "Lannister") == 0);
+	list_destroy(list);
+
+	list = dm_top_countries(10, NULL);
+	TEST_ASSERT(list_size(list) == 9);
+	list_destroy(list);
+
+	list = dm_top_countries(10, "Cough");
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+
+	// Ο Tyrion μετακινείται στη Stark, και οι υπόλοιπες εγγραφές της Lannister αφαιρούνται
+	struct record tyrion = records[7];
+	tyrion.country = "Stark";
+	TEST_ASSERT(dm_update_record(8, &tyrion));
+	dm_remove_record(2);
+	dm_remove_record(3);
+	dm_remove_record(9);
+
+	for (int k = 1; k <= 5; k++)
+		run_and_test_top_countries(k, "Grayscale");
+
+	list = dm_top_countries(10, "Grayscale");
+	TEST_ASSERT(list_size(list) == 5);
+	TEST_ASSERT(dm_count_records("Grayscale", list_node_value(list, list_first(list)), NULL, NULL) == 2);
+	list_destroy(list);
+
+	// Η Stark έχει πλέον 5 εγγραφές, και η Lannister καμία
+	list = dm_top_countries(10, NULL);
+	TEST_ASSERT(list_size(list) == 8);
+	TEST_ASSERT(strcmp(list_node_value(list, list_first(list)), "Stark") == 0);
+	list_destroy(list);
+
+	dm_destroy();
+}
+
+// Ελέγχει ότι κάθε ομάδα του groups έχει το πλήθος της dm_count_records, ότι είναι ταξινομημένες
+// κατά key, και ότι μαζί περιέχουν όλες τις εγγραφές (της filter στο by_country, αλλιώς της χώρας filter)
+void check_groups(DMGroupCount groups, int n, bool by_country, String filter, Date date_from, Date date_to) {
+	int sum = 0;
+	for (int i = 0; i < n; i++) {
+		String disease = by_country ? filter : groups[i].key;
+		String country = by_country ? groups[i].key : filter;
+		TEST_ASSERT(groups[i].count > 0);
+		TEST_ASSERT(groups[i].count == dm_count_records(disease, country, date_from, date_to));
+		TEST_ASSERT(i == 0 || strcmp(groups[i-1].key, groups[i].key) < 0);
+		sum += groups[i].count;
+	}
+	TEST_ASSERT(sum == dm_count_records(by_country ? filter : NULL, by_country ? NULL : filter, date_from, date_to));
+	free(groups);
+}
+
+void test_count_by(void) {
+	dm_init();
+
+	for(int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+	TEST_ASSERT(dm_set_region("Stark", "North", "Westeros"));
+	TEST_ASSERT(dm_set_region("Lannister", "Westerlands", "Westeros"));
+
+	int n;
+	DMGroupCount groups = dm_count_by_country("Grayscale", NULL, NULL, &n);
+	TEST_ASSERT(n == 5);
+	TEST_ASSERT(strcmp(groups[0].key, "Baelish") == 0 && groups[0].count == 1);
+	TEST_ASSERT(strcmp(groups[2].key, "Lannister") == 0 && groups[2].count == 4);
+	check_groups(groups, n, true, "Grayscale", NULL, NULL);
+
+	String diseases[] = { NULL, "Grayscale", "Pale Mare", "Cough" };
+	String countries[] = { NULL, "Stark", "Lannister", "Westeros", "North", "Dorne" };
+	Date dates[][2] = { { NULL, NULL }, { "0299-01-01", NULL }, { NULL, "0300-01-01" }, { "0300-01-01", "0301-01-01" }, { "0303-01-01", NULL } };
+
+	for (int d = 0; d < 5; d++) {
+		for (int i = 0; i < 4; i++) {
+			groups = dm_count_by_country(diseases[i], dates[d][0], dates[d][1], &n);
+			check_groups(groups, n, true, diseases[i], dates[d][0], dates[d][1]);
+		}
+		for (int i = 0; i < 6; i++) {
+			groups = dm_count_by_disease(countries[i], dates[d][0], dates[d][1], &n);
+			check_groups(groups, n, false, countries[i], dates[d][0], dates[d][1]);
+		}
+	}
+
+	// Στη Westeros το Grayscale έχει εγγραφές μόνο από τη Lannister, το Pale Mare μόνο από τη Stark
+	groups = dm_count_by_disease("Westeros", NULL, NULL, &n);
+	TEST_ASSERT(n == 3);
+	TEST_ASSERT(strcmp(groups[0].key, "Grayscale") == 0 && groups[0].count == 4);
+	TEST_ASSERT(strcmp(groups[2].key, "Pale Mare") == 0 && groups[2].count == 3);
+	free(groups);
+
+	groups = dm_count_by_country("Cough", NULL, NULL, &n);
+	TEST_ASSERT(n == 0);
+	free(groups);
+
+	dm_destroy();
+}
+
+void test_update(void) {
+	dm_init();
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	// Δεν υπάρχει εγγραφή με id 100
+	struct record missing = { .id = 100, .name = "Hodor", .country = "Stark", .disease = "Headache", .date = "0300-01-01" };
+	TEST_ASSERT(!dm_update_record(100, &missing));
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == record_no);
+
+	// Αλλαγή ημερομηνίας. Κάθε αλλαγή γίνεται με νέο struct, αφού το record που είναι
+	// αποθηκευμένο στον monitor δεν επιτρέπεται να αλλάξει.
+	struct record ned[4];
+	ned[0] = records[3];
+	ned[0].date = "0302-01-01";
+	TEST_ASSERT(dm_update_record(4, &ned[0]));
+
+	List list = dm_get_records("Headache", "Stark", "0301-01-01", NULL);
+	int ids1[] = {4};
+	check_record_list(list, ids1, 1);
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, "0298-12-31") == 4);	// Rhaegar, Aerys II, Aegon, Robert
+
+	// Αλλαγή χώρας και ασθένειας: ο Ned είναι πλέον η μοναδική εγγραφή του Headache και μετακινείται
+	ned[1] = ned[0];
+	ned[1].country = "Lannister";
+	ned[1].disease = "Pale Mare";
+	TEST_ASSERT(dm_update_record(4, &ned[1]));
+	TEST_ASSERT(dm_count_records("Headache", NULL, NULL, NULL) == 0);
+	TEST_ASSERT(dm_count_records(NULL, "Stark", NULL, NULL) == 3);
+	TEST_ASSERT(dm_count_records("Pale Mare", "Lannister", NULL, NULL) == 1);
+
+	list = dm_top_diseases(10, "Stark");
+	TEST_ASSERT(list_size(list) == 1);
+	list_destroy(list);
+
+	list = dm_top_diseases(10, NULL);
+	TEST_ASSERT(list_size(list) == 5);
+	TEST_ASSERT(strcmp(list_node_value(list, list_first(list)), "Grayscale") == 0);
+	TEST_ASSERT(strcmp(list_node_value(list, list_next(list, list_first(list))), "Pale Mare") == 0);
+	list_destroy(list);
+
+	// Αλλαγή ονόματος, η εγγραφή επιστρέφεται με το νέο record
+	ned[2] = ned[1];
+	ned[2].name = "Eddard";
+	TEST_ASSERT(dm_update_record(4, &ned[2]));
+	list = dm_get_records("Pale Mare", "Lannister", NULL, NULL);
+	TEST_ASSERT(list_size(list) == 1 && list_node_value(list, list_first(list)) == &ned[2]);
+	list_destroy(list);
+
+	// Αλλαγή id: ισοδύναμη με remove + insert
+	ned[3] = ned[2];
+	ned[3].id = 21;
+	TEST_ASSERT(dm_update_record(4, &ned[3]));
+	TEST_ASSERT(!dm_remove_record(4));
+	TEST_ASSERT(dm_remove_record(21));
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == record_no - 1);
+
+	dm_destroy();
+}
+
+// Ελέγχει ότι η λίστα περιέχει ακριβώς τα ids με τη σειρά που δίνονται
+static void check_record_order(List result, int ids[], int size) {
+	TEST_ASSERT(list_size(result) == size);
+
+	int i = 0;
+	for (ListNode node = list_first(result); node != LIST_EOF; node = list_next(result, node), i++)
+		TEST_ASSERT(((Record)list_node_value(result, node))->id == ids[i]);
+
+	list_destroy(result);
+}
+
+void test_find_by_name_prefix(void) {
+	dm_init();
+
+	List list = dm_find_by_name_prefix("", -1);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	// Τα αποτελέσματα είναι ταξινομημένα κατά όνομα
+	int ids1[] = {8, 9};				// Tyrion, Tywin
+	check_record_order(dm_find_by_name_prefix("Ty", -1), ids1, 2);
+	int ids2[] = {13, 7, 10};			// Aegon, Aerys II, Arya
+	check_record_order(dm_find_by_name_prefix("A", -1), ids2, 3);
+	check_record_order(dm_find_by_name_prefix("A", 2), ids2, 2);
+	check_record_order(dm_find_by_name_prefix("Tyrion", 1), ids1, 1);
+	check_record_order(dm_find_by_name_prefix("Tyrions", -1), NULL, 0);
+	check_record_order(dm_find_by_name_prefix("Hodor", -1), NULL, 0);
+
+	list = dm_find_by_name_prefix("", -1);
+	TEST_ASSERT(list_size(list) == record_no);
+	list_destroy(list);
+
+	// Το index ενημερώνεται σε κάθε remove και update
+	TEST_ASSERT(dm_remove_record(8));
+	int ids3[] = {9};
+	check_record_order(dm_find_by_name_prefix("Ty", -1), ids3, 1);
+
+	struct record ned = records[3];
+	ned.name = "Eddard";
+	TEST_ASSERT(dm_update_record(4, &ned));
+	check_record_order(dm_find_by_name_prefix("Ned", -1), NULL, 0);
+	list = dm_find_by_name_prefix("Ed", -1);
+	TEST_ASSERT(list_size(list) == 1 && list_node_value(list, list_first(list)) == &ned);
+	list_destroy(list);
+
+	struct dm_memory memory;
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.names > 0);
+
+	for (int i = 0; i < record_no; i++)
+		dm_remove_record(records[i].id);
+	check_record_order(dm_find_by_name_prefix("", -1), NULL, 0);
+
+	dm_destroy();
+}
+
+void test_regions(void) {
+	dm_init();
+
+	// Οι χώρες μπορούν να μπουν στην ιεραρχία πριν ή μετά τις εγγραφές τους
+	TEST_ASSERT(dm_set_region("Stark", "North", "Westeros"));
+	TEST_ASSERT(dm_set_region("Lannister", "Westerlands", "Westeros"));
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	TEST_ASSERT(dm_set_region("Clegane", "Westerlands", NULL));
+
+	TEST_ASSERT(dm_count_records(NULL, "North", NULL, NULL) == 4);
+	TEST_ASSERT(dm_count_records(NULL, "Westerlands", NULL, NULL) == 5);
+	TEST_ASSERT(dm_count_records(NULL, "Westeros", NULL, NULL) == 9);
+	TEST_ASSERT(dm_count_records("Grayscale", "Westeros", NULL, NULL) == 4);
+	TEST_ASSERT(dm_count_records("Madness", "Westeros", NULL, NULL) == 0);
+	TEST_ASSERT(dm_count_records(NULL, "Westeros", "0301-01-01", NULL) == 6);
+	TEST_ASSERT(dm_count_records("Pale Mare", "Westeros", NULL, "0300-12-31") == 0);
+
+	List list = dm_get_records("Pale Mare", "Westeros", NULL, NULL);
+	int ids1[] = {6, 10, 11};
+	check_record_list(list, ids1, 3);
+
+	list = dm_get_records(NULL, "Westerlands", "0300-01-01", NULL);
+	int ids2[] = {2, 3, 9};
+	check_record_list(list, ids2, 3);
+
+	list = dm_top_diseases(10, "Westeros");
+	TEST_ASSERT(list_size(list) == 4);
+	String top[] = { "Grayscale", "Pale Mare", "Headache", "Burns" };
+	int i = 0;
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node), i++)
+		TEST_ASSERT(strcmp(list_node_value(list, node), top[i]) == 0);
+	list_destroy(list);
+
+	// Συγκρούσεις ονομάτων και κύκλοι
+	TEST_ASSERT(!dm_set_region("North", "Riverlands", NULL));
+	TEST_ASSERT(!dm_set_region("Greyjoy", "Stark", NULL));
+	TEST_ASSERT(!dm_set_region("Greyjoy", "Westeros", "North"));
+	TEST_ASSERT(!dm_set_region("Greyjoy", "Iron Islands", "Greyjoy"));
+	TEST_ASSERT(dm_count_records(NULL, "Greyjoy", NULL, NULL) == 2);
+
+	// Μετακίνηση χώρας και περιοχής, μαζί με τους μετρητές τους
+	TEST_ASSERT(dm_set_region("Stark", "Westerlands", NULL));
+	TEST_ASSERT(dm_count_records(NULL, "North", NULL, NULL) == 0);
+	TEST_ASSERT(dm_count_records(NULL, "Westerlands", NULL, NULL) == 9);
+	TEST_ASSERT(dm_set_region("Stark", "North", NULL));
+
+	TEST_ASSERT(dm_set_region("Targaryen", "Crownlands", "Essos"));
+	TEST_ASSERT(dm_set_region("Baratheon", "Crownlands", NULL));
+	TEST_ASSERT(dm_count_records(NULL, "Essos", NULL, NULL) == 6);
+	TEST_ASSERT(dm_set_region("Targaryen", "Crownlands", "Westeros"));
+	TEST_ASSERT(dm_count_records(NULL, "Essos", NULL, NULL) == 0);
+	TEST_ASSERT(dm_count_records(NULL, "Westeros", NULL, NULL) == 15);
+
+	// Και τα queries με ημερομηνίες βρίσκουν τις χώρες της περιοχής μετά τις μετακινήσεις
+	TEST_ASSERT(dm_count_records(NULL, "Westeros", "0301-01-01", NULL) == 8);
+	TEST_ASSERT(dm_count_records(NULL, "Essos", "0200-01-01", NULL) == 0);
+	TEST_ASSERT(dm_count_records("Grayscale", "Westeros", "0299-01-01", "0301-12-31") == 4);
+	list = dm_get_records("Grayscale", "Crownlands", "0297-01-01", NULL);
+	int ids3[] = {1, 14, 19};
+	check_record_list(list, ids3, 3);
+
+	list = dm_top_diseases(1, "Essos");
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+
+	// Οι μετρητές ενημερώνονται σε κάθε update και remove
+	struct record ned = records[3];
+	ned.country = "Greyjoy";
+	TEST_ASSERT(dm_update_record(4, &ned));
+	TEST_ASSERT(dm_count_records(NULL, "North", NULL, NULL) == 3);
+	TEST_ASSERT(dm_count_records("Headache", "Westeros", NULL, NULL) == 0);
+
+	TEST_ASSERT(dm_remove_record(12));
+	TEST_ASSERT(dm_count_records(NULL, "Westerlands", NULL, NULL) == 4);
+	TEST_ASSERT(dm_count_records("Burns", "Westeros", NULL, NULL) == 0);
+
+	struct dm_memory memory;
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.regions > 0);
+
+	for (int i = 0; i < record_no; i++)
+		dm_remove_record(records[i].id);
+	TEST_ASSERT(dm_count_records(NULL, "Westeros", NULL, NULL) == 0);
 	dm_destroy();
+
+	// Φόρτωση από αρχείο, με σχόλια, κενές γραμμές και μία λάθος γραμμή
+	char path[] = "DiseaseMonitor_test.regions";
+	FILE* file = fopen(path, "w");
+	fprintf(file, "# country, region, continent\n\nStark, North, Westeros\n  Lannister ,Westerlands,Westeros\nClegane\n");
+	fclose(file);
+
+	dm_init();
+	TEST_ASSERT(!dm_load_regions("/nonexistent/regions"));
+	TEST_ASSERT(!dm_load_regions(path));
+	remove(path);
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+	TEST_ASSERT(dm_count_records(NULL, "Westeros", NULL, NULL) == 8);
+	TEST_ASSERT(dm_count_records(NULL, "Clegane", NULL, NULL) == 1);
+
+	dm_destroy();
+}
+
+// Κρατάει τις εξάρσεις που αναφέρει ο monitor
+struct outbreaks {
+	int count;
+	struct dm_outbreak last;
+	char date[11];
+};
+
+static void on_outbreak(DMOutbreak outbreak, Pointer context) {
+	struct outbreaks* outbreaks = context;
+	outbreaks->count++;
+	outbreaks->last = *outbreak;
+	strcpy(outbreaks->date, outbreak->date);
+
+	// Το callback μπορεί να καλέσει queries
+	TEST_ASSERT(dm_count_records(outbreak->disease, outbreak->country, outbreak->date, outbreak->date) == outbreak->count);
+}
+
+void test_outbreak(void) {
+	// 2 εγγραφές την ημέρα για 28 ημέρες στο Stark, μετά 8 σε μία ημέρα. Στο Lannister 2 την ημέρα συνέχεια.
+	int n = 28 * 2 * 2 + 8 + 2;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	int k = 0;
+	for (int day = 1; day <= 29; day++) {
+		for (int i = 0; i < (day < 29 ? 4 : 10); i++, k++) {
+			sprintf(dates[k], "0301-01-%02d", day);
+			many[k] = (struct record){ .id = 1000 + k, .name = "Hodor", .disease = "Grayscale", .date = dates[k],
+				.country = day == 29 ? (i < 8 ? "Stark" : "Lannister") : (i < 2 ? "Stark" : "Lannister") };
+		}
+	}
+	TEST_ASSERT(k == n);
+
+	struct outbreaks outbreaks = { .count = 0 };
+	struct dm_outbreak_config config = { .alpha = 0.2, .threshold = 3, .min_count = 5, .warmup = 7, .callback = on_outbreak, .context = &outbreaks };
+	dm_set_outbreak_detection(&config);
+	dm_init();
+
+	// Μέχρι την τελευταία ημέρα το πλήθος είναι σταθερό
+	dm_insert_records(&many, 1, NULL);
+	for (int i = 1; i < n - 10; i++)
+		dm_insert_record(&many[i]);
+	TEST_ASSERT(outbreaks.count == 0);
+
+	// Η έξαρση αναφέρεται μία φορά, με την πέμπτη εγγραφή της ημέρας (min_count)
+	for (int i = n - 10; i < n; i++) {
+		dm_insert_record(&many[i]);
+		TEST_ASSERT(outbreaks.count == (i - (n - 10) >= 4 ? 1 : 0));
+	}
+	TEST_ASSERT(strcmp(outbreaks.last.disease, "Grayscale") == 0);
+	TEST_ASSERT(strcmp(outbreaks.last.country, "Stark") == 0);
+	TEST_ASSERT(strcmp(outbreaks.date, "0301-01-29") == 0);
+	TEST_ASSERT(outbreaks.last.count == 5);
+	TEST_ASSERT(outbreaks.last.mean > 1.99 && outbreaks.last.mean < 2.01);
+
+	// Παλιότερες εγγραφές αγνοούνται
+	struct record late = { .id = 2000, .name = "Hodor", .disease = "Grayscale", .country = "Lannister", .date = "0301-01-15" };
+	for (int i = 0; i < 10; i++) {
+		late.id = 2000 + i;
+		dm_insert_record(&late);
+	}
+	TEST_ASSERT(outbreaks.count == 1);
+
+	struct dm_memory memory;
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.tops >= 2 * sizeof(struct outbreak_detector));
+
+	// Μετά από dm_destroy / dm_init οι baselines ξεκινούν από την αρχή (άρα και το warmup)
+	dm_destroy();
+	dm_init();
+	for (int i = n - 10; i < n; i++)
+		dm_insert_record(&many[i]);
+	TEST_ASSERT(outbreaks.count == 1);
+	dm_destroy();
+
+	// Χωρίς ανίχνευση δεν καλείται το callback
+	dm_set_outbreak_detection(NULL);
+	dm_init();
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&many[i]);
+	TEST_ASSERT(outbreaks.count == 1);
+	dm_destroy();
+
+	free(many);
+	free(dates);
+}
+
+// Δημιουργεί n εγγραφές (πάνω από το όριο της παράλληλης διάσχισης), με ημερομηνίες
+// μοιρασμένες σε 365 μέρες. Οι ημερομηνίες γράφονται στο dates, με 11 chars ανά εγγραφή.
+static String many_diseases[] = { "Grayscale", "Pale Mare", "Headache", "Burns" };
+static String many_countries[] = { "Stark", "Lannister", "Targaryen" };
+
+void create_many_records(struct record many[], char dates[][11], int n) {
+	for (int i = 0; i < n; i++) {
+		sprintf(dates[i], "0300-%02d-%02d", 1 + (i % 365) / 31, 1 + (i % 365) % 31 % 28);
+		many[i] = (struct record){
+			.id = i, .name = "Hodor", .date = dates[i],
+			.disease = many_diseases[i % 4], .country = many_countries[i % 3],
+		};
+	}
+}
+
+// Το p-οστό εκατοστημόριο των ημερομηνιών της λίστα (nearest rank), ή NULL αν είναι κενή
+
+static int compare_dates(const void* a, const void* b) {
+	return strcmp(*(String*)a, *(String*)b);
+}
+
+static String list_percentile(List list, double p) {
+	int n = list_size(list);
+	if (n == 0) {
+		list_destroy(list);
+		return NULL;
+	}
+
+	String dates[n];
+	int i = 0;
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+		dates[i++] = ((Record)list_node_value(list, node))->date;
+	qsort(dates, n, sizeof(String), compare_dates);
+
+	int k = 0;
+	while ((k + 1) * 100.0 < p * n)		// η μικρότερη θέση k + 1 με k + 1 >= p/100 * n
+		k++;
+	list_destroy(list);
+	return dates[k];
+}
+
+void test_date_percentile(void) {
+	dm_init();
+	TEST_ASSERT(dm_date_percentile(NULL, NULL, NULL, NULL, 50) == NULL);
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, NULL, NULL, NULL, 0), "0271-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, NULL, NULL, NULL, 50), "0300-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, NULL, NULL, NULL, 90), "0301-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, NULL, NULL, NULL, 100), "0302-01-01") == 0);
+
+	TEST_ASSERT(strcmp(dm_date_percentile("Grayscale", "Lannister", NULL, NULL, 0), "0299-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile("Grayscale", "Lannister", NULL, NULL, 50), "0301-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile("Pale Mare", NULL, "0290-01-01", NULL, 50), "0301-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, "Stark", NULL, "0300-12-31", 100), "0298-01-01") == 0);
+
+	TEST_ASSERT(dm_date_percentile("Madness", "Stark", NULL, NULL, 50) == NULL);
+	TEST_ASSERT(dm_date_percentile("Cough", NULL, NULL, NULL, 50) == NULL);
+	TEST_ASSERT(dm_date_percentile(NULL, NULL, "0303-01-01", NULL, 50) == NULL);
+	TEST_ASSERT(dm_date_percentile(NULL, NULL, "0301-01-01", "0300-01-01", 50) == NULL);
+	TEST_ASSERT(dm_date_percentile(NULL, NULL, NULL, NULL, -1) == NULL);
+	TEST_ASSERT(dm_date_percentile(NULL, NULL, NULL, NULL, 101) == NULL);
+
+	// Οι αλλαγές ενημερώνουν τα indexes κατά ημερομηνία
+	struct record tyrion = records[7];
+	tyrion.date = "0303-01-01";
+	dm_update_record(tyrion.id, &tyrion);
+	TEST_ASSERT(strcmp(dm_date_percentile("Grayscale", "Lannister", NULL, NULL, 100), "0303-01-01") == 0);
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, NULL, NULL, NULL, 100), "0303-01-01") == 0);
+	dm_remove_record(tyrion.id);
+	TEST_ASSERT(strcmp(dm_date_percentile(NULL, NULL, NULL, NULL, 100), "0302-01-01") == 0);
+	dm_destroy();
+
+	// Σύγκριση με την ταξινόμηση των εγγραφών, και για περιοχές
+	int n = 3000;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	create_many_records(many, dates, n);
+
+	dm_init();
+	dm_set_region("Stark", "North", "Westeros");
+	dm_set_region("Lannister", "Westerlands", "Westeros");
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&many[(i * 7) % n]);
+	for (int i = 0; i < n; i += 5)
+		dm_remove_record(i);
+
+	String diseases[] = { NULL, "Grayscale", "Burns" };
+	String countries[] = { NULL, "Stark", "Westeros", "North" };
+	Date ranges[][2] = { { NULL, NULL }, { "0300-03-01", NULL }, { NULL, "0300-06-15" }, { "0300-02-10", "0300-02-20" } };
+	double ps[] = { 0, 1, 25, 50, 90, 99.9, 100 };
+
+	for (int d = 0; d < 3; d++)
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++)
+				for (int k = 0; k < 7; k++) {
+					String expected = list_percentile(dm_get_records(diseases[d], countries[c], ranges[r][0], ranges[r][1]), ps[k]);
+					String date = dm_date_percentile(diseases[d], countries[c], ranges[r][0], ranges[r][1], ps[k]);
+					TEST_ASSERT(expected == NULL ? date == NULL : date != NULL && strcmp(date, expected) == 0);
+				}
+
+	dm_destroy();
+	free(many);
+	free(dates);
+}
+
+// Ελέγχει ότι η dm_get_records_page επιστρέφει το αντίστοιχο τμήμα των εγγραφών της dm_get_records,
+// ταξινομημένων κατά ημερομηνία και id
+
+static int compare_records_by_date(const void* a, const void* b) {
+	Record x = *(Record*)a, y = *(Record*)b;
+	int res = strcmp(x->date, y->date);
+	return res != 0 ? res : x->id - y->id;
+}
+
+static void check_page(String disease, String country, Date date_from, Date date_to, bool newest_first, int offset, int limit) {
+	List all = dm_get_records(disease, country, date_from, date_to);
+	int n = list_size(all);
+	Record* sorted = malloc((n + 1) * sizeof(Record));
+	int i = 0;
+	for (ListNode node = list_first(all); node != LIST_EOF; node = list_next(all, node))
+		sorted[i++] = list_node_value(all, node);
+	qsort(sorted, n, sizeof(Record), compare_records_by_date);
+	list_destroy(all);
+
+	int expected = offset >= n ? 0 : limit < 0 || offset + limit > n ? n - offset : limit;
+	List page = dm_get_records_page(disease, country, date_from, date_to, newest_first, offset, limit);
+	TEST_ASSERT(list_size(page) == expected);
+
+	i = offset;
+	for (ListNode node = list_first(page); node != LIST_EOF; node = list_next(page, node), i++)
+		TEST_ASSERT(list_node_value(page, node) == sorted[newest_first ? n - 1 - i : i]);
+
+	list_destroy(page);
+	free(sorted);
+}
+
+void test_get_records_page(void) {
+	dm_init();
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	// Οι 3 νεότερες εγγραφές: Cersei, Jaime (0302-01-01), και ο Oberyn με το μεγαλύτερο id από όσες έχουν 0301-01-01
+	List list = dm_get_records_page(NULL, NULL, NULL, NULL, true, 0, 3);
+	TEST_ASSERT(list_size(list) == 3);
+	TEST_ASSERT(((Record)list_node_value(list, list_first(list)))->id == 3);
+	TEST_ASSERT(((Record)list_node_value(list, list_last(list)))->id == 18);
+	list_destroy(list);
+
+	list = dm_get_records_page("Grayscale", "Lannister", NULL, NULL, false, 1, 2);
+	int ids[] = {9, 2};
+	check_record_list(list, ids, 2);
+
+	list = dm_get_records_page(NULL, NULL, NULL, NULL, false, record_no, 10);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+	list = dm_get_records_page(NULL, NULL, NULL, NULL, false, -1, 10);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+	list = dm_get_records_page("Cough", NULL, NULL, NULL, false, 0, 10);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+	dm_destroy();
+
+	// Σύγκριση με την ταξινόμηση των εγγραφών, και για περιοχές
+	int n = 3000;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	create_many_records(many, dates, n);
+
+	dm_init();
+	dm_set_region("Stark", "North", "Westeros");
+	dm_set_region("Lannister", "Westerlands", "Westeros");
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&many[(i * 7) % n]);
+	for (int i = 0; i < n; i += 5)
+		dm_remove_record(i);
+
+	String diseases[] = { NULL, "Grayscale" };
+	String countries[] = { NULL, "Stark", "Westeros" };
+	Date ranges[][2] = { { NULL, NULL }, { "0300-03-01", NULL }, { "0300-02-10", "0300-02-20" } };
+	int pages[][2] = { { 0, 10 }, { 5, 1 }, { 37, 50 }, { 0, -1 }, { 150, 100 }, { 2000, 10 } };
+
+	for (int d = 0; d < 2; d++)
+		for (int c = 0; c < 3; c++)
+			for (int r = 0; r < 3; r++)
+				for (int p = 0; p < 6; p++) {
+					check_page(diseases[d], countries[c], ranges[r][0], ranges[r][1], false, pages[p][0], pages[p][1]);
+					check_page(diseases[d], countries[c], ranges[r][0], ranges[r][1], true, pages[p][0], pages[p][1]);
+				}
+
+	dm_destroy();
+	free(many);
+	free(dates);
+}
+
+static int compare_pointers(Pointer a, Pointer b) {
+	return a != b;
+}
+
+// Ελέγχει ότι το δείγμα έχει size διαφορετικές εγγραφές που ικανοποιούν τα κριτήρια, κατά ημερομηνία
+
+static void check_sample(List sample, int size, String disease, String country, Date date_from, Date date_to) {
+	TEST_ASSERT(list_size(sample) == size);
+
+	List all = dm_get_records(disease, country, date_from, date_to);
+	Record previous = NULL;
+	for (ListNode node = list_first(sample); node != LIST_EOF; node = list_next(sample, node)) {
+		Record record = list_node_value(sample, node);
+		TEST_ASSERT(list_find(all, record, compare_pointers) != NULL);
+		TEST_ASSERT(previous == NULL || compare_records_by_date(&previous, &record) < 0);
+		previous = record;
+	}
+	list_destroy(all);
+	list_destroy(sample);
 }
 
+void test_sample_records(void) {
+	dm_init();
+	check_sample(dm_sample_records(5, NULL, NULL, NULL, NULL, 1), 0, NULL, NULL, NULL, NULL);
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	check_sample(dm_sample_records(5, NULL, NULL, NULL, NULL, 1), 5, NULL, NULL, NULL, NULL);
+	check_sample(dm_sample_records(2, "Grayscale", "Lannister", NULL, NULL, 2), 2, "Grayscale", "Lannister", NULL, NULL);
+	check_sample(dm_sample_records(100, "Pale Mare", NULL, NULL, NULL, 3), 6, "Pale Mare", NULL, NULL, NULL);
+	check_sample(dm_sample_records(0, NULL, NULL, NULL, NULL, 4), 0, NULL, NULL, NULL, NULL);
+	check_sample(dm_sample_records(3, "Cough", NULL, NULL, NULL, 5), 0, NULL, NULL, NULL, NULL);
+
+	// Το ίδιο seed δίνει το ίδιο δείγμα
+	List a = dm_sample_records(4, NULL, NULL, NULL, NULL, 42);
+	List b = dm_sample_records(4, NULL, NULL, NULL, NULL, 42);
+	for (ListNode x = list_first(a), y = list_first(b); x != LIST_EOF; x = list_next(a, x), y = list_next(b, y))
+		TEST_ASSERT(list_node_value(a, x) == list_node_value(b, y));
+	list_destroy(a);
+	list_destroy(b);
+
+	// Το seed για το οποίο η αρχική κατάσταση του generator θα ήταν 0
+	check_sample(dm_sample_records(4, NULL, NULL, NULL, NULL, 0x0E217C1E66C88CC3ULL), 4, NULL, NULL, NULL, NULL);
+
+	// Ομοιόμορφη κατανομή: σε 4000 δείγματα 2 από τις 20 εγγραφές, κάθε μία αναμένεται 400 φορές
+	int times[21] = { 0 };
+	for (int seed = 0; seed < 4000; seed++) {
+		List sample = dm_sample_records(2, NULL, NULL, NULL, NULL, seed);
+		for (ListNode node = list_first(sample); node != LIST_EOF; node = list_next(sample, node))
+			times[((Record)list_node_value(sample, node))->id]++;
+		list_destroy(sample);
+	}
+	for (int id = 1; id <= record_no; id++)
+		TEST_ASSERT(times[id] > 300 && times[id] < 500);
+	dm_destroy();
+
+	// Μεγαλύτερο πλήθος εγγραφών, και περιοχές
+	int n = 3000;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	create_many_records(many, dates, n);
+
+	dm_init();
+	dm_set_region("Stark", "North", "Westeros");
+	dm_set_region("Lannister", "Westerlands", "Westeros");
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&many[i]);
+
+	check_sample(dm_sample_records(50, NULL, NULL, NULL, NULL, 7), 50, NULL, NULL, NULL, NULL);
+	check_sample(dm_sample_records(50, "Grayscale", "Westeros", "0300-03-01", NULL, 8), 50, "Grayscale", "Westeros", "0300-03-01", NULL);
+	check_sample(dm_sample_records(20, NULL, "Stark", "0300-02-10", "0300-02-20", 9), 20, NULL, "Stark", "0300-02-10", "0300-02-20");
+
+	dm_destroy();
+	free(many);
+	free(dates);
+}
+
+void test_parallel(void) {
+	int n = 6000;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	create_many_records(many, dates, n);
+
+	dm_init();
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&many[i]);
+
+	// Τα ίδια ερωτήματα με 1 και με 4 threads πρέπει να δίνουν τα ίδια αποτελέσματα
+	Date ranges[][2] = { { NULL, NULL }, { "0300-03-01", NULL }, { NULL, "0300-06-15" }, { "0300-02-10", "0300-02-20" } };
+	for (int r = 0; r < 4; r++) {
+		dm_set_threads(1);
+		List serial = dm_get_records(NULL, NULL, ranges[r][0], ranges[r][1]);
+		int count = dm_count_records(NULL, NULL, ranges[r][0], ranges[r][1]);
+		TEST_ASSERT(count == list_size(serial));
+
+		dm_set_threads(4);
+		List parallel = dm_get_records(NULL, NULL, ranges[r][0], ranges[r][1]);
+		TEST_ASSERT(dm_count_records(NULL, NULL, ranges[r][0], ranges[r][1]) == count);
+
+		// Οι δύο λίστες έχουν τις ίδιες εγγραφές (όχι απαραίτητα με την ίδια σειρά)
+		int ids[count];
+		int i = 0;
+		for (ListNode node = list_first(serial); node != LIST_EOF; node = list_next(serial, node))
+			ids[i++] = ((Record)list_node_value(serial, node))->id;
+		check_record_list(parallel, ids, count);
+
+		list_destroy(serial);
+	}
+
+	dm_set_threads(1);
+	dm_destroy();
+	free(many);
+	free(dates);
+}
+
+void test_owned(void) {
+	dm_init();
+	TEST_ASSERT(dm_set_owned(true));
+
+	// Εισάγουμε εγγραφές από ένα buffer που αλλάζει μετά από κάθε εισαγωγή
+	char name[64], date[16];
+	for (int i = 0; i < record_no; i++) {
+		strcpy(name, records[i].name);
+		strcpy(date, records[i].date);
+		struct record temp = { .id = records[i].id, .name = name, .date = date, .disease = records[i].disease, .country = records[i].country };
+		TEST_ASSERT(!dm_insert_record(&temp));
+		memset(name, 0, sizeof(name));
+		memset(date, 0, sizeof(date));
+	}
+
+	// Ο monitor δεν είναι κενός, η ρύθμιση δεν αλλάζει
+	TEST_ASSERT(!dm_set_owned(false));
+
+	// Τα queries επιστρέφουν τα αντίγραφα, με σωστά περιεχόμενα
+	List list = dm_get_records("Pale Mare", NULL, NULL, NULL);
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+		Record record = list_node_value(list, node);
+		Record original = &records[record->id - 1];
+		TEST_ASSERT(record != original);
+		TEST_ASSERT(strcmp(record->name, original->name) == 0);
+		TEST_ASSERT(strcmp(record->date, original->date) == 0);
+		TEST_ASSERT(strcmp(record->country, original->country) == 0);
+	}
+	int ids[] = {5, 6, 10, 11, 16, 17};
+	check_record_list(list, ids, 6);
+
+	// Το slot μιας εγγραφής που αφαιρέθηκε ξαναχρησιμοποιείται, και ένα μεγάλο name αποθηκεύεται σωστά
+	list = dm_get_records(NULL, NULL, "0271-01-01", "0271-01-01");
+	Record removed = list_node_value(list, list_first(list));
+	list_destroy(list);
+
+	TEST_ASSERT(dm_remove_record(7));
+	struct record longer = { .id = 7, .name = "Aerys II Targaryen, the Mad King, second of his name", .date = "0271-01-01", .disease = "Madness", .country = "Targaryen" };
+	TEST_ASSERT(!dm_insert_record(&longer));
+
+	list = dm_get_records("Madness", NULL, NULL, NULL);
+	Record inserted = list_node_value(list, list_first(list));
+	TEST_ASSERT(inserted == removed);
+	TEST_ASSERT(strcmp(inserted->name, longer.name) == 0);
+	list_destroy(list);
+
+	// Αντικατάσταση με διαφορετική ασθένεια
+	longer.disease = "Grayscale";
+	TEST_ASSERT(dm_insert_record(&longer));
+	TEST_ASSERT(dm_count_records("Madness", NULL, NULL, NULL) == 0);
+	TEST_ASSERT(dm_count_records("Grayscale", "Targaryen", NULL, NULL) == 3);
+
+	// Update σε owned mode, το buffer του χρήστη μπορεί να αλλάξει αμέσως μετά
+	strcpy(date, "0270-01-01");
+	longer.date = date;
+	TEST_ASSERT(dm_update_record(7, &longer));
+	strcpy(date, "0400-01-01");
+	TEST_ASSERT(dm_count_records("Grayscale", NULL, NULL, "0270-12-31") == 1);
+
+	dm_destroy();
+	dm_set_owned(false);
+}
+
+// Μετράει τις εγγραφές του many που ταιριάζουν με τα κριτήρια, χωρίς τον monitor. Η περιοχή
+// Westeros περιέχει τα Stark και Lannister.
+
+static int count_many(struct record many[], int n, String disease, String country, Date date_from, Date date_to) {
+	int count = 0;
+	for (int i = 0; i < n; i++) {
+		bool westeros = strcmp(many[i].country, "Stark") == 0 || strcmp(many[i].country, "Lannister") == 0;
+		if ((disease == NULL || strcmp(many[i].disease, disease) == 0)
+			&& (country == NULL || strcmp(many[i].country, country) == 0 || (strcmp(country, "Westeros") == 0 && westeros))
+			&& (date_from == NULL || strcmp(many[i].date, date_from) >= 0)
+			&& (date_to == NULL || strcmp(many[i].date, date_to) <= 0))
+			count++;
+	}
+	return count;
+}
+
+static void on_history_event(Record record, DMEvent event, Pointer context) {
+	if (event == DM_RECORD_REMOVED)
+		*(int*)context = record->id;
+}
+
+void test_history(void) {
+	// 24 μήνες, 0300-01 .. 0301-12, κατά ημερομηνία
+	int n = 4800;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	Record* pointers = malloc(n * sizeof(Record));
+	for (int i = 0; i < n; i++) {
+		int month = i * 24 / n;
+		sprintf(dates[i], "%04d-%02d-%02d", 300 + month / 12, 1 + month % 12, 1 + i % 28);
+		many[i] = (struct record){
+			.id = i, .name = "Hodor", .date = dates[i],
+			.disease = many_diseases[i % 4], .country = many_countries[i % 3],
+		};
+		pointers[i] = &many[i];
+	}
+
+	// Η μνήμη του ίδιου monitor χωρίς ιστορικό
+	dm_init();
+	dm_insert_records(pointers, n, NULL);
+	struct dm_memory full;
+	dm_memory_usage(&full);
+	TEST_ASSERT(full.history == 0);
+	dm_destroy();
+
+	char directory[] = "/tmp/DiseaseMonitor_test_XXXXXX";
+	TEST_ASSERT(mkdtemp(directory) != NULL);
+	TEST_ASSERT(!dm_set_history(directory, 0));
+	TEST_ASSERT(dm_set_history(directory, 6));
+
+	dm_init();
+	TEST_ASSERT(dm_set_region("Stark", "North", "Westeros"));
+	TEST_ASSERT(dm_set_region("Lannister", "Westerlands", "Westeros"));
+	for (int i = 0; i < n / 2; i++)
+		dm_insert_record(&many[i]);
+	dm_insert_records(pointers + n / 2, n / 2, NULL);
+	TEST_ASSERT(!dm_set_history(NULL, 0));
+
+	// Στη μνήμη μένουν μόνο οι 6 πιο πρόσφατοι μήνες, 0301-07 .. 0301-12
+	struct dm_memory memory;
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.total < full.total * 3 / 4);
+	TEST_ASSERT(memory.history > 0);
+
+	// Τα queries που δεν εξετάζουν το ιστορικό αποτυγχάνουν, αντί να απαντήσουν μόνο για τη μνήμη
+	int groups = -1;
+	TEST_ASSERT(dm_count_by_country(NULL, NULL, NULL, &groups) == NULL && groups == 0);
+	groups = -1;
+	TEST_ASSERT(dm_count_by_disease("Westeros", NULL, NULL, &groups) == NULL && groups == 0);
+	TEST_ASSERT(dm_top_diseases(3, NULL) == NULL);
+	TEST_ASSERT(dm_top_countries(3, "Grayscale") == NULL);
+	TEST_ASSERT(dm_get_records_page(NULL, NULL, NULL, NULL, false, 0, 10) == NULL);
+	TEST_ASSERT(dm_sample_records(10, NULL, NULL, NULL, NULL, 1) == NULL);
+	TEST_ASSERT(dm_find_by_name_prefix("Ho", 10) == NULL);
+	TEST_ASSERT(dm_date_percentile(NULL, NULL, NULL, NULL, 50) == NULL);
+	TEST_ASSERT(dm_snapshot_open() == NULL);
+
+	// Τα queries όμως απαντούν για όλες τις εγγραφές
+	String queries[][4] = {
+		{ NULL, NULL, NULL, NULL },
+		{ "Grayscale", NULL, NULL, NULL },
+		{ NULL, "Stark", NULL, "0300-06-15" },
+		{ "Burns", "Targaryen", "0300-03-01", "0301-08-31" },
+		{ NULL, "Westeros", "0300-11-01", "0301-02-28" },
+		{ "Pale Mare", "Westeros", NULL, NULL },
+		{ NULL, NULL, "0301-07-01", NULL },
+		{ NULL, "Dorne", NULL, NULL },
+	};
+	int query_no = sizeof(queries) / sizeof(queries[0]);
+	List lists[query_no];
+	for (int q = 0; q < query_no; q++) {
+		String* c = queries[q];
+		TEST_ASSERT(dm_count_records(c[0], c[1], c[2], c[3]) == count_many(many, n, c[0], c[1], c[2], c[3]));
+		lists[q] = dm_get_records(c[0], c[1], c[2], c[3]);
+	}
+
+	// Οι λίστες περιέχουν αντίγραφα που ανήκουν σε αυτές, οπότε ισχύουν και μετά τις επόμενες κλήσεις
+	for (int q = 0; q < query_no; q++) {
+		String* c = queries[q];
+		TEST_ASSERT(list_size(lists[q]) == count_many(many, n, c[0], c[1], c[2], c[3]));
+		for (ListNode node = list_first(lists[q]); node != LIST_EOF; node = list_next(lists[q], node)) {
+			Record record = list_node_value(lists[q], node);
+			Record original = &many[record->id];
+			TEST_ASSERT(record != original);
+			TEST_ASSERT(strcmp(record->date, original->date) == 0 && strcmp(record->name, original->name) == 0);
+			TEST_ASSERT(strcmp(record->disease, original->disease) == 0 && strcmp(record->country, original->country) == 0);
+		}
+		list_destroy(lists[q]);
+	}
+
+	struct dm_query batch[query_no];
+	int results[query_no];
+	for (int q = 0; q < query_no; q++)
+		batch[q] = (struct dm_query){ queries[q][0], queries[q][1], queries[q][2], queries[q][3] };
+	dm_set_threads(4);
+	dm_count_records_batch(batch, query_no, results);
+	dm_set_threads(1);
+	for (int q = 0; q < query_no; q++)
+		TEST_ASSERT(results[q] == count_many(many, n, queries[q][0], queries[q][1], queries[q][2], queries[q][3]));
+
+	// Οι εγγραφές του ιστορικού αφαιρούνται, και η αφαίρεση ειδοποιεί τα subscriptions
+	int removed = -1;
+	int subscription = dm_subscribe(NULL, NULL, on_history_event, &removed);
+	TEST_ASSERT(dm_remove_record(0));
+	TEST_ASSERT(removed == 0);
+	TEST_ASSERT(!dm_remove_record(0));
+	TEST_ASSERT(dm_unsubscribe(subscription));
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == n - 1);
+	TEST_ASSERT(dm_count_records("Grayscale", "Stark", NULL, "0300-01-31") == count_many(many, n, "Grayscale", "Stark", NULL, "0300-01-31") - 1);
+
+	// Μια εγγραφή με το ίδιο id την αντικαθιστά, και η dm_update_record την αλλάζει
+	struct record replacement = many[1];
+	replacement.disease = "Burns";
+	TEST_ASSERT(dm_insert_record(&replacement));
+	TEST_ASSERT(dm_count_records("Burns", NULL, NULL, NULL) == count_many(many, n, "Burns", NULL, NULL, NULL) + 1);
+	List list = dm_get_records(NULL, NULL, many[1].date, many[1].date);
+	TEST_ASSERT(list_size(list) == count_many(many, n, NULL, NULL, many[1].date, many[1].date));
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+		Record record = list_node_value(list, node);
+		TEST_ASSERT(record->id != 1 || strcmp(record->disease, "Burns") == 0);
+	}
+	list_destroy(list);
+
+	struct record updated = many[2];
+	updated.date = "0301-12-20";
+	TEST_ASSERT(dm_update_record(2, &updated));
+	TEST_ASSERT(!dm_update_record(0, &updated));
+	TEST_ASSERT(dm_count_records(NULL, NULL, many[2].date, many[2].date) == count_many(many, n, NULL, NULL, many[2].date, many[2].date) - 1);
+	TEST_ASSERT(dm_count_records(NULL, NULL, "0301-12-20", "0301-12-20") == count_many(many, n, NULL, NULL, "0301-12-20", "0301-12-20") + 1);
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == n - 1);
+
+	// Μια εγγραφή σε μήνα που είναι ήδη στο δίσκο μένει στη μνήμη
+	struct record late = { .id = n, .name = "Hodor", .disease = "Burns", .country = "Stark", .date = "0300-01-15" };
+	TEST_ASSERT(!dm_insert_record(&late));
+	TEST_ASSERT(dm_count_records("Burns", "Stark", NULL, "0300-01-31") == count_many(many, n, "Burns", "Stark", NULL, "0300-01-31") + 1);
+	TEST_ASSERT(dm_remove_record(n));
+
+	// Ένας νέος μήνας μεταφέρει τον 0301-07 στο ιστορικό
+	late.date = "0302-01-15";
+	TEST_ASSERT(!dm_insert_record(&late));
+	list = dm_get_records(NULL, NULL, "0301-07-01", "0301-07-31");
+	TEST_ASSERT(list_size(list) == count_many(many, n, NULL, NULL, "0301-07-01", "0301-07-31"));
+	list_destroy(list);
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == n);
+
+	// Το replica περιέχει και το ιστορικό
+	char name[64];
+	sprintf(name, "/DiseaseMonitor_test_history_%d", (int)getpid());
+	TEST_ASSERT(dm_replica_create(name, 1 << 20));
+	Replica replica = replica_attach(name);
+	TEST_ASSERT(replica != NULL);
+	for (int q = 0; q < query_no; q++) {
+		String* c = queries[q];
+		if (c[1] == NULL || strcmp(c[1], "Westeros") != 0)
+			TEST_ASSERT(replica_count_records(replica, c[0], c[1], c[2], c[3]) == dm_count_records(c[0], c[1], c[2], c[3]));
+	}
+	list = replica_get_records(replica, NULL, NULL, NULL, NULL);
+	TEST_ASSERT(list_size(list) == n);
+	list_destroy(list);
+	replica_detach(replica);
+	dm_replica_close();
+
+	// Το checkpoint περιέχει και το ιστορικό
+	char path[64];
+	sprintf(path, "%s/checkpoint", directory);
+	TEST_ASSERT(dm_checkpoint_async(path));
+	struct dm_checkpoint checkpoint;
+	TEST_ASSERT(dm_checkpoint_status(&checkpoint, true) == DM_CHECKPOINT_DONE);
+	TEST_ASSERT(checkpoint.records == n);
+	TEST_ASSERT(remove(path) == 0);
+
+	// Τα αρχεία του ιστορικού διαγράφονται με τη dm_destroy
+	dm_destroy();
+	TEST_ASSERT(rmdir(directory) == 0);
+	TEST_ASSERT(dm_set_history(NULL, 0));
+
+	free(pointers);
+	free(dates);
+	free(many);
+}
+
+void test_stats(void) {
+	dm_init();
+	dm_stats_reset();
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+	dm_count_records("Grayscale", NULL, NULL, NULL);
+
+	DMStats stats = malloc(sizeof(*stats));
+	dm_stats(stats);
+
+	TEST_ASSERT(stats->records == record_no);
+	TEST_ASSERT(stats->countries == 9);
+	TEST_ASSERT(stats->diseases == 6);
+	TEST_ASSERT(stats->pairs == 12);
+
+	// Οι μετρήσεις υπάρχουν μόνο με -DDM_STATS. Η dm_insert_record καλεί εσωτερικά και την
+	// remove, και η dm_count_records την get, αυτές όμως δεν μετράνε ως ξεχωριστές κλήσεις.
+	if (stats->enabled) {
+		TEST_ASSERT(stats->operations[STAT_OP_INSERT].count == record_no);
+		TEST_ASSERT(stats->operations[STAT_OP_REMOVE].count == 0);
+		TEST_ASSERT(stats->operations[STAT_OP_COUNT_RECORDS].count == 1);
+		TEST_ASSERT(stats->operations[STAT_OP_GET_RECORDS].count == 0);
+		TEST_ASSERT(stats->counters[STAT_SET_COMPARES] > 0);
+	} else {
+		TEST_ASSERT(stats->operations[STAT_OP_INSERT].count == 0);
+		TEST_ASSERT(stats->counters[STAT_SET_COMPARES] == 0);
+	}
+
+	// Εκτύπωση σε JSON
+	FILE* file = tmpfile();
+	dm_stats_print(file, true);
+	rewind(file);
+
+	char buffer[4096];
+	TEST_ASSERT(fgets(buffer, sizeof(buffer), file) != NULL);
+	TEST_ASSERT(strstr(buffer, "\"records\":20") != NULL);
+	TEST_ASSERT(strstr(buffer, "\"insert_record\":{\"count\":") != NULL);
+	fclose(file);
+
+	free(stats);
+	dm_destroy();
+}
+
+void test_memory_usage(void) {
+	struct dm_memory empty, full, memory;
+
+	dm_init();
+	dm_memory_usage(&empty);
+	TEST_ASSERT(empty.entries == 0);
+	TEST_ASSERT(empty.arena == 0);
+	TEST_ASSERT(empty.total == empty.ids + empty.names + empty.monitor + empty.dates + empty.ranking + empty.countries + empty.tops + empty.diseases + empty.regions + empty.versions);
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	dm_memory_usage(&full);
+	TEST_ASSERT(full.entries > 0 && full.entries % record_no == 0);
+	TEST_ASSERT(full.monitor > empty.monitor);
+	TEST_ASSERT(full.dates > empty.dates);
+	TEST_ASSERT(full.countries > empty.countries);
+	TEST_ASSERT(full.tops > empty.tops);
+	TEST_ASSERT(full.diseases > empty.diseases);
+	TEST_ASSERT(full.total == full.entries + full.ids + full.names + full.monitor + full.dates + full.ranking + full.countries + full.tops + full.diseases + full.regions + full.versions);
+
+	// Μετά την αφαίρεση όλων των εγγραφών, τα indexes επιστρέφουν στην αρχική τους μνήμη
+	// (εκτός από το ids, που δεν μικραίνει μετά από rehash)
+	for (int i = 0; i < record_no; i++)
+		dm_remove_record(records[i].id);
+
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.entries == 0);
+	TEST_ASSERT(memory.monitor == empty.monitor);
+	TEST_ASSERT(memory.dates == empty.dates);
+	TEST_ASSERT(memory.countries == empty.countries);
+	TEST_ASSERT(memory.tops == 0);
+	TEST_ASSERT(memory.diseases == empty.diseases);
+	dm_destroy();
+
+	// Στο owned mode μετράει και το arena
+	dm_set_owned(true);
+	dm_init();
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.arena > 0);
+	TEST_ASSERT(memory.total == full.total + memory.arena);
+
+	dm_destroy();
+	dm_set_owned(false);
+}
+
+void test_trace(void) {
+	char path[] = "DiseaseMonitor_test.trace";
+
+	dm_init();
+	TEST_ASSERT(!dm_trace_start("/nonexistent/dir/trace"));
+	TEST_ASSERT(dm_trace_start(path));
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+	dm_remove_record(-3);
+	struct record updated = records[0];
+	updated.date = "0305-05-05";
+	dm_update_record(1, &updated);
+	list_destroy(dm_get_records("Grayscale", NULL, "0300-01-01", NULL));
+	dm_count_records(NULL, "Stark", NULL, "0301-01-01");
+	list_destroy(dm_top_diseases(3, NULL));
+	list_destroy(dm_get_records_page(NULL, "Lannister", NULL, NULL, true, 2, -1));
+	list_destroy(dm_sample_records(4, "Pale Mare", NULL, "0300-06-01", "0301-06-01", 0xFFFFFFFFFFFFFFFFULL));
+	int n;
+	free(dm_count_by_country("Madness", NULL, "0302-01-01", &n));
+	free(dm_count_by_disease(NULL, "0300-01-01", NULL, &n));
+	list_destroy(dm_top_countries(2, "Grayscale"));
+	list_destroy(dm_find_by_name_prefix("Jo", 5));
+	dm_date_percentile(NULL, NULL, NULL, NULL, 37.5);
+
+	// Η ιεραρχία των περιοχών, και από αρχείο (η λάθος γραμμή δεν καταγράφεται)
+	char regions[] = "DiseaseMonitor_test.regions";
+	FILE* file = fopen(regions, "w");
+	fprintf(file, "# country, region\nLannister, Westerlands\nClegane\n");
+	fclose(file);
+	dm_set_region("Stark", "North", "Westeros");
+	dm_load_regions(regions);
+	remove(regions);
+
+	TEST_ASSERT(dm_trace_stop());
+	TEST_ASSERT(!dm_trace_stop());			// δεν υπάρχει καταγραφή
+	dm_destroy();
+
+	// Διαβάζουμε το trace και ελέγχουμε ότι περιέχει ακριβώς τις παραπάνω κλήσεις
+	TraceReader reader = trace_reader_create(path);
+	TEST_ASSERT(reader != NULL);
+
+	struct trace_op op;
+	uint64_t time = 0;
+	for (int i = 0; i < record_no; i++) {
+		TEST_ASSERT(trace_read(reader, &op));
+		TEST_ASSERT(op.type == TRACE_INSERT);
+		TEST_ASSERT(op.time >= time);
+		TEST_ASSERT(op.record.id == records[i].id);
+		TEST_ASSERT(strcmp(op.record.name, records[i].name) == 0);
+		TEST_ASSERT(strcmp(op.record.disease, records[i].disease) == 0);
+		TEST_ASSERT(strcmp(op.record.country, records[i].country) == 0);
+		TEST_ASSERT(strcmp(op.record.date, records[i].date) == 0);
+		time = op.time;
+	}
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_REMOVE && op.id == -3);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_UPDATE && op.id == 1 && op.record.id == 1);
+	TEST_ASSERT(strcmp(op.record.date, "0305-05-05") == 0);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_GET_RECORDS);
+	TEST_ASSERT(strcmp(op.disease, "Grayscale") == 0 && op.country == NULL);
+	TEST_ASSERT(strcmp(op.date_from, "0300-01-01") == 0 && op.date_to == NULL);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_COUNT_RECORDS);
+	TEST_ASSERT(op.disease == NULL && strcmp(op.country, "Stark") == 0);
+	TEST_ASSERT(op.date_from == NULL && strcmp(op.date_to, "0301-01-01") == 0);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_TOP_DISEASES && op.k == 3 && op.country == NULL);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_GET_RECORDS_PAGE && op.disease == NULL && strcmp(op.country, "Lannister") == 0);
+	TEST_ASSERT(op.date_from == NULL && op.date_to == NULL);
+	TEST_ASSERT(op.newest_first && op.offset == 2 && op.limit == -1);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_SAMPLE_RECORDS && op.k == 4 && op.seed == 0xFFFFFFFFFFFFFFFFULL);
+	TEST_ASSERT(strcmp(op.disease, "Pale Mare") == 0 && op.country == NULL);
+	TEST_ASSERT(strcmp(op.date_from, "0300-06-01") == 0 && strcmp(op.date_to, "0301-06-01") == 0);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_COUNT_BY_COUNTRY && strcmp(op.disease, "Madness") == 0 && op.country == NULL);
+	TEST_ASSERT(op.date_from == NULL && strcmp(op.date_to, "0302-01-01") == 0);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_COUNT_BY_DISEASE && op.disease == NULL && op.country == NULL);
+	TEST_ASSERT(strcmp(op.date_from, "0300-01-01") == 0 && op.date_to == NULL);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_TOP_COUNTRIES && op.k == 2 && strcmp(op.disease, "Grayscale") == 0 && op.country == NULL);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_FIND_BY_NAME_PREFIX && strcmp(op.prefix, "Jo") == 0 && op.limit == 5);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_DATE_PERCENTILE && op.p == 37.5);
+	TEST_ASSERT(op.disease == NULL && op.country == NULL && op.date_from == NULL && op.date_to == NULL);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_SET_REGION && strcmp(op.country, "Stark") == 0);
+	TEST_ASSERT(strcmp(op.region, "North") == 0 && strcmp(op.continent, "Westeros") == 0);
+
+	TEST_ASSERT(trace_read(reader, &op));
+	TEST_ASSERT(op.type == TRACE_SET_REGION && strcmp(op.country, "Lannister") == 0);
+	TEST_ASSERT(strcmp(op.region, "Westerlands") == 0 && op.continent == NULL);
+
+	TEST_ASSERT(!trace_read(reader, &op));
+	trace_reader_destroy(reader);
+
+	// Ένα αρχείο που δεν είναι trace απορρίπτεται
+	file = fopen(path, "w");
+	fputs("not a trace", file);
+	fclose(file);
+	TEST_ASSERT(trace_reader_create(path) == NULL);
+
+	// Ένα αλλοιωμένο μήκος string (πολύ μεγαλύτερο από το αρχείο) δίνει false, χωρίς να δεσμευτεί η μνήμη
+	// του: insert με id 1 και νέα ασθένεια μήκους ~2^63
+	unsigned char corrupt[] = { 'D', 'M', 'T', 'R', 'A', 'C', 'E', 1, TRACE_INSERT, 0, 2, 0,
+		0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 'G', 'r', 'a', 'y' };
+	file = fopen(path, "wb");
+	fwrite(corrupt, 1, sizeof(corrupt), file);
+	fclose(file);
+	reader = trace_reader_create(path);
+	TEST_ASSERT(reader != NULL);
+	TEST_ASSERT(!trace_read(reader, &op));
+	trace_reader_destroy(reader);
+
+	remove(path);
+}
+
+void test_checkpoint(void) {
+	char path[] = "DiseaseMonitor_test.checkpoint";
+
+	dm_init();
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	TEST_ASSERT(dm_checkpoint_async(path));
+	TEST_ASSERT(!dm_checkpoint_async(path));		// εκτελείται ήδη
+
+	// Οι αλλαγές μετά το fork δεν φαίνονται στο checkpoint
+	struct record hodor = { .id = 21, .name = "Hodor", .country = "Stark", .disease = "Headache", .date = "0302-01-01" };
+	dm_insert_record(&hodor);
+	dm_remove_record(1);
+
+	struct dm_checkpoint checkpoint;
+	TEST_ASSERT(dm_checkpoint_status(&checkpoint, true) == DM_CHECKPOINT_DONE);
+	TEST_ASSERT(checkpoint.state == DM_CHECKPOINT_DONE);
+	TEST_ASSERT(checkpoint.records == record_no);
+	TEST_ASSERT(checkpoint.pause > 0 && checkpoint.duration > 0);
+
+	// Η κατάσταση μένει μέχρι το επόμενο checkpoint
+	TEST_ASSERT(dm_checkpoint_status(NULL, false) == DM_CHECKPOINT_DONE);
+
+	FILE* file = fopen(path, "rb");
+	TEST_ASSERT(file != NULL);
+	fseek(file, 0, SEEK_END);
+	TEST_ASSERT((uint64_t)ftell(file) == checkpoint.bytes);
+	fclose(file);
+
+	// Το checkpoint περιέχει όλες τις εγγραφές τη στιγμή του fork, κατά ημερομηνία
+	TraceReader reader = trace_reader_create(path);
+	TEST_ASSERT(reader != NULL);
+
+	bool seen[record_no];
+	for (int i = 0; i < record_no; i++)
+		seen[i] = false;
+
+	struct trace_op op;
+	char previous[11] = "";
+	int count = 0;
+	while (trace_read(reader, &op)) {
+		TEST_ASSERT(op.type == TRACE_INSERT);
+		TEST_ASSERT(op.record.id >= 1 && op.record.id <= record_no && !seen[op.record.id - 1]);
+
+		Record record = &records[op.record.id - 1];
+		TEST_ASSERT(strcmp(op.record.name, record->name) == 0);
+		TEST_ASSERT(strcmp(op.record.disease, record->disease) == 0);
+		TEST_ASSERT(strcmp(op.record.country, record->country) == 0);
+		TEST_ASSERT(strcmp(op.record.date, record->date) == 0);
+		TEST_ASSERT(strcmp(previous, op.record.date) <= 0);
+
+		strcpy(previous, op.record.date);
+		seen[op.record.id - 1] = true;
+		count++;
+	}
+	TEST_ASSERT(count == record_no);
+	trace_reader_destroy(reader);
+
+	// Ένα checkpoint σε φάκελο που δεν υπάρχει αποτυγχάνει, χωρίς να επηρεάσει τον monitor
+	TEST_ASSERT(dm_checkpoint_async("/nonexistent/dir/checkpoint"));
+	TEST_ASSERT(dm_checkpoint_status(&checkpoint, true) == DM_CHECKPOINT_FAILED);
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == record_no);
+
+	// Το ίδιο κι ένα checkpoint που δεν γράφεται ολόκληρο (το path.tmp οδηγεί στο /dev/full, όπου κάθε
+	// εγγραφή αποτυγχάνει), και το προηγούμενο checkpoint στο path μένει ως έχει
+	struct stat before, after;
+	TEST_ASSERT(stat(path, &before) == 0);
+	char temp[64];
+	sprintf(temp, "%s.tmp", path);
+	TEST_ASSERT(symlink("/dev/full", temp) == 0);
+	TEST_ASSERT(dm_checkpoint_async(path));
+	TEST_ASSERT(dm_checkpoint_status(&checkpoint, true) == DM_CHECKPOINT_FAILED);
+	TEST_ASSERT(access(temp, F_OK) != 0);
+	TEST_ASSERT(stat(path, &after) == 0 && after.st_ino == before.st_ino && after.st_size == before.st_size);
+
+	// Το checkpoint περιέχει και την ιεραρχία των περιοχών, ακόμα και μιας περιοχής (Westeros) που
+	// έχει γονική αλλά καμία χώρα απευθείας
+	dm_set_region("Stark", "North", "Westeros");
+	dm_set_region("Lannister", "Westerlands", "Westeros");
+	dm_set_region("Clegane", "Westeros", "World");
+	dm_set_region("Clegane", "Westerlands", NULL);
+	String names[] = { "World", "Westeros", "North", "Westerlands" };
+	int expected[4];
+	for (int i = 0; i < 4; i++)
+		expected[i] = dm_count_records(NULL, names[i], NULL, NULL);
+	TEST_ASSERT(expected[0] > 0 && expected[0] == expected[1]);
+
+	// Η dm_destroy περιμένει το checkpoint που εκτελείται
+	TEST_ASSERT(dm_checkpoint_async(path));
+	dm_destroy();
+	TEST_ASSERT(dm_checkpoint_status(&checkpoint, false) == DM_CHECKPOINT_DONE);
+	TEST_ASSERT(checkpoint.records == record_no);
+
+	// Επαναφορά από το checkpoint, όπως στο dm_replay
+	dm_init();
+	reader = trace_reader_create(path);
+	TEST_ASSERT(reader != NULL);
+	while (trace_read(reader, &op)) {
+		if (op.type == TRACE_SET_REGION) {
+			TEST_ASSERT(dm_set_region(op.country, op.region, op.continent));
+		} else {
+			TEST_ASSERT(op.type == TRACE_INSERT);
+			dm_insert_record(op.record.id == hodor.id ? &hodor : &records[op.record.id - 1]);
+		}
+	}
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == record_no);
+	trace_reader_destroy(reader);
+	for (int i = 0; i < 4; i++)
+		TEST_ASSERT(dm_count_records(NULL, names[i], NULL, NULL) == expected[i]);
+	dm_destroy();
+
+	remove(path);
+}
+
+void test_replica(void) {
+	char name[64];
+	sprintf(name, "/DiseaseMonitor_test_%d", (int)getpid());
+
+	dm_init();
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	TEST_ASSERT(!dm_replica_publish());			// δεν υπάρχει replica
+	TEST_ASSERT(!dm_replica_create(name, 64));	// δεν χωράνε οι εγγραφές
+	TEST_ASSERT(replica_attach(name) == NULL);
+	TEST_ASSERT(dm_replica_create(name, 1 << 16));
+
+	Replica replica = replica_attach(name);
+	TEST_ASSERT(replica != NULL);
+	TEST_ASSERT(replica_version(replica) == 1);
+
+	// Τα queries στο replica δίνουν τα ίδια αποτελέσματα με τον monitor
+	String filters[][4] = {
+		{ NULL, NULL, NULL, NULL },
+		{ "Grayscale", NULL, NULL, NULL },
+		{ NULL, "Lannister", NULL, NULL },
+		{ "Pale Mare", "Stark", "0300-01-01", NULL },
+		{ NULL, NULL, "0299-01-01", "0301-01-01" },
+	};
+	for (int f = 0; f < (int)(sizeof(filters) / sizeof(filters[0])); f++) {
+		String* q = filters[f];
+		int expected = dm_count_records(q[0], q[1], q[2], q[3]);
+		TEST_ASSERT(replica_count_records(replica, q[0], q[1], q[2], q[3]) == expected);
+
+		List list = replica_get_records(replica, q[0], q[1], q[2], q[3]);
+		TEST_ASSERT(list_size(list) == expected);
+		list_destroy(list);
+	}
+
+	// Οι αλλαγές φαίνονται μετά τη δημοσίευση
+	dm_remove_record(2);
+	TEST_ASSERT(replica_count_records(replica, "Grayscale", "Lannister", NULL, NULL) == 4);
+	TEST_ASSERT(dm_replica_publish());
+	TEST_ASSERT(replica_version(replica) == 2);
+	TEST_ASSERT(replica_count_records(replica, "Grayscale", "Lannister", NULL, NULL) == 3);
+
+	List list = replica_get_records(replica, NULL, "Lannister", "0302-01-01", NULL);
+	TEST_ASSERT(list_size(list) == 1);
+	Record record = list_node_value(list, list_first(list));
+	TEST_ASSERT(record->id == 3 && strcmp(record->name, "Cersei") == 0);
+	list_destroy(list);
+
+	// Το region συνεχίζει να υπάρχει μετά την dm_destroy, μέχρι την dm_replica_close
+	dm_destroy();
+	TEST_ASSERT(replica_count_records(replica, NULL, NULL, NULL, NULL) == record_no - 1);
+	dm_replica_close();
+	TEST_ASSERT(replica_attach(name) == NULL);
+	replica_detach(replica);
+}
+
+void test_insert_records(void) {
+	dm_init();
+
+	// Bulk load όλων των εγγραφών, με την πρώτη και μία αντικατάσταση της πρώτης στο τέλος
+	struct record replacement = records[0];
+	replacement.country = "Stark";
+
+	Record batch[record_no + 1];
+	bool replaced[record_no + 1];
+	for (int i = 0; i < record_no; i++)
+		batch[i] = &records[i];
+	batch[record_no] = &replacement;
+
+	TEST_ASSERT(dm_insert_records(batch, record_no + 1, replaced) == 1);
+	for (int i = 0; i < record_no; i++)
+		TEST_ASSERT(!replaced[i]);
+	TEST_ASSERT(replaced[record_no]);
+
+	// Ίδιο αποτέλεσμα με διαδοχικές dm_insert_record
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) == record_no);
+	TEST_ASSERT(dm_count_records(NULL, "Targaryen", NULL, NULL) == 3);
+	TEST_ASSERT(dm_count_records("Grayscale", "Stark", NULL, NULL) == 1);
+
+	List list = dm_top_diseases(1, "Stark");
+	TEST_ASSERT(strcmp(list_node_value(list, list_first(list)), "Pale Mare") == 0);
+	list_destroy(list);
+
+	// Αντικατάσταση της μοναδικής εγγραφής μιας χώρας μέσα στο batch (η χώρα καταστρέφεται και ξαναδημιουργείται)
+	struct record clegane[] = { records[11], records[11] };
+	clegane[1].disease = "Madness";
+	Record batch2[] = { &clegane[0], &clegane[1] };
+	TEST_ASSERT(dm_insert_records(batch2, 2, NULL) == 2);
+	TEST_ASSERT(dm_count_records("Madness", "Clegane", NULL, NULL) == 1);
+	TEST_ASSERT(dm_count_records("Burns", NULL, NULL, NULL) == 0);
+
+	dm_destroy();
+}
+
+void test_count_records_batch(void) {
+	int n = 6000;
+	struct record* many = malloc(n * sizeof(*many));
+	char (*dates)[11] = malloc(n * sizeof(*dates));
+	create_many_records(many, dates, n);
+
+	dm_init();
+	for (int i = 0; i < n; i++)
+		dm_insert_record(&many[i]);
+
+	struct dm_query queries[] = {
+		{ NULL, NULL, NULL, NULL },
+		{ "Grayscale", NULL, NULL, NULL },
+		{ NULL, "Stark", "0300-03-01", NULL },
+		{ "Burns", "Lannister", NULL, "0300-06-15" },
+		{ NULL, NULL, "0300-02-10", "0300-02-20" },
+		{ "Unknown", NULL, NULL, NULL },
+	};
+	int query_no = sizeof(queries) / sizeof(queries[0]);
+
+	// Τα αποτελέσματα είναι ίδια με της dm_count_records, με 1 και με 4 threads
+	for (int threads = 1; threads <= 4; threads += 3) {
+		dm_set_threads(threads);
+
+		int results[query_no];
+		dm_count_records_batch(queries, query_no, results);
+		for (int i = 0; i < query_no; i++)
+			TEST_ASSERT(results[i] == dm_count_records(queries[i].disease, queries[i].country, queries[i].date_from, queries[i].date_to));
+	}
+
+	dm_set_threads(1);
+	dm_destroy();
+	free(many);
+	free(dates);
+}
+
+// Ελέγχει ότι οι εγγραφές της λίστας είναι ταξινομημένες κατά disease, country, name, id
+static bool is_sorted(List list) {
+	Record previous = NULL;
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+		Record r = list_node_value(list, node);
+		if (previous != NULL) {
+			int res = strcmp(previous->disease, r->disease);
+			if (res == 0) res = strcmp(previous->country, r->country);
+			if (res == 0) res = strcmp(previous->name, r->name);
+			if (res == 0) res = previous->id - r->id;
+			if (res >= 0)
+				return false;
+		}
+		previous = r;
+	}
+	return true;
+}
+
+// Κρατάει τις αλλαγές που αναφέρει ένα subscription
+struct events {
+	int inserted;
+	int removed;
+	int last_id;
+};
+
+static void on_event(Record record, DMEvent event, Pointer context) {
+	struct events* events = context;
+	if (event == DM_RECORD_INSERTED)
+		events->inserted++;
+	else
+		events->removed++;
+	events->last_id = record->id;
+
+	// Το callback μπορεί να καλέσει queries, και βλέπει τα indexes μετά την αλλαγή
+	TEST_ASSERT(dm_count_records(NULL, NULL, NULL, NULL) >= 0);
+}
+
+void test_subscribe(void) {
+	dm_init();
+	TEST_ASSERT(dm_set_region("Stark", "North", "Westeros"));
+	TEST_ASSERT(dm_set_region("Lannister", "Westerlands", "Westeros"));
+
+	struct events grayscale = { 0 }, stark = { 0 }, westeros = { 0 }, all = { 0 }, pale_westeros = { 0 };
+	TEST_ASSERT(dm_subscribe(NULL, NULL, NULL, NULL) == 0);
+	int id1 = dm_subscribe("Grayscale", NULL, on_event, &grayscale);
+	int id2 = dm_subscribe(NULL, "Stark", on_event, &stark);
+	int id3 = dm_subscribe(NULL, "Westeros", on_event, &westeros);
+	int id4 = dm_subscribe(NULL, NULL, on_event, &all);
+	int id5 = dm_subscribe("Pale Mare", "Westeros", on_event, &pale_westeros);
+	TEST_ASSERT(id1 > 0 && id2 > id1 && id3 > id2 && id4 > id3 && id5 > id4);
+
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	TEST_ASSERT(grayscale.inserted == 10);
+	TEST_ASSERT(stark.inserted == 4);
+	TEST_ASSERT(westeros.inserted == 8);	// Stark και Lannister
+	TEST_ASSERT(all.inserted == record_no);
+	TEST_ASSERT(pale_westeros.inserted == 3);
+	TEST_ASSERT(all.removed == 0);
+
+	// Αφαίρεση της τελευταίας εγγραφής της Clegane (χωρίς περιοχή) και της Stark με Headache
+	TEST_ASSERT(dm_remove_record(12));
+	TEST_ASSERT(all.removed == 1 && all.last_id == 12 && stark.removed == 0);
+	TEST_ASSERT(dm_remove_record(4));
+	TEST_ASSERT(stark.removed == 1 && westeros.removed == 1 && stark.last_id == 4);
+
+	// Update: η παλιά εγγραφή αφαιρείται από όσα subscriptions ταίριαζε, η νέα προστίθεται
+	struct record tyrion = records[7];
+	tyrion.country = "Stark";
+	tyrion.disease = "Pale Mare";
+	TEST_ASSERT(dm_update_record(8, &tyrion));
+	TEST_ASSERT(grayscale.removed == 1 && grayscale.inserted == 10);
+	TEST_ASSERT(stark.inserted == 5);
+	TEST_ASSERT(westeros.removed == 2 && westeros.inserted == 9);
+	TEST_ASSERT(pale_westeros.inserted == 4);
+
+	// Insert με υπάρχον id: αφαίρεση και εισαγωγή
+	dm_insert_record(&records[7]);
+	TEST_ASSERT(stark.removed == 2 && grayscale.inserted == 11 && pale_westeros.removed == 1);
+
+	// Μετά το unsubscribe το callback δεν καλείται
+	TEST_ASSERT(dm_unsubscribe(id1));
+	TEST_ASSERT(!dm_unsubscribe(id1));
+	TEST_ASSERT(!dm_unsubscribe(12345));
+	TEST_ASSERT(dm_unsubscribe(id5));
+	dm_remove_record(2);
+	TEST_ASSERT(grayscale.removed == 1 && westeros.removed == 4 && all.removed == 5);
+
+	// Δύο subscriptions με τα ίδια κριτήρια
+	struct events again = { 0 };
+	int id6 = dm_subscribe(NULL, "Stark", on_event, &again);
+	struct record hodor = { .id = 100, .name = "Hodor", .country = "Stark", .disease = "Headache", .date = "0300-01-01" };
+	dm_insert_record(&hodor);
+	TEST_ASSERT(again.inserted == 1 && stark.inserted == 6);
+	TEST_ASSERT(dm_unsubscribe(id2));
+	dm_remove_record(100);
+	TEST_ASSERT(again.removed == 1 && stark.removed == 2);
+
+	TEST_ASSERT(dm_unsubscribe(id6));
+	TEST_ASSERT(dm_unsubscribe(id3));
+	dm_destroy();		// το id4 καταστρέφεται μαζί με τον monitor
+}
+
+void test_snapshot(void) {
+	// Χωρίς multi-version mode δεν υπάρχουν snapshots
+	dm_init();
+	TEST_ASSERT(dm_snapshot_open() == NULL);
+	dm_insert_record(&records[0]);
+	TEST_ASSERT(!dm_set_mvcc(true));
+	dm_destroy();
+
+	// Στο owned mode τα αντίγραφα που αφαιρούνται πρέπει να κρατηθούν για το snapshot
+	TEST_ASSERT(dm_set_mvcc(true));
+	dm_set_owned(true);
+	dm_init();
+	for (int i = 0; i < record_no; i++)
+		dm_insert_record(&records[i]);
+
+	struct dm_memory before;
+	dm_memory_usage(&before);
+	TEST_ASSERT(before.versions > 0);
+
+	DMSnapshot snapshot = dm_snapshot_open();
+	TEST_ASSERT(snapshot != NULL);
+
+	// Αλλαγές μετά το snapshot
+	TEST_ASSERT(dm_remove_record(8));
+	TEST_ASSERT(dm_remove_record(9));
+	struct record ned = records[3];
+	ned.disease = "Grayscale";
+	TEST_ASSERT(dm_update_record(4, &ned));
+	struct record hodor = { .id = 100, .name = "Hodor", .country = "Stark", .disease = "Pale Mare", .date = "0301-01-01" };
+	dm_insert_record(&hodor);
+
+	TEST_ASSERT(dm_count_records("Grayscale", "Lannister", NULL, NULL) == 2);
+	TEST_ASSERT(dm_count_records("Pale Mare", "Stark", NULL, NULL) == 4);
+
+	// Το snapshot βλέπει την αρχική εικόνα
+	TEST_ASSERT(dm_snapshot_count_records(snapshot, NULL, NULL, NULL, NULL) == record_no);
+	TEST_ASSERT(dm_snapshot_count_records(snapshot, "Grayscale", "Lannister", NULL, NULL) == 4);
+	TEST_ASSERT(dm_snapshot_count_records(snapshot, "Headache", NULL, NULL, NULL) == 1);
+	TEST_ASSERT(dm_snapshot_count_records(snapshot, NULL, "Stark", "0301-01-01", NULL) == 3);
+	TEST_ASSERT(dm_snapshot_count_records(snapshot, "Madness", "Stark", NULL, NULL) == 0);
+
+	List list = dm_snapshot_get_records(snapshot, "Grayscale", "Lannister", "0301-01-01", NULL);
+	TEST_ASSERT(is_sorted(list));
+	int ids1[] = {2, 3, 9};
+	check_record_list(list, ids1, 3);
+
+	list = dm_snapshot_get_records(snapshot, NULL, NULL, NULL, NULL);
+	TEST_ASSERT(list_size(list) == record_no && is_sorted(list));
+	for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+		Record r = list_node_value(list, node);
+		TEST_ASSERT(r->id != 100);
+		if (r->id == 8)
+			TEST_ASSERT(strcmp(r->name, "Tyrion") == 0);		// το αντίγραφο δεν έχει αποδεσμευτεί
+		if (r->id == 4)
+			TEST_ASSERT(strcmp(r->disease, "Headache") == 0);
+	}
+	list_destroy(list);
+
+	// Ένα νέο snapshot βλέπει τις αλλαγές
+	DMSnapshot current = dm_snapshot_open();
+	TEST_ASSERT(dm_snapshot_count_records(current, NULL, NULL, NULL, NULL) == record_no - 1);
+	TEST_ASSERT(dm_snapshot_count_records(current, "Pale Mare", "Stark", NULL, NULL) == 4);
+	dm_snapshot_release(current);
+
+	// Μετά το release, η επόμενη αλλαγή αποδεσμεύει ό,τι κρατιόταν για το snapshot
+	struct dm_memory memory;
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.versions > before.versions);
+
+	dm_snapshot_release(snapshot);
+	TEST_ASSERT(dm_remove_record(100));
+	dm_memory_usage(&memory);
+	TEST_ASSERT(memory.versions < before.versions);
+
+	dm_destroy();
+	dm_set_owned(false);
+	dm_set_mvcc(false);
+}
+
+// Ένα thread ανοίγει snapshots ενώ το κύριο thread αλλάζει τον monitor
+
+struct snapshot_reader {
+	int snapshots;
+	bool ok;
+};
+
+static void* snapshot_reader(void* arg) {
+	struct snapshot_reader* reader = arg;
+	for (int i = 0; i < reader->snapshots; i++) {
+		DMSnapshot snapshot = dm_snapshot_open();
+		List list = dm_snapshot_get_records(snapshot, NULL, NULL, NULL, NULL);
+
+		// Κάθε εικόνα είναι ταξινομημένη, συνεπής με το πλήθος της, και οι εγγραφές της δεν έχουν αποδεσμευτεί
+		if (!is_sorted(list) || list_size(list) != dm_snapshot_count_records(snapshot, NULL, NULL, NULL, NULL))
+			reader->ok = false;
+		for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node))
+			if (strcmp(((Record)list_node_value(list, node))->name, "Hodor") != 0)
+				reader->ok = false;
+
+		list_destroy(list);
+		dm_snapshot_release(snapshot);
+	}
+	return NULL;
+}
+
+void test_snapshot_concurrent(void) {
+	dm_set_mvcc(true);
+	dm_set_owned(true);
+	dm_init();
+
+	struct snapshot_reader reader = { .snapshots = 200, .ok = true };
+	pthread_t thread;
+	pthread_create(&thread, NULL, snapshot_reader, &reader);
+
+	// Εισαγωγές, αφαιρέσεις και αλλαγές εγγραφών (στο owned mode ο monitor κρατάει αντίγραφα)
+	char date[11];
+	for (int round = 0; round < 4000; round++) {
+		int id = round % 1000;
+		sprintf(date, "0301-01-%02d", 1 + round % 28);
+		struct record record = { .id = id, .name = "Hodor", .disease = round % 3 ? "Grayscale" : "Pale Mare", .country = "Stark", .date = date };
+		if (round < 1000 || round % 2 == 0)
+			dm_insert_record(&record);
+		else
+			dm_remove_record(id);
+	}
+
+	pthread_join(thread, NULL);
+	TEST_ASSERT(reader.ok);
+	dm_destroy();
+	dm_set_owned(false);
+	dm_set_mvcc(false);
+}
 
 
 // Λίστα με όλα τα tests προς εκτέλεση
@@ -231,6 +1983,28 @@ TEST_LIST = {
 	{ "dm_get_records", test_get_records },
 	{ "dm_count_records", test_count_records },
 	{ "dm_top_diseases", test_top_diseases },
+	{ "dm_top_countries", test_top_countries },
+	{ "dm_count_by_country", test_count_by },
+	{ "dm_update_record", test_update },
+	{ "dm_find_by_name_prefix", test_find_by_name_prefix },
+	{ "dm_set_region", test_regions },
+	{ "dm_date_percentile", test_date_percentile },
+	{ "dm_get_records_page", test_get_records_page },
+	{ "dm_sample_records", test_sample_records },
+	{ "dm_set_outbreak_detection", test_outbreak },
+	{ "dm_subscribe", test_subscribe },
+	{ "dm_snapshot_open", test_snapshot },
+	{ "dm_snapshot_concurrent", test_snapshot_concurrent },
+	{ "dm_insert_records", test_insert_records },
+	{ "dm_count_records_batch", test_count_records_batch },
+	{ "dm_set_threads", test_parallel },
+	{ "dm_set_owned", test_owned },
+	{ "dm_set_history", test_history },
+	{ "dm_stats", test_stats },
+	{ "dm_memory_usage", test_memory_usage },
+	{ "dm_trace_start", test_trace },
+	{ "dm_checkpoint_async", test_checkpoint },
+	{ "dm_replica_create", test_replica },
 
 	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
 };
\ No newline at end of file
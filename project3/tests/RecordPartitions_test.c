@@ -0,0 +1,392 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για τα Record Partitions.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "RecordPartitions.h"
+
+
+static String diseases[] = { "Grayscale", "Pale Mare", "Madness", "Headache" };
+static String countries[] = { "Stark", "Lannister", "Targaryen" };
+
+// Δημιουργεί n records με τυχαίες τιμές, σε ημερομηνίες του 0300 - 0302 (τα strings αποθηκεύονται στο buffers)
+static struct record* create_records(int n, char (*buffers)[2][16]) {
+	struct record* records = malloc(n * sizeof(*records));
+	for (int i = 0; i < n; i++) {
+		sprintf(buffers[i][0], "%04d-%02d-%02d", 300 + rand() % 3, 1 + rand() % 12, 1 + rand() % 28);
+		sprintf(buffers[i][1], "name%d", rand() % (n / 4));
+		records[i] = (struct record){
+			.id = i,
+			.name = buffers[i][1],
+			.date = buffers[i][0],
+			.disease = diseases[rand() % 4],
+			.country = countries[rand() % 3],
+		};
+	}
+	return records;
+}
+
+// Μετράει τα records που ταιριάζουν με τα κριτήρια, χωρίς τα partitions
+static int count_matches(struct record* records, int n, String disease, String country, Date date_from, Date date_to) {
+	int count = 0;
+	for (int i = 0; i < n; i++)
+		if ((disease == NULL || strcmp(records[i].disease, disease) == 0)
+			&& (country == NULL || strcmp(records[i].country, country) == 0)
+			&& (date_from == NULL || strcmp(records[i].date, date_from) >= 0)
+			&& (date_to == NULL || strcmp(records[i].date, date_to) <= 0))
+			count++;
+	return count;
+}
+
+// Για την επαλήθευση των records που επιστρέφει η partitions_scan
+
+struct check {
+	struct record* records;
+	bool* seen;
+	bool ok;
+	char previous_date[11];			// Αντίγραφο, το record ισχύει μόνο κατά την κλήση
+	int previous_id;
+	int limit;						// σταματάμε μετά από τόσα records
+	int visited;
+};
+
+static bool check_record(Record record, Pointer context) {
+	struct check* check = context;
+	Record original = &check->records[record->id];
+
+	if (check->seen[record->id]
+		|| strcmp(record->name, original->name) != 0 || strcmp(record->date, original->date) != 0
+		|| strcmp(record->disease, original->disease) != 0 || strcmp(record->country, original->country) != 0)
+		check->ok = false;
+
+	// Κατά ημερομηνία και id
+	if (check->visited > 0) {
+		int res = strcmp(check->previous_date, record->date);
+		if (res > 0 || (res == 0 && check->previous_id > record->id))
+			check->ok = false;
+	}
+
+	check->seen[record->id] = true;
+	strcpy(check->previous_date, record->date);
+	check->previous_id = record->id;
+	return ++check->visited < check->limit;
+}
+
+// Ελέγχει την partitions_scan για διάφορα κριτήρια, συγκρίνοντας με τα records[0 .. n-1]
+static void check_scans(RecordPartitions partitions, struct record* records, int n) {
+	String filters[][4] = {
+		{ NULL, NULL, NULL, NULL },
+		{ "Grayscale", NULL, NULL, NULL },
+		{ NULL, "Stark", NULL, NULL },
+		{ "Madness", "Targaryen", NULL, NULL },
+		{ NULL, NULL, "0301-03-15", NULL },
+		{ NULL, NULL, NULL, "0300-06-01" },
+		{ "Pale Mare", "Lannister", "0300-12-01", "0301-02-28" },
+		{ NULL, NULL, "0301-05-05", "0301-05-05" },
+		{ NULL, "Stark", "0301-05-01", "0301-05-31" },
+		{ NULL, NULL, "0303-01-01", NULL },
+		{ NULL, NULL, "0301-06-01", "0301-05-01" },
+		{ "Cough", NULL, NULL, NULL },
+		{ NULL, "Dorne", "0300-01-01", NULL },
+	};
+	for (int f = 0; f < (int)(sizeof(filters) / sizeof(filters[0])); f++) {
+		String* q = filters[f];
+		int expected = count_matches(records, n, q[0], q[1], q[2], q[3]);
+
+		struct check check = { .records = records, .seen = calloc(n, sizeof(bool)), .ok = true, .limit = n + 1 };
+		TEST_ASSERT(partitions_scan(partitions, q[0], q[1], q[2], q[3], check_record, &check) == expected);
+		TEST_ASSERT(partitions_scan(partitions, q[0], q[1], q[2], q[3], NULL, NULL) == expected);
+		TEST_ASSERT(check.ok && check.visited == expected);
+		free(check.seen);
+	}
+}
+
+
+void test_create(void) {
+	RecordPartitions partitions = partitions_create();
+	TEST_ASSERT(partitions != NULL);
+	TEST_ASSERT(partitions_size(partitions) == 0);
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, NULL, NULL, NULL, NULL) == 0);
+
+	List months = partitions_months(partitions);
+	TEST_ASSERT(list_size(months) == 0);
+	list_destroy(months);
+
+	partitions_destroy(partitions);
+}
+
+void test_insert(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordPartitions partitions = partitions_create();
+	for (int i = 0; i < n; i++)
+		TEST_ASSERT(partitions_insert(partitions, &records[i]));
+	TEST_ASSERT(partitions_size(partitions) == n);
+
+	// Μη έγκυρες ημερομηνίες δεν προστίθενται
+	struct record invalid = { .id = n, .name = "Hodor", .disease = "Grayscale", .country = "Stark", .date = "0301-1-1" };
+	TEST_ASSERT(!partitions_insert(partitions, &invalid));
+	invalid.date = "0301-01-0x";
+	TEST_ASSERT(!partitions_insert(partitions, &invalid));
+	TEST_ASSERT(partitions_size(partitions) == n);
+
+	// Ούτε records με ίδια ημερομηνία και id με κάποιο υπάρχον (ακόμα κι αν διαφέρουν τα υπόλοιπα πεδία)
+	struct record duplicate = records[n / 2];
+	duplicate.name = "Hodor";
+	TEST_ASSERT(!partitions_insert(partitions, &records[0]));
+	TEST_ASSERT(!partitions_insert(partitions, &duplicate));
+	TEST_ASSERT(partitions_size(partitions) == n);
+	check_scans(partitions, records, n);
+
+	// Ένα partition για κάθε μήνα, ταξινομημένα
+	List months = partitions_months(partitions);
+	TEST_ASSERT(list_size(months) == 36);
+	TEST_ASSERT(strcmp(list_node_value(months, list_first(months)), "0300-01") == 0);
+	TEST_ASSERT(strcmp(list_node_value(months, list_last(months)), "0302-12") == 0);
+	list_destroy(months);
+
+	// Τα μεγέθη των indexes είναι σωστά και μετά το πάγωμα
+	for (int year = 300; year <= 302; year++) {
+		for (int month = 1; month <= 12; month++) {
+			char name[8];
+			sprintf(name, "%04d-%02d", year, month);
+			TEST_ASSERT(partitions_freeze(partitions, name));
+		}
+	}
+	check_scans(partitions, records, n);
+
+	partitions_destroy(partitions);
+	free(records);
+	free(buffers);
+}
+
+void test_scan(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordPartitions partitions = partitions_create();
+	for (int i = 0; i < n; i++)
+		partitions_insert(partitions, &records[i]);
+
+	check_scans(partitions, records, n);
+
+	// Η visit μπορεί να σταματήσει τη διάσχιση
+	struct check check = { .records = records, .seen = calloc(n, sizeof(bool)), .ok = true, .limit = 10 };
+	partitions_scan(partitions, NULL, NULL, NULL, NULL, check_record, &check);
+	TEST_ASSERT(check.ok && check.visited == 10);
+	free(check.seen);
+
+	partitions_destroy(partitions);
+	free(records);
+	free(buffers);
+}
+
+void test_freeze(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordPartitions partitions = partitions_create();
+	for (int i = 0; i < n; i++)
+		partitions_insert(partitions, &records[i]);
+
+	TEST_ASSERT(!partitions_freeze(partitions, "0299-12"));
+	TEST_ASSERT(!partitions_freeze(partitions, "0300"));
+
+	// Παγώνουμε τα μισά partitions: τα αποτελέσματα δεν αλλάζουν, η μνήμη μειώνεται
+	size_t before = partitions_memory(partitions);
+	List months = partitions_months(partitions);
+	int i = 0;
+	for (ListNode node = list_first(months); node != LIST_EOF; node = list_next(months, node), i++)
+		if (i % 2 == 0)
+			TEST_ASSERT(partitions_freeze(partitions, list_node_value(months, node)));
+	list_destroy(months);
+
+	TEST_ASSERT(partitions_frozen(partitions, "0300-01"));
+	TEST_ASSERT(!partitions_frozen(partitions, "0300-02"));
+	TEST_ASSERT(partitions_memory(partitions) < before);
+	check_scans(partitions, records, n);
+
+	// Ένα παγωμένο partition δεν δέχεται νέα records
+	struct record late = { .id = n, .name = "Hodor", .disease = "Grayscale", .country = "Stark", .date = "0300-01-15" };
+	TEST_ASSERT(!partitions_insert(partitions, &late));
+	late.date = "0300-02-15";
+	TEST_ASSERT(partitions_insert(partitions, &late));
+	TEST_ASSERT(partitions_size(partitions) == n + 1);
+
+	partitions_destroy(partitions);
+	free(records);
+	free(buffers);
+}
+
+void test_drop(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordPartitions partitions = partitions_create();
+	for (int i = 0; i < n; i++)
+		partitions_insert(partitions, &records[i]);
+
+	TEST_ASSERT(!partitions_drop(partitions, "0303-01"));
+
+	// Αφαιρούμε όλο το 0300, με ένα παγωμένο partition ανάμεσα
+	TEST_ASSERT(partitions_freeze(partitions, "0300-06"));
+	int dropped = count_matches(records, n, NULL, NULL, NULL, "0300-12-31");
+	size_t before = partitions_memory(partitions);
+	char month[8];
+	for (int m = 1; m <= 12; m++) {
+		sprintf(month, "0300-%02d", m);
+		TEST_ASSERT(partitions_drop(partitions, month));
+	}
+	TEST_ASSERT(!partitions_drop(partitions, "0300-01"));
+	TEST_ASSERT(partitions_size(partitions) == n - dropped);
+	TEST_ASSERT(partitions_memory(partitions) < before);
+
+	List months = partitions_months(partitions);
+	TEST_ASSERT(list_size(months) == 24);
+	TEST_ASSERT(strcmp(list_node_value(months, list_first(months)), "0301-01") == 0);
+	list_destroy(months);
+
+	// Τα υπόλοιπα records δεν αλλάζουν
+	int remaining = 0;
+	for (int i = 0; i < n; i++)
+		if (strcmp(records[i].date, "0301-01-01") >= 0)
+			records[remaining++] = records[i];
+	for (int i = 0; i < remaining; i++)
+		records[i].id = i;
+
+	RecordPartitions expected = partitions_create();
+	for (int i = 0; i < remaining; i++)
+		partitions_insert(expected, &records[i]);
+	TEST_ASSERT(partitions_scan(partitions, "Grayscale", NULL, NULL, NULL, NULL, NULL) == partitions_scan(expected, "Grayscale", NULL, NULL, NULL, NULL, NULL));
+	TEST_ASSERT(partitions_scan(partitions, NULL, "Stark", "0300-06-01", "0301-06-30", NULL, NULL) == count_matches(records, remaining, NULL, "Stark", NULL, "0301-06-30"));
+	partitions_destroy(expected);
+
+	// Ένα νέο record για μήνα που αφαιρέθηκε δημιουργεί ξανά το partition
+	struct record late = { .id = n, .name = "Hodor", .disease = "Grayscale", .country = "Stark", .date = "0300-01-15" };
+	TEST_ASSERT(partitions_insert(partitions, &late));
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, NULL, "0300-12-31", NULL, NULL) == 1);
+
+	partitions_destroy(partitions);
+	free(records);
+	free(buffers);
+}
+
+void test_spill(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordPartitions partitions = partitions_create();
+	for (int i = 0; i < n; i++)
+		partitions_insert(partitions, &records[i]);
+
+	char directory[] = "/tmp/partitions_test_XXXXXX";
+	TEST_ASSERT(mkdtemp(directory) != NULL);
+	TEST_ASSERT(!partitions_set_spill(partitions, directory, 0));
+	TEST_ASSERT(!partitions_spill(partitions, "0300-01"));
+
+	// Μένουν στη μνήμη μόνο οι 6 πιο πρόσφατοι μήνες, 0302-07 .. 0302-12
+	size_t before = partitions_memory(partitions);
+	TEST_ASSERT(partitions_set_spill(partitions, directory, 6));
+	TEST_ASSERT(partitions_spilled(partitions, "0300-01"));
+	TEST_ASSERT(partitions_spilled(partitions, "0302-06"));
+	TEST_ASSERT(!partitions_spilled(partitions, "0302-07"));
+	TEST_ASSERT(!partitions_spilled(partitions, "0303-01"));
+	TEST_ASSERT(partitions_frozen(partitions, "0300-01"));
+	TEST_ASSERT(!partitions_frozen(partitions, "0302-07"));
+	TEST_ASSERT(partitions_size(partitions) == n);
+
+	size_t spilled = partitions_memory(partitions);
+	TEST_ASSERT(spilled < before / 3);
+
+	char path[64];
+	sprintf(path, "%s/0300-01.part", directory);
+	TEST_ASSERT(access(path, F_OK) == 0);
+
+	// Ένα διάστημα μόνο στους πρόσφατους μήνες δεν φορτώνει κανένα αρχείο
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, "0302-08-01", NULL, NULL, NULL) == count_matches(records, n, NULL, NULL, "0302-08-01", NULL));
+	TEST_ASSERT(partitions_memory(partitions) == spilled);
+
+	// Τα αποτελέσματα δεν αλλάζουν, τα partitions φορτώνονται όταν χρειαστούν
+	check_scans(partitions, records, n);
+	TEST_ASSERT(partitions_memory(partitions) > spilled);
+	TEST_ASSERT(partitions_memory(partitions) < before / 3);
+
+	// Μένουν φορτωμένα μόνο τα πιο πρόσφατα χρησιμοποιημένα, και με μικρότερο όριο αποφορτώνονται αμέσως
+	TEST_ASSERT(partitions_loaded(partitions) == 4);
+	size_t loaded = partitions_memory(partitions);
+	TEST_ASSERT(!partitions_set_max_loaded(partitions, 0));
+	TEST_ASSERT(partitions_set_max_loaded(partitions, 1));
+	TEST_ASSERT(partitions_loaded(partitions) == 1);
+	TEST_ASSERT(partitions_memory(partitions) < loaded);
+
+	check_scans(partitions, records, n);
+	TEST_ASSERT(partitions_loaded(partitions) == 1);
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, NULL, "0301-12-31", NULL, NULL) == count_matches(records, n, NULL, NULL, NULL, "0301-12-31"));
+	TEST_ASSERT(partitions_loaded(partitions) == 1);
+	TEST_ASSERT(partitions_memory(partitions) < loaded);
+
+	// Η αφαίρεση του φορτωμένου partition (του 0301-12, από το τελευταίο query) το αφαιρεί κι από τα φορτωμένα
+	TEST_ASSERT(partitions_drop(partitions, "0301-12"));
+	TEST_ASSERT(partitions_loaded(partitions) == 0);
+	TEST_ASSERT(partitions_set_max_loaded(partitions, 4));
+
+	// Ένα partition στο δίσκο δεν δέχεται νέα records. Ένας νέος μήνας στέλνει στο δίσκο τον 0302-07.
+	struct record late = { .id = n, .name = "Hodor", .disease = "Grayscale", .country = "Stark", .date = "0300-01-15" };
+	TEST_ASSERT(!partitions_insert(partitions, &late));
+	late.date = "0303-01-15";
+	TEST_ASSERT(partitions_insert(partitions, &late));
+	TEST_ASSERT(partitions_spilled(partitions, "0302-07"));
+	TEST_ASSERT(!partitions_spilled(partitions, "0302-08"));
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, "0302-07-01", "0302-07-31", NULL, NULL) == count_matches(records, n, NULL, NULL, "0302-07-01", "0302-07-31"));
+
+	// Ένας μήνας μπορεί να σταλεί στο δίσκο και πριν γίνει παλιός
+	TEST_ASSERT(partitions_spill(partitions, "0302-09"));
+	TEST_ASSERT(partitions_spilled(partitions, "0302-09"));
+	TEST_ASSERT(partitions_spill(partitions, "0302-09"));
+	TEST_ASSERT(!partitions_spill(partitions, "0299-01"));
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, "0302-09-01", "0302-09-30", NULL, NULL) == count_matches(records, n, NULL, NULL, "0302-09-01", "0302-09-30"));
+
+	// Η αφαίρεση ενός partition διαγράφει και το αρχείο του
+	TEST_ASSERT(partitions_drop(partitions, "0300-01"));
+	TEST_ASSERT(access(path, F_OK) != 0);
+	TEST_ASSERT(partitions_scan(partitions, NULL, NULL, NULL, "0300-01-31", NULL, NULL) == 0);
+
+	// Χωρίς spill, τα νέα partitions μένουν στη μνήμη
+	TEST_ASSERT(partitions_set_spill(partitions, NULL, 0));
+	late.date = "0304-01-15";
+	TEST_ASSERT(partitions_insert(partitions, &late));
+	TEST_ASSERT(!partitions_spilled(partitions, "0302-08"));
+	TEST_ASSERT(partitions_spilled(partitions, "0302-07"));
+
+	// Όλα τα αρχεία διαγράφονται με το destroy, οπότε ο φάκελος μένει άδειος
+	partitions_destroy(partitions);
+	TEST_ASSERT(rmdir(directory) == 0);
+
+	free(records);
+	free(buffers);
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "partitions_create", test_create },
+	{ "partitions_insert", test_insert },
+	{ "partitions_scan", test_scan },
+	{ "partitions_freeze", test_freeze },
+	{ "partitions_drop", test_drop },
+	{ "partitions_spill", test_spill },
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};
@@ -0,0 +1,188 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για το Record Store.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "RecordStore.h"
+
+
+static String diseases[] = { "Grayscale", "Pale Mare", "Madness", "Headache" };
+static String countries[] = { "Stark", "Lannister", "Targaryen" };
+
+// Δημιουργεί n records με τυχαίες τιμές, σε ημερομηνίες του 0300 - 0302 (τα strings αποθηκεύονται στο buffers)
+static struct record* create_records(int n, char (*buffers)[2][16]) {
+	struct record* records = malloc(n * sizeof(*records));
+	for (int i = 0; i < n; i++) {
+		sprintf(buffers[i][0], "%04d-%02d-%02d", 300 + rand() % 3, 1 + rand() % 12, 1 + rand() % 28);
+		sprintf(buffers[i][1], "name%d", rand() % (n / 4));
+		records[i] = (struct record){
+			.id = i - n / 2,
+			.name = buffers[i][1],
+			.date = buffers[i][0],
+			.disease = diseases[rand() % 4],
+			.country = countries[rand() % 3],
+		};
+	}
+	return records;
+}
+
+// Μετράει τα records που ταιριάζουν με τα κριτήρια, χωρίς το store
+static int count_matches(struct record* records, int n, String disease, String country, Date date_from, Date date_to) {
+	int count = 0;
+	for (int i = 0; i < n; i++)
+		if ((disease == NULL || strcmp(records[i].disease, disease) == 0)
+			&& (country == NULL || strcmp(records[i].country, country) == 0)
+			&& (date_from == NULL || strcmp(records[i].date, date_from) >= 0)
+			&& (date_to == NULL || strcmp(records[i].date, date_to) <= 0))
+			count++;
+	return count;
+}
+
+// Για την επαλήθευση των records που επιστρέφει η store_scan
+
+struct check {
+	struct record* records;
+	int offset;						// records[id + offset] είναι το record με αυτό το id
+	bool* seen;
+	bool ok;
+	int limit;						// σταματάμε μετά από τόσα records
+	int visited;
+};
+
+static bool check_record(Record record, Pointer context) {
+	struct check* check = context;
+	Record original = &check->records[record->id + check->offset];
+
+	if (check->seen[record->id + check->offset]
+		|| strcmp(record->name, original->name) != 0 || strcmp(record->date, original->date) != 0
+		|| strcmp(record->disease, original->disease) != 0 || strcmp(record->country, original->country) != 0)
+		check->ok = false;
+
+	check->seen[record->id + check->offset] = true;
+	return ++check->visited < check->limit;
+}
+
+
+void test_create(void) {
+	RecordStore store = store_create();
+	TEST_ASSERT(store != NULL);
+	TEST_ASSERT(store_size(store) == 0);
+	TEST_ASSERT(store_scan(store, NULL, NULL, NULL, NULL, NULL, NULL) == 0);
+	store_destroy(store);
+}
+
+void test_append(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordStore store = store_create();
+	for (int i = 0; i < n; i++)
+		TEST_ASSERT(store_append(store, &records[i]));
+	TEST_ASSERT(store_size(store) == n);
+
+	// Μη έγκυρες ημερομηνίες δεν προστίθενται
+	struct record invalid = { .id = n, .name = "Hodor", .disease = "Grayscale", .country = "Stark", .date = "0301-1-1" };
+	TEST_ASSERT(!store_append(store, &invalid));
+	invalid.date = "0301-01-0x";
+	TEST_ASSERT(!store_append(store, &invalid));
+	TEST_ASSERT(store_size(store) == n);
+
+	// Κάθε record επιστρέφεται ακριβώς μία φορά, με τις σωστές τιμές
+	struct check check = { .records = records, .offset = n / 2, .seen = calloc(n, sizeof(bool)), .ok = true, .limit = n + 1 };
+	TEST_ASSERT(store_scan(store, NULL, NULL, NULL, NULL, check_record, &check) == n);
+	TEST_ASSERT(check.ok && check.visited == n);
+	free(check.seen);
+
+	store_destroy(store);
+	free(records);
+	free(buffers);
+}
+
+void test_scan(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordStore store = store_create();
+	for (int i = 0; i < n; i++)
+		store_append(store, &records[i]);
+
+	String filters[][4] = {
+		{ NULL, NULL, NULL, NULL },
+		{ "Grayscale", NULL, NULL, NULL },
+		{ NULL, "Stark", NULL, NULL },
+		{ "Madness", "Targaryen", NULL, NULL },
+		{ NULL, NULL, "0301-03-15", NULL },
+		{ NULL, NULL, NULL, "0300-06-01" },
+		{ "Pale Mare", "Lannister", "0300-12-01", "0301-02-28" },
+		{ NULL, NULL, "0301-05-05", "0301-05-05" },
+		{ NULL, NULL, "0303-01-01", NULL },
+	};
+	for (int f = 0; f < (int)(sizeof(filters) / sizeof(filters[0])); f++) {
+		String* q = filters[f];
+		int expected = count_matches(records, n, q[0], q[1], q[2], q[3]);
+
+		struct check check = { .records = records, .offset = n / 2, .seen = calloc(n, sizeof(bool)), .ok = true, .limit = n + 1 };
+		TEST_ASSERT(store_scan(store, q[0], q[1], q[2], q[3], check_record, &check) == expected);
+		TEST_ASSERT(store_scan(store, q[0], q[1], q[2], q[3], NULL, NULL) == expected);
+		TEST_ASSERT(check.ok && check.visited == expected);
+		free(check.seen);
+	}
+
+	// Strings που δεν υπάρχουν στα λεξικά
+	TEST_ASSERT(store_scan(store, "Cough", NULL, NULL, NULL, NULL, NULL) == 0);
+	TEST_ASSERT(store_scan(store, NULL, "Dorne", NULL, NULL, NULL, NULL) == 0);
+
+	// Η visit μπορεί να σταματήσει τη διάσχιση
+	struct check check = { .records = records, .offset = n / 2, .seen = calloc(n, sizeof(bool)), .ok = true, .limit = 10 };
+	store_scan(store, NULL, NULL, NULL, NULL, check_record, &check);
+	TEST_ASSERT(check.ok && check.visited == 10);
+	free(check.seen);
+
+	store_destroy(store);
+	free(records);
+	free(buffers);
+}
+
+void test_memory(void) {
+	int n = 10240;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	struct record* records = create_records(n, buffers);
+
+	RecordStore store = store_create();
+	size_t empty = store_memory(store);
+	for (int i = 0; i < n; i++)
+		store_append(store, &records[i]);
+	size_t full = store_memory(store);
+	TEST_ASSERT(full > empty);
+
+	// Με τα strings ήδη στα λεξικά, κάθε record κοστίζει μόνο τους κωδικούς του: εδώ 2 bytes για
+	// το id, 2 για το name, 1 για disease, country και date
+	for (int i = 0; i < n; i++) {
+		records[i].id += n;
+		store_append(store, &records[i]);
+	}
+	TEST_ASSERT(store_memory(store) - full < n * 8);
+	TEST_ASSERT(store_scan(store, NULL, NULL, NULL, NULL, NULL, NULL) == 2 * n);
+
+	store_destroy(store);
+	free(records);
+	free(buffers);
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "store_create", test_create },
+	{ "store_append", test_append },
+	{ "store_scan", test_scan },
+	{ "store_memory", test_memory },
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};
@@ -0,0 +1,242 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για το Shared Replica.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "SharedReplica.h"
+#include "ADTList.h"
+
+
+static String diseases[] = { "Grayscale", "Pale Mare", "Madness", "Headache" };
+static String countries[] = { "Stark", "Lannister", "Targaryen" };
+
+// Το όνομα του region, διαφορετικό για κάθε διεργασία ώστε τα tests να μη συγκρούονται
+static char region[64];
+
+static String region_name() {
+	sprintf(region, "/SharedReplica_test_%d", (int)getpid());
+	return region;
+}
+
+static int compare_records(const void* a, const void* b) {
+	Record x = *(Record*)a, y = *(Record*)b;
+	int res = strcmp(x->date, y->date);
+	return res != 0 ? res : x->id - y->id;
+}
+
+// Δημιουργεί n records με τυχαίες τιμές, σε ημερομηνίες του 0300 - 0302 (τα strings αποθηκεύονται στο
+// buffers), και γεμίζει το sorted με pointers σε αυτά κατά ημερομηνία
+static struct record* create_records(int n, char (*buffers)[2][16], Record* sorted) {
+	struct record* records = malloc(n * sizeof(*records));
+	for (int i = 0; i < n; i++) {
+		sprintf(buffers[i][0], "%04d-%02d-%02d", 300 + rand() % 3, 1 + rand() % 12, 1 + rand() % 28);
+		sprintf(buffers[i][1], "name%d", rand() % (n / 4 + 1));
+		records[i] = (struct record){
+			.id = i,
+			.name = buffers[i][1],
+			.date = buffers[i][0],
+			.disease = diseases[rand() % 4],
+			.country = countries[rand() % 3],
+		};
+		sorted[i] = &records[i];
+	}
+	qsort(sorted, n, sizeof(Record), compare_records);
+	return records;
+}
+
+// Μετράει τα records που ταιριάζουν με τα κριτήρια, χωρίς το replica
+static int count_matches(struct record* records, int n, String disease, String country, Date date_from, Date date_to) {
+	int count = 0;
+	for (int i = 0; i < n; i++)
+		if ((disease == NULL || strcmp(records[i].disease, disease) == 0)
+			&& (country == NULL || strcmp(records[i].country, country) == 0)
+			&& (date_from == NULL || strcmp(records[i].date, date_from) >= 0)
+			&& (date_to == NULL || strcmp(records[i].date, date_to) <= 0))
+			count++;
+	return count;
+}
+
+// Ελέγχει τις replica_get_records / replica_count_records για διάφορα κριτήρια, συγκρίνοντας με τα records
+static void check_queries(Replica replica, struct record* records, int n) {
+	String filters[][4] = {
+		{ NULL, NULL, NULL, NULL },
+		{ "Grayscale", NULL, NULL, NULL },
+		{ NULL, "Stark", NULL, NULL },
+		{ "Madness", "Targaryen", NULL, NULL },
+		{ NULL, NULL, "0301-03-15", NULL },
+		{ NULL, NULL, NULL, "0300-06-01" },
+		{ "Pale Mare", "Lannister", "0300-12-01", "0301-02-28" },
+		{ NULL, NULL, "0301-06-01", "0301-05-01" },
+		{ "Cough", NULL, NULL, NULL },
+		{ NULL, "Dorne", "0300-01-01", NULL },
+	};
+	for (int f = 0; f < (int)(sizeof(filters) / sizeof(filters[0])); f++) {
+		String* q = filters[f];
+		int expected = count_matches(records, n, q[0], q[1], q[2], q[3]);
+		TEST_ASSERT(replica_count_records(replica, q[0], q[1], q[2], q[3]) == expected);
+
+		// Τα αντίγραφα είναι ίδια με τα αρχικά records, κατά ημερομηνία
+		List list = replica_get_records(replica, q[0], q[1], q[2], q[3]);
+		TEST_ASSERT(list_size(list) == expected);
+		Record previous = NULL;
+		for (ListNode node = list_first(list); node != LIST_EOF; node = list_next(list, node)) {
+			Record record = list_node_value(list, node);
+			Record original = &records[record->id];
+			TEST_ASSERT(record != original);
+			TEST_ASSERT(strcmp(record->name, original->name) == 0 && strcmp(record->date, original->date) == 0);
+			TEST_ASSERT(strcmp(record->disease, original->disease) == 0 && strcmp(record->country, original->country) == 0);
+			TEST_ASSERT(previous == NULL || compare_records(&previous, &record) < 0);
+			previous = record;
+		}
+		list_destroy(list);
+	}
+}
+
+
+void test_create(void) {
+	String name = region_name();
+	TEST_ASSERT(replica_attach(name) == NULL);
+	TEST_ASSERT(replica_writer_create("no-slash/name", 1024) == NULL);
+
+	ReplicaWriter writer = replica_writer_create(name, 1024);
+	TEST_ASSERT(writer != NULL);
+
+	// Πριν το πρώτο publish η εικόνα είναι κενή
+	Replica replica = replica_attach(name);
+	TEST_ASSERT(replica != NULL);
+	TEST_ASSERT(replica_version(replica) == 0);
+	TEST_ASSERT(replica_count_records(replica, NULL, NULL, NULL, NULL) == 0);
+	List list = replica_get_records(replica, "Grayscale", NULL, NULL, NULL);
+	TEST_ASSERT(list_size(list) == 0);
+	list_destroy(list);
+
+	// Μετά το destroy του writer το region δεν υπάρχει για νέα attach, αλλά το υπάρχον συνεχίζει
+	replica_writer_destroy(writer);
+	TEST_ASSERT(replica_attach(name) == NULL);
+	TEST_ASSERT(replica_count_records(replica, NULL, NULL, NULL, NULL) == 0);
+	replica_detach(replica);
+}
+
+void test_publish(void) {
+	int n = 5000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	Record* sorted = malloc(n * sizeof(Record));
+	struct record* records = create_records(n, buffers, sorted);
+
+	String name = region_name();
+	ReplicaWriter writer = replica_writer_create(name, 1 << 20);
+	Replica replica = replica_attach(name);
+
+	TEST_ASSERT(replica_publish(writer, sorted, n));
+	TEST_ASSERT(replica_version(replica) == 1);
+	check_queries(replica, records, n);
+
+	// Μια νέα εικόνα με τα μισά records αντικαθιστά την προηγούμενη
+	for (int i = 0; i < n / 2; i++)
+		sorted[i] = &records[i];
+	qsort(sorted, n / 2, sizeof(Record), compare_records);
+	TEST_ASSERT(replica_publish(writer, sorted, n / 2));
+	TEST_ASSERT(replica_version(replica) == 2);
+	check_queries(replica, records, n / 2);
+
+	// Μια εικόνα που δεν χωράει απορρίπτεται, και η τρέχουσα μένει ίδια
+	ReplicaWriter small = replica_writer_create(name, 4096);
+	Replica small_replica = replica_attach(name);
+	TEST_ASSERT(!replica_publish(small, sorted, n / 2));
+	TEST_ASSERT(replica_version(small_replica) == 0);
+	TEST_ASSERT(replica_count_records(small_replica, NULL, NULL, NULL, NULL) == 0);
+	TEST_ASSERT(replica_publish(small, sorted, 10));
+	TEST_ASSERT(replica_version(small_replica) == 1);
+	TEST_ASSERT(replica_count_records(small_replica, NULL, NULL, NULL, NULL) == 10);
+	replica_detach(small_replica);
+	replica_writer_destroy(small);
+
+	// Το παλιό region (που αντικαταστάθηκε) εξακολουθεί να ισχύει για όσους έχουν κάνει attach
+	check_queries(replica, records, n / 2);
+	replica_detach(replica);
+	replica_writer_destroy(writer);
+
+	free(records);
+	free(sorted);
+	free(buffers);
+}
+
+// Ένας reader σε άλλη διεργασία τρέχει queries ενώ ο writer δημοσιεύει συνεχώς, εναλλάξ, δύο
+// διαφορετικές εικόνες. Κάθε αποτέλεσμα πρέπει να προέρχεται ολόκληρο από μία από τις δύο.
+
+void test_concurrent(void) {
+	int n = 2000;
+	char (*buffers)[2][16] = malloc(n * sizeof(*buffers));
+	Record* sorted = malloc(n * sizeof(Record));
+	struct record* records = create_records(n, buffers, sorted);
+
+	Record* half = malloc(n / 2 * sizeof(Record));
+	for (int i = 0; i < n / 2; i++)
+		half[i] = &records[i];
+	qsort(half, n / 2, sizeof(Record), compare_records);
+
+	int expected[2][2] = {
+		{ n, count_matches(records, n, "Grayscale", "Stark", "0300-06-01", "0301-06-01") },
+		{ n / 2, count_matches(records, n / 2, "Grayscale", "Stark", "0300-06-01", "0301-06-01") },
+	};
+
+	String name = region_name();
+	ReplicaWriter writer = replica_writer_create(name, 1 << 20);
+	TEST_ASSERT(replica_publish(writer, sorted, n));
+
+	int fds[2];
+	TEST_ASSERT(pipe(fds) == 0);
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Reader: ελέγχει ότι κάθε αποτέλεσμα ταιριάζει με μία από τις δύο εικόνες
+		close(fds[0]);
+		Replica replica = replica_attach(name);
+		bool ok = replica != NULL;
+		for (int i = 0; i < 1000 && ok; i++) {
+			List all = replica_get_records(replica, NULL, NULL, NULL, NULL);
+			int count = replica_count_records(replica, "Grayscale", "Stark", "0300-06-01", "0301-06-01");
+			ok = (list_size(all) == expected[0][0] || list_size(all) == expected[1][0])
+				&& (count == expected[0][1] || count == expected[1][1]);
+			list_destroy(all);
+		}
+		if (replica != NULL)
+			replica_detach(replica);
+		_exit(write(fds[1], &ok, sizeof(ok)) == sizeof(ok) && ok ? 0 : 1);
+	}
+	close(fds[1]);
+
+	// Writer: δημοσιεύει μέχρι να τελειώσει ο reader
+	int published = 1;
+	bool done = false;
+	while (!done) {
+		TEST_ASSERT(replica_publish(writer, published % 2 == 0 ? sorted : half, published % 2 == 0 ? n : n / 2));
+		published++;
+		done = waitpid(pid, NULL, WNOHANG) == pid;
+	}
+	bool ok = false;
+	TEST_ASSERT(read(fds[0], &ok, sizeof(ok)) == sizeof(ok) && ok);
+	close(fds[0]);
+	replica_writer_destroy(writer);
+
+	free(half);
+	free(records);
+	free(sorted);
+	free(buffers);
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "replica_create", test_create },
+	{ "replica_publish", test_publish },
+	{ "replica_concurrent", test_concurrent },
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};
@@ -0,0 +1,82 @@
+//////////////////////////////////////////////////////////////////
+//
+// Unit tests για τα histograms του Stats.
+//
+//////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include "acutest.h"			// Απλή βιβλιοθήκη για unit testing
+
+#include "Stats.h"
+
+
+// Ελέγχει ότι η τιμή value απέχει από την expected το πολύ όσο το σφάλμα ενός bucket
+static bool close_to(uint64_t value, uint64_t expected) {
+	uint64_t diff = value > expected ? value - expected : expected - value;
+	return diff <= expected / HISTOGRAM_SUB_BUCKETS + 1;
+}
+
+void test_histogram_record(void) {
+	Histogram histogram = calloc(1, sizeof(*histogram));
+
+	TEST_ASSERT(histogram_percentile(histogram, 50) == 0);
+
+	// Μικρές τιμές αποθηκεύονται ακριβώς
+	for (uint64_t i = 1; i <= HISTOGRAM_SUB_BUCKETS; i++)
+		histogram_record(histogram, i);
+
+	TEST_ASSERT(histogram->count == HISTOGRAM_SUB_BUCKETS);
+	TEST_ASSERT(histogram->max == HISTOGRAM_SUB_BUCKETS);
+	TEST_ASSERT(histogram_percentile(histogram, 0) == 1);
+	TEST_ASSERT(histogram_percentile(histogram, 50) == HISTOGRAM_SUB_BUCKETS / 2);
+	TEST_ASSERT(histogram_percentile(histogram, 100) == HISTOGRAM_SUB_BUCKETS);
+
+	// Τιμές 1000, 2000, ..., 1000000
+	histogram_reset(histogram);
+	TEST_ASSERT(histogram->count == 0);
+
+	for (uint64_t i = 1; i <= 1000; i++)
+		histogram_record(histogram, i * 1000);
+
+	TEST_ASSERT(histogram->sum == 500500000);
+	TEST_ASSERT(histogram->max == 1000000);
+	TEST_ASSERT(close_to(histogram_percentile(histogram, 50), 500000));
+	TEST_ASSERT(close_to(histogram_percentile(histogram, 99), 990000));
+	TEST_ASSERT(close_to(histogram_percentile(histogram, 99.9), 999000));
+	TEST_ASSERT(histogram_percentile(histogram, 100) == 1000000);
+
+	// Πολύ μεγάλες τιμές μετράνε στο τελευταίο bucket, το max όμως είναι ακριβές
+	histogram_record(histogram, UINT64_MAX);
+	TEST_ASSERT(histogram->max == UINT64_MAX);
+	TEST_ASSERT(histogram->buckets[HISTOGRAM_BUCKETS - 1] == 1);
+
+	free(histogram);
+}
+
+void test_histogram_merge(void) {
+	Histogram a = calloc(1, sizeof(*a));
+	Histogram b = calloc(1, sizeof(*b));
+
+	for (uint64_t i = 0; i < 100; i++) {
+		histogram_record(a, 100);
+		histogram_record(b, 10000);
+	}
+	histogram_merge(a, b);
+
+	TEST_ASSERT(a->count == 200);
+	TEST_ASSERT(a->max == 10000);
+	TEST_ASSERT(close_to(histogram_percentile(a, 25), 100));
+	TEST_ASSERT(close_to(histogram_percentile(a, 75), 10000));
+
+	free(a);
+	free(b);
+}
+
+
+// Λίστα με όλα τα tests προς εκτέλεση
+TEST_LIST = {
+	{ "histogram_record", test_histogram_record },
+	{ "histogram_merge", test_histogram_merge },
+
+	{ NULL, NULL } // τερματίζουμε τη λίστα με NULL
+};